@@ -0,0 +1,71 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/*! \file allocation_counter.hpp
+ * \brief Heap allocation accounting shared by the benchmarks.
+ *
+ * Every benchmark executable is linked with test/allocation_counter.cpp, which counts the calls to
+ * the global `operator new` and the bytes requested, in all threads.
+ */
+
+#ifndef BENCHMARK__ALLOCATION_COUNTER_HPP_
+#define BENCHMARK__ALLOCATION_COUNTER_HPP_
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+
+#include "../test/allocation_counter.hpp"
+
+namespace rcpputils_benchmark
+{
+
+using rcpputils_test::allocation_count;
+using rcpputils_test::allocated_bytes;
+
+/// Report the heap allocations made while it is alive as per iteration counters.
+/**
+ * Construct it right before the benchmark loop; when it goes out of scope after the loop, the
+ * `allocations` and `allocated_bytes` counters of the state are set to the averages per
+ * iteration.
+ */
+class AllocationCounter
+{
+public:
+  explicit AllocationCounter(benchmark::State & state) noexcept
+  : state_(state), allocations_(allocation_count()), bytes_(allocated_bytes())
+  {}
+
+  ~AllocationCounter()
+  {
+    const std::size_t allocations = allocation_count() - allocations_;
+    const std::size_t bytes = allocated_bytes() - bytes_;
+    state_.counters["allocations"] =
+      benchmark::Counter(static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+    state_.counters["allocated_bytes"] =
+      benchmark::Counter(static_cast<double>(bytes), benchmark::Counter::kAvgIterations);
+  }
+
+  AllocationCounter(const AllocationCounter &) = delete;
+  AllocationCounter & operator=(const AllocationCounter &) = delete;
+
+private:
+  benchmark::State & state_;
+  const std::size_t allocations_;
+  const std::size_t bytes_;
+};
+
+}  // namespace rcpputils_benchmark
+
+#endif  // BENCHMARK__ALLOCATION_COUNTER_HPP_
@@ -0,0 +1,66 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Bulk byte order conversion throughput of rcpputils::byteswap_n(), compared with a loop over
+// rcpputils::byteswap(), on arrays the size of a point cloud.
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "rcpputils/endian.hpp"
+
+namespace
+{
+
+template<typename T>
+void scalar_loop(benchmark::State & state)
+{
+  std::vector<T> data(static_cast<std::size_t>(state.range(0)), T{1});
+  for (auto _ : state) {
+    for (T & value : data) {
+      value = rcpputils::byteswap(value);
+    }
+    benchmark::DoNotOptimize(data.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(T));
+}
+
+template<typename T>
+void bulk(benchmark::State & state)
+{
+  std::vector<T> data(static_cast<std::size_t>(state.range(0)), T{1});
+  for (auto _ : state) {
+    rcpputils::byteswap_n(data.data(), data.size());
+    benchmark::DoNotOptimize(data.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(T));
+  state.SetLabel(rcpputils::detail::byteswap_kernel_name);
+}
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(scalar_loop, std::uint16_t)->Range(64, 1 << 20);
+BENCHMARK_TEMPLATE(scalar_loop, std::uint32_t)->Range(64, 1 << 20);
+BENCHMARK_TEMPLATE(scalar_loop, std::uint64_t)->Range(64, 1 << 20);
+BENCHMARK_TEMPLATE(bulk, std::uint16_t)->Range(64, 1 << 20);
+BENCHMARK_TEMPLATE(bulk, std::uint32_t)->Range(64, 1 << 20);
+BENCHMARK_TEMPLATE(bulk, float)->Range(64, 1 << 20);
+BENCHMARK_TEMPLATE(bulk, std::uint64_t)->Range(64, 1 << 20);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,253 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// rcpputils::fs::path construction, concatenation and decomposition on deep install space paths,
+// the cost of the file_size() and exists() queries, and reading a whole file through a stream
+// or rcpputils::fs::mapped_file, and creating temporary files.
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include "rcpputils/filesystem_helper.hpp"
+#include "rcpputils/mapped_file.hpp"
+#include "rcpputils/temp_file.hpp"
+
+#include "allocation_counter.hpp"
+#include "benchmark_inputs.hpp"
+
+namespace fs = rcpputils::fs;
+
+namespace
+{
+
+void path_from_string(benchmark::State & state)
+{
+  const std::string deep_path = rcpputils_benchmark::deep_path();
+  rcpputils_benchmark::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    fs::path p(deep_path);
+    benchmark::DoNotOptimize(p);
+  }
+}
+BENCHMARK(path_from_string);
+
+void path_from_temporary_string(benchmark::State & state)
+{
+  const std::string deep_path = rcpputils_benchmark::deep_path();
+  rcpputils_benchmark::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    std::string copy = deep_path;
+    fs::path p(std::move(copy));
+    benchmark::DoNotOptimize(p);
+  }
+}
+BENCHMARK(path_from_temporary_string);
+
+void path_concatenation(benchmark::State & state)
+{
+  const auto & segments = rcpputils_benchmark::deep_path_segments();
+  rcpputils_benchmark::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    fs::path p("/");
+    for (const std::string & segment : segments) {
+      p /= segment;
+    }
+    benchmark::DoNotOptimize(p);
+  }
+  state.SetItemsProcessed(state.iterations() * segments.size());
+}
+BENCHMARK(path_concatenation);
+
+void path_concatenation_chained(benchmark::State & state)
+{
+  const fs::path install("/home/developer/workspaces/ros2_rolling_ws/install");
+  rcpputils_benchmark::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    fs::path p = install / "nav2_behavior_tree" / "share" / "nav2_behavior_tree" /
+      "behavior_trees" / "navigate_w_replanning_and_recovery.xml";
+    benchmark::DoNotOptimize(p);
+  }
+}
+BENCHMARK(path_concatenation_chained);
+
+void path_decomposition(benchmark::State & state)
+{
+  const fs::path p(rcpputils_benchmark::deep_path());
+  rcpputils_benchmark::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(p.parent_path());
+    benchmark::DoNotOptimize(p.filename());
+    benchmark::DoNotOptimize(p.extension());
+  }
+}
+BENCHMARK(path_decomposition);
+
+void path_decomposition_views(benchmark::State & state)
+{
+  const fs::path p(rcpputils_benchmark::deep_path());
+  rcpputils_benchmark::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(fs::parent_path_view(p));
+    benchmark::DoNotOptimize(fs::filename_view(p));
+    benchmark::DoNotOptimize(fs::extension_view(p));
+    benchmark::DoNotOptimize(fs::stem_view(p));
+  }
+}
+BENCHMARK(path_decomposition_views);
+
+void remove_extension(benchmark::State & state)
+{
+  const fs::path p(rcpputils_benchmark::deep_path() + ".gz");
+  rcpputils_benchmark::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(fs::remove_extension(p, 2));
+  }
+}
+BENCHMARK(remove_extension);
+
+void path_iteration(benchmark::State & state)
+{
+  const fs::path p(rcpputils_benchmark::deep_path());
+  rcpputils_benchmark::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    for (const auto & component : p) {
+      benchmark::DoNotOptimize(component);
+    }
+  }
+}
+BENCHMARK(path_iteration);
+
+// A regular file of 4 KiB in the temporary directory, removed with the fixture.
+class TemporaryFile : public benchmark::Fixture
+{
+public:
+  void SetUp(const benchmark::State &) override
+  {
+    file_ = fs::temp_directory_path() / "rcpputils_benchmark_filesystem_helper.bin";
+    std::ofstream(file_.string(), std::ios::binary) << std::string(4096, 'x');
+  }
+
+  void TearDown(const benchmark::State &) override
+  {
+    fs::remove(file_);
+  }
+
+protected:
+  fs::path file_;
+};
+
+BENCHMARK_F(TemporaryFile, file_size)(benchmark::State & state)
+{
+  rcpputils_benchmark::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(fs::file_size(file_));
+  }
+}
+
+BENCHMARK_F(TemporaryFile, exists)(benchmark::State & state)
+{
+  rcpputils_benchmark::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(fs::exists(file_));
+  }
+}
+
+BENCHMARK_F(TemporaryFile, exists_missing)(benchmark::State & state)
+{
+  const fs::path missing = file_.parent_path() / "rcpputils_benchmark_missing.bin";
+  rcpputils_benchmark::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(fs::exists(missing));
+  }
+}
+
+BENCHMARK_F(TemporaryFile, file_size_error_code)(benchmark::State & state)
+{
+  rcpputils_benchmark::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    std::error_code ec;
+    benchmark::DoNotOptimize(fs::file_size(file_, ec));
+  }
+}
+
+BENCHMARK_F(TemporaryFile, read_ifstream)(benchmark::State & state)
+{
+  rcpputils_benchmark::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    std::ifstream stream(file_.string(), std::ios::binary);
+    std::string contents{std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()};
+    benchmark::DoNotOptimize(std::count(contents.begin(), contents.end(), '\n'));
+  }
+}
+
+BENCHMARK_F(TemporaryFile, read_mapped_file)(benchmark::State & state)
+{
+  rcpputils_benchmark::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    const fs::mapped_file mapped(file_, fs::access_advice::sequential);
+    benchmark::DoNotOptimize(std::count(mapped.begin(), mapped.end(), '\n'));
+  }
+}
+
+// The pattern create_temp_file() replaces: probe names until one is free, then create it.
+void temp_file_check_then_create(benchmark::State & state)
+{
+  const fs::temp_directory parent = fs::create_temp_directory();
+  rcpputils_benchmark::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    fs::path file;
+    for (int i = 0; ; ++i) {
+      file = parent.path() / ("rcpputils_" + std::to_string(i));
+      if (!fs::exists(file)) {
+        break;
+      }
+    }
+    std::ofstream(file.string()).close();
+    fs::remove(file);
+  }
+}
+BENCHMARK(temp_file_check_then_create);
+
+void temp_file_create(benchmark::State & state)
+{
+  const fs::temp_directory parent = fs::create_temp_directory();
+  rcpputils_benchmark::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    const fs::temp_file file = fs::create_temp_file("rcpputils_", parent.path());
+    benchmark::DoNotOptimize(file.native_handle());
+  }
+}
+BENCHMARK(temp_file_create);
+
+void temp_file_create_anonymous(benchmark::State & state)
+{
+  const fs::temp_directory parent = fs::create_temp_directory();
+  rcpputils_benchmark::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    const fs::temp_file file = fs::create_anonymous_temp_file(parent.path());
+    benchmark::DoNotOptimize(file.native_handle());
+  }
+}
+BENCHMARK(temp_file_create_anonymous);
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,103 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Name mangling with rcpputils::find_and_replace(), find_and_replace_in_place() and a
+// FindAndReplaceSet, on topic names and library search paths.
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "rcpputils/find_and_replace.hpp"
+#include "rcpputils/join.hpp"
+
+#include "allocation_counter.hpp"
+#include "benchmark_inputs.hpp"
+
+namespace
+{
+
+void find_and_replace_topic_names(benchmark::State & state)
+{
+  const auto & topics = rcpputils_benchmark::topic_names();
+  rcpputils_benchmark::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    for (const std::string & topic : topics) {
+      benchmark::DoNotOptimize(rcpputils::find_and_replace(topic, "/", "__"));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * topics.size());
+}
+BENCHMARK(find_and_replace_topic_names);
+
+void find_and_replace_no_match(benchmark::State & state)
+{
+  const auto & topics = rcpputils_benchmark::topic_names();
+  rcpputils_benchmark::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    for (const std::string & topic : topics) {
+      benchmark::DoNotOptimize(rcpputils::find_and_replace(topic, "::", "/"));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * topics.size());
+}
+BENCHMARK(find_and_replace_no_match);
+
+void find_and_replace_library_path(benchmark::State & state)
+{
+  const std::string search_path = rcpputils::join(
+    rcpputils_benchmark::library_directories(static_cast<std::size_t>(state.range(0))), ":");
+  rcpputils_benchmark::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+      rcpputils::find_and_replace(search_path, "/opt/ros/rolling", "/opt/ros/jazzy"));
+  }
+  state.SetBytesProcessed(state.iterations() * search_path.size());
+}
+BENCHMARK(find_and_replace_library_path)->Arg(8)->Arg(64);
+
+void find_and_replace_in_place_growing(benchmark::State & state)
+{
+  const auto & topics = rcpputils_benchmark::topic_names();
+  std::vector<std::string> buffers(topics.size());
+  rcpputils_benchmark::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < topics.size(); ++i) {
+      buffers[i].assign(topics[i]);
+      benchmark::DoNotOptimize(rcpputils::find_and_replace_in_place(buffers[i], "/", "__"));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * topics.size());
+}
+BENCHMARK(find_and_replace_in_place_growing);
+
+void find_and_replace_set_topic_names(benchmark::State & state)
+{
+  const auto & topics = rcpputils_benchmark::topic_names();
+  const rcpputils::FindAndReplaceSet<char> mangling{{"/", "__"}, {"_", "-"}, {"~", "%7E"}};
+  rcpputils_benchmark::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    for (const std::string & topic : topics) {
+      benchmark::DoNotOptimize(rcpputils::find_and_replace(topic, mangling));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * topics.size());
+}
+BENCHMARK(find_and_replace_set_topic_names);
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,121 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Locating a library through a realistic, long library search path with
+// rcpputils::find_library_path() and rcpputils::LibrarySearcher.
+
+#include <benchmark/benchmark.h>
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "rcpputils/find_library.hpp"
+#include "rcpputils/join.hpp"
+
+#include "allocation_counter.hpp"
+#include "benchmark_inputs.hpp"
+
+namespace
+{
+
+#ifdef _WIN32
+constexpr const char * kSearchPathSeparator = ";";
+#else
+constexpr const char * kSearchPathSeparator = ":";
+#endif
+
+// The workspace and distribution directories, with the benchmark library in the last one.
+std::string search_path(std::size_t packages)
+{
+  std::vector<std::string> directories = rcpputils_benchmark::library_directories(packages);
+  directories.push_back(BENCHMARK_LIBRARY_DIR);
+  return rcpputils::join(directories, kSearchPathSeparator);
+}
+
+void set_library_search_path(const std::string & value)
+{
+#ifdef _WIN32
+  _putenv_s("PATH", value.c_str());
+#elif __APPLE__
+  setenv("DYLD_LIBRARY_PATH", value.c_str(), 1);
+#else
+  setenv("LD_LIBRARY_PATH", value.c_str(), 1);
+#endif
+}
+
+void find_library_path(benchmark::State & state)
+{
+  set_library_search_path(search_path(static_cast<std::size_t>(state.range(0))));
+  if (rcpputils::find_library_path("benchmark_library").empty()) {
+    state.SkipWithError("benchmark_library is not in the search path");
+    return;
+  }
+  rcpputils_benchmark::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(rcpputils::find_library_path("benchmark_library"));
+  }
+}
+BENCHMARK(find_library_path)->Arg(8)->Arg(64);
+
+void find_library_path_missing(benchmark::State & state)
+{
+  set_library_search_path(search_path(static_cast<std::size_t>(state.range(0))));
+  rcpputils_benchmark::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(rcpputils::find_library_path("not_a_library"));
+  }
+}
+BENCHMARK(find_library_path_missing)->Arg(8)->Arg(64);
+
+void find_library_paths(benchmark::State & state)
+{
+  set_library_search_path(search_path(static_cast<std::size_t>(state.range(0))));
+  const std::vector<std::string> names{
+    "benchmark_library", "rclcpp", "rcl", "rmw_implementation", "rcutils", "not_a_library"};
+  rcpputils_benchmark::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(rcpputils::find_library_paths(names));
+  }
+  state.SetItemsProcessed(state.iterations() * names.size());
+}
+BENCHMARK(find_library_paths)->Arg(64);
+
+// A first lookup: the searcher lists each directory of the search path.
+void library_searcher_cold(benchmark::State & state)
+{
+  const std::string path = search_path(static_cast<std::size_t>(state.range(0)));
+  rcpputils_benchmark::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    rcpputils::LibrarySearcher searcher(path);
+    benchmark::DoNotOptimize(searcher.find("benchmark_library"));
+  }
+}
+BENCHMARK(library_searcher_cold)->Arg(8)->Arg(64);
+
+void library_searcher_warm(benchmark::State & state)
+{
+  const rcpputils::LibrarySearcher searcher(
+    search_path(static_cast<std::size_t>(state.range(0))));
+  benchmark::DoNotOptimize(searcher.find("benchmark_library"));
+  rcpputils_benchmark::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(searcher.find("benchmark_library"));
+  }
+}
+BENCHMARK(library_searcher_warm)->Arg(8)->Arg(64);
+
+}  // namespace
+
+BENCHMARK_MAIN();
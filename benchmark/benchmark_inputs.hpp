@@ -0,0 +1,89 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/*! \file benchmark_inputs.hpp
+ * \brief Realistic inputs shared by the benchmarks: ROS topic names, deep install space paths
+ * and a long library search path.
+ */
+
+#ifndef BENCHMARK__BENCHMARK_INPUTS_HPP_
+#define BENCHMARK__BENCHMARK_INPUTS_HPP_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace rcpputils_benchmark
+{
+
+/// Fully qualified topic names, as found in a mid sized robot.
+inline const std::vector<std::string> & topic_names()
+{
+  static const std::vector<std::string> names{
+    "/robot_1/sensors/lidar_front/points_filtered",
+    "/robot_1/sensors/camera_left/image_rect_color/compressed",
+    "/robot_1/sensors/imu_base/data_raw",
+    "/robot_1/navigation/local_costmap/costmap_updates",
+    "/robot_1/navigation/global_planner/plan_smoothed",
+    "/robot_1/manipulation/arm_controller/follow_joint_trajectory/_action/feedback",
+    "/robot_1/diagnostics/battery_monitor/state_of_charge",
+    "/robot_1/tf_static",
+  };
+  return names;
+}
+
+/// Path segments of a file deep inside a colcon install space.
+inline const std::vector<std::string> & deep_path_segments()
+{
+  static const std::vector<std::string> segments{
+    "home", "developer", "workspaces", "ros2_rolling_ws", "install", "nav2_behavior_tree",
+    "share", "nav2_behavior_tree", "behavior_trees", "navigate_through_poses",
+    "navigate_w_replanning_and_recovery.xml",
+  };
+  return segments;
+}
+
+/// The deep path of deep_path_segments(), joined with the native separator.
+inline std::string deep_path()
+{
+  std::string path;
+  for (const std::string & segment : deep_path_segments()) {
+#ifdef _WIN32
+    path += '\\';
+#else
+    path += '/';
+#endif
+    path += segment;
+  }
+  return path;
+}
+
+/// A library search path listing the lib directories of count packages of a colcon workspace,
+/// followed by the ROS distribution's own.
+inline std::vector<std::string> library_directories(std::size_t count)
+{
+  std::vector<std::string> directories;
+  for (std::size_t i = 0; i < count; ++i) {
+    directories.push_back(
+      "/home/developer/workspaces/ros2_rolling_ws/install/package_" + std::to_string(i) + "/lib");
+  }
+  directories.push_back("/opt/ros/rolling/opt/rviz_ogre_vendor/lib");
+  directories.push_back("/opt/ros/rolling/lib/x86_64-linux-gnu");
+  directories.push_back("/opt/ros/rolling/lib");
+  return directories;
+}
+
+}  // namespace rcpputils_benchmark
+
+#endif  // BENCHMARK__BENCHMARK_INPUTS_HPP_
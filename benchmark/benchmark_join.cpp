@@ -0,0 +1,84 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Building topic names and library search paths with rcpputils::join() and append_join().
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "rcpputils/join.hpp"
+
+#include "allocation_counter.hpp"
+#include "benchmark_inputs.hpp"
+
+namespace
+{
+
+void join_topic_name(benchmark::State & state)
+{
+  const std::vector<std::string> tokens{"robot_1", "sensors", "lidar_front", "points_filtered"};
+  rcpputils_benchmark::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(rcpputils::join(tokens, "/"));
+  }
+}
+BENCHMARK(join_topic_name);
+
+void join_library_path(benchmark::State & state)
+{
+  const std::vector<std::string> directories =
+    rcpputils_benchmark::library_directories(static_cast<std::size_t>(state.range(0)));
+  rcpputils_benchmark::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(rcpputils::join(directories, ":"));
+  }
+  state.SetItemsProcessed(state.iterations() * directories.size());
+}
+BENCHMARK(join_library_path)->Arg(8)->Arg(64);
+
+void append_join_reused_buffer(benchmark::State & state)
+{
+  const std::vector<std::string> directories =
+    rcpputils_benchmark::library_directories(static_cast<std::size_t>(state.range(0)));
+  std::string buffer;
+  rcpputils_benchmark::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    buffer.clear();
+    rcpputils::append_join(buffer, directories, ":");
+    benchmark::DoNotOptimize(buffer.data());
+  }
+  state.SetItemsProcessed(state.iterations() * directories.size());
+}
+BENCHMARK(append_join_reused_buffer)->Arg(8)->Arg(64);
+
+void join_integers(benchmark::State & state)
+{
+  std::vector<int> values(static_cast<std::size_t>(state.range(0)));
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    values[i] = static_cast<int>(i * 7919u);
+  }
+  rcpputils_benchmark::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(rcpputils::join(values, ", "));
+  }
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+BENCHMARK(join_integers)->Arg(64);
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,35 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// @file
+/// Library loaded by `benchmark_find_library` and `benchmark_shared_library`.
+
+#include "rcpputils/visibility_control.hpp"
+
+extern "C"
+{
+
+RCPPUTILS_EXPORT
+int rcpputils_benchmark_add_one(int x)
+{
+  return x + 1;
+}
+
+RCPPUTILS_EXPORT
+int rcpputils_benchmark_add_two(int x)
+{
+  return x + 2;
+}
+
+}
@@ -0,0 +1,144 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Hand-off throughput of the ring buffers, compared with the mutex guarded std::deque queue
+// they are meant to replace. Every benchmark moves a fixed number of integers from the
+// producer threads to the consumer threads.
+
+#include <benchmark/benchmark.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "rcpputils/ring_buffer.hpp"
+#include "rcpputils/thread_safety_annotations.hpp"
+
+namespace
+{
+
+constexpr std::size_t kCapacity = 1024;
+constexpr std::int64_t kItems = 1 << 20;
+
+/// The usual bounded queue: a mutex, two condition variables and a std::deque.
+class MutexDeque
+{
+public:
+  explicit MutexDeque(std::size_t capacity)
+  : capacity_(capacity)
+  {}
+
+  void push(std::int64_t value)
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_full_.wait(
+      lock, [this]() RCPPUTILS_TSA_REQUIRES(mutex_) {return queue_.size() < capacity_;});
+    queue_.push_back(value);
+    lock.unlock();
+    not_empty_.notify_one();
+  }
+
+  std::int64_t pop()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_empty_.wait(
+      lock, [this]() RCPPUTILS_TSA_REQUIRES(mutex_) {return !queue_.empty();});
+    const std::int64_t value = queue_.front();
+    queue_.pop_front();
+    lock.unlock();
+    not_full_.notify_one();
+    return value;
+  }
+
+private:
+  const std::size_t capacity_;
+  std::mutex mutex_;
+  std::condition_variable not_full_;
+  std::condition_variable not_empty_;
+  std::deque<std::int64_t> queue_ RCPPUTILS_TSA_GUARDED_BY(mutex_);
+};
+
+template<typename Queue>
+void run_hand_off(benchmark::State & state)
+{
+  const auto producers = static_cast<std::size_t>(state.range(0));
+  const auto consumers = static_cast<std::size_t>(state.range(1));
+  const std::int64_t per_producer = kItems / static_cast<std::int64_t>(producers);
+  const std::int64_t total = per_producer * static_cast<std::int64_t>(producers);
+
+  for (auto _ : state) {
+    Queue queue(kCapacity);
+    std::vector<std::thread> threads;
+    for (std::size_t p = 0; p < producers; ++p) {
+      threads.emplace_back(
+        [&queue, per_producer]() {
+          for (std::int64_t i = 0; i < per_producer; ++i) {
+            queue.push(i);
+          }
+        });
+    }
+    for (std::size_t c = 0; c < consumers; ++c) {
+      // Split the items evenly, the first consumer takes the remainder.
+      std::int64_t share = total / static_cast<std::int64_t>(consumers);
+      if (c == 0) {
+        share += total % static_cast<std::int64_t>(consumers);
+      }
+      threads.emplace_back(
+        [&queue, share]() {
+          for (std::int64_t i = 0; i < share; ++i) {
+            benchmark::DoNotOptimize(queue.pop());
+          }
+        });
+    }
+    for (auto & thread : threads) {
+      thread.join();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * total);
+}
+
+void spsc_arguments(benchmark::internal::Benchmark * benchmark)
+{
+  benchmark->Args({1, 1})->UseRealTime()->Unit(benchmark::kMillisecond);
+}
+
+void mpmc_arguments(benchmark::internal::Benchmark * benchmark)
+{
+  for (std::int64_t threads : {1, 2, 4}) {
+    benchmark->Args({threads, threads});
+  }
+  benchmark->UseRealTime()->Unit(benchmark::kMillisecond);
+}
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(run_hand_off, MutexDeque)->Apply(spsc_arguments);
+BENCHMARK_TEMPLATE(run_hand_off, rcpputils::SpscRingBuffer<std::int64_t, rcpputils::SpinWait>)
+->Apply(spsc_arguments);
+BENCHMARK_TEMPLATE(run_hand_off, rcpputils::SpscRingBuffer<std::int64_t, rcpputils::YieldWait>)
+->Apply(spsc_arguments);
+BENCHMARK_TEMPLATE(run_hand_off, rcpputils::SpscRingBuffer<std::int64_t, rcpputils::FutexWait>)
+->Apply(spsc_arguments);
+
+BENCHMARK_TEMPLATE(run_hand_off, MutexDeque)->Apply(mpmc_arguments);
+BENCHMARK_TEMPLATE(run_hand_off, rcpputils::MpmcRingBuffer<std::int64_t, rcpputils::YieldWait>)
+->Apply(mpmc_arguments);
+BENCHMARK_TEMPLATE(run_hand_off, rcpputils::MpmcRingBuffer<std::int64_t, rcpputils::FutexWait>)
+->Apply(mpmc_arguments);
+
+BENCHMARK_MAIN();
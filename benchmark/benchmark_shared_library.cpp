@@ -0,0 +1,104 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Loading a library and resolving its symbols with rcpputils::SharedLibrary and the
+// SharedLibraryRegistry.
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "rcpputils/shared_library.hpp"
+
+#include "allocation_counter.hpp"
+
+namespace
+{
+
+using add_function = int (*)(int);
+
+void load_and_unload(benchmark::State & state)
+{
+  const std::string library_path = BENCHMARK_LIBRARY;
+  rcpputils_benchmark::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    rcpputils::SharedLibrary library(library_path);
+    benchmark::DoNotOptimize(library.get_library_path());
+  }
+}
+BENCHMARK(load_and_unload);
+
+// Further loads of a library which is already mapped in the process.
+void load_loaded(benchmark::State & state)
+{
+  const std::string library_path = BENCHMARK_LIBRARY;
+  const rcpputils::SharedLibrary keep_loaded(library_path);
+  rcpputils_benchmark::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    rcpputils::SharedLibrary library(library_path);
+    benchmark::DoNotOptimize(library.get_library_path());
+  }
+}
+BENCHMARK(load_loaded);
+
+void registry_load(benchmark::State & state)
+{
+  const std::string library_path = BENCHMARK_LIBRARY;
+  auto & registry = rcpputils::SharedLibraryRegistry::instance();
+  const auto keep_loaded = registry.load(library_path);
+  rcpputils_benchmark::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(registry.load(library_path));
+  }
+}
+BENCHMARK(registry_load);
+
+void get_symbol(benchmark::State & state)
+{
+  rcpputils::SharedLibrary library(BENCHMARK_LIBRARY);
+  const std::string symbol = "rcpputils_benchmark_add_one";
+  rcpputils_benchmark::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(library.get_symbol(symbol));
+  }
+}
+BENCHMARK(get_symbol);
+
+void get_symbol_typed(benchmark::State & state)
+{
+  rcpputils::SharedLibrary library(BENCHMARK_LIBRARY);
+  constexpr std::string_view symbol = "rcpputils_benchmark_add_two";
+  rcpputils_benchmark::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(library.get_symbol<add_function>(symbol));
+  }
+}
+BENCHMARK(get_symbol_typed);
+
+void has_symbol_missing(benchmark::State & state)
+{
+  rcpputils::SharedLibrary library(BENCHMARK_LIBRARY);
+  const std::string symbol = "rcpputils_benchmark_missing";
+  rcpputils_benchmark::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(library.has_symbol(symbol));
+  }
+}
+BENCHMARK(has_symbol_missing);
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,105 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Tokenizing topic names and library search paths with rcpputils::split() and split_view(),
+// and split() into a rcpputils::small_vector.
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "rcpputils/join.hpp"
+#include "rcpputils/small_vector.hpp"
+#include "rcpputils/split.hpp"
+
+#include "allocation_counter.hpp"
+#include "benchmark_inputs.hpp"
+
+namespace
+{
+
+void split_topic_names(benchmark::State & state)
+{
+  const auto & topics = rcpputils_benchmark::topic_names();
+  rcpputils_benchmark::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    for (const std::string & topic : topics) {
+      benchmark::DoNotOptimize(rcpputils::split(topic, '/', true));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * topics.size());
+}
+BENCHMARK(split_topic_names);
+
+void split_view_topic_names(benchmark::State & state)
+{
+  const auto & topics = rcpputils_benchmark::topic_names();
+  rcpputils_benchmark::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    for (const std::string & topic : topics) {
+      for (std::string_view token : rcpputils::split_view(topic, '/', true)) {
+        benchmark::DoNotOptimize(token);
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * topics.size());
+}
+BENCHMARK(split_view_topic_names);
+
+void split_topic_names_small_vector(benchmark::State & state)
+{
+  using tokens_t = rcpputils::small_vector<std::string_view, 8>;
+  const auto & topics = rcpputils_benchmark::topic_names();
+  rcpputils_benchmark::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    for (const std::string & topic : topics) {
+      benchmark::DoNotOptimize(rcpputils::split<tokens_t>(topic, '/', true));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * topics.size());
+}
+BENCHMARK(split_topic_names_small_vector);
+
+void split_library_path(benchmark::State & state)
+{
+  const std::string search_path = rcpputils::join(
+    rcpputils_benchmark::library_directories(static_cast<std::size_t>(state.range(0))), ":");
+  rcpputils_benchmark::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(rcpputils::split(search_path, ':'));
+  }
+  state.SetBytesProcessed(state.iterations() * search_path.size());
+}
+BENCHMARK(split_library_path)->Arg(8)->Arg(64);
+
+void split_view_library_path(benchmark::State & state)
+{
+  const std::string search_path = rcpputils::join(
+    rcpputils_benchmark::library_directories(static_cast<std::size_t>(state.range(0))), ":");
+  rcpputils_benchmark::AllocationCounter allocations(state);
+  for (auto _ : state) {
+    for (std::string_view directory : rcpputils::split_view(search_path, ':')) {
+      benchmark::DoNotOptimize(directory);
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * search_path.size());
+}
+BENCHMARK(split_view_library_path)->Arg(8)->Arg(64);
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,515 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/*! \file allocators.hpp
+ * \brief Allocators which avoid the global heap on hot paths.
+ *
+ * Both allocators meet the standard Allocator requirements, so they can be used with the
+ * standard containers and strings, as well as with the rcpputils string helpers:
+ *  * PoolAllocator serves single objects out of per-thread free lists, for node based
+ *    containers such as std::list, std::map and std::set
+ *  * ArenaAllocator serves allocations out of a MonotonicArena, which releases everything at
+ *    once on reset()
+ *
+ * Example, with no heap allocation after the first iteration:
+ *
+ *     rcpputils::MonotonicArena arena(64 * 1024);
+ *     using arena_string =
+ *       std::basic_string<char, std::char_traits<char>, rcpputils::ArenaAllocator<char>>;
+ *     while (running) {
+ *       arena_string topic(rcpputils::ArenaAllocator<char>(arena));
+ *       rcpputils::append_join(topic, tokens, "/");
+ *       publish(topic);
+ *       arena.reset();
+ *     }
+ */
+
+#ifndef RCPPUTILS__ALLOCATORS_HPP_
+#define RCPPUTILS__ALLOCATORS_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+
+namespace rcpputils
+{
+
+namespace detail
+{
+
+/// Free lists of fixed-size nodes, one per thread, refilled from and drained into a shared one.
+/**
+ * Nodes are carved out of chunks of BlockSize nodes, which are never returned to the system:
+ * the memory of a pool only grows to its peak use. A node can be deallocated by any thread,
+ * it then goes to that thread's free list.
+ */
+template<std::size_t NodeSize, std::size_t NodeAlignment, std::size_t BlockSize>
+class NodePool
+{
+public:
+  static void * allocate()
+  {
+    if (cache_destroyed()) {
+      // Thread exit, after this thread's free list is gone.
+      Cache cache;
+      refill(cache);
+      void * node = pop(cache);
+      release(cache, cache.size);
+      return node;
+    }
+    Cache & cache = local_cache();
+    if (cache.head == nullptr) {
+      refill(cache);
+    }
+    return pop(cache);
+  }
+
+  static void deallocate(void * pointer) noexcept
+  {
+    Node * node = static_cast<Node *>(pointer);
+    if (cache_destroyed()) {
+      Cache cache;
+      push(cache, node);
+      release(cache, 1);
+      return;
+    }
+    Cache & cache = local_cache();
+    push(cache, node);
+    // Hand surplus back, so memory freed by a consumer thread is reused by the producer.
+    if (cache.size > 2 * BlockSize) {
+      release(cache, BlockSize);
+    }
+  }
+
+private:
+  union Node
+  {
+    Node * next;
+    alignas(NodeAlignment) unsigned char storage[NodeSize];
+  };
+
+  struct FreeList
+  {
+    Node * head = nullptr;
+    std::size_t size = 0;
+  };
+
+  struct Shared
+  {
+    std::mutex mutex;
+    FreeList free;
+  };
+
+  struct Cache : FreeList
+  {
+    Cache() = default;
+    Cache(const Cache &) = delete;
+    Cache & operator=(const Cache &) = delete;
+  };
+
+  struct LocalCache : Cache
+  {
+    ~LocalCache()
+    {
+      release(*this, this->size);
+      cache_destroyed() = true;
+    }
+  };
+
+  static Shared & shared()
+  {
+    // Never destroyed: nodes may still be deallocated during static destruction.
+    static Shared * instance = new Shared;
+    return *instance;
+  }
+
+  static Cache & local_cache()
+  {
+    thread_local LocalCache cache;
+    return cache;
+  }
+
+  static bool & cache_destroyed() noexcept
+  {
+    thread_local bool destroyed = false;
+    return destroyed;
+  }
+
+  static void * pop(FreeList & list) noexcept
+  {
+    Node * node = list.head;
+    list.head = node->next;
+    --list.size;
+    return node;
+  }
+
+  static void push(FreeList & list, Node * node) noexcept
+  {
+    node->next = list.head;
+    list.head = node;
+    ++list.size;
+  }
+
+  /// Move up to count nodes from the front of list into to.
+  static void splice(FreeList & from, FreeList & to, std::size_t count) noexcept
+  {
+    for (; count != 0 && from.head != nullptr; --count) {
+      push(to, static_cast<Node *>(pop(from)));
+    }
+  }
+
+  static void refill(FreeList & cache)
+  {
+    {
+      Shared & pool = shared();
+      std::lock_guard<std::mutex> lock(pool.mutex);
+      splice(pool.free, cache, BlockSize);
+    }
+    if (cache.head != nullptr) {
+      return;
+    }
+    auto * chunk = static_cast<Node *>(
+      ::operator new(sizeof(Node) * BlockSize, std::align_val_t(alignof(Node))));
+    for (std::size_t i = BlockSize; i != 0; --i) {
+      push(cache, &chunk[i - 1]);
+    }
+  }
+
+  static void release(FreeList & cache, std::size_t count) noexcept
+  {
+    Shared & pool = shared();
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    splice(cache, pool.free, count);
+  }
+};
+
+}  // namespace detail
+
+/// Allocator which serves single objects out of per-thread free lists.
+/**
+ * Allocations of one object are served by a free list of the calling thread, shared by all
+ * pool allocators for types of the same size and alignment, without locking in the common case.
+ * Free lists are refilled BlockSize objects at a time, from objects released by other threads
+ * or from a new chunk of memory. Memory of the pools is never returned to the system.
+ *
+ * Allocations of more than one object, such as the storage of a `std::vector`, use
+ * `std::allocator`.
+ *
+ * \tparam T type of the allocated objects
+ * \tparam BlockSize number of objects a free list is refilled with at once
+ */
+template<typename T, std::size_t BlockSize = 64>
+class PoolAllocator
+{
+  static_assert(BlockSize > 0, "the block size must be greater than zero");
+
+public:
+  using value_type = T;
+  using is_always_equal = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+
+  template<typename U>
+  struct rebind
+  {
+    using other = PoolAllocator<U, BlockSize>;
+  };
+
+  PoolAllocator() noexcept = default;
+
+  template<typename U>
+  PoolAllocator(const PoolAllocator<U, BlockSize> &) noexcept  // NOLINT(runtime/explicit)
+  {}
+
+  /// Allocate storage for n objects, see the class documentation.
+  T * allocate(std::size_t n)
+  {
+    if (n == 1) {
+      return static_cast<T *>(pool::allocate());
+    }
+    return std::allocator<T>().allocate(n);
+  }
+
+  /// Release storage returned by allocate(n).
+  void deallocate(T * pointer, std::size_t n) noexcept
+  {
+    if (n == 1) {
+      pool::deallocate(pointer);
+      return;
+    }
+    std::allocator<T>().deallocate(pointer, n);
+  }
+
+private:
+  using pool = detail::NodePool<sizeof(T), alignof(T), BlockSize>;
+};
+
+template<typename T, typename U, std::size_t BlockSize>
+bool operator==(const PoolAllocator<T, BlockSize> &, const PoolAllocator<U, BlockSize> &) noexcept
+{
+  return true;
+}
+
+template<typename T, typename U, std::size_t BlockSize>
+bool operator!=(const PoolAllocator<T, BlockSize> &, const PoolAllocator<U, BlockSize> &) noexcept
+{
+  return false;
+}
+
+/// Memory resource which hands out memory by bumping a pointer, and frees it all at once.
+/**
+ * Memory comes from an optional caller supplied buffer first, then from blocks allocated on
+ * the heap, each twice as large as the previous one. reset() makes all of it available again
+ * without releasing the blocks, so a loop which resets the arena every iteration stops
+ * allocating from the heap once the arena has grown to the loop's peak use.
+ *
+ * An arena is not thread-safe, and must outlive everything allocated from it.
+ */
+class MonotonicArena
+{
+public:
+  /// Create an arena which allocates its first heap block on first use.
+  /**
+   * \param[in] initial_block_size size of the first heap block, in bytes
+   */
+  explicit MonotonicArena(std::size_t initial_block_size = 4096) noexcept
+  : next_block_size_(initial_block_size != 0 ? initial_block_size : 1)
+  {}
+
+  /// Create an arena which uses buffer before allocating from the heap.
+  /**
+   * \param[in] buffer memory to allocate from first; it is not owned and must outlive the arena
+   * \param[in] size size of buffer, in bytes
+   */
+  MonotonicArena(void * buffer, std::size_t size) noexcept
+  : buffer_(static_cast<char *>(buffer)), buffer_size_(size),
+    current_(buffer_), end_(buffer_ + size), next_block_size_(size != 0 ? size : 4096)
+  {}
+
+  MonotonicArena(const MonotonicArena &) = delete;
+  MonotonicArena & operator=(const MonotonicArena &) = delete;
+
+  ~MonotonicArena()
+  {
+    release();
+  }
+
+  /// Allocate bytes of memory.
+  /**
+   * \param[in] bytes number of bytes to allocate
+   * \param[in] alignment alignment of the memory, a power of two
+   * \return Pointer to the memory, valid until reset(), release() or the arena's destruction.
+   * \throws std::bad_alloc if a new block cannot be allocated
+   */
+  void * allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t))
+  {
+    void * pointer = bump(bytes, alignment);
+    if (pointer == nullptr) {
+      pointer = allocate_from_next_block(bytes, alignment);
+    }
+    return pointer;
+  }
+
+  /// Give back memory returned by allocate().
+  /**
+   * This only reclaims the memory if it was the last allocation, so a string or vector
+   * regrowing its storage reuses it; otherwise it is only reclaimed by reset().
+   */
+  void deallocate(void * pointer, std::size_t bytes) noexcept
+  {
+    if (static_cast<char *>(pointer) + bytes == current_) {
+      current_ = static_cast<char *>(pointer);
+    }
+  }
+
+  /// Make all memory available again, keeping the blocks allocated so far.
+  void reset() noexcept
+  {
+    used_before_current_ = 0;
+    current_block_ = nullptr;
+    current_ = buffer_;
+    end_ = buffer_ + buffer_size_;
+  }
+
+  /// Make all memory available again, and free all heap blocks.
+  void release() noexcept
+  {
+    while (blocks_ != nullptr) {
+      Block * next = blocks_->next;
+      ::operator delete(blocks_);
+      blocks_ = next;
+    }
+    capacity_ = buffer_size_;
+    reset();
+  }
+
+  /// Get the number of bytes handed out since the last reset(), including alignment padding.
+  std::size_t bytes_used() const noexcept
+  {
+    const char * begin = current_block_ != nullptr ? current_block_->data() : buffer_;
+    return used_before_current_ + static_cast<std::size_t>(current_ - begin);
+  }
+
+  /// Get the total size of the caller supplied buffer and the heap blocks.
+  std::size_t capacity() const noexcept
+  {
+    return capacity_;
+  }
+
+private:
+  struct alignas(std::max_align_t) Block
+  {
+    Block * next;
+    std::size_t size;
+
+    char * data() noexcept
+    {
+      return reinterpret_cast<char *>(this + 1);
+    }
+  };
+
+  void * bump(std::size_t bytes, std::size_t alignment) noexcept
+  {
+    const auto address = reinterpret_cast<std::uintptr_t>(current_);
+    const std::uintptr_t aligned = (address + alignment - 1) & ~(std::uintptr_t(alignment) - 1);
+    const std::size_t padding = static_cast<std::size_t>(aligned - address);
+    if (current_ == nullptr || padding > static_cast<std::size_t>(end_ - current_) ||
+      bytes > static_cast<std::size_t>(end_ - current_) - padding)
+    {
+      return nullptr;
+    }
+    current_ += padding + bytes;
+    return reinterpret_cast<void *>(aligned);
+  }
+
+  void * allocate_from_next_block(std::size_t bytes, std::size_t alignment)
+  {
+    // Reuse the blocks kept by reset(), skipping those too small for this allocation.
+    Block * block = current_block_ != nullptr ? current_block_->next : blocks_;
+    Block * last = current_block_;
+    for (; block != nullptr; last = block, block = block->next) {
+      enter(block);
+      if (void * pointer = bump(bytes, alignment)) {
+        return pointer;
+      }
+    }
+
+    if (bytes > std::numeric_limits<std::size_t>::max() / 2 - alignment - sizeof(Block)) {
+      throw std::bad_alloc();
+    }
+    std::size_t size = next_block_size_;
+    while (size < bytes + alignment) {
+      size *= 2;
+    }
+    block = static_cast<Block *>(::operator new(sizeof(Block) + size));
+    block->next = nullptr;
+    block->size = size;
+    if (last != nullptr) {
+      last->next = block;
+    } else {
+      blocks_ = block;
+    }
+    capacity_ += size;
+    next_block_size_ = size * 2;
+    enter(block);
+    return bump(bytes, alignment);
+  }
+
+  void enter(Block * block) noexcept
+  {
+    used_before_current_ = bytes_used();
+    current_block_ = block;
+    current_ = block->data();
+    end_ = current_ + block->size;
+  }
+
+  char * const buffer_ = nullptr;
+  const std::size_t buffer_size_ = 0;
+  // Heap blocks, in the order they are used.
+  Block * blocks_ = nullptr;
+  // The block current_ points into, nullptr for the caller supplied buffer.
+  Block * current_block_ = nullptr;
+  char * current_ = nullptr;
+  char * end_ = nullptr;
+  std::size_t used_before_current_ = 0;
+  std::size_t capacity_ = buffer_size_;
+  std::size_t next_block_size_;
+};
+
+/// Allocator which allocates out of a MonotonicArena.
+/**
+ * Deallocation is a no-op, except for the most recent allocation, see
+ * MonotonicArena::deallocate(). Allocators compare equal if they use the same arena.
+ *
+ * \tparam T type of the allocated objects
+ */
+template<typename T>
+class ArenaAllocator
+{
+public:
+  using value_type = T;
+
+  /// Create an allocator using arena, which must outlive all memory allocated with it.
+  explicit ArenaAllocator(MonotonicArena & arena) noexcept
+  : arena_(&arena)
+  {}
+
+  template<typename U>
+  ArenaAllocator(const ArenaAllocator<U> & other) noexcept  // NOLINT(runtime/explicit)
+  : arena_(other.arena())
+  {}
+
+  /// Allocate storage for n objects.
+  T * allocate(std::size_t n)
+  {
+    if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+      throw std::bad_array_new_length();
+    }
+    return static_cast<T *>(arena_->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  /// Release storage returned by allocate(n).
+  void deallocate(T * pointer, std::size_t n) noexcept
+  {
+    arena_->deallocate(pointer, n * sizeof(T));
+  }
+
+  /// Get the arena this allocator uses.
+  MonotonicArena * arena() const noexcept
+  {
+    return arena_;
+  }
+
+private:
+  MonotonicArena * arena_;
+};
+
+template<typename T, typename U>
+bool operator==(const ArenaAllocator<T> & lhs, const ArenaAllocator<U> & rhs) noexcept
+{
+  return lhs.arena() == rhs.arena();
+}
+
+template<typename T, typename U>
+bool operator!=(const ArenaAllocator<T> & lhs, const ArenaAllocator<U> & rhs) noexcept
+{
+  return lhs.arena() != rhs.arena();
+}
+
+}  // namespace rcpputils
+
+#endif  // RCPPUTILS__ALLOCATORS_HPP_
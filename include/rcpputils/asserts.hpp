@@ -19,12 +19,35 @@
 #ifndef RCPPUTILS__ASSERTS_HPP_
 #define RCPPUTILS__ASSERTS_HPP_
 
+#include <cstdint>
 #include <exception>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
 
 #include "rcpputils/visibility_control.hpp"
 
+/// Hint that a condition is expected to hold, for the compiler to lay out the other branch
+/// out of the way.
+#if defined(__GNUC__) || defined(__clang__)
+# define RCPPUTILS_LIKELY(x) __builtin_expect(!!(x), 1)
+# define RCPPUTILS_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#else
+# define RCPPUTILS_LIKELY(x) (x)
+# define RCPPUTILS_UNLIKELY(x) (x)
+#endif
+
+/// Mark a function as rarely called, so that it is never inlined and is kept with cold code.
+#if defined(__GNUC__) || defined(__clang__)
+# define RCPPUTILS_COLD __attribute__((cold, noinline))
+#elif defined(_MSC_VER)
+# define RCPPUTILS_COLD __declspec(noinline)
+#else
+# define RCPPUTILS_COLD
+#endif
+
 // Needed to disable compiler warning for exporting a class that extends a
 // non-DLL-interface class.
 // This should be fine since its extending an STL class.
@@ -34,15 +57,50 @@
 # pragma warning(disable:4275)
 #endif
 
+#if defined(__GNUC__) || defined(__clang__) || (defined(_MSC_VER) && _MSC_VER >= 1926)
+# define RCPPUTILS_HAS_BUILTIN_SOURCE_LOCATION 1
+#endif
+
 namespace rcpputils
 {
 
+/// A location in the source code, made of string literals so that copying it never allocates.
+struct SourceLocation
+{
+  /// Get the location of the call site, when used as a default argument.
+  /**
+   * Without compiler support, the returned location is empty.
+   */
+#if defined(RCPPUTILS_HAS_BUILTIN_SOURCE_LOCATION)
+  static constexpr SourceLocation current(
+    const char * file = __builtin_FILE(),
+    std::uint_least32_t line = __builtin_LINE(),
+    const char * function = __builtin_FUNCTION()) noexcept
+  {
+    return SourceLocation{file, line, function};
+  }
+#else
+  static constexpr SourceLocation current() noexcept
+  {
+    return SourceLocation{};
+  }
+#endif
+
+  /// Path of the source file, or "" if unknown.
+  const char * file = "";
+  /// Line in the source file, or 0 if unknown.
+  std::uint_least32_t line = 0u;
+  /// Name of the enclosing function, or "" if unknown.
+  const char * function = "";
+};
+
 /**
  * \brief An assertion-like exception for halting tests if conditions are not met.
  */
 class RCPPUTILS_PUBLIC AssertionException : public std::exception
 {
   std::string msg_;
+  SourceLocation location_;
 
 public:
   /**
@@ -52,6 +110,30 @@ public:
    */
   explicit AssertionException(const char * msg);
 
+  /**
+   * \brief Constructor for AssertionException
+   *
+   * \param msg The message to display when this exception is thrown.
+   */
+  explicit AssertionException(std::string_view msg);
+
+  /**
+   * \brief Constructor for AssertionException
+   *
+   * \param msg The message to display when this exception is thrown.
+   * \param location Where the failed assertion is.
+   */
+  AssertionException(std::string_view msg, const SourceLocation & location);
+
+  /// Get the file of the failed assertion, or "" if unknown.
+  const char * file() const noexcept {return location_.file;}
+
+  /// Get the line of the failed assertion, or 0 if unknown.
+  std::uint_least32_t line() const noexcept {return location_.line;}
+
+  /// Get the function of the failed assertion, or "" if unknown.
+  const char * function() const noexcept {return location_.function;}
+
   /**
    * \brief Get the message description of why this exception was thrown.
    *
@@ -67,6 +149,7 @@ public:
 class RCPPUTILS_PUBLIC IllegalStateException : public std::exception
 {
   std::string msg_;
+  SourceLocation location_;
 
 public:
   /**
@@ -77,6 +160,30 @@ public:
 
   explicit IllegalStateException(const char * msg);
 
+  /**
+   * \brief Constructor for IllegalStateException
+   *
+   * \param msg The message to display when this exception is thrown.
+   */
+  explicit IllegalStateException(std::string_view msg);
+
+  /**
+   * \brief Constructor for IllegalStateException
+   *
+   * \param msg The message to display when this exception is thrown.
+   * \param location Where the failed check is.
+   */
+  IllegalStateException(std::string_view msg, const SourceLocation & location);
+
+  /// Get the file of the failed check, or "" if unknown.
+  const char * file() const noexcept {return location_.file;}
+
+  /// Get the line of the failed check, or 0 if unknown.
+  std::uint_least32_t line() const noexcept {return location_.line;}
+
+  /// Get the function of the failed check, or "" if unknown.
+  const char * function() const noexcept {return location_.function;}
+
   /**
    * \brief Get the message description of why this exception was thrown.
    *
@@ -85,31 +192,194 @@ public:
   virtual const char * what() const throw();
 };
 
+/**
+ * \brief The std::invalid_argument thrown when an argument check fails.
+ */
+class RCPPUTILS_PUBLIC InvalidArgumentException : public std::invalid_argument
+{
+  SourceLocation location_;
+
+public:
+  /**
+   * \brief Constructor for InvalidArgumentException
+   *
+   * \param msg The message to display when this exception is thrown.
+   * \param location Where the failed check is.
+   */
+  InvalidArgumentException(std::string_view msg, const SourceLocation & location);
+
+  /// Get the file of the failed check, or "" if unknown.
+  const char * file() const noexcept {return location_.file;}
+
+  /// Get the line of the failed check, or 0 if unknown.
+  std::uint_least32_t line() const noexcept {return location_.line;}
+
+  /// Get the function of the failed check, or "" if unknown.
+  const char * function() const noexcept {return location_.function;}
+};
+
+namespace detail
+{
+
+// Out of line throws, keeping the failure branch of the checks below small.
+
+/// Throw an rcpputils::InvalidArgumentException with the given message.
+[[noreturn]] RCPPUTILS_PUBLIC RCPPUTILS_COLD
+void
+throw_invalid_argument(std::string_view msg, const SourceLocation & location = {});
+
+/// Throw an rcpputils::IllegalStateException with the given message.
+[[noreturn]] RCPPUTILS_PUBLIC RCPPUTILS_COLD
+void
+throw_illegal_state(std::string_view msg, const SourceLocation & location = {});
+
+/// Throw an rcpputils::AssertionException with the given message.
+[[noreturn]] RCPPUTILS_PUBLIC RCPPUTILS_COLD
+void
+throw_assertion(std::string_view msg, const SourceLocation & location = {});
+
+/// Message factories are callables returning something convertible to std::string_view.
+template<typename MessageFactoryT>
+using enable_if_message_factory_t = std::enable_if_t<
+  std::is_invocable_v<MessageFactoryT &> &&
+  std::is_convertible_v<std::invoke_result_t<MessageFactoryT &>, std::string_view>>;
+
+// The message is built in these out of line functions, only once a check has failed.
+
+template<typename MessageFactoryT>
+[[noreturn]] RCPPUTILS_COLD
+void
+throw_invalid_argument_with(MessageFactoryT & make_message, const SourceLocation & location)
+{
+  throw_invalid_argument(make_message(), location);
+}
+
+template<typename MessageFactoryT>
+[[noreturn]] RCPPUTILS_COLD
+void
+throw_illegal_state_with(MessageFactoryT & make_message, const SourceLocation & location)
+{
+  throw_illegal_state(make_message(), location);
+}
+
+template<typename MessageFactoryT>
+[[noreturn]] RCPPUTILS_COLD
+void
+throw_assertion_with(MessageFactoryT & make_message, const SourceLocation & location)
+{
+  throw_assertion(make_message(), location);
+}
+
+/// Concatenate the text representations of the arguments, as written to a std::ostream.
+template<typename ... ArgsT>
+RCPPUTILS_COLD
+std::string
+format_message(const ArgsT &... args)
+{
+  std::ostringstream stream;
+  (stream << ... << args);
+  return stream.str();
+}
+
+}  // namespace detail
+
 /**
  * \brief Check that an argument condition passes.
  *
+ * Nothing is allocated unless the condition fails.
+ *
  * \param condition condition that is asserted to be true
  * \param msg message to pass to exception when condition is false
- * \throw std::invalid_argument if the condition is not met.
+ * \throw rcpputils::InvalidArgumentException, a std::invalid_argument, if the condition is not met.
  */
-inline void require_true(bool condition, const std::string & msg = "invalid argument passed")
+inline void require_true(bool condition, const char * msg = "invalid argument passed")
 {
-  if (!condition) {
-    throw std::invalid_argument{msg};
+  if (RCPPUTILS_UNLIKELY(!condition)) {
+    detail::throw_invalid_argument(msg);
+  }
+}
+
+/// \copydoc require_true(bool, const char *)
+inline void require_true(bool condition, std::string_view msg)
+{
+  if (RCPPUTILS_UNLIKELY(!condition)) {
+    detail::throw_invalid_argument(msg);
+  }
+}
+
+/// \copydoc require_true(bool, const char *)
+inline void require_true(bool condition, const std::string & msg)
+{
+  if (RCPPUTILS_UNLIKELY(!condition)) {
+    detail::throw_invalid_argument(msg);
+  }
+}
+
+/**
+ * \brief Check that an argument condition passes, building the message only if it fails.
+ *
+ * \param condition condition that is asserted to be true
+ * \param make_message callable returning the message, convertible to std::string_view
+ * \param location where the check is, the call site by default
+ * \throw rcpputils::InvalidArgumentException if the condition is not met.
+ */
+template<typename MessageFactoryT, typename = detail::enable_if_message_factory_t<MessageFactoryT>>
+void require_true(
+  bool condition, MessageFactoryT && make_message,
+  const SourceLocation & location = SourceLocation::current())
+{
+  if (RCPPUTILS_UNLIKELY(!condition)) {
+    detail::throw_invalid_argument_with(make_message, location);
   }
 }
 
 /**
  * \brief Check that a state condition passes.
  *
+ * Nothing is allocated unless the condition fails.
+ *
  * \param condition condition to check whether it is true or not
  * \param msg message to pass to exception when condition is false
  * \throw rcpputils::IllegalStateException if the condition is not met.
  */
-inline void check_true(bool condition, const std::string & msg = "check reported invalid state")
+inline void check_true(bool condition, const char * msg = "check reported invalid state")
+{
+  if (RCPPUTILS_UNLIKELY(!condition)) {
+    detail::throw_illegal_state(msg);
+  }
+}
+
+/// \copydoc check_true(bool, const char *)
+inline void check_true(bool condition, std::string_view msg)
+{
+  if (RCPPUTILS_UNLIKELY(!condition)) {
+    detail::throw_illegal_state(msg);
+  }
+}
+
+/// \copydoc check_true(bool, const char *)
+inline void check_true(bool condition, const std::string & msg)
+{
+  if (RCPPUTILS_UNLIKELY(!condition)) {
+    detail::throw_illegal_state(msg);
+  }
+}
+
+/**
+ * \brief Check that a state condition passes, building the message only if it fails.
+ *
+ * \param condition condition to check whether it is true or not
+ * \param make_message callable returning the message, convertible to std::string_view
+ * \param location where the check is, the call site by default
+ * \throw rcpputils::IllegalStateException if the condition is not met.
+ */
+template<typename MessageFactoryT, typename = detail::enable_if_message_factory_t<MessageFactoryT>>
+void check_true(
+  bool condition, MessageFactoryT && make_message,
+  const SourceLocation & location = SourceLocation::current())
 {
-  if (!condition) {
-    throw rcpputils::IllegalStateException{msg.c_str()};
+  if (RCPPUTILS_UNLIKELY(!condition)) {
+    detail::throw_illegal_state_with(make_message, location);
   }
 }
 
@@ -123,20 +393,199 @@ inline void check_true(bool condition, const std::string & msg = "check reported
  * \param msg message to pass to exception when condition is not met.
  * \throw rcpputils::AssertionException if the macro NDEBUG is not set and the condition is not met.
  */
-inline void assert_true(bool condition, const std::string & msg = "assertion failed")
+inline void assert_true(bool condition, const char * msg = "assertion failed")
 {
 // Same macro definition used by cassert
 #ifndef NDEBUG
-  if (!condition) {
-    throw rcpputils::AssertionException{msg.c_str()};
+  if (RCPPUTILS_UNLIKELY(!condition)) {
+    detail::throw_assertion(msg);
+  }
+#else
+  (void) condition;
+  (void) msg;
+#endif
+}
+
+/// \copydoc assert_true(bool, const char *)
+inline void assert_true(bool condition, std::string_view msg)
+{
+#ifndef NDEBUG
+  if (RCPPUTILS_UNLIKELY(!condition)) {
+    detail::throw_assertion(msg);
+  }
+#else
+  (void) condition;
+  (void) msg;
+#endif
+}
+
+/// \copydoc assert_true(bool, const char *)
+inline void assert_true(bool condition, const std::string & msg)
+{
+#ifndef NDEBUG
+  if (RCPPUTILS_UNLIKELY(!condition)) {
+    detail::throw_assertion(msg);
   }
 #else
   (void) condition;
   (void) msg;
 #endif
 }
+
+/**
+ * \brief Assert that a condition passes, building the message only if it fails.
+ *
+ * It is only enabled when NDEBUG is not defined.
+ *
+ * \param condition condition to check whether it's true or not
+ * \param make_message callable returning the message, convertible to std::string_view
+ * \param location where the assertion is, the call site by default
+ * \throw rcpputils::AssertionException if the macro NDEBUG is not set and the condition is not met.
+ */
+template<typename MessageFactoryT, typename = detail::enable_if_message_factory_t<MessageFactoryT>>
+void assert_true(
+  bool condition, MessageFactoryT && make_message,
+  const SourceLocation & location = SourceLocation::current())
+{
+#ifndef NDEBUG
+  if (RCPPUTILS_UNLIKELY(!condition)) {
+    detail::throw_assertion_with(make_message, location);
+  }
+#else
+  (void) condition;
+  (void) make_message;
+  (void) location;
+#endif
+}
+
 }  // namespace rcpputils
 
+#define RCPPUTILS_ASSERTS_STRINGIFY_IMPL(x) #x
+#define RCPPUTILS_ASSERTS_STRINGIFY(x) RCPPUTILS_ASSERTS_STRINGIFY_IMPL(x)
+
+/// Prefix a message literal with the file and line it appears at, at compile time.
+#define RCPPUTILS_ASSERTS_LOCATED(msg) \
+  __FILE__ ":" RCPPUTILS_ASSERTS_STRINGIFY(__LINE__) ": " msg
+
+/// The rcpputils::SourceLocation of the macro expansion.
+#define RCPPUTILS_CURRENT_SOURCE_LOCATION() \
+  ::rcpputils::SourceLocation{__FILE__, __LINE__, __func__}
+
+/**
+ * \def RCPPUTILS_REQUIRE_TRUE
+ * \brief Check that an argument condition passes, like rcpputils::require_true().
+ *
+ * The message must be a string literal: it is prefixed with the file and line of the check at
+ * compile time, so that the thrown message reads `file:line: msg`.
+ * The location of the check is also available from the thrown exception.
+ *
+ * \throw rcpputils::InvalidArgumentException if the condition is not met.
+ */
+#define RCPPUTILS_REQUIRE_TRUE(condition, msg) \
+  do { \
+    if (RCPPUTILS_UNLIKELY(!(condition))) { \
+      ::rcpputils::detail::throw_invalid_argument( \
+        RCPPUTILS_ASSERTS_LOCATED(msg), RCPPUTILS_CURRENT_SOURCE_LOCATION()); \
+    } \
+  } while (0)
+
+/**
+ * \def RCPPUTILS_REQUIRE_TRUE_FMT
+ * \brief Check that an argument condition passes, with a message formatted on failure.
+ *
+ * The arguments after the condition are only evaluated when the check fails; they are written
+ * to a std::ostream one after the other, after the `file:line: ` of the check.
+ *
+ * \throw rcpputils::InvalidArgumentException if the condition is not met.
+ */
+#define RCPPUTILS_REQUIRE_TRUE_FMT(condition, ...) \
+  do { \
+    if (RCPPUTILS_UNLIKELY(!(condition))) { \
+      ::rcpputils::detail::throw_invalid_argument( \
+        ::rcpputils::detail::format_message(RCPPUTILS_ASSERTS_LOCATED(""), __VA_ARGS__), \
+        RCPPUTILS_CURRENT_SOURCE_LOCATION()); \
+    } \
+  } while (0)
+
+/**
+ * \def RCPPUTILS_CHECK_TRUE
+ * \brief Check that a state condition passes, like rcpputils::check_true().
+ *
+ * The message must be a string literal, prefixed with the file and line of the check.
+ *
+ * \throw rcpputils::IllegalStateException if the condition is not met.
+ */
+#define RCPPUTILS_CHECK_TRUE(condition, msg) \
+  do { \
+    if (RCPPUTILS_UNLIKELY(!(condition))) { \
+      ::rcpputils::detail::throw_illegal_state( \
+        RCPPUTILS_ASSERTS_LOCATED(msg), RCPPUTILS_CURRENT_SOURCE_LOCATION()); \
+    } \
+  } while (0)
+
+/**
+ * \def RCPPUTILS_CHECK_TRUE_FMT
+ * \brief Check that a state condition passes, with a message formatted on failure.
+ *
+ * See RCPPUTILS_REQUIRE_TRUE_FMT for the handling of the message arguments.
+ *
+ * \throw rcpputils::IllegalStateException if the condition is not met.
+ */
+#define RCPPUTILS_CHECK_TRUE_FMT(condition, ...) \
+  do { \
+    if (RCPPUTILS_UNLIKELY(!(condition))) { \
+      ::rcpputils::detail::throw_illegal_state( \
+        ::rcpputils::detail::format_message(RCPPUTILS_ASSERTS_LOCATED(""), __VA_ARGS__), \
+        RCPPUTILS_CURRENT_SOURCE_LOCATION()); \
+    } \
+  } while (0)
+
+/**
+ * \def RCPPUTILS_ASSERT_TRUE
+ * \brief Assert that a condition passes, like rcpputils::assert_true().
+ *
+ * The message must be a string literal, prefixed with the file and line of the assertion.
+ * Like assert(), the condition is not evaluated when NDEBUG is defined.
+ *
+ * \throw rcpputils::AssertionException if the macro NDEBUG is not set and the condition is not met.
+ */
+
+/**
+ * \def RCPPUTILS_ASSERT_TRUE_FMT
+ * \brief Assert that a condition passes, with a message formatted on failure.
+ *
+ * See RCPPUTILS_REQUIRE_TRUE_FMT for the handling of the message arguments.
+ * Neither the condition nor the message arguments are evaluated when NDEBUG is defined.
+ *
+ * \throw rcpputils::AssertionException if the macro NDEBUG is not set and the condition is not met.
+ */
+#ifndef NDEBUG
+# define RCPPUTILS_ASSERT_TRUE(condition, msg) \
+  do { \
+    if (RCPPUTILS_UNLIKELY(!(condition))) { \
+      ::rcpputils::detail::throw_assertion( \
+        RCPPUTILS_ASSERTS_LOCATED(msg), RCPPUTILS_CURRENT_SOURCE_LOCATION()); \
+    } \
+  } while (0)
+# define RCPPUTILS_ASSERT_TRUE_FMT(condition, ...) \
+  do { \
+    if (RCPPUTILS_UNLIKELY(!(condition))) { \
+      ::rcpputils::detail::throw_assertion( \
+        ::rcpputils::detail::format_message(RCPPUTILS_ASSERTS_LOCATED(""), __VA_ARGS__), \
+        RCPPUTILS_CURRENT_SOURCE_LOCATION()); \
+    } \
+  } while (0)
+#else
+# define RCPPUTILS_ASSERT_TRUE(condition, msg) \
+  do { \
+    (void) sizeof(!(condition)); \
+  } while (0)
+# define RCPPUTILS_ASSERT_TRUE_FMT(condition, ...) \
+  do { \
+    (void) sizeof(!(condition)); \
+  } while (0)
+#endif
+
 #ifdef _WIN32
 # pragma warning(pop)
 #endif
@@ -0,0 +1,319 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/*! \file byteswap.hpp
+ * \brief Internal, vectorized kernels reversing the bytes of arrays of 2, 4 or 8 byte values.
+ *
+ * The kernel is selected at compile time from the instruction set the translation unit is
+ * built for: AVX2, SSSE3 (`pshufb`), SSE2 (shifts and word shuffles) or NEON (`vrev`), falling
+ * back to a scalar implementation otherwise.
+ * Define `RCPPUTILS_BYTESWAP_DISABLE_SIMD` to force the scalar implementation.
+ * The kernels live in a namespace named after the instruction set, see isa.hpp.
+ *
+ * All kernels accept `output == input` to swap in place; other overlapping ranges are not
+ * supported.
+ */
+
+#ifndef RCPPUTILS__DETAIL__BYTESWAP_HPP_
+#define RCPPUTILS__DETAIL__BYTESWAP_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "rcpputils/detail/isa.hpp"
+
+#if !defined(RCPPUTILS_BYTESWAP_DISABLE_SIMD)
+#  if defined(__AVX2__)
+#    define RCPPUTILS_BYTESWAP_AVX2 1
+#  elif defined(__SSSE3__)
+#    define RCPPUTILS_BYTESWAP_SSSE3 1
+#  elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    define RCPPUTILS_BYTESWAP_SSE2 1
+#  elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#    define RCPPUTILS_BYTESWAP_NEON 1
+#  endif
+#endif
+
+#if defined(RCPPUTILS_BYTESWAP_AVX2)
+#  include <immintrin.h>
+#elif defined(RCPPUTILS_BYTESWAP_SSSE3)
+#  include <tmmintrin.h>
+#elif defined(RCPPUTILS_BYTESWAP_SSE2)
+#  include <emmintrin.h>
+#elif defined(RCPPUTILS_BYTESWAP_NEON)
+#  include <arm_neon.h>
+#endif
+
+namespace rcpputils
+{
+namespace detail
+{
+inline namespace RCPPUTILS_DETAIL_ISA_NAMESPACE
+{
+
+/// Name of the byte swapping kernel selected at compile time.
+#if defined(RCPPUTILS_BYTESWAP_AVX2)
+constexpr const char * byteswap_kernel_name = "avx2";
+#elif defined(RCPPUTILS_BYTESWAP_SSSE3)
+constexpr const char * byteswap_kernel_name = "ssse3";
+#elif defined(RCPPUTILS_BYTESWAP_SSE2)
+constexpr const char * byteswap_kernel_name = "sse2";
+#elif defined(RCPPUTILS_BYTESWAP_NEON)
+constexpr const char * byteswap_kernel_name = "neon";
+#else
+constexpr const char * byteswap_kernel_name = "scalar";
+#endif
+
+constexpr std::uint16_t byteswap_uint(std::uint16_t value) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_bswap16(value);
+#else
+  return static_cast<std::uint16_t>((value << 8) | (value >> 8));
+#endif
+}
+
+constexpr std::uint32_t byteswap_uint(std::uint32_t value) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_bswap32(value);
+#else
+  return ((value & 0x000000FFu) << 24) | ((value & 0x0000FF00u) << 8) |
+         ((value & 0x00FF0000u) >> 8) | ((value & 0xFF000000u) >> 24);
+#endif
+}
+
+constexpr std::uint64_t byteswap_uint(std::uint64_t value) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_bswap64(value);
+#else
+  return (static_cast<std::uint64_t>(byteswap_uint(static_cast<std::uint32_t>(value))) << 32) |
+         byteswap_uint(static_cast<std::uint32_t>(value >> 32));
+#endif
+}
+
+/// Unsigned integer type of Width bytes.
+template<std::size_t Width>
+struct uint_of_width;
+
+template<>
+struct uint_of_width<2>
+{
+  using type = std::uint16_t;
+};
+
+template<>
+struct uint_of_width<4>
+{
+  using type = std::uint32_t;
+};
+
+template<>
+struct uint_of_width<8>
+{
+  using type = std::uint64_t;
+};
+
+namespace scalar
+{
+
+template<std::size_t Width>
+void byteswap_n(unsigned char * output, const unsigned char * input, std::size_t count) noexcept
+{
+  using uint = typename uint_of_width<Width>::type;
+  for (std::size_t i = 0; i < count; ++i) {
+    uint value;
+    std::memcpy(&value, input + i * Width, Width);
+    value = byteswap_uint(value);
+    std::memcpy(output + i * Width, &value, Width);
+  }
+}
+
+}  // namespace scalar
+
+#if defined(RCPPUTILS_BYTESWAP_AVX2) || defined(RCPPUTILS_BYTESWAP_SSSE3) || \
+  defined(RCPPUTILS_BYTESWAP_SSE2) || defined(RCPPUTILS_BYTESWAP_NEON)
+#  define RCPPUTILS_BYTESWAP_HAS_SIMD 1
+
+// Each block of vector operations loads, swaps and stores `width` bytes at once.
+#  if defined(RCPPUTILS_BYTESWAP_AVX2)
+struct byteswap_ops
+{
+  using vector = __m256i;
+  static constexpr std::size_t width = 32u;
+
+  static vector load(const unsigned char * p) noexcept
+  {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+  }
+  static void store(unsigned char * p, vector v) noexcept
+  {
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v);
+  }
+  // pshufb only shuffles within 128 bit lanes, which is enough for values of up to 8 bytes.
+  template<std::size_t Width>
+  static vector swap(vector v) noexcept
+  {
+    if constexpr (Width == 2) {
+      return _mm256_shuffle_epi8(
+        v, _mm256_setr_epi8(
+          1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+          1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14));
+    } else if constexpr (Width == 4) {
+      return _mm256_shuffle_epi8(
+        v, _mm256_setr_epi8(
+          3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+          3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12));
+    } else {
+      return _mm256_shuffle_epi8(
+        v, _mm256_setr_epi8(
+          7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+          7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8));
+    }
+  }
+};
+#  elif defined(RCPPUTILS_BYTESWAP_SSSE3)
+struct byteswap_ops
+{
+  using vector = __m128i;
+  static constexpr std::size_t width = 16u;
+
+  static vector load(const unsigned char * p) noexcept
+  {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+  }
+  static void store(unsigned char * p, vector v) noexcept
+  {
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v);
+  }
+  template<std::size_t Width>
+  static vector swap(vector v) noexcept
+  {
+    if constexpr (Width == 2) {
+      return _mm_shuffle_epi8(
+        v, _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14));
+    } else if constexpr (Width == 4) {
+      return _mm_shuffle_epi8(
+        v, _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12));
+    } else {
+      return _mm_shuffle_epi8(
+        v, _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8));
+    }
+  }
+};
+#  elif defined(RCPPUTILS_BYTESWAP_SSE2)
+struct byteswap_ops
+{
+  using vector = __m128i;
+  static constexpr std::size_t width = 16u;
+
+  static vector load(const unsigned char * p) noexcept
+  {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+  }
+  static void store(unsigned char * p, vector v) noexcept
+  {
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v);
+  }
+  // Without pshufb: reverse the 16 bit words of each value, then the bytes of each word.
+  template<std::size_t Width>
+  static vector swap(vector v) noexcept
+  {
+    if constexpr (Width == 4) {
+      v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+      v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+    } else if constexpr (Width == 8) {
+      v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+      v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+    }
+    return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+  }
+};
+#  elif defined(RCPPUTILS_BYTESWAP_NEON)
+struct byteswap_ops
+{
+  using vector = uint8x16_t;
+  static constexpr std::size_t width = 16u;
+
+  static vector load(const unsigned char * p) noexcept
+  {
+    return vld1q_u8(p);
+  }
+  static void store(unsigned char * p, vector v) noexcept
+  {
+    vst1q_u8(p, v);
+  }
+  template<std::size_t Width>
+  static vector swap(vector v) noexcept
+  {
+    if constexpr (Width == 2) {
+      return vrev16q_u8(v);
+    } else if constexpr (Width == 4) {
+      return vrev32q_u8(v);
+    } else {
+      return vrev64q_u8(v);
+    }
+  }
+};
+#  endif
+
+namespace simd
+{
+
+template<std::size_t Width>
+void byteswap_n(unsigned char * output, const unsigned char * input, std::size_t count) noexcept
+{
+  using ops = byteswap_ops;
+  const std::size_t bytes = count * Width;
+  std::size_t i = 0;
+  // Four vectors per iteration keep the load and store ports busy.
+  for (; i + 4 * ops::width <= bytes; i += 4 * ops::width) {
+    const auto v0 = ops::load(input + i);
+    const auto v1 = ops::load(input + i + ops::width);
+    const auto v2 = ops::load(input + i + 2 * ops::width);
+    const auto v3 = ops::load(input + i + 3 * ops::width);
+    ops::store(output + i, ops::template swap<Width>(v0));
+    ops::store(output + i + ops::width, ops::template swap<Width>(v1));
+    ops::store(output + i + 2 * ops::width, ops::template swap<Width>(v2));
+    ops::store(output + i + 3 * ops::width, ops::template swap<Width>(v3));
+  }
+  for (; i + ops::width <= bytes; i += ops::width) {
+    ops::store(output + i, ops::template swap<Width>(ops::load(input + i)));
+  }
+  scalar::byteswap_n<Width>(output + i, input + i, (bytes - i) / Width);
+}
+
+}  // namespace simd
+
+#endif
+
+/// Reverse the bytes of count values of Width bytes each, with the selected kernel.
+template<std::size_t Width>
+void byteswap_n(unsigned char * output, const unsigned char * input, std::size_t count) noexcept
+{
+  static_assert(Width == 2 || Width == 4 || Width == 8, "unsupported value width");
+#if defined(RCPPUTILS_BYTESWAP_HAS_SIMD)
+  simd::byteswap_n<Width>(output, input, count);
+#else
+  scalar::byteswap_n<Width>(output, input, count);
+#endif
+}
+
+}  // namespace RCPPUTILS_DETAIL_ISA_NAMESPACE
+}  // namespace detail
+}  // namespace rcpputils
+
+#endif  // RCPPUTILS__DETAIL__BYTESWAP_HPP_
@@ -0,0 +1,50 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/*! \file cpu_relax.hpp
+ * \brief Internal spin-wait hint shared by the lock-free and spinning primitives.
+ */
+
+#ifndef RCPPUTILS__DETAIL__CPU_RELAX_HPP_
+#define RCPPUTILS__DETAIL__CPU_RELAX_HPP_
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+namespace rcpputils
+{
+namespace detail
+{
+
+/// Tell the processor the calling thread is spinning.
+/**
+ * This is a `pause` instruction on x86 and a `yield` instruction on ARM, which saves power and
+ * frees execution resources for a sibling hyper-thread; it is a no-op elsewhere.
+ */
+inline void cpu_relax() noexcept
+{
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+  asm volatile ("yield");
+#endif
+}
+
+}  // namespace detail
+}  // namespace rcpputils
+
+#endif  // RCPPUTILS__DETAIL__CPU_RELAX_HPP_
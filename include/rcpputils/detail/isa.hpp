@@ -0,0 +1,42 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/*! \file isa.hpp
+ * \brief Internal tag of the instruction set a translation unit is compiled for.
+ *
+ * Inline functions whose code depends on the instruction set, like the vectorized kernels, are
+ * declared in `inline namespace RCPPUTILS_DETAIL_ISA_NAMESPACE`. Translation units built with
+ * different `-m` flags then define them under different symbols, instead of sharing one symbol
+ * of which the linker keeps a single copy, possibly using instructions the CPU running it lacks.
+ *
+ * The macros disabling a kernel, e.g. `RCPPUTILS_SCAN_DISABLE_SIMD`, are not part of the tag:
+ * like any other configuration macro, they must be defined consistently across a program.
+ */
+
+#ifndef RCPPUTILS__DETAIL__ISA_HPP_
+#define RCPPUTILS__DETAIL__ISA_HPP_
+
+#if defined(__AVX2__)
+#  define RCPPUTILS_DETAIL_ISA_NAMESPACE avx2
+#elif defined(__SSSE3__)
+#  define RCPPUTILS_DETAIL_ISA_NAMESPACE ssse3
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define RCPPUTILS_DETAIL_ISA_NAMESPACE sse2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#  define RCPPUTILS_DETAIL_ISA_NAMESPACE neon
+#else
+#  define RCPPUTILS_DETAIL_ISA_NAMESPACE generic
+#endif
+
+#endif  // RCPPUTILS__DETAIL__ISA_HPP_
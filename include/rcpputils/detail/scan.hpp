@@ -0,0 +1,390 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/*! \file scan.hpp
+ * \brief Internal, vectorized byte scanning kernels shared by the string helpers.
+ *
+ * The kernel is selected at compile time from the instruction set the translation unit is
+ * built for: AVX2, SSE2 or NEON, falling back to a scalar implementation otherwise.
+ * Define `RCPPUTILS_SCAN_DISABLE_SIMD` to force the scalar implementation.
+ * The kernels live in a namespace named after the instruction set, see isa.hpp, so translation
+ * units built for different instruction sets can be linked together.
+ *
+ * All functions follow the `std::string_view::find` family semantics, returning the index of
+ * the first match at or after `pos`, or `std::string_view::npos`.
+ */
+
+#ifndef RCPPUTILS__DETAIL__SCAN_HPP_
+#define RCPPUTILS__DETAIL__SCAN_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#include "rcpputils/detail/isa.hpp"
+
+#if !defined(RCPPUTILS_SCAN_DISABLE_SIMD)
+#  if defined(__AVX2__)
+#    define RCPPUTILS_SCAN_AVX2 1
+#  elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    define RCPPUTILS_SCAN_SSE2 1
+#  elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#    define RCPPUTILS_SCAN_NEON 1
+#  endif
+#endif
+
+#if defined(RCPPUTILS_SCAN_AVX2)
+#  include <immintrin.h>
+#elif defined(RCPPUTILS_SCAN_SSE2)
+#  include <emmintrin.h>
+#elif defined(RCPPUTILS_SCAN_NEON)
+#  include <arm_neon.h>
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#  include <intrin.h>
+#endif
+
+namespace rcpputils
+{
+namespace detail
+{
+inline namespace RCPPUTILS_DETAIL_ISA_NAMESPACE
+{
+
+/// Name of the scanning kernel selected at compile time.
+#if defined(RCPPUTILS_SCAN_AVX2)
+constexpr const char * scan_kernel_name = "avx2";
+#elif defined(RCPPUTILS_SCAN_SSE2)
+constexpr const char * scan_kernel_name = "sse2";
+#elif defined(RCPPUTILS_SCAN_NEON)
+constexpr const char * scan_kernel_name = "neon";
+#else
+constexpr const char * scan_kernel_name = "scalar";
+#endif
+
+/// Maximum size of a delimiter set handled by the vectorized find_first_of.
+constexpr std::size_t kMaxVectorizedSetSize = 8u;
+
+inline unsigned count_trailing_zeros(std::uint32_t value) noexcept
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+  unsigned long index;
+  _BitScanForward(&index, value);
+  return static_cast<unsigned>(index);
+#else
+  return static_cast<unsigned>(__builtin_ctz(value));
+#endif
+}
+
+inline unsigned count_trailing_zeros(std::uint64_t value) noexcept
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+#  if defined(_M_X64) || defined(_M_ARM64)
+  unsigned long index;
+  _BitScanForward64(&index, value);
+  return static_cast<unsigned>(index);
+#  else
+  const auto low = static_cast<std::uint32_t>(value);
+  return low != 0u ?
+         count_trailing_zeros(low) :
+         32u + count_trailing_zeros(static_cast<std::uint32_t>(value >> 32));
+#  endif
+#else
+  return static_cast<unsigned>(__builtin_ctzll(value));
+#endif
+}
+
+namespace scalar
+{
+
+inline std::size_t
+find(std::string_view input, char c, std::size_t pos = 0u) noexcept
+{
+  if (pos >= input.size()) {
+    return std::string_view::npos;
+  }
+  const void * match = std::memchr(input.data() + pos, c, input.size() - pos);
+  return match ?
+         static_cast<std::size_t>(static_cast<const char *>(match) - input.data()) :
+         std::string_view::npos;
+}
+
+inline std::size_t
+find_first_of(std::string_view input, std::string_view set, std::size_t pos = 0u) noexcept
+{
+  if (set.size() == 1u) {
+    return find(input, set[0], pos);
+  }
+  if (set.empty() || pos >= input.size()) {
+    return std::string_view::npos;
+  }
+  bool table[256] = {};
+  for (const char c : set) {
+    table[static_cast<unsigned char>(c)] = true;
+  }
+  for (std::size_t i = pos; i < input.size(); ++i) {
+    if (table[static_cast<unsigned char>(input[i])]) {
+      return i;
+    }
+  }
+  return std::string_view::npos;
+}
+
+inline std::size_t
+find(std::string_view input, std::string_view needle, std::size_t pos = 0u) noexcept
+{
+  if (needle.empty()) {
+    return pos <= input.size() ? pos : std::string_view::npos;
+  }
+  if (pos > input.size() || input.size() - pos < needle.size()) {
+    return std::string_view::npos;
+  }
+  const std::size_t last_start = input.size() - needle.size();
+  while (pos <= last_start) {
+    const void * match = std::memchr(input.data() + pos, needle[0], last_start - pos + 1u);
+    if (!match) {
+      break;
+    }
+    const auto index = static_cast<std::size_t>(static_cast<const char *>(match) - input.data());
+    if (std::memcmp(input.data() + index + 1u, needle.data() + 1u, needle.size() - 1u) == 0) {
+      return index;
+    }
+    pos = index + 1u;
+  }
+  return std::string_view::npos;
+}
+
+}  // namespace scalar
+
+#if defined(RCPPUTILS_SCAN_AVX2) || defined(RCPPUTILS_SCAN_SSE2) || defined(RCPPUTILS_SCAN_NEON)
+#  define RCPPUTILS_SCAN_HAS_SIMD 1
+
+// Each block of vector operations compares `width` bytes at once and produces a bit mask with
+// `bits_per_byte` bits set for every matching byte, lowest address in the lowest bits.
+#  if defined(RCPPUTILS_SCAN_AVX2)
+struct vector_ops
+{
+  using vector = __m256i;
+  using mask = std::uint32_t;
+  static constexpr std::ptrdiff_t width = 32;
+  static constexpr unsigned bits_per_byte = 1u;
+
+  static vector splat(char c) noexcept {return _mm256_set1_epi8(c);}
+  static vector load(const char * p) noexcept
+  {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+  }
+  static vector equal(vector a, vector b) noexcept {return _mm256_cmpeq_epi8(a, b);}
+  static vector bit_or(vector a, vector b) noexcept {return _mm256_or_si256(a, b);}
+  static vector bit_and(vector a, vector b) noexcept {return _mm256_and_si256(a, b);}
+  static mask to_mask(vector v) noexcept
+  {
+    return static_cast<mask>(_mm256_movemask_epi8(v));
+  }
+};
+#  elif defined(RCPPUTILS_SCAN_SSE2)
+struct vector_ops
+{
+  using vector = __m128i;
+  using mask = std::uint32_t;
+  static constexpr std::ptrdiff_t width = 16;
+  static constexpr unsigned bits_per_byte = 1u;
+
+  static vector splat(char c) noexcept {return _mm_set1_epi8(c);}
+  static vector load(const char * p) noexcept
+  {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+  }
+  static vector equal(vector a, vector b) noexcept {return _mm_cmpeq_epi8(a, b);}
+  static vector bit_or(vector a, vector b) noexcept {return _mm_or_si128(a, b);}
+  static vector bit_and(vector a, vector b) noexcept {return _mm_and_si128(a, b);}
+  static mask to_mask(vector v) noexcept
+  {
+    return static_cast<mask>(_mm_movemask_epi8(v));
+  }
+};
+#  elif defined(RCPPUTILS_SCAN_NEON)
+struct vector_ops
+{
+  using vector = uint8x16_t;
+  using mask = std::uint64_t;
+  static constexpr std::ptrdiff_t width = 16;
+  static constexpr unsigned bits_per_byte = 4u;
+
+  static vector splat(char c) noexcept {return vdupq_n_u8(static_cast<std::uint8_t>(c));}
+  static vector load(const char * p) noexcept
+  {
+    return vld1q_u8(reinterpret_cast<const std::uint8_t *>(p));
+  }
+  static vector equal(vector a, vector b) noexcept {return vceqq_u8(a, b);}
+  static vector bit_or(vector a, vector b) noexcept {return vorrq_u8(a, b);}
+  static vector bit_and(vector a, vector b) noexcept {return vandq_u8(a, b);}
+  static mask to_mask(vector v) noexcept
+  {
+    // NEON has no movemask, narrowing by a shift packs every byte into a nibble instead.
+    const uint8x8_t nibbles = vshrn_n_u16(vreinterpretq_u16_u8(v), 4);
+    return vget_lane_u64(vreinterpret_u64_u8(nibbles), 0);
+  }
+};
+#  endif
+
+namespace simd
+{
+
+/// Index of the lowest matching byte in a non-zero mask.
+inline std::size_t first_index(vector_ops::mask m) noexcept
+{
+  return count_trailing_zeros(m) / vector_ops::bits_per_byte;
+}
+
+/// Clear the bits of the lowest matching byte, which is at index.
+inline vector_ops::mask clear_index(vector_ops::mask m, std::size_t index) noexcept
+{
+  constexpr vector_ops::mask byte_bits = (vector_ops::mask{1} << vector_ops::bits_per_byte) - 1u;
+  return m & ~(byte_bits << (index * vector_ops::bits_per_byte));
+}
+
+inline std::size_t
+find(std::string_view input, char c, std::size_t pos = 0u) noexcept
+{
+  if (pos >= input.size()) {
+    return std::string_view::npos;
+  }
+  const char * const begin = input.data();
+  const char * const end = begin + input.size();
+  const char * p = begin + pos;
+  const vector_ops::vector needle = vector_ops::splat(c);
+  for (; end - p >= vector_ops::width; p += vector_ops::width) {
+    const vector_ops::mask m = vector_ops::to_mask(vector_ops::equal(vector_ops::load(p), needle));
+    if (m != 0u) {
+      return static_cast<std::size_t>(p - begin) + first_index(m);
+    }
+  }
+  for (; p != end; ++p) {
+    if (*p == c) {
+      return static_cast<std::size_t>(p - begin);
+    }
+  }
+  return std::string_view::npos;
+}
+
+inline std::size_t
+find_first_of(std::string_view input, std::string_view set, std::size_t pos = 0u) noexcept
+{
+  if (set.size() == 1u) {
+    return find(input, set[0], pos);
+  }
+  if (set.size() > kMaxVectorizedSetSize) {
+    return scalar::find_first_of(input, set, pos);
+  }
+  if (set.empty() || pos >= input.size()) {
+    return std::string_view::npos;
+  }
+  const char * const begin = input.data();
+  const char * const end = begin + input.size();
+  const char * p = begin + pos;
+  vector_ops::vector needles[kMaxVectorizedSetSize];
+  for (std::size_t i = 0u; i < set.size(); ++i) {
+    needles[i] = vector_ops::splat(set[i]);
+  }
+  for (; end - p >= vector_ops::width; p += vector_ops::width) {
+    const vector_ops::vector block = vector_ops::load(p);
+    vector_ops::vector matches = vector_ops::equal(block, needles[0]);
+    for (std::size_t i = 1u; i < set.size(); ++i) {
+      matches = vector_ops::bit_or(matches, vector_ops::equal(block, needles[i]));
+    }
+    const vector_ops::mask m = vector_ops::to_mask(matches);
+    if (m != 0u) {
+      return static_cast<std::size_t>(p - begin) + first_index(m);
+    }
+  }
+  return scalar::find_first_of(input, set, static_cast<std::size_t>(p - begin));
+}
+
+inline std::size_t
+find(std::string_view input, std::string_view needle, std::size_t pos = 0u) noexcept
+{
+  if (needle.size() <= 1u) {
+    return needle.empty() ? scalar::find(input, needle, pos) : find(input, needle[0], pos);
+  }
+  if (pos > input.size() || input.size() - pos < needle.size()) {
+    return std::string_view::npos;
+  }
+  const std::size_t n = needle.size();
+  const char * const begin = input.data();
+  // Candidate start positions are [begin + pos, stop).
+  const char * const stop = begin + input.size() - n + 1u;
+  const char * p = begin + pos;
+  // Filter candidates on the first and last needle characters, then confirm the middle.
+  const vector_ops::vector first = vector_ops::splat(needle[0]);
+  const vector_ops::vector last = vector_ops::splat(needle[n - 1u]);
+  for (; stop - p >= vector_ops::width; p += vector_ops::width) {
+    vector_ops::mask m = vector_ops::to_mask(
+      vector_ops::bit_and(
+        vector_ops::equal(vector_ops::load(p), first),
+        vector_ops::equal(vector_ops::load(p + n - 1u), last)));
+    while (m != 0u) {
+      const std::size_t index = first_index(m);
+      if (std::memcmp(p + index + 1u, needle.data() + 1u, n - 2u) == 0) {
+        return static_cast<std::size_t>(p - begin) + index;
+      }
+      m = clear_index(m, index);
+    }
+  }
+  return scalar::find(input, needle, static_cast<std::size_t>(p - begin));
+}
+
+}  // namespace simd
+#endif
+
+/// Find the first occurrence of character c in input, starting at pos.
+inline std::size_t
+scan_find(std::string_view input, char c, std::size_t pos = 0u) noexcept
+{
+#if defined(RCPPUTILS_SCAN_HAS_SIMD)
+  return simd::find(input, c, pos);
+#else
+  return scalar::find(input, c, pos);
+#endif
+}
+
+/// Find the first occurrence of any character of set in input, starting at pos.
+inline std::size_t
+scan_find_first_of(std::string_view input, std::string_view set, std::size_t pos = 0u) noexcept
+{
+#if defined(RCPPUTILS_SCAN_HAS_SIMD)
+  return simd::find_first_of(input, set, pos);
+#else
+  return scalar::find_first_of(input, set, pos);
+#endif
+}
+
+/// Find the first occurrence of needle in input, starting at pos.
+inline std::size_t
+scan_find(std::string_view input, std::string_view needle, std::size_t pos = 0u) noexcept
+{
+#if defined(RCPPUTILS_SCAN_HAS_SIMD)
+  return simd::find(input, needle, pos);
+#else
+  return scalar::find(input, needle, pos);
+#endif
+}
+
+}  // namespace RCPPUTILS_DETAIL_ISA_NAMESPACE
+}  // namespace detail
+}  // namespace rcpputils
+
+#endif  // RCPPUTILS__DETAIL__SCAN_HPP_
@@ -19,6 +19,11 @@
  * can be deprecated in favor of the built-in functionality.
  *
  * Note: std::endian is targeted for C++20
+ *
+ * Byte order conversions are provided as well: byteswap() for single values, to_big(),
+ * to_little(), from_big() and from_little(), which compile to nothing when the host already
+ * has the requested byte order, and byteswap_n() for arrays, using SIMD kernels when the
+ * target instruction set has them.
  */
 
 #ifndef RCPPUTILS__ENDIAN_HPP_
@@ -69,4 +74,220 @@ enum class endian
 };
 }  // namespace rcpputils
 #endif  // RCPPUTILS_HAVE_STD_ENDIAN
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+
+#include "rcpputils/detail/byteswap.hpp"
+
+#if defined(__has_builtin)
+#  if __has_builtin(__builtin_bit_cast)
+#    define RCPPUTILS_HAS_BUILTIN_BIT_CAST 1
+#  endif
+#endif
+#if defined(RCPPUTILS_HAS_BUILTIN_BIT_CAST)
+#  define RCPPUTILS_BYTESWAP_FLOAT_CONSTEXPR constexpr
+#else
+#  define RCPPUTILS_BYTESWAP_FLOAT_CONSTEXPR inline
+#endif
+
+namespace rcpputils
+{
+
+namespace detail
+{
+
+template<typename T>
+constexpr bool is_byteswappable_v =
+  (std::is_integral<T>::value && !std::is_same<T, bool>::value) ||
+  (std::is_floating_point<T>::value && (sizeof(T) == 4 || sizeof(T) == 8));
+
+}  // namespace detail
+
+/// Reverse the bytes of an integer.
+/**
+ * \param[in] value the integer, of any width
+ * \return The integer with its bytes in reverse order.
+ */
+template<typename T>
+constexpr std::enable_if_t<std::is_integral<T>::value && !std::is_same<T, bool>::value, T>
+byteswap(T value) noexcept
+{
+  if constexpr (sizeof(T) == 1) {
+    return value;
+  } else {
+    using uint = typename detail::uint_of_width<sizeof(T)>::type;
+    return static_cast<T>(detail::byteswap_uint(static_cast<uint>(value)));
+  }
+}
+
+/// Reverse the bytes of a float.
+/**
+ * This is constexpr where the compiler provides `__builtin_bit_cast`.
+ *
+ * \param[in] value the float
+ * \return The float with its bytes in reverse order, which may not be a number.
+ */
+RCPPUTILS_BYTESWAP_FLOAT_CONSTEXPR float byteswap(float value) noexcept
+{
+#if defined(RCPPUTILS_HAS_BUILTIN_BIT_CAST)
+  return __builtin_bit_cast(
+    float, detail::byteswap_uint(__builtin_bit_cast(std::uint32_t, value)));
+#else
+  std::uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  bits = detail::byteswap_uint(bits);
+  std::memcpy(&value, &bits, sizeof(bits));
+  return value;
+#endif
+}
+
+/// Reverse the bytes of a double.
+/**
+ * This is constexpr where the compiler provides `__builtin_bit_cast`.
+ *
+ * \param[in] value the double
+ * \return The double with its bytes in reverse order, which may not be a number.
+ */
+RCPPUTILS_BYTESWAP_FLOAT_CONSTEXPR double byteswap(double value) noexcept
+{
+#if defined(RCPPUTILS_HAS_BUILTIN_BIT_CAST)
+  return __builtin_bit_cast(
+    double, detail::byteswap_uint(__builtin_bit_cast(std::uint64_t, value)));
+#else
+  std::uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  bits = detail::byteswap_uint(bits);
+  std::memcpy(&value, &bits, sizeof(bits));
+  return value;
+#endif
+}
+
+/// Convert a value from the host byte order to big endian.
+template<typename T>
+constexpr T to_big(T value) noexcept
+{
+  static_assert(detail::is_byteswappable_v<T>, "only integers, float and double are supported");
+  if constexpr (endian::native == endian::big) {
+    return value;
+  } else {
+    return byteswap(value);
+  }
+}
+
+/// Convert a value from the host byte order to little endian.
+template<typename T>
+constexpr T to_little(T value) noexcept
+{
+  static_assert(detail::is_byteswappable_v<T>, "only integers, float and double are supported");
+  if constexpr (endian::native == endian::little) {
+    return value;
+  } else {
+    return byteswap(value);
+  }
+}
+
+/// Convert a big endian value to the host byte order.
+template<typename T>
+constexpr T from_big(T value) noexcept
+{
+  return to_big(value);
+}
+
+/// Convert a little endian value to the host byte order.
+template<typename T>
+constexpr T from_little(T value) noexcept
+{
+  return to_little(value);
+}
+
+/// Reverse the bytes of every value of an array, into another array.
+/**
+ * Large arrays are processed 16 or 32 bytes at a time with SSSE3 or AVX2 `pshufb`, SSE2 or
+ * NEON, whichever the target instruction set has.
+ *
+ * \param[in] input the values to convert
+ * \param[in] count the number of values
+ * \param[out] output where to write the converted values; it may be input itself, but must not
+ *   overlap it otherwise
+ */
+template<typename T>
+void byteswap_n(const T * input, std::size_t count, T * output) noexcept
+{
+  static_assert(detail::is_byteswappable_v<T>, "only integers, float and double are supported");
+  if constexpr (sizeof(T) == 1) {
+    if (output != input && count != 0) {
+      std::memmove(output, input, count);
+    }
+  } else {
+    detail::byteswap_n<sizeof(T)>(
+      reinterpret_cast<unsigned char *>(output), reinterpret_cast<const unsigned char *>(input),
+      count);
+  }
+}
+
+/// Reverse the bytes of every value of an array, in place.
+/**
+ * \param[inout] data the values to convert
+ * \param[in] count the number of values
+ */
+template<typename T>
+void byteswap_n(T * data, std::size_t count) noexcept
+{
+  byteswap_n(static_cast<const T *>(data), count, data);
+}
+
+/// Reverse the bytes of every value of a contiguous range, in place.
+/**
+ * \param[inout] range a contiguous range, like a `std::vector`, `std::array` or `std::span`
+ */
+template<typename ContiguousRange>
+auto byteswap_n(ContiguousRange && range) noexcept
+-> decltype(std::data(range), std::size(range), void())
+{
+  byteswap_n(std::data(range), std::size(range));
+}
+
+/// Convert the values of an array from the host byte order to big endian, in place.
+template<typename T>
+void to_big_n(T * data, std::size_t count) noexcept
+{
+  if constexpr (endian::native != endian::big) {
+    byteswap_n(data, count);
+  } else {
+    (void)data;
+    (void)count;
+  }
+}
+
+/// Convert the values of an array from the host byte order to little endian, in place.
+template<typename T>
+void to_little_n(T * data, std::size_t count) noexcept
+{
+  if constexpr (endian::native != endian::little) {
+    byteswap_n(data, count);
+  } else {
+    (void)data;
+    (void)count;
+  }
+}
+
+/// Convert the big endian values of an array to the host byte order, in place.
+template<typename T>
+void from_big_n(T * data, std::size_t count) noexcept
+{
+  to_big_n(data, count);
+}
+
+/// Convert the little endian values of an array to the host byte order, in place.
+template<typename T>
+void from_little_n(T * data, std::size_t count) noexcept
+{
+  to_little_n(data, count);
+}
+
+}  // namespace rcpputils
+
 #endif  // RCPPUTILS__ENDIAN_HPP_
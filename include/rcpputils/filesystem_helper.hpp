@@ -46,8 +46,16 @@
 
 #include <sys/stat.h>
 
-#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <new>
 #include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
 #include <vector>
 
 /**
@@ -69,10 +77,13 @@
 #  include <io.h>
 #  define access _access_s
 #else
+#  include <dirent.h>
+#  include <fcntl.h>
 #  include <sys/types.h>
 #  include <unistd.h>
 #endif
 
+#include "rcpputils/small_vector.hpp"
 #include "rcpputils/split.hpp"
 
 namespace rcpputils
@@ -82,6 +93,264 @@ namespace fs
 
 static constexpr const char kPreferredSeparator = RCPPUTILS_IMPL_OS_DIRSEP;
 
+/**
+ * \brief Drop-in replacement for [std::filesystem::file_type](https://en.cppreference.com/w/cpp/filesystem/file_type).
+ */
+enum class file_type
+{
+  none = 0,
+  not_found = -1,
+  regular = 1,
+  directory = 2,
+  symlink = 3,
+  block = 4,
+  character = 5,
+  fifo = 6,
+  socket = 7,
+  unknown = 8
+};
+
+/**
+ * \brief Drop-in replacement for [std::filesystem::file_status](https://en.cppreference.com/w/cpp/filesystem/file_status).
+ *
+ * Besides the file type it keeps the file size reported by the same `stat` call, so that one
+ * system call answers whether a file exists, what type it is and how big it is.
+ */
+class file_status
+{
+public:
+  /**
+   * \brief Construct a file status.
+   *
+   * \param type The type of the file.
+   * \param size The size of the file in bytes.
+   */
+  explicit file_status(file_type type = file_type::none, uint64_t size = 0u) noexcept
+  : type_(type), size_(size)
+  {}
+
+  /**
+   * \brief Get the type of the file.
+   *
+   * \return The file type.
+   */
+  file_type type() const noexcept
+  {
+    return type_;
+  }
+
+  /**
+   * \brief Set the type of the file.
+   *
+   * \param type The file type.
+   */
+  void type(file_type type) noexcept
+  {
+    type_ = type;
+  }
+
+  /**
+   * \brief Get the size of the file in bytes, as reported by `stat`.
+   *
+   * \return The file size, only meaningful for regular files.
+   */
+  uint64_t size() const noexcept
+  {
+    return size_;
+  }
+
+private:
+  file_type type_;
+  uint64_t size_;
+};
+
+/**
+ * \brief Check if the file status is known.
+ *
+ * \param s The file status to check.
+ * \return True if the status is known, even if the file does not exist, false otherwise.
+ */
+inline bool status_known(file_status s) noexcept
+{
+  return s.type() != file_type::none;
+}
+
+/**
+ * \brief Check if the file status corresponds to an existing file.
+ *
+ * \param s The file status to check.
+ * \return True if the file exists, false otherwise.
+ */
+inline bool exists(file_status s) noexcept
+{
+  return status_known(s) && s.type() != file_type::not_found;
+}
+
+/**
+ * \brief Check if the file status corresponds to a regular file.
+ *
+ * \param s The file status to check.
+ * \return True if the file is a regular file, false otherwise.
+ */
+inline bool is_regular_file(file_status s) noexcept
+{
+  return s.type() == file_type::regular;
+}
+
+/**
+ * \brief Check if the file status corresponds to a directory.
+ *
+ * \param s The file status to check.
+ * \return True if the file is a directory, false otherwise.
+ */
+inline bool is_directory(file_status s) noexcept
+{
+  return s.type() == file_type::directory;
+}
+
+/**
+ * \brief Check if the file status corresponds to a symbolic link.
+ *
+ * \param s The file status to check.
+ * \return True if the file is a symbolic link, false otherwise.
+ */
+inline bool is_symlink(file_status s) noexcept
+{
+  return s.type() == file_type::symlink;
+}
+
+namespace detail
+{
+
+/**
+ * \brief Get the status of a file with a single `stat` (or `lstat`) call.
+ *
+ * \param native_path The path of the file, using the platform's separator.
+ * \param follow_symlinks Whether to report the target of a symbolic link rather than the link.
+ *   Symbolic links are always followed on Windows.
+ * \param ec Set to the error reported by the system call, cleared otherwise.
+ * \return The status of the file, of type not_found if it does not exist or none on other errors.
+ */
+inline file_status status_of(
+  const char * native_path, bool follow_symlinks, std::error_code & ec) noexcept
+{
+#ifdef _WIN32
+  (void) follow_symlinks;
+  struct _stat64 stat_buffer;
+  const auto rc = _stat64(native_path, &stat_buffer);
+#else
+  struct stat stat_buffer;
+  const auto rc = follow_symlinks ?
+    stat(native_path, &stat_buffer) :
+    lstat(native_path, &stat_buffer);
+#endif
+  if (rc != 0) {
+    const int error = errno;
+    ec.assign(error, std::system_category());
+    if (error == ENOENT || error == ENOTDIR) {
+      return file_status(file_type::not_found);
+    }
+    return file_status(file_type::none);
+  }
+  ec.clear();
+
+  file_type type = file_type::unknown;
+#ifdef _WIN32
+  switch (stat_buffer.st_mode & S_IFMT) {
+    case S_IFREG: type = file_type::regular; break;
+    case S_IFDIR: type = file_type::directory; break;
+    case S_IFCHR: type = file_type::character; break;
+    default: break;
+  }
+#else
+  if (S_ISREG(stat_buffer.st_mode)) {
+    type = file_type::regular;
+  } else if (S_ISDIR(stat_buffer.st_mode)) {
+    type = file_type::directory;
+  } else if (S_ISLNK(stat_buffer.st_mode)) {
+    type = file_type::symlink;
+  } else if (S_ISBLK(stat_buffer.st_mode)) {
+    type = file_type::block;
+  } else if (S_ISCHR(stat_buffer.st_mode)) {
+    type = file_type::character;
+  } else if (S_ISFIFO(stat_buffer.st_mode)) {
+    type = file_type::fifo;
+  } else if (S_ISSOCK(stat_buffer.st_mode)) {
+    type = file_type::socket;
+  }
+#endif
+  return file_status(type, static_cast<uint64_t>(stat_buffer.st_size));
+}
+
+/// Create a directory with all permissions, subject to the umask.
+/**
+ * \return 0 on success, -1 with errno set otherwise.
+ */
+inline int make_directory(const char * native_path) noexcept
+{
+#ifdef _WIN32
+  return _mkdir(native_path);
+#else
+  return mkdir(native_path, S_IRWXU | S_IRWXG | S_IRWXO);
+#endif
+}
+
+/// Get the size of the extension of a path element: from its last '.' to its end.
+/**
+ * Like std::filesystem, "." and "..", and elements whose only '.' is their first character,
+ * such as ".bashrc", have no extension.
+ */
+inline std::size_t extension_size(std::string_view filename) noexcept
+{
+  if (filename == "." || filename == "..") {
+    return 0u;
+  }
+  const std::size_t dot = filename.rfind('.');
+  return dot == std::string_view::npos || dot == 0u ? 0u : filename.size() - dot;
+}
+
+/// Get the last element of a path string; a trailing separator is not part of it.
+/**
+ * Like the other accessors below, it is found with a single reverse scan of the path string,
+ * which must only contain preferred separators.
+ */
+inline std::string_view filename_of(std::string_view native) noexcept
+{
+  if (!native.empty() && native.back() == kPreferredSeparator) {
+    native.remove_suffix(1u);
+  }
+  const std::size_t separator = native.rfind(kPreferredSeparator);
+  return separator == std::string_view::npos ? native : native.substr(separator + 1u);
+}
+
+/// Get the parent directory of a path string, "" if it only has one element.
+inline std::string_view parent_path_of(std::string_view native) noexcept
+{
+  const std::string_view filename = filename_of(native);
+  const std::size_t begin = static_cast<std::size_t>(filename.data() - native.data());
+  if (begin == 0u) {
+    return {};
+  }
+  // Drop the separator before the filename, unless it is the root.
+  return native.substr(0u, begin == 1u ? 1u : begin - 1u);
+}
+
+/// Get the extension of the last element of a path string, including its '.'.
+inline std::string_view extension_of(std::string_view native) noexcept
+{
+  const std::string_view filename = filename_of(native);
+  return filename.substr(filename.size() - extension_size(filename));
+}
+
+/// Get the last element of a path string without its extension.
+inline std::string_view stem_of(std::string_view native) noexcept
+{
+  const std::string_view filename = filename_of(native);
+  return filename.substr(0u, filename.size() - extension_size(filename));
+}
+
+}  // namespace detail
+
 /**
  * \brief Drop-in replacement for [std::filesystem::path](https://en.cppreference.com/w/cpp/filesystem/path).
  *
@@ -91,12 +360,130 @@ static constexpr const char kPreferredSeparator = RCPPUTILS_IMPL_OS_DIRSEP;
 class path
 {
 public:
+  /**
+   * \brief Bidirectional iterator over the elements of a path.
+   *
+   * Elements are found in the path string on the fly, so paths carry no per-element storage.
+   * Dereferencing copies the current element into a buffer of the iterator, reused as it moves:
+   * like for std::filesystem::path::iterator, equal iterators may refer to different copies of an
+   * element, and a reference is only valid until its iterator is moved or destroyed.
+   * The iterator is only valid as long as the path it was obtained from is not modified.
+   */
+  class const_iterator
+  {
+public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = std::string;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const std::string *;
+    using reference = const std::string &;
+
+    const_iterator() = default;
+
+    reference operator*() const
+    {
+      if (!cached_) {
+        element_.assign(*path_, begin_, end_ - begin_);
+        cached_ = true;
+      }
+      return element_;
+    }
+
+    pointer operator->() const
+    {
+      return &**this;
+    }
+
+    const_iterator & operator++()
+    {
+      cached_ = false;
+      // No element follows a trailing separator.
+      if (end_ + 1u >= path_->size()) {
+        begin_ = end_ = std::string::npos;
+      } else {
+        begin_ = end_ + 1u;
+        end_ = element_end(begin_);
+      }
+      return *this;
+    }
+
+    const_iterator operator++(int)
+    {
+      const_iterator copy(*this);
+      ++(*this);
+      return copy;
+    }
+
+    const_iterator & operator--()
+    {
+      cached_ = false;
+      if (begin_ == std::string::npos) {
+        // The last element ends before a trailing separator, if any.
+        end_ = path_->size();
+        if (path_->back() == kPreferredSeparator) {
+          --end_;
+        }
+      } else {
+        end_ = begin_ - 1u;
+      }
+      begin_ = element_begin(end_);
+      return *this;
+    }
+
+    const_iterator operator--(int)
+    {
+      const_iterator copy(*this);
+      --(*this);
+      return copy;
+    }
+
+    bool operator==(const const_iterator & other) const noexcept
+    {
+      return path_ == other.path_ && begin_ == other.begin_;
+    }
+
+    bool operator!=(const const_iterator & other) const noexcept
+    {
+      return !(*this == other);
+    }
+
+private:
+    friend class path;
+
+    const_iterator(const std::string * p, std::size_t begin)
+    : path_(p), begin_(begin), end_(begin)
+    {
+      if (begin_ != std::string::npos) {
+        end_ = element_end(begin_);
+      }
+    }
+
+    std::size_t element_end(std::size_t begin) const noexcept
+    {
+      const std::size_t end = path_->find(kPreferredSeparator, begin);
+      return end == std::string::npos ? path_->size() : end;
+    }
+
+    std::size_t element_begin(std::size_t end) const noexcept
+    {
+      if (end == 0u) {
+        return 0u;
+      }
+      const std::size_t separator = path_->rfind(kPreferredSeparator, end - 1u);
+      return separator == std::string::npos ? 0u : separator + 1u;
+    }
+
+    const std::string * path_{nullptr};
+    std::size_t begin_{std::string::npos};
+    std::size_t end_{std::string::npos};
+    mutable std::string element_;
+    mutable bool cached_{false};
+  };
+
   /**
     * \brief Constructs an empty path.
     */
-  path()
-  : path("")
-  {}
+  path() = default;
 
   /**
    * \brief Conversion constructor from a std::string path.
@@ -104,10 +491,20 @@ public:
    * \param p A string path split by the platform's string path separator.
    */
   path(const std::string & p)  // NOLINT(runtime/explicit): this is a conversion constructor
-  : path_(p), path_as_vector_(split(p, kPreferredSeparator))
+  : path_(p)
+  {
+    normalize_separators(0u);
+  }
+
+  /**
+   * \brief Conversion constructor from a temporary std::string path, reusing its storage.
+   *
+   * \param p A string path split by the platform's string path separator.
+   */
+  path(std::string && p)  // NOLINT(runtime/explicit): this is a conversion constructor
+  : path_(std::move(p))
   {
-    std::replace(path_.begin(), path_.end(), '\\', kPreferredSeparator);
-    std::replace(path_.begin(), path_.end(), '/', kPreferredSeparator);
+    normalize_separators(0u);
   }
 
   /**
@@ -115,6 +512,21 @@ public:
     */
   path(const path & p) = default;
 
+  /**
+    * \brief Move constructor.
+    */
+  path(path && p) noexcept = default;
+
+  /**
+    * \brief Copy assignment operator.
+    */
+  path & operator=(const path & p) = default;
+
+  /**
+    * \brief Move assignment operator.
+    */
+  path & operator=(path && p) noexcept = default;
+
   /**
    * \brief Get the path delimited using this system's path separator.
    *
@@ -125,6 +537,26 @@ public:
     return path_;
   }
 
+  /**
+   * \brief Get the path in its native format, without copying it.
+   *
+   * \return A reference to the path string.
+   */
+  const std::string & native() const noexcept
+  {
+    return path_;
+  }
+
+  /**
+   * \brief Get the path in its native format as a null terminated string.
+   *
+   * \return A pointer to the path string, valid until the path is modified.
+   */
+  const char * c_str() const noexcept
+  {
+    return path_.c_str();
+  }
+
   /**
    * \brief Check if this path exists.
    *
@@ -132,7 +564,8 @@ public:
    */
   bool exists() const
   {
-    return access(path_.c_str(), 0) == 0;
+    std::error_code ec;
+    return fs::exists(detail::status_of(path_.c_str(), true, ec));
   }
 
   /**
@@ -142,18 +575,8 @@ public:
    */
   bool is_directory() const noexcept
   {
-    struct stat stat_buffer;
-    const auto rc = stat(path_.c_str(), &stat_buffer);
-
-    if (rc != 0) {
-      return false;
-    }
-
-#ifdef _WIN32
-    return (stat_buffer.st_mode & S_IFDIR) == S_IFDIR;
-#else
-    return S_ISDIR(stat_buffer.st_mode);
-#endif
+    std::error_code ec;
+    return fs::is_directory(detail::status_of(path_.c_str(), true, ec));
   }
 
   /**
@@ -163,18 +586,8 @@ public:
    */
   bool is_regular_file() const noexcept
   {
-    struct stat stat_buffer;
-    const auto rc = stat(path_.c_str(), &stat_buffer);
-
-    if (rc != 0) {
-      return false;
-    }
-
-#ifdef _WIN32
-    return (stat_buffer.st_mode & S_IFREG) == S_IFREG;
-#else
-    return S_ISREG(stat_buffer.st_mode);
-#endif
+    std::error_code ec;
+    return fs::is_regular_file(detail::status_of(path_.c_str(), true, ec));
   }
 
   /**
@@ -185,21 +598,16 @@ public:
   */
   uint64_t file_size() const
   {
-    if (is_directory()) {
-      auto ec = std::make_error_code(std::errc::is_a_directory);
+    std::error_code ec;
+    const file_status s = detail::status_of(path_.c_str(), true, ec);
+    if (ec) {
       throw std::system_error{ec, "cannot get file size"};
     }
-
-    struct stat stat_buffer;
-    const auto rc = stat(path_.c_str(), &stat_buffer);
-
-    if (rc != 0) {
-      std::error_code ec{errno, std::system_category()};
-      errno = 0;
-      throw std::system_error{ec, "cannot get file size"};
-    } else {
-      return static_cast<uint64_t>(stat_buffer.st_size);
+    if (fs::is_directory(s)) {
+      throw std::system_error{
+              std::make_error_code(std::errc::is_a_directory), "cannot get file size"};
     }
+    return s.size();
   }
 
   /**
@@ -228,9 +636,9 @@ public:
   *
   * \return A const iterator to the first element.
   */
-  std::vector<std::string>::const_iterator cbegin() const
+  const_iterator cbegin() const
   {
-    return path_as_vector_.cbegin();
+    return const_iterator(&path_, path_.empty() ? std::string::npos : 0u);
   }
 
   /**
@@ -238,9 +646,29 @@ public:
   *
   * return A const iterator to one past the last element of the path.
   */
-  std::vector<std::string>::const_iterator cend() const
+  const_iterator cend() const
+  {
+    return const_iterator(&path_, std::string::npos);
+  }
+
+  /**
+  * \brief Const iterator to first element of this path.
+  *
+  * \return A const iterator to the first element.
+  */
+  const_iterator begin() const
+  {
+    return cbegin();
+  }
+
+  /**
+  * \brief Const iterator to one past the last element of this path.
+  *
+  * \return A const iterator to one past the last element of the path.
+  */
+  const_iterator end() const
   {
-    return path_as_vector_.cend();
+    return cend();
   }
 
   /**
@@ -250,15 +678,7 @@ public:
   */
   path parent_path() const
   {
-    path parent;
-    for (auto it = this->cbegin(); it != --this->cend(); ++it) {
-      if (!parent.empty() || it->empty()) {
-        parent /= *it;
-      } else {
-        parent = *it;
-      }
-    }
-    return parent;
+    return from_normalized(detail::parent_path_of(path_));
   }
 
   /**
@@ -270,19 +690,28 @@ public:
   */
   path filename() const
   {
-    return path_.empty() ? path() : *--this->cend();
+    return from_normalized(detail::filename_of(path_));
   }
 
   /**
-  * \brief Get a relative path to the component including and following the last '.'.
+  * \brief Get a relative path to the component of the filename including and following its
+  * last '.'.
   *
   * \return The string extension
   */
   path extension() const
   {
-    const char * delimiter = ".";
-    auto split_fname = split(this->string(), *delimiter);
-    return split_fname.size() == 1 ? path("") : path("." + split_fname.back());
+    return from_normalized(detail::extension_of(path_));
+  }
+
+  /**
+  * \brief Get the filename without its extension.
+  *
+  * \return The stem of the filename.
+  */
+  path stem() const
+  {
+    return from_normalized(detail::stem_of(path_));
   }
 
   /**
@@ -291,9 +720,24 @@ public:
   * \param other the string compnoent to concatenate
   * \return The combined path of this and other.
   */
-  path operator/(const std::string & other)
+  path operator/(const std::string & other) const &
+  {
+    path result;
+    result.path_.reserve(path_.size() + 1u + other.size());
+    result.path_ = path_;
+    result /= other;
+    return result;
+  }
+
+  /**
+  * \brief Concatenate a temporary path and a string into a single path, reusing its storage.
+  *
+  * \param other the string compnoent to concatenate
+  * \return The combined path of this and other.
+  */
+  path operator/(const std::string & other) &&
   {
-    return this->operator/(path(other));
+    return std::move(*this /= other);
   }
 
   /**
@@ -304,7 +748,14 @@ public:
   */
   path & operator/=(const std::string & other)
   {
-    this->operator/=(path(other));
+    if (&other == &path_) {
+      return *this /= std::string(other);
+    }
+    const std::size_t offset = path_.size() + 1u;
+    path_.reserve(offset + other.size());
+    path_ += kPreferredSeparator;
+    path_ += other;
+    normalize_separators(offset);
     return *this;
   }
 
@@ -314,9 +765,24 @@ public:
   * \param other the path to append
   * \return The combined path.
   */
-  path operator/(const path & other)
+  path operator/(const path & other) const &
+  {
+    path result;
+    result.path_.reserve(path_.size() + 1u + other.path_.size());
+    result.path_ = path_;
+    result /= other;
+    return result;
+  }
+
+  /**
+  * \brief Concatenate a temporary path and another path together, reusing its storage.
+  *
+  * \param other the path to append
+  * \return The combined path.
+  */
+  path operator/(const path & other) &&
   {
-    return path(*this).operator/=(other);
+    return std::move(*this /= other);
   }
 
   /**
@@ -327,17 +793,192 @@ public:
   */
   path & operator/=(const path & other)
   {
-    this->path_ += kPreferredSeparator + other.string();
-    this->path_as_vector_.insert(
-      std::end(this->path_as_vector_),
-      std::begin(other.path_as_vector_), std::end(other.path_as_vector_));
+    if (&other == this) {
+      return *this /= path(other);
+    }
+    this->path_.reserve(this->path_.size() + 1u + other.path_.size());
+    this->path_ += kPreferredSeparator;
+    this->path_ += other.path_;
     return *this;
   }
 
-private:
-  std::string path_;
-  std::vector<std::string> path_as_vector_;
-};
+  /**
+  * \brief Concatenate a string to this path, without adding a separator.
+  *
+  * \param other the string to concatenate
+  * \return *this
+  */
+  path & operator+=(const std::string & other)
+  {
+    return concat(other);
+  }
+
+  /**
+  * \brief Concatenate a path to this path, without adding a separator.
+  *
+  * \param other the path to concatenate
+  * \return *this
+  */
+  path & operator+=(const path & other)
+  {
+    if (&other == this) {
+      return *this += path(other);
+    }
+    path_ += other.path_;
+    return *this;
+  }
+
+  /**
+  * \brief Concatenate a string to this path, without adding a separator.
+  *
+  * \param other the string to concatenate
+  * \return *this
+  */
+  path & concat(const std::string & other)
+  {
+    const std::size_t offset = path_.size();
+    path_ += other;
+    normalize_separators(offset);
+    return *this;
+  }
+
+private:
+  /// Build a path from a string which only contains preferred separators.
+  static path from_normalized(std::string_view normalized)
+  {
+    path result;
+    result.path_.assign(normalized.data(), normalized.size());
+    return result;
+  }
+
+  /// Replace both separators with the preferred one, from offset to the end of the path.
+  void normalize_separators(std::size_t offset)
+  {
+    for (auto it = path_.begin() + static_cast<std::ptrdiff_t>(offset); it != path_.end(); ++it) {
+      if (*it == '\\' || *it == '/') {
+        *it = kPreferredSeparator;
+      }
+    }
+  }
+
+  std::string path_;
+};
+
+/**
+ * \brief Get the last element of a path, as a view into it.
+ *
+ * Like the other views below, it is found with a single reverse scan of the path string, without
+ * allocating, and it is only valid as long as the path is not modified or destroyed.
+ * They are free functions, since std::filesystem::path has no such members.
+ *
+ * \param[in] p The path.
+ * \return The last element, see path::filename().
+ */
+inline std::string_view filename_view(const path & p) noexcept
+{
+  return detail::filename_of(p.native());
+}
+
+/**
+ * \brief Get the parent directory of a path, as a view into it.
+ *
+ * \param[in] p The path.
+ * \return The parent directory, "" if the path only has one element.
+ */
+inline std::string_view parent_path_view(const path & p) noexcept
+{
+  return detail::parent_path_of(p.native());
+}
+
+/**
+ * \brief Get the extension of the filename of a path, as a view into it.
+ *
+ * \param[in] p The path.
+ * \return The extension including its '.', see path::extension().
+ */
+inline std::string_view extension_view(const path & p) noexcept
+{
+  return detail::extension_of(p.native());
+}
+
+/**
+ * \brief Get the filename of a path without its extension, as a view into it.
+ *
+ * \param[in] p The path.
+ * \return The stem of the filename, see path::stem().
+ */
+inline std::string_view stem_view(const path & p) noexcept
+{
+  return detail::stem_of(p.native());
+}
+
+// Views into temporary paths would dangle.
+std::string_view filename_view(const path &&) = delete;
+std::string_view parent_path_view(const path &&) = delete;
+std::string_view extension_view(const path &&) = delete;
+std::string_view stem_view(const path &&) = delete;
+
+/**
+ * \brief Get the status of a file, following symbolic links.
+ *
+ * \param p The path of the file.
+ * \return The status of the file, of type not_found if it does not exist.
+ * \throws std::system_error if the status cannot be determined for another reason.
+ */
+inline file_status status(const path & p)
+{
+  std::error_code ec;
+  const file_status s = detail::status_of(p.c_str(), true, ec);
+  if (!status_known(s)) {
+    throw std::system_error{ec, "cannot get file status"};
+  }
+  return s;
+}
+
+/**
+ * \brief Get the status of a file, following symbolic links.
+ *
+ * \param p The path of the file.
+ * \param ec Set to the reported error if the status cannot be determined, cleared otherwise.
+ * \return The status of the file, of type not_found if it does not exist or none on other errors.
+ */
+inline file_status status(const path & p, std::error_code & ec) noexcept
+{
+  return detail::status_of(p.c_str(), true, ec);
+}
+
+/**
+ * \brief Get the status of a file, without following symbolic links.
+ *
+ * Symbolic links are always followed on Windows.
+ *
+ * \param p The path of the file.
+ * \return The status of the file, of type not_found if it does not exist.
+ * \throws std::system_error if the status cannot be determined for another reason.
+ */
+inline file_status symlink_status(const path & p)
+{
+  std::error_code ec;
+  const file_status s = detail::status_of(p.c_str(), false, ec);
+  if (!status_known(s)) {
+    throw std::system_error{ec, "cannot get file status"};
+  }
+  return s;
+}
+
+/**
+ * \brief Get the status of a file, without following symbolic links.
+ *
+ * Symbolic links are always followed on Windows.
+ *
+ * \param p The path of the file.
+ * \param ec Set to the reported error if the status cannot be determined, cleared otherwise.
+ * \return The status of the file, of type not_found if it does not exist or none on other errors.
+ */
+inline file_status symlink_status(const path & p, std::error_code & ec) noexcept
+{
+  return detail::status_of(p.c_str(), false, ec);
+}
 
 /**
  * \brief Check if the path is a regular file.
@@ -350,6 +991,42 @@ inline bool is_regular_file(const path & p) noexcept
   return p.is_regular_file();
 }
 
+/**
+ * \brief Check if the path is a regular file.
+ *
+ * \param p The path to check.
+ * \param ec Set to the reported error if the status cannot be determined, cleared otherwise.
+ * \return True if the path is an existing regular file, false otherwise.
+ */
+inline bool is_regular_file(const path & p, std::error_code & ec) noexcept
+{
+  return is_regular_file(status(p, ec));
+}
+
+/**
+ * \brief Check if the path is a directory.
+ *
+ * \param p The path to check.
+ * \param ec Set to the reported error if the status cannot be determined, cleared otherwise.
+ * \return True if the path is an existing directory, false otherwise.
+ */
+inline bool is_directory(const path & p, std::error_code & ec) noexcept
+{
+  return is_directory(status(p, ec));
+}
+
+/**
+ * \brief Check if the path is a symbolic link.
+ *
+ * \param p The path to check.
+ * \return True if the path is a symbolic link, false otherwise.
+ */
+inline bool is_symlink(const path & p) noexcept
+{
+  std::error_code ec;
+  return is_symlink(symlink_status(p, ec));
+}
+
 /**
  * \brief Check if the path is a directory.
  *
@@ -374,6 +1051,26 @@ inline uint64_t file_size(const path & p)
   return p.file_size();
 }
 
+/**
+ * \brief Get the file size of the path.
+ *
+ * \param p The path to get the file size of.
+ * \param ec Set to the reported error if the size cannot be determined, cleared otherwise.
+ * \return The file size in bytes, or `static_cast<uint64_t>(-1)` on error.
+ */
+inline uint64_t file_size(const path & p, std::error_code & ec) noexcept
+{
+  const file_status s = status(p, ec);
+  if (ec) {
+    return static_cast<uint64_t>(-1);
+  }
+  if (is_directory(s)) {
+    ec = std::make_error_code(std::errc::is_a_directory);
+    return static_cast<uint64_t>(-1);
+  }
+  return s.size();
+}
+
 /**
  * \brief Check if a path exists.
  *
@@ -385,6 +1082,22 @@ inline bool exists(const path & path_to_check)
   return path_to_check.exists();
 }
 
+/**
+ * \brief Check if a path exists.
+ *
+ * \param path_to_check The path to check.
+ * \param ec Set to the reported error if existence cannot be determined, cleared otherwise.
+ * \return True if the path exists, false otherwise.
+ */
+inline bool exists(const path & path_to_check, std::error_code & ec) noexcept
+{
+  const file_status s = status(path_to_check, ec);
+  if (s.type() == file_type::not_found) {
+    ec.clear();
+  }
+  return exists(s);
+}
+
 
 /**
  * \brief Get a path to a location in the temporary directory, if it's available.
@@ -414,31 +1127,111 @@ inline path temp_directory_path()
 }
 
 /**
- * \brief Create a directory with the given path p.
+ * \brief Create a directory with the given path p, and its missing parent directories.
  *
- * This builds directories recursively and will skip directories if they are already created.
- * \return Return true if the directory is created, false otherwise.
+ * The deepest directory is created first; only when its parent is missing are the parent
+ * directories probed, from the deepest one backwards, so that creating a directory in an
+ * existing tree costs a single system call.
+ * It is not an error for the directories to exist already.
+ *
+ * \param p The path of the directory.
+ * \param ec Set to the reported error if a directory cannot be created, cleared otherwise.
+ * \return True if p is a directory when the function returns, false otherwise.
  */
-inline bool create_directories(const path & p)
+inline bool create_directories(const path & p, std::error_code & ec) noexcept
 {
-  path p_built;
-  int status = 0;
+  ec.clear();
+  if (p.empty()) {
+    ec = std::make_error_code(std::errc::no_such_file_or_directory);
+    return false;
+  }
+  // The prefixes of the path are terminated in place to probe the parent directories.
+  std::string buffer;
+  try {
+    buffer = p.native();
+  } catch (const std::bad_alloc &) {
+    ec = std::make_error_code(std::errc::not_enough_memory);
+    return false;
+  }
+  while (buffer.size() > 1u && buffer.back() == kPreferredSeparator) {
+    buffer.pop_back();
+  }
+  const std::size_t size = buffer.size();
 
-  for (auto it = p.cbegin(); it != p.cend() && status == 0; ++it) {
-    if (!p_built.empty() || it->empty()) {
-      p_built /= *it;
-    } else {
-      p_built = *it;
+  // Walk backwards until a directory can be created or its parent is not missing.
+  std::size_t end = size;
+  int error = 0;
+  while (detail::make_directory(buffer.c_str()) != 0) {
+    error = errno;
+    if (error != ENOENT) {
+      // A parent which cannot be created, e.g. for lack of permissions, is the real cause.
+      std::error_code status_ec;
+      if (end != size && error != EEXIST &&
+        !fs::is_directory(detail::status_of(buffer.c_str(), true, status_ec)))
+      {
+        ec.assign(error, std::system_category());
+        return false;
+      }
+      break;
     }
-    if (!p_built.exists()) {
-#ifdef _WIN32
-      status = _mkdir(p_built.string().c_str());
-#else
-      status = mkdir(p_built.string().c_str(), S_IRWXU | S_IRWXG | S_IRWXO);
-#endif
+    std::size_t separator = buffer.rfind(kPreferredSeparator, end - 1u);
+    while (separator != std::string::npos && separator > 0u &&
+      buffer[separator - 1u] == kPreferredSeparator)
+    {
+      --separator;
+    }
+    if (separator == std::string::npos || separator == 0u) {
+      ec.assign(error, std::system_category());
+      return false;
+    }
+    buffer[separator] = '\0';
+    end = separator;
+  }
+  if (end == size) {
+    if (error == 0) {
+      return true;
+    }
+    if (error == EEXIST) {
+      std::error_code status_ec;
+      if (fs::is_directory(detail::status_of(buffer.c_str(), true, status_ec))) {
+        return true;
+      }
+    }
+    ec.assign(error, std::system_category());
+    return false;
+  }
+
+  // Then create the missing directories forwards. Existing ones were created concurrently.
+  while (end != size) {
+    buffer[end] = kPreferredSeparator;
+    end = buffer.find('\0', end + 1u);
+    if (end == std::string::npos) {
+      end = size;
+    }
+    if (detail::make_directory(buffer.c_str()) != 0) {
+      error = errno;
+      std::error_code status_ec;
+      if (error != EEXIST ||
+        !fs::is_directory(detail::status_of(buffer.c_str(), true, status_ec)))
+      {
+        ec.assign(error, std::system_category());
+        return false;
+      }
     }
   }
-  return status == 0;
+  return true;
+}
+
+/**
+ * \brief Create a directory with the given path p.
+ *
+ * This builds directories recursively and will skip directories if they are already created.
+ * \return Return true if the directory is created, false otherwise.
+ */
+inline bool create_directories(const path & p)
+{
+  std::error_code ec;
+  return create_directories(p, ec);
 }
 
 /**
@@ -468,7 +1261,8 @@ inline bool remove(const path & p)
 /**
  * \brief Remove extension(s) from a path.
  *
- * An extension is defined as text starting from the end of a path to the first period (.) character.
+ * An extension is defined as text starting from the end of the filename of a path to its last
+ * period (.) character, see path::extension(); the path is copied once.
  *
  * \param file_path The file path string.
  * \param n_times The number of extensions to remove if there are multiple extensions.
@@ -476,16 +1270,965 @@ inline bool remove(const path & p)
  */
 inline path remove_extension(const path & file_path, int n_times = 1)
 {
-  path new_path(file_path);
+  const std::string_view filename = filename_view(file_path);
+  std::string_view stem = filename;
   for (int i = 0; i < n_times; i++) {
-    const auto new_path_str = new_path.string();
-    const auto last_dot = new_path_str.find_last_of('.');
-    if (last_dot == std::string::npos) {
-      return new_path;
+    const std::size_t extension_size = detail::extension_size(stem);
+    if (extension_size == 0u) {
+      break;
+    }
+    stem.remove_suffix(extension_size);
+  }
+  if (stem.size() == filename.size()) {
+    return file_path;
+  }
+  const std::string & native = file_path.native();
+  const auto stem_end = static_cast<std::size_t>(stem.data() - native.data()) + stem.size();
+  return path(native.substr(0u, stem_end));
+}
+
+/**
+ * \brief Drop-in replacement for [std::filesystem::directory_entry](https://en.cppreference.com/w/cpp/filesystem/directory_entry).
+ *
+ * Entries produced by a directory iterator cache the file type reported by the directory listing
+ * itself, so type queries on them do not touch the file system again unless the entry is a
+ * symbolic link or the platform did not report a type.
+ */
+class directory_entry
+{
+public:
+  directory_entry() noexcept = default;
+
+  /**
+   * \brief Construct an entry for a path and query its status.
+   *
+   * \param p The path of the entry.
+   */
+  explicit directory_entry(const fs::path & p)
+  : path_(p)
+  {
+    refresh();
+  }
+
+  /**
+   * \brief Construct an entry for a path whose (non-followed) status is already known.
+   *
+   * \param p The path of the entry.
+   * \param symlink_status The status of the entry itself, or a status of type none if unknown.
+   */
+  directory_entry(fs::path p, file_status symlink_status) noexcept
+  : path_(std::move(p)), symlink_status_(symlink_status)
+  {}
+
+  /**
+   * \brief Replace the path of the entry and query its status.
+   *
+   * \param p The new path of the entry.
+   */
+  void assign(const fs::path & p)
+  {
+    path_ = p;
+    refresh();
+  }
+
+  /**
+   * \brief Query the status of the entry again, replacing the cached file type.
+   */
+  void refresh() noexcept
+  {
+    std::error_code ec;
+    refresh(ec);
+  }
+
+  /**
+   * \brief Query the status of the entry again, replacing the cached file type.
+   *
+   * \param ec Set to the reported error if the status cannot be determined, cleared otherwise.
+   */
+  void refresh(std::error_code & ec) noexcept
+  {
+    symlink_status_ = detail::status_of(path_.c_str(), false, ec);
+  }
+
+  /**
+   * \brief Get the path of the entry.
+   *
+   * \return The path.
+   */
+  const fs::path & path() const noexcept
+  {
+    return path_;
+  }
+
+  /**
+   * \brief Convert the entry to its path.
+   */
+  operator const fs::path &() const noexcept
+  {
+    return path_;
+  }
+
+  /**
+   * \brief Get the status of the entry, following symbolic links.
+   *
+   * \return The cached status if the entry is not a symbolic link, a freshly queried one otherwise.
+   */
+  file_status status() const noexcept
+  {
+    if (status_known(symlink_status_) && !fs::is_symlink(symlink_status_)) {
+      return symlink_status_;
+    }
+    std::error_code ec;
+    return detail::status_of(path_.c_str(), true, ec);
+  }
+
+  /**
+   * \brief Get the status of the entry itself, without following symbolic links.
+   *
+   * \return The cached status if known, a freshly queried one otherwise.
+   */
+  file_status symlink_status() const noexcept
+  {
+    if (status_known(symlink_status_)) {
+      return symlink_status_;
     }
-    new_path = path(new_path_str.substr(0, last_dot));
+    std::error_code ec;
+    return detail::status_of(path_.c_str(), false, ec);
+  }
+
+  /**
+   * \brief Check if the entry exists.
+   *
+   * \return True if the entry exists, false otherwise.
+   */
+  bool exists() const noexcept
+  {
+    return fs::exists(status());
+  }
+
+  /**
+   * \brief Check if the entry is a directory, following symbolic links.
+   *
+   * \return True if the entry is a directory, false otherwise.
+   */
+  bool is_directory() const noexcept
+  {
+    return fs::is_directory(status());
+  }
+
+  /**
+   * \brief Check if the entry is a regular file, following symbolic links.
+   *
+   * \return True if the entry is a regular file, false otherwise.
+   */
+  bool is_regular_file() const noexcept
+  {
+    return fs::is_regular_file(status());
+  }
+
+  /**
+   * \brief Check if the entry is a symbolic link.
+   *
+   * \return True if the entry is a symbolic link, false otherwise.
+   */
+  bool is_symlink() const noexcept
+  {
+    return fs::is_symlink(symlink_status());
+  }
+
+  /**
+   * \brief Return the size of the file in bytes.
+   *
+   * \return size of file in bytes
+   * \throws std::system_error
+   */
+  uint64_t file_size() const
+  {
+    return path_.file_size();
   }
-  return new_path;
+
+private:
+  fs::path path_;
+  file_status symlink_status_;
+};
+
+namespace detail
+{
+
+/**
+ * \brief An open directory handle producing one directory_entry at a time.
+ *
+ * The "." and ".." entries are skipped.
+ */
+class directory_stream
+{
+public:
+  /**
+   * \brief Open a directory and read its first entry.
+   *
+   * \param dir The directory to list.
+   * \param ec Set to the reported error if the directory cannot be opened or read.
+   */
+  directory_stream(const path & dir, std::error_code & ec)
+  : dir_(dir)
+  {
+    ec.clear();
+#ifdef _WIN32
+    const std::string pattern = dir_.string() + kPreferredSeparator + "*";
+    handle_ = FindFirstFileExA(
+      pattern.c_str(), FindExInfoBasic, &find_data_, FindExSearchNameMatch, NULL,
+      FIND_FIRST_EX_LARGE_FETCH);
+    if (handle_ == INVALID_HANDLE_VALUE) {
+      const DWORD error = GetLastError();
+      if (error != ERROR_FILE_NOT_FOUND) {
+        ec.assign(static_cast<int>(error), std::system_category());
+      }
+      return;
+    }
+    has_pending_ = true;
+#else
+    handle_ = opendir(dir_.c_str());
+    if (handle_ == nullptr) {
+      ec.assign(errno, std::system_category());
+      return;
+    }
+#endif
+    advance(ec);
+  }
+
+  ~directory_stream()
+  {
+    close();
+  }
+
+  directory_stream(const directory_stream &) = delete;
+  directory_stream & operator=(const directory_stream &) = delete;
+
+  /**
+   * \brief Check if the stream still has an entry.
+   *
+   * \return True if entry() is valid, false once the listing is exhausted or failed.
+   */
+  bool valid() const noexcept
+  {
+    return valid_;
+  }
+
+  /**
+   * \brief Get the current entry.
+   *
+   * \return The current entry.
+   */
+  const directory_entry & entry() const noexcept
+  {
+    return entry_;
+  }
+
+  /**
+   * \brief Move to the next entry.
+   *
+   * \param ec Set to the reported error if the directory cannot be read, cleared otherwise.
+   * \return True if a new entry is available, false otherwise.
+   */
+  bool advance(std::error_code & ec)
+  {
+    ec.clear();
+    valid_ = false;
+#ifdef _WIN32
+    while (handle_ != INVALID_HANDLE_VALUE) {
+      if (!has_pending_ && !FindNextFileA(handle_, &find_data_)) {
+        const DWORD error = GetLastError();
+        if (error != ERROR_NO_MORE_FILES) {
+          ec.assign(static_cast<int>(error), std::system_category());
+        }
+        close();
+        break;
+      }
+      has_pending_ = false;
+      const char * name = find_data_.cFileName;
+      if (is_dot_or_dot_dot(name)) {
+        continue;
+      }
+      entry_ = directory_entry(dir_ / name, status_from_find_data());
+      valid_ = true;
+      break;
+    }
+#else
+    while (handle_ != nullptr) {
+      errno = 0;
+      const struct dirent * ent = readdir(handle_);
+      if (ent == nullptr) {
+        if (errno != 0) {
+          ec.assign(errno, std::system_category());
+        }
+        close();
+        break;
+      }
+      if (is_dot_or_dot_dot(ent->d_name)) {
+        continue;
+      }
+      entry_ = directory_entry(dir_ / ent->d_name, status_from_dirent(*ent));
+      valid_ = true;
+      break;
+    }
+#endif
+    return valid_;
+  }
+
+private:
+  static bool is_dot_or_dot_dot(const char * name) noexcept
+  {
+    return name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'));
+  }
+
+#ifdef _WIN32
+  file_status status_from_find_data() const noexcept
+  {
+    const DWORD attributes = find_data_.dwFileAttributes;
+    if ((attributes & FILE_ATTRIBUTE_REPARSE_POINT) != 0 &&
+      find_data_.dwReserved0 == IO_REPARSE_TAG_SYMLINK)
+    {
+      return file_status(file_type::symlink);
+    }
+    if ((attributes & FILE_ATTRIBUTE_DIRECTORY) != 0) {
+      return file_status(file_type::directory);
+    }
+    const uint64_t size =
+      (static_cast<uint64_t>(find_data_.nFileSizeHigh) << 32) | find_data_.nFileSizeLow;
+    return file_status(file_type::regular, size);
+  }
+
+  void close() noexcept
+  {
+    if (handle_ != INVALID_HANDLE_VALUE) {
+      FindClose(handle_);
+      handle_ = INVALID_HANDLE_VALUE;
+    }
+  }
+
+  HANDLE handle_ = INVALID_HANDLE_VALUE;
+  WIN32_FIND_DATAA find_data_;
+  bool has_pending_ = false;
+#else
+  static file_status status_from_dirent(const struct dirent & ent) noexcept
+  {
+#ifdef DT_UNKNOWN
+    switch (ent.d_type) {
+      case DT_REG: return file_status(file_type::regular);
+      case DT_DIR: return file_status(file_type::directory);
+      case DT_LNK: return file_status(file_type::symlink);
+      case DT_BLK: return file_status(file_type::block);
+      case DT_CHR: return file_status(file_type::character);
+      case DT_FIFO: return file_status(file_type::fifo);
+      case DT_SOCK: return file_status(file_type::socket);
+      default: break;
+    }
+#else
+    (void) ent;
+#endif
+    // The file system did not report a type; it is queried lazily by the entry.
+    return file_status(file_type::none);
+  }
+
+  void close() noexcept
+  {
+    if (handle_ != nullptr) {
+      closedir(handle_);
+      handle_ = nullptr;
+    }
+  }
+
+  DIR * handle_ = nullptr;
+#endif
+  path dir_;
+  directory_entry entry_;
+  bool valid_ = false;
+};
+
+}  // namespace detail
+
+/**
+ * \brief Drop-in replacement for [std::filesystem::directory_iterator](https://en.cppreference.com/w/cpp/filesystem/directory_iterator).
+ *
+ * Entries are read from the operating system one at a time (readdir on POSIX,
+ * FindFirstFileEx/FindNextFile on Windows) and carry the file type reported by the listing.
+ * The order of the entries is unspecified. Copies of an iterator share the same position.
+ */
+class directory_iterator
+{
+public:
+  using iterator_category = std::input_iterator_tag;
+  using value_type = directory_entry;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const directory_entry *;
+  using reference = const directory_entry &;
+
+  /**
+   * \brief Construct the end iterator.
+   */
+  directory_iterator() noexcept = default;
+
+  /**
+   * \brief Start listing a directory.
+   *
+   * \param p The directory to list.
+   * \throws std::system_error if the directory cannot be opened.
+   */
+  explicit directory_iterator(const path & p)
+  {
+    std::error_code ec;
+    open(p, ec);
+    if (ec) {
+      throw std::system_error{ec, "cannot open directory: " + p.string()};
+    }
+  }
+
+  /**
+   * \brief Start listing a directory.
+   *
+   * \param p The directory to list.
+   * \param ec Set to the reported error if the directory cannot be opened, cleared otherwise.
+   *   The iterator is the end iterator on error.
+   */
+  directory_iterator(const path & p, std::error_code & ec)
+  {
+    open(p, ec);
+  }
+
+  reference operator*() const noexcept
+  {
+    return stream_->entry();
+  }
+
+  pointer operator->() const noexcept
+  {
+    return &stream_->entry();
+  }
+
+  /**
+   * \brief Move to the next entry.
+   *
+   * \throws std::system_error if the directory cannot be read.
+   */
+  directory_iterator & operator++()
+  {
+    std::error_code ec;
+    increment(ec);
+    if (ec) {
+      throw std::system_error{ec, "cannot read directory"};
+    }
+    return *this;
+  }
+
+  /**
+   * \brief Move to the next entry.
+   *
+   * \param ec Set to the reported error if the directory cannot be read, cleared otherwise.
+   *   The iterator becomes the end iterator on error.
+   * \return This iterator.
+   */
+  directory_iterator & increment(std::error_code & ec)
+  {
+    if (!stream_->advance(ec)) {
+      stream_.reset();
+    }
+    return *this;
+  }
+
+  bool operator==(const directory_iterator & other) const noexcept
+  {
+    return stream_ == other.stream_;
+  }
+
+  bool operator!=(const directory_iterator & other) const noexcept
+  {
+    return !(*this == other);
+  }
+
+private:
+  void open(const path & p, std::error_code & ec)
+  {
+    auto stream = std::make_shared<detail::directory_stream>(p, ec);
+    if (!ec && stream->valid()) {
+      stream_ = std::move(stream);
+    }
+  }
+
+  std::shared_ptr<detail::directory_stream> stream_;
+};
+
+/**
+ * \brief Support range-based for loops over a directory_iterator.
+ *
+ * \param it The iterator.
+ * \return The iterator itself.
+ */
+inline directory_iterator begin(directory_iterator it) noexcept
+{
+  return it;
+}
+
+/**
+ * \brief Support range-based for loops over a directory_iterator.
+ *
+ * \return The end iterator.
+ */
+inline directory_iterator end(const directory_iterator &) noexcept
+{
+  return directory_iterator();
+}
+
+/**
+ * \brief Drop-in replacement for [std::filesystem::recursive_directory_iterator](https://en.cppreference.com/w/cpp/filesystem/recursive_directory_iterator).
+ *
+ * Directories are visited before their contents. Symbolic links to directories are not followed.
+ * A subdirectory that cannot be opened is reported by the increment that tries to descend into
+ * it; the walk can then go on with its siblings. Copies of an iterator share the same position.
+ */
+class recursive_directory_iterator
+{
+public:
+  using iterator_category = std::input_iterator_tag;
+  using value_type = directory_entry;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const directory_entry *;
+  using reference = const directory_entry &;
+
+  /**
+   * \brief Construct the end iterator.
+   */
+  recursive_directory_iterator() noexcept = default;
+
+  /**
+   * \brief Start listing a directory tree.
+   *
+   * \param p The root of the tree to list.
+   * \throws std::system_error if the directory cannot be opened.
+   */
+  explicit recursive_directory_iterator(const path & p)
+  {
+    open(directory_iterator(p));
+  }
+
+  /**
+   * \brief Start listing a directory tree.
+   *
+   * \param p The root of the tree to list.
+   * \param ec Set to the reported error if the directory cannot be opened, cleared otherwise.
+   *   The iterator is the end iterator on error.
+   */
+  recursive_directory_iterator(const path & p, std::error_code & ec)
+  {
+    open(directory_iterator(p, ec));
+  }
+
+  reference operator*() const noexcept
+  {
+    return *state_->stack.back();
+  }
+
+  pointer operator->() const noexcept
+  {
+    return &*state_->stack.back();
+  }
+
+  /**
+   * \brief Get the depth of the current entry below the root directory.
+   *
+   * \return 0 for entries of the root directory, 1 for their children, and so on.
+   */
+  int depth() const noexcept
+  {
+    return static_cast<int>(state_->stack.size()) - 1;
+  }
+
+  /**
+   * \brief Check if the next increment will descend into the current entry if it is a directory.
+   *
+   * \return True unless disable_recursion_pending() was called for the current entry.
+   */
+  bool recursion_pending() const noexcept
+  {
+    return state_->recursion_pending;
+  }
+
+  /**
+   * \brief Do not descend into the current entry on the next increment.
+   */
+  void disable_recursion_pending() noexcept
+  {
+    state_->recursion_pending = false;
+  }
+
+  /**
+   * \brief Move to the next entry.
+   *
+   * \throws std::system_error if a directory cannot be opened or read.
+   *   See increment(std::error_code &) for the position the iterator is left at.
+   */
+  recursive_directory_iterator & operator++()
+  {
+    std::error_code ec;
+    increment(ec);
+    if (ec) {
+      throw std::system_error{ec, "cannot read directory"};
+    }
+    return *this;
+  }
+
+  /**
+   * \brief Move to the next entry.
+   *
+   * \param ec Set to the reported error if a directory cannot be opened or read, cleared otherwise.
+   *   If the current entry is a directory that cannot be opened, the iterator stays on it with
+   *   recursion disabled, so that the next increment moves on to its siblings.
+   *   The iterator becomes the end iterator on any other error.
+   * \return This iterator.
+   */
+  recursive_directory_iterator & increment(std::error_code & ec)
+  {
+    ec.clear();
+    auto & stack = state_->stack;
+    const directory_entry & current = *stack.back();
+    if (state_->recursion_pending &&
+      current.symlink_status().type() == file_type::directory)
+    {
+      directory_iterator child(current.path(), ec);
+      if (ec) {
+        state_->recursion_pending = false;
+        return *this;
+      }
+      if (child != directory_iterator()) {
+        stack.push_back(std::move(child));
+        return *this;
+      }
+    }
+    state_->recursion_pending = true;
+    stack.back().increment(ec);
+    unwind(ec);
+    return *this;
+  }
+
+  /**
+   * \brief Stop listing the current directory and move to the next entry of its parent.
+   *
+   * \throws std::system_error if the parent directory cannot be read.
+   */
+  void pop()
+  {
+    std::error_code ec;
+    pop(ec);
+    if (ec) {
+      throw std::system_error{ec, "cannot read directory"};
+    }
+  }
+
+  /**
+   * \brief Stop listing the current directory and move to the next entry of its parent.
+   *
+   * \param ec Set to the reported error if the parent directory cannot be read, cleared otherwise.
+   */
+  void pop(std::error_code & ec)
+  {
+    ec.clear();
+    state_->recursion_pending = true;
+    state_->stack.pop_back();
+    if (!state_->stack.empty()) {
+      state_->stack.back().increment(ec);
+    }
+    unwind(ec);
+  }
+
+  bool operator==(const recursive_directory_iterator & other) const noexcept
+  {
+    return state_ == other.state_;
+  }
+
+  bool operator!=(const recursive_directory_iterator & other) const noexcept
+  {
+    return !(*this == other);
+  }
+
+private:
+  struct state
+  {
+    // Trees deeper than this are rare; shallower ones need no allocation beyond the state.
+    small_vector<directory_iterator, 8> stack;
+    bool recursion_pending = true;
+  };
+
+  void open(directory_iterator root)
+  {
+    if (root != directory_iterator()) {
+      state_ = std::make_shared<state>();
+      state_->stack.push_back(std::move(root));
+    }
+  }
+
+  // Drop exhausted directories until an entry is found or the tree is done.
+  void unwind(std::error_code & ec)
+  {
+    auto & stack = state_->stack;
+    while (!ec && !stack.empty() && stack.back() == directory_iterator()) {
+      stack.pop_back();
+      if (!stack.empty()) {
+        stack.back().increment(ec);
+      }
+    }
+    if (ec || stack.empty()) {
+      state_.reset();
+    }
+  }
+
+  std::shared_ptr<state> state_;
+};
+
+/**
+ * \brief Support range-based for loops over a recursive_directory_iterator.
+ *
+ * \param it The iterator.
+ * \return The iterator itself.
+ */
+inline recursive_directory_iterator begin(recursive_directory_iterator it) noexcept
+{
+  return it;
+}
+
+/**
+ * \brief Support range-based for loops over a recursive_directory_iterator.
+ *
+ * \return The end iterator.
+ */
+inline recursive_directory_iterator end(const recursive_directory_iterator &) noexcept
+{
+  return recursive_directory_iterator();
+}
+
+namespace detail
+{
+
+#ifndef _WIN32
+/**
+ * \brief Remove the entries of an open directory, recursively, without following symbolic links.
+ *
+ * Entries are opened and removed relative to their directory's descriptor, so that the
+ * traversal cannot be redirected by a concurrent rename or symbolic link.
+ *
+ * \param dir_fd The descriptor of the directory, which is closed.
+ * \param ec Set to the first reported error, cleared otherwise.
+ * \return The number of entries removed.
+ */
+inline std::uintmax_t remove_directory_contents(int dir_fd, std::error_code & ec) noexcept
+{
+  ec.clear();
+  DIR * dir = fdopendir(dir_fd);
+  if (dir == nullptr) {
+    ec.assign(errno, std::system_category());
+    ::close(dir_fd);
+    return 0u;
+  }
+  std::uintmax_t count = 0u;
+  while (true) {
+    errno = 0;
+    const struct dirent * ent = readdir(dir);
+    if (ent == nullptr) {
+      if (errno != 0) {
+        ec.assign(errno, std::system_category());
+      }
+      break;
+    }
+    const char * name = ent->d_name;
+    if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+      continue;
+    }
+    bool is_dir = false;
+#ifdef DT_UNKNOWN
+    if (ent->d_type != DT_UNKNOWN) {
+      is_dir = ent->d_type == DT_DIR;
+    } else
+#endif
+    {
+      struct stat stat_buffer;
+      is_dir = fstatat(dir_fd, name, &stat_buffer, AT_SYMLINK_NOFOLLOW) == 0 &&
+        S_ISDIR(stat_buffer.st_mode);
+    }
+    if (is_dir) {
+      const int child_fd = openat(dir_fd, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+      if (child_fd == -1) {
+        ec.assign(errno, std::system_category());
+        break;
+      }
+      count += remove_directory_contents(child_fd, ec);
+      if (ec) {
+        break;
+      }
+    }
+    if (unlinkat(dir_fd, name, is_dir ? AT_REMOVEDIR : 0) != 0) {
+      ec.assign(errno, std::system_category());
+      break;
+    }
+    ++count;
+  }
+  closedir(dir);
+  return count;
+}
+#endif
+
+}  // namespace detail
+
+/**
+ * \brief Remove a file or a directory and all its contents, recursively.
+ *
+ * Symbolic links are removed, not followed.
+ * On POSIX systems, the tree is traversed with descriptors relative to each directory
+ * (`openat`, `fdopendir`, `unlinkat`), so that no path is resolved twice.
+ *
+ * \param p The path to remove.
+ * \param ec Set to the reported error, cleared otherwise.
+ * \return The number of files and directories removed, 0 if p did not exist, or
+ *   `static_cast<std::uintmax_t>(-1)` on error.
+ */
+inline std::uintmax_t remove_all(const path & p, std::error_code & ec) noexcept
+{
+  constexpr auto kError = static_cast<std::uintmax_t>(-1);
+  const file_status s = detail::status_of(p.c_str(), false, ec);
+  if (s.type() == file_type::not_found) {
+    ec.clear();
+    return 0u;
+  }
+  if (ec) {
+    return kError;
+  }
+  std::uintmax_t count = 0u;
+#ifdef _WIN32
+  if (s.type() == file_type::directory) {
+    const directory_iterator end;
+    for (directory_iterator it(p, ec); !ec && it != end; it.increment(ec)) {
+      const std::uintmax_t removed = remove_all(it->path(), ec);
+      if (ec) {
+        return kError;
+      }
+      count += removed;
+    }
+    if (ec || _rmdir(p.c_str()) != 0) {
+      if (!ec) {
+        ec.assign(errno, std::system_category());
+      }
+      return kError;
+    }
+  } else if (::remove(p.c_str()) != 0) {
+    ec.assign(errno, std::system_category());
+    return kError;
+  }
+#else
+  if (s.type() == file_type::directory) {
+    const int dir_fd = ::open(p.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    if (dir_fd == -1) {
+      ec.assign(errno, std::system_category());
+      return kError;
+    }
+    count = detail::remove_directory_contents(dir_fd, ec);
+    if (ec) {
+      return kError;
+    }
+    if (::rmdir(p.c_str()) != 0) {
+      ec.assign(errno, std::system_category());
+      return kError;
+    }
+  } else if (::unlink(p.c_str()) != 0) {
+    ec.assign(errno, std::system_category());
+    return kError;
+  }
+#endif
+  return count + 1u;
+}
+
+/**
+ * \brief Remove a file or a directory and all its contents, recursively.
+ *
+ * \param p The path to remove.
+ * \return The number of files and directories removed, 0 if p did not exist.
+ * \throws std::system_error if an entry cannot be removed.
+ */
+inline std::uintmax_t remove_all(const path & p)
+{
+  std::error_code ec;
+  const std::uintmax_t count = remove_all(p, ec);
+  if (ec) {
+    throw std::system_error{ec, "cannot remove all: " + p.string()};
+  }
+  return count;
+}
+
+/**
+ * \brief Create many directories under a common parent directory.
+ *
+ * The parent directory is created if needed, with create_directories(), and opened once; the
+ * directories are then created relative to it with `mkdirat` on POSIX systems.
+ * Each name may contain separators when the directories it is in come earlier in names.
+ * It is not an error for the directories to exist already.
+ *
+ * \param parent The parent directory.
+ * \param names The paths of the directories to create, relative to parent, in order.
+ * \param ec Set to the first reported error, cleared otherwise.
+ * \return True if all the directories exist when the function returns, false otherwise.
+ */
+inline bool create_directories(
+  const path & parent, const std::vector<std::string> & names, std::error_code & ec) noexcept
+{
+  if (!create_directories(parent, ec)) {
+    return false;
+  }
+#ifdef _WIN32
+  try {
+    for (const std::string & name : names) {
+      if (!create_directories(parent / name, ec)) {
+        return false;
+      }
+    }
+  } catch (const std::bad_alloc &) {
+    ec = std::make_error_code(std::errc::not_enough_memory);
+    return false;
+  }
+  return true;
+#else
+  const int parent_fd = ::open(parent.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (parent_fd == -1) {
+    ec.assign(errno, std::system_category());
+    return false;
+  }
+  for (const std::string & name : names) {
+    if (mkdirat(parent_fd, name.c_str(), S_IRWXU | S_IRWXG | S_IRWXO) == 0) {
+      continue;
+    }
+    const int error = errno;
+    struct stat stat_buffer;
+    if (error != EEXIST || fstatat(parent_fd, name.c_str(), &stat_buffer, 0) != 0 ||
+      !S_ISDIR(stat_buffer.st_mode))
+    {
+      ec.assign(error, std::system_category());
+      ::close(parent_fd);
+      return false;
+    }
+  }
+  ::close(parent_fd);
+  return true;
+#endif
+}
+
+/**
+ * \brief Create many directories under a common parent directory.
+ *
+ * See create_directories(const path &, const std::vector<std::string> &, std::error_code &).
+ *
+ * \param parent The parent directory.
+ * \param names The paths of the directories to create, relative to parent, in order.
+ * \return True if all the directories exist when the function returns, false otherwise.
+ */
+inline bool create_directories(const path & parent, const std::vector<std::string> & names)
+{
+  std::error_code ec;
+  return create_directories(parent, names, ec);
 }
 
 #undef RCPPUTILS_IMPL_OS_DIRSEP
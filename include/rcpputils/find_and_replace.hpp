@@ -19,14 +19,180 @@
 #ifndef RCPPUTILS__FIND_AND_REPLACE_HPP_
 #define RCPPUTILS__FIND_AND_REPLACE_HPP_
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "rcpputils/detail/scan.hpp"
 
 namespace rcpputils
 {
 
+namespace detail
+{
+
+/// Deduce the character, traits and result string types of a string-like type.
+template<class T, class = void>
+struct string_like_traits
+{};
+
+template<class CharT, class Traits, class Allocator>
+struct string_like_traits<std::basic_string<CharT, Traits, Allocator>>
+{
+  using char_type = CharT;
+  using traits_type = Traits;
+  using string_type = std::basic_string<CharT, Traits, Allocator>;
+};
+
+template<class CharT, class Traits>
+struct string_like_traits<std::basic_string_view<CharT, Traits>>
+{
+  using char_type = CharT;
+  using traits_type = Traits;
+  using string_type = std::basic_string<CharT, Traits>;
+};
+
+template<class CharT, std::size_t Length>
+struct string_like_traits<CharT[Length]>
+{
+  using char_type = CharT;
+  using traits_type = std::char_traits<CharT>;
+  using string_type = std::basic_string<CharT>;
+};
+
+template<class CharT>
+struct string_like_traits<CharT *>
+{
+  using char_type = std::remove_const_t<CharT>;
+  using traits_type = std::char_traits<char_type>;
+  using string_type = std::basic_string<char_type>;
+};
+
+template<class T>
+using string_like_traits_t = string_like_traits<std::remove_cv_t<std::remove_reference_t<T>>>;
+
+template<class T>
+using string_view_for_t = std::basic_string_view<
+  typename string_like_traits_t<T>::char_type,
+  typename string_like_traits_t<T>::traits_type>;
+
+/// Find the next occurrence of needle in haystack, using the vectorized kernel for char strings.
+template<class CharT, class Traits>
+std::size_t
+find_next(
+  std::basic_string_view<CharT, Traits> haystack,
+  std::basic_string_view<CharT, Traits> needle,
+  std::size_t pos)
+{
+  if constexpr (std::is_same<Traits, std::char_traits<char>>::value) {
+    return scan_find(haystack, needle, pos);
+  } else {
+    return haystack.find(needle, pos);
+  }
+}
+
+/// Visit the unmatched segments and the non-overlapping matches of find in input, in order.
+/**
+ * \param[in] on_segment invoked with each (possibly empty) run of unmatched input.
+ * \param[in] on_match invoked once per match, between the segments it separates.
+ */
+template<class CharT, class Traits, class SegmentF, class MatchF>
+void
+for_each_match(
+  std::basic_string_view<CharT, Traits> input,
+  std::basic_string_view<CharT, Traits> find,
+  SegmentF && on_segment,
+  MatchF && on_match)
+{
+  std::size_t start = 0u;
+  std::size_t pos = find_next(input, find, 0u);
+  while (pos != std::basic_string_view<CharT, Traits>::npos) {
+    on_segment(input.substr(start, pos - start));
+    on_match();
+    start = pos + find.size();
+    pos = find_next(input, find, start);
+  }
+  on_segment(input.substr(start));
+}
+
+/// Count the non-overlapping occurrences of find in input.
+template<class CharT, class Traits>
+std::size_t
+count_matches(
+  std::basic_string_view<CharT, Traits> input,
+  std::basic_string_view<CharT, Traits> find)
+{
+  std::size_t count = 0u;
+  for (std::size_t pos = find_next(input, find, 0u);
+    pos != std::basic_string_view<CharT, Traits>::npos;
+    pos = find_next(input, find, pos + find.size()))
+  {
+    ++count;
+  }
+  return count;
+}
+
+/// Build a copy of input with every occurrence of find replaced, allocating exactly once.
+template<class StringT, class CharT, class Traits>
+StringT
+find_and_replace_copy(
+  std::basic_string_view<CharT, Traits> input,
+  std::basic_string_view<CharT, Traits> find,
+  std::basic_string_view<CharT, Traits> replace,
+  const typename StringT::allocator_type & allocator)
+{
+  const std::size_t count = (find.empty() || find == replace) ? 0u : count_matches(input, find);
+  if (0u == count) {
+    return StringT(input, allocator);
+  }
+  StringT output(allocator);
+  output.reserve(input.size() - count * find.size() + count * replace.size());
+  for_each_match(
+    input, find,
+    [&output](std::basic_string_view<CharT, Traits> segment) {output.append(segment);},
+    [&output, replace]() {output.append(replace);});
+  return output;
+}
+
+/// Use the allocator of input if it is of the result string type, a default one otherwise.
+template<class StringT, class InputT>
+typename StringT::allocator_type
+allocator_of(const InputT & input)
+{
+  if constexpr (std::is_same<InputT, StringT>::value) {
+    return input.get_allocator();
+  } else {
+    (void) input;
+    return typename StringT::allocator_type();
+  }
+}
+
+/// Check whether view points into the storage of str.
+template<class CharT, class Traits, class Allocator>
+bool
+aliases(
+  const std::basic_string<CharT, Traits, Allocator> & str,
+  std::basic_string_view<CharT, Traits> view)
+{
+  const std::less<const CharT *> less;
+  return !less(view.data(), str.data()) && less(view.data(), str.data() + str.size());
+}
+
+}  // namespace detail
+
 /// Find and replace all instances of a string with another string.
 /**
+ * The matches are counted first, so the result is allocated exactly once and written in a single
+ * pass.
+ *
  * \param[in] input The input string.
  * \param[in] find The substring to replace.
  * \param[in] replace The string to substitute for each occurrence of `find`.
@@ -44,47 +210,21 @@ find_and_replace(
   const std::basic_string<CharT, Traits, Allocator> & find,
   const std::basic_string<CharT, Traits, Allocator> & replace)
 {
-  std::basic_string<CharT, Traits, Allocator> output = input;
-  const std::size_t find_len = find.length();
-  const std::size_t replace_len = replace.length();
-  if (find == replace) {
-    return output;
-  }
-  if (0u == find_len) {
-    return output;
-  }
-  std::size_t pos = output.find(find);
-  while (pos != std::basic_string<CharT, Traits, Allocator>::npos) {
-    output.replace(pos, find_len, replace);
-    pos = output.find(find, pos + replace_len);
-  }
-  return output;
-}
-
-namespace detail
-{
-template<typename CharT, std::size_t Length>
-std::basic_string<CharT>
-normalize_to_basic_string(const CharT (& char_string)[Length])
-{
-  return std::basic_string<CharT>(char_string);
+  using view = std::basic_string_view<CharT, Traits>;
+  return detail::find_and_replace_copy<std::basic_string<CharT, Traits, Allocator>>(
+    view(input), view(find), view(replace), input.get_allocator());
 }
 
-template<typename StringLikeT>
-StringLikeT &&
-normalize_to_basic_string(StringLikeT && string_like)
-{
-  return string_like;
-}
-}  // namespace detail
-
 /// Find and replace all instances of a string with another string.
 /**
+ * Each argument may be a `std::basic_string`, a `std::basic_string_view`, a null terminated
+ * character array or a pointer to one.
+ *
  * \param[in] input The input string.
  * \param[in] find The substring to replace.
  * \param[in] replace The string to substitute for each occurrence of `find`.
  * \return A copy of the input string with all instances of the string `find` replaced with the
- *   string `replace`.
+ *   string `replace`, of the same string type as `input` if it is a `std::basic_string`.
  */
 template<typename InputT, typename FindT, typename ReplaceT>
 auto
@@ -93,11 +233,380 @@ find_and_replace(
   FindT && find,
   ReplaceT && replace)
 {
-  auto input_str = detail::normalize_to_basic_string(input);
-  return find_and_replace<typename decltype(input_str)::value_type>(
-    input_str,
-    detail::normalize_to_basic_string(find),
-    detail::normalize_to_basic_string(replace));
+  using string_type = typename detail::string_like_traits_t<InputT>::string_type;
+  using view = detail::string_view_for_t<InputT>;
+  return detail::find_and_replace_copy<string_type>(
+    view(input), view(find), view(replace),
+    detail::allocator_of<string_type>(input));
+}
+
+/// Compute the size of the result of find_and_replace without building it.
+/**
+ * \param[in] input The input string.
+ * \param[in] find The substring to replace.
+ * \param[in] replace The string to substitute for each occurrence of `find`.
+ * \return The number of characters find_and_replace would produce for these arguments.
+ */
+template<typename InputT, typename FindT, typename ReplaceT>
+std::size_t
+find_and_replace_size(
+  const InputT & input,
+  const FindT & find,
+  const ReplaceT & replace)
+{
+  using view = detail::string_view_for_t<InputT>;
+  const view input_view(input);
+  const view find_view(find);
+  const view replace_view(replace);
+  if (find_view.empty() || find_view == replace_view) {
+    return input_view.size();
+  }
+  const std::size_t count = detail::count_matches(input_view, find_view);
+  return input_view.size() - count * find_view.size() + count * replace_view.size();
+}
+
+/// Find and replace all instances of a string with another string, writing to an output iterator.
+/**
+ * Use find_and_replace_size() to size a caller-supplied buffer beforehand.
+ *
+ * \param[in] input The input string.
+ * \param[in] find The substring to replace.
+ * \param[in] replace The string to substitute for each occurrence of `find`.
+ * \param[in] out The beginning of the destination range, it may be a pointer into a buffer.
+ * \return The output iterator past the last character written.
+ */
+template<typename InputT, typename FindT, typename ReplaceT, typename OutputIt>
+OutputIt
+find_and_replace(
+  const InputT & input,
+  const FindT & find,
+  const ReplaceT & replace,
+  OutputIt out)
+{
+  using view = detail::string_view_for_t<InputT>;
+  const view input_view(input);
+  const view find_view(find);
+  const view replace_view(replace);
+  if (find_view.empty() || find_view == replace_view) {
+    return std::copy(input_view.begin(), input_view.end(), out);
+  }
+  detail::for_each_match(
+    input_view, find_view,
+    [&out](view segment) {out = std::copy(segment.begin(), segment.end(), out);},
+    [&out, replace_view]() {out = std::copy(replace_view.begin(), replace_view.end(), out);});
+  return out;
+}
+
+/// Find and replace all instances of a string with another string, modifying the string in place.
+/**
+ * The string is reallocated at most once, when the replacement is longer than `find`, and every
+ * character is moved at most twice.
+ *
+ * \param[inout] str The string to modify.
+ * \param[in] find The substring to replace.
+ * \param[in] replace The string to substitute for each occurrence of `find`.
+ * \return The number of replaced occurrences.
+ */
+template<class CharT, class Traits, class Allocator, typename FindT, typename ReplaceT>
+std::size_t
+find_and_replace_in_place(
+  std::basic_string<CharT, Traits, Allocator> & str,
+  const FindT & find,
+  const ReplaceT & replace)
+{
+  using view = std::basic_string_view<CharT, Traits>;
+  view find_view(find);
+  view replace_view(replace);
+  if (find_view.empty() || find_view == replace_view) {
+    return 0u;
+  }
+  // The arguments must not be overwritten while the string is rewritten.
+  if (detail::aliases(str, find_view) || detail::aliases(str, replace_view)) {
+    const std::basic_string<CharT, Traits, Allocator> find_copy(find_view, str.get_allocator());
+    const std::basic_string<CharT, Traits, Allocator> replace_copy(
+      replace_view, str.get_allocator());
+    return find_and_replace_in_place(str, find_copy, replace_copy);
+  }
+
+  const std::size_t old_size = str.size();
+  std::size_t count = 0u;
+  std::size_t read = 0u;
+  if (replace_view.size() > find_view.size()) {
+    count = detail::count_matches(view(str), find_view);
+    if (0u == count) {
+      return 0u;
+    }
+    // Move the input to the back of the grown string and rewrite it front to back, the write
+    // position never overtakes the unread input.
+    const std::size_t new_size = old_size + count * (replace_view.size() - find_view.size());
+    str.resize(new_size);
+    Traits::move(&str[new_size - old_size], str.data(), old_size);
+    read = new_size - old_size;
+  }
+
+  CharT * const data = &str[0];
+  const view unread(data, str.size());
+  std::size_t write = 0u;
+  count = 0u;
+  for (std::size_t pos = detail::find_next(unread, find_view, read);
+    pos != view::npos;
+    pos = detail::find_next(unread, find_view, read))
+  {
+    Traits::move(data + write, data + read, pos - read);
+    write += pos - read;
+    Traits::copy(data + write, replace_view.data(), replace_view.size());
+    write += replace_view.size();
+    read = pos + find_view.size();
+    ++count;
+  }
+  Traits::move(data + write, data + read, str.size() - read);
+  write += str.size() - read;
+  str.resize(write);
+  return count;
+}
+
+/// Find and replace many strings in a single scan of the input.
+/**
+ * The `find` strings are stored in a trie.
+ * At every position of the input the longest matching `find` string is replaced and the scan
+ * resumes after it, so replacements never overlap and are not scanned again.
+ *
+ * ```
+ * const rcpputils::FindAndReplaceSet<char> mangling{{"/", "__"}, {"::", "_"}};
+ * auto mangled = mangling.apply("/ns/my_pkg::msg");
+ * ```
+ *
+ * \tparam CharT is the string character type.
+ * \tparam Traits is the string character traits type.
+ */
+template<class CharT, class Traits = std::char_traits<CharT>>
+class FindAndReplaceSet
+{
+public:
+  using view_type = std::basic_string_view<CharT, Traits>;
+  using string_type = std::basic_string<CharT, Traits>;
+
+  /// Construct an empty set, which leaves its input unchanged.
+  FindAndReplaceSet() = default;
+
+  /// Construct a set from (find, replace) pairs.
+  /**
+   * \param[in] pairs the strings to find and their replacements, see add().
+   */
+  FindAndReplaceSet(std::initializer_list<std::pair<view_type, view_type>> pairs)
+  {
+    for (const auto & pair : pairs) {
+      add(pair.first, pair.second);
+    }
+  }
+
+  /// Add a string to find and its replacement.
+  /**
+   * Empty `find` strings are ignored, and only the first replacement added for a given `find`
+   * string is used.
+   *
+   * \param[in] find the string to find.
+   * \param[in] replace the string to substitute for each occurrence of `find`.
+   */
+  void add(view_type find, view_type replace)
+  {
+    if (find.empty()) {
+      return;
+    }
+    std::uint32_t node = 0u;
+    for (const CharT c : find) {
+      node = child_or_insert(node, c);
+    }
+    if (nodes_[node].replacement == kNone) {
+      nodes_[node].replacement = static_cast<std::uint32_t>(replacements_.size());
+      replacements_.emplace_back(replace);
+    }
+    if constexpr (std::is_same<Traits, std::char_traits<char>>::value) {
+      if (first_chars_.find(find[0]) == string_type::npos) {
+        first_chars_.push_back(find[0]);
+      }
+    }
+  }
+
+  /// Compute the size of the result of apply() without building it.
+  std::size_t size(view_type input) const
+  {
+    std::size_t size = 0u;
+    scan(
+      input,
+      [&size](view_type segment) {size += segment.size();},
+      [&size, this](std::uint32_t replacement) {size += replacements_[replacement].size();});
+    return size;
+  }
+
+  /// Replace every occurrence of the strings in the set in input.
+  /**
+   * \param[in] input The input string.
+   * \return A copy of input with the replacements applied.
+   */
+  string_type apply(view_type input) const
+  {
+    string_type output;
+    append(input, output);
+    return output;
+  }
+
+  /// Replace every occurrence of the strings in the set in input, appending to a string.
+  /**
+   * The output grows at most once, through its own allocator.
+   *
+   * \param[in] input The input string.
+   * \param[inout] output The string to append input with the replacements applied to.
+   */
+  template<class Allocator>
+  void append(view_type input, std::basic_string<CharT, Traits, Allocator> & output) const
+  {
+    output.reserve(output.size() + size(input));
+    scan(
+      input,
+      [&output](view_type segment) {output.append(segment);},
+      [&output, this](std::uint32_t replacement) {output.append(replacements_[replacement]);});
+  }
+
+  /// Replace every occurrence of the strings in the set in input, writing to an output iterator.
+  /**
+   * \param[in] input The input string.
+   * \param[in] out The beginning of the destination range, it may be a pointer into a buffer.
+   * \return The output iterator past the last character written.
+   */
+  template<typename OutputIt>
+  OutputIt apply(view_type input, OutputIt out) const
+  {
+    scan(
+      input,
+      [&out](view_type segment) {out = std::copy(segment.begin(), segment.end(), out);},
+      [&out, this](std::uint32_t replacement) {
+        const string_type & replace = replacements_[replacement];
+        out = std::copy(replace.begin(), replace.end(), out);
+      });
+    return out;
+  }
+
+private:
+  static constexpr std::uint32_t kNone = UINT32_MAX;
+
+  struct Node
+  {
+    // Sorted by character.
+    std::vector<std::pair<CharT, std::uint32_t>> children;
+    std::uint32_t replacement = kNone;
+  };
+
+  std::uint32_t child(std::uint32_t node, CharT c) const
+  {
+    const auto & children = nodes_[node].children;
+    const auto it = std::lower_bound(
+      children.begin(), children.end(), c,
+      [](const std::pair<CharT, std::uint32_t> & entry, CharT value) {
+        return Traits::lt(entry.first, value);
+      });
+    return (it != children.end() && Traits::eq(it->first, c)) ? it->second : kNone;
+  }
+
+  std::uint32_t child_or_insert(std::uint32_t node, CharT c)
+  {
+    const std::uint32_t existing = child(node, c);
+    if (existing != kNone) {
+      return existing;
+    }
+    const auto created = static_cast<std::uint32_t>(nodes_.size());
+    nodes_.emplace_back();
+    auto & children = nodes_[node].children;
+    const auto it = std::lower_bound(
+      children.begin(), children.end(), c,
+      [](const std::pair<CharT, std::uint32_t> & entry, CharT value) {
+        return Traits::lt(entry.first, value);
+      });
+    children.emplace(it, c, created);
+    return created;
+  }
+
+  /// Position of the next character which may start a match.
+  std::size_t next_candidate(view_type input, std::size_t pos) const
+  {
+    if constexpr (std::is_same<Traits, std::char_traits<char>>::value) {
+      return detail::scan_find_first_of(input, first_chars_, pos);
+    } else {
+      for (; pos < input.size(); ++pos) {
+        if (child(0u, input[pos]) != kNone) {
+          return pos;
+        }
+      }
+      return view_type::npos;
+    }
+  }
+
+  template<class SegmentF, class MatchF>
+  void scan(view_type input, SegmentF && on_segment, MatchF && on_match) const
+  {
+    std::size_t start = 0u;
+    std::size_t pos = next_candidate(input, 0u);
+    while (pos != view_type::npos) {
+      // Walk the trie, remembering the longest find string ending on the way.
+      std::uint32_t node = 0u;
+      std::uint32_t replacement = kNone;
+      std::size_t match_end = pos;
+      for (std::size_t i = pos; i < input.size(); ++i) {
+        node = child(node, input[i]);
+        if (node == kNone) {
+          break;
+        }
+        if (nodes_[node].replacement != kNone) {
+          replacement = nodes_[node].replacement;
+          match_end = i + 1u;
+        }
+      }
+      if (replacement == kNone) {
+        pos = next_candidate(input, pos + 1u);
+        continue;
+      }
+      on_segment(input.substr(start, pos - start));
+      on_match(replacement);
+      start = match_end;
+      pos = next_candidate(input, start);
+    }
+    on_segment(input.substr(start));
+  }
+
+  std::vector<Node> nodes_ = std::vector<Node>(1u);
+  std::vector<string_type> replacements_;
+  // Distinct first characters of the find strings, to skip ahead with the scanning kernel.
+  string_type first_chars_;
+};
+
+/// Find and replace many strings in a single scan of the input.
+/**
+ * \param[in] input The input string.
+ * \param[in] set The strings to find and their replacements.
+ * \return A copy of input with the replacements of set applied.
+ */
+template<typename InputT, class CharT, class Traits>
+std::basic_string<CharT, Traits>
+find_and_replace(const InputT & input, const FindAndReplaceSet<CharT, Traits> & set)
+{
+  return set.apply(std::basic_string_view<CharT, Traits>(input));
+}
+
+/// Find and replace many strings in a single scan of the input.
+/**
+ * \param[in] input The input string.
+ * \param[in] set The strings to find and their replacements.
+ * \return A copy of input with the replacements of set applied, using the allocator of input.
+ */
+template<class CharT, class Traits, class Allocator>
+std::basic_string<CharT, Traits, Allocator>
+find_and_replace(
+  const std::basic_string<CharT, Traits, Allocator> & input,
+  const FindAndReplaceSet<CharT, Traits> & set)
+{
+  std::basic_string<CharT, Traits, Allocator> output(input.get_allocator());
+  set.append(std::basic_string_view<CharT, Traits>(input), output);
+  return output;
 }
 
 }  // namespace rcpputils
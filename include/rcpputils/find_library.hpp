@@ -19,7 +19,10 @@
 #ifndef RCPPUTILS__FIND_LIBRARY_HPP_
 #define RCPPUTILS__FIND_LIBRARY_HPP_
 
+#include <memory>
 #include <string>
+#include <system_error>
+#include <vector>
 
 #include "rcpputils/visibility_control.hpp"
 
@@ -41,6 +44,185 @@ namespace rcpputils
 RCPPUTILS_PUBLIC
 std::string find_library_path(const std::string & library_name);
 
+/// Find a library located in the OS's specified environment variable for library paths.
+/**
+ * Same as find_library_path(const std::string &), but reporting failures to read the environment
+ * through an error code instead of an exception.
+ *
+ * \param[in] library_name Name of the library to find.
+ * \param[out] ec Set if the environment variable could not be read, cleared otherwise.
+ * \return The absolute filesystem path, including the appropriate prefix and extension, or ""
+ * if the library was not found or on failure.
+ */
+RCPPUTILS_PUBLIC
+std::string find_library_path(const std::string & library_name, std::error_code & ec);
+
+/// Find several libraries located in the OS's specified environment variable for library paths.
+/**
+ * Equivalent to calling find_library_path() for each name, but the search path is walked once
+ * for the whole batch.
+ *
+ * \param[in] library_names Names of the libraries to find.
+ * \return The path of each library, in the same order, or "" for the ones that were not found.
+ * \throws std::runtime_error if an error is encountered when accessing environment variables.
+ */
+RCPPUTILS_PUBLIC
+std::vector<std::string> find_library_paths(const std::vector<std::string> & library_names);
+
+/// Where a library located by find_library_location() was found.
+enum class LibrarySource
+{
+  /// The library was not found.
+  not_found,
+  /// A `DT_RPATH` entry of the executable.
+  rpath,
+  /// The OS's environment variable for library paths.
+  search_path,
+  /// A `DT_RUNPATH` entry of the executable.
+  runpath,
+  /// The dynamic loader's cache, `/etc/ld.so.cache`.
+  loader_cache,
+  /// One of the dynamic loader's default directories.
+  system_directory
+};
+
+/// The result of find_library_location().
+struct LibraryLocation
+{
+  /// The path of the library, or "" if it was not found.
+  std::string path;
+  /// Where the library was found.
+  LibrarySource source = LibrarySource::not_found;
+};
+
+/// Find a library the way the dynamic loader would.
+/**
+ * Unlike find_library_path(), which only consults the OS's environment variable for library
+ * paths, this also consults the places the dynamic loader searches, in the loader's order:
+ *  * Linux: the executable's `DT_RPATH` (if it has no `DT_RUNPATH`), `${LD_LIBRARY_PATH}`,
+ *    the executable's `DT_RUNPATH`, `/etc/ld.so.cache` and the default system directories.
+ *  * Apple: `${DYLD_LIBRARY_PATH}`, then `/usr/local/lib` and `/usr/lib`.
+ *  * Windows: `%PATH%`.
+ *
+ * `$ORIGIN` in `DT_RPATH` and `DT_RUNPATH` is expanded to the directory of the executable;
+ * entries using other dynamic string tokens are ignored.
+ * The loader cache is memory-mapped once per process and binary-searched, and results found in
+ * it are not checked against the filesystem, like the loader itself does.
+ *
+ * \param[in] library_name Name of the library to find.
+ * \return The path of the library, including the appropriate prefix and extension, and where
+ * it was found.
+ * \throws std::runtime_error if an error is encountered when accessing environment variables.
+ */
+RCPPUTILS_PUBLIC
+LibraryLocation find_library_location(const std::string & library_name);
+
+/// Find several libraries the way the dynamic loader would.
+/**
+ * Equivalent to calling find_library_location() for each name, but each source is consulted
+ * once for the whole batch.
+ *
+ * \param[in] library_names Names of the libraries to find.
+ * \return The location of each library, in the same order.
+ * \throws std::runtime_error if an error is encountered when accessing environment variables.
+ */
+RCPPUTILS_PUBLIC
+std::vector<LibraryLocation> find_library_locations(
+  const std::vector<std::string> & library_names);
+
+/// Resolve library names against a fixed library search path.
+/**
+ * The search path is split once on construction. The contents of each directory are listed the
+ * first time a lookup reaches it and kept in an index, so subsequent lookups don't touch the
+ * filesystem except to confirm a match. Resolved names are cached as well.
+ *
+ * Since the directory listings are cached, libraries added to the search path after they were
+ * indexed are only seen after refresh() is called, unless the searcher does not cache misses:
+ * then a directory is listed again when its modification time changed, at the cost of one
+ * `stat` per directory and found library for each lookup.
+ *
+ * find_library_path() and find_library_paths() share a process-wide LibrarySearcher that does
+ * not cache misses, and is rebuilt whenever the value of the search path environment variable
+ * changes.
+ *
+ * All member functions are thread-safe; the directories are listed without blocking concurrent
+ * lookups.
+ */
+class LibrarySearcher
+{
+public:
+  /// Construct a searcher for the current value of the OS's library path environment variable.
+  /**
+   * \throws std::runtime_error if an error is encountered when accessing environment variables.
+   */
+  RCPPUTILS_PUBLIC
+  LibrarySearcher();
+
+  /// Construct a searcher for the given search path.
+  /**
+   * \param[in] search_path Directories separated by the OS's path list separator
+   * (`;` on Windows, `:` elsewhere).
+   */
+  RCPPUTILS_PUBLIC
+  explicit LibrarySearcher(const std::string & search_path);
+
+  /// Construct a searcher for the given search path, choosing whether misses are cached.
+  /**
+   * \param[in] search_path Directories separated by the OS's path list separator.
+   * \param[in] cache_misses If false, names that were not found are looked up again, in
+   * directories listed again if they changed, and found libraries are checked to still exist.
+   */
+  RCPPUTILS_PUBLIC
+  LibrarySearcher(const std::string & search_path, bool cache_misses);
+
+  RCPPUTILS_PUBLIC
+  ~LibrarySearcher();
+
+  RCPPUTILS_PUBLIC
+  LibrarySearcher(LibrarySearcher && other) noexcept;
+
+  RCPPUTILS_PUBLIC
+  LibrarySearcher & operator=(LibrarySearcher && other) noexcept;
+
+  /// Find a library in the search path.
+  /**
+   * \param[in] library_name Name of the library to find, without prefix and extension.
+   * \return The path of the library, including the appropriate prefix and extension, or "".
+   */
+  RCPPUTILS_PUBLIC
+  std::string find(const std::string & library_name) const;
+
+  /// Find several libraries in the search path.
+  /**
+   * \param[in] library_names Names of the libraries to find, without prefix and extension.
+   * \return The path of each library, in the same order, or "" for the ones that were not found.
+   */
+  RCPPUTILS_PUBLIC
+  std::vector<std::string> find(const std::vector<std::string> & library_names) const;
+
+  /// Drop the directory listings and resolved names, so they are read again on the next lookup.
+  RCPPUTILS_PUBLIC
+  void refresh();
+
+  /// Get the search path this searcher was constructed with.
+  /**
+   * \return The unsplit search path.
+   */
+  RCPPUTILS_PUBLIC
+  const std::string & search_path() const noexcept;
+
+  /// Get the directories of the search path, in search order.
+  /**
+   * \return The non-empty entries of the search path.
+   */
+  RCPPUTILS_PUBLIC
+  const std::vector<std::string> & search_directories() const noexcept;
+
+private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
 }  // namespace rcpputils
 
 #endif  // RCPPUTILS__FIND_LIBRARY_HPP_
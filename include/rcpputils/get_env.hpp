@@ -35,8 +35,15 @@
 
 #include "rcutils/get_env.h"
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 #include "rcpputils/visibility_control.hpp"
 
@@ -49,7 +56,7 @@ namespace rcpputils
  * \return The value of the environment variable if it exists, or "".
  * \throws std::runtime_error on error
  */
-std::string get_env_var(const char * env_var)
+inline std::string get_env_var(const char * env_var)
 {
   const char * value{};
   const char * err = rcutils_get_env(env_var, &value);
@@ -59,6 +66,147 @@ std::string get_env_var(const char * env_var)
   return value ? value : "";
 }
 
+/// An immutable copy of the process environment.
+/**
+ * The environment is read once, on construction or refresh(), and kept in a single buffer, so
+ * lookups return `std::string_view`s into it without allocating. The views stay valid until the
+ * snapshot is refreshed or destroyed.
+ *
+ * Name lookups are case-insensitive on Windows, like the Windows environment itself.
+ *
+ * A const snapshot can be read from several threads at once; refresh() must not run
+ * concurrently with other member functions.
+ */
+class EnvSnapshot
+{
+public:
+  /// Read the current environment of the process.
+  RCPPUTILS_PUBLIC
+  EnvSnapshot();
+
+  RCPPUTILS_PUBLIC
+  ~EnvSnapshot();
+
+  EnvSnapshot(const EnvSnapshot &) = delete;
+  EnvSnapshot & operator=(const EnvSnapshot &) = delete;
+
+  RCPPUTILS_PUBLIC
+  EnvSnapshot(EnvSnapshot &&) noexcept;
+
+  RCPPUTILS_PUBLIC
+  EnvSnapshot & operator=(EnvSnapshot &&) noexcept;
+
+  /// Read the current environment of the process again.
+  /**
+   * Views returned before the refresh are invalidated.
+   */
+  RCPPUTILS_PUBLIC
+  void
+  refresh();
+
+  /// Get the value of an environment variable.
+  /**
+   * \param[in] name the name of the environment variable
+   * \return The value, which may be empty, or std::nullopt if the variable is not set.
+   */
+  RCPPUTILS_PUBLIC
+  std::optional<std::string_view>
+  get(std::string_view name) const noexcept;
+
+  /// Get the value of an environment variable, or a default if it is not set.
+  /**
+   * \param[in] name the name of the environment variable
+   * \param[in] default_value the value returned if the variable is not set
+   * \return The value of the variable, or default_value.
+   */
+  RCPPUTILS_PUBLIC
+  std::string_view
+  get_or(std::string_view name, std::string_view default_value) const noexcept;
+
+  /// Check if an environment variable is set.
+  /**
+   * \param[in] name the name of the environment variable
+   * \return true if the variable is set, even to an empty value.
+   */
+  RCPPUTILS_PUBLIC
+  bool
+  contains(std::string_view name) const noexcept;
+
+  /// Get the value of an environment variable as a boolean.
+  /**
+   * `1`, `true`, `yes` and `on` are true; `0`, `false`, `no` and `off` are false.
+   * The comparison is case-insensitive.
+   *
+   * \param[in] name the name of the environment variable
+   * \return The parsed value, or std::nullopt if the variable is not set or is not a boolean.
+   */
+  RCPPUTILS_PUBLIC
+  std::optional<bool>
+  get_bool(std::string_view name) const noexcept;
+
+  /// Get the value of an environment variable as a signed integer.
+  /**
+   * \param[in] name the name of the environment variable
+   * \return The parsed value, or std::nullopt if the variable is not set or its whole value is
+   * not a base 10 integer in range.
+   */
+  RCPPUTILS_PUBLIC
+  std::optional<int64_t>
+  get_int(std::string_view name) const noexcept;
+
+  /// Get the value of an environment variable as a list, such as `PATH`.
+  /**
+   * Empty items are skipped.
+   *
+   * \param[in] name the name of the environment variable
+   * \param[in] separator the separator of the items; defaults to the platform's path list
+   * separator, `;` on Windows and `:` elsewhere.
+   * \return The items, or an empty list if the variable is not set.
+   */
+  RCPPUTILS_PUBLIC
+  std::vector<std::string_view>
+  get_list(std::string_view name, char separator = kPathListSeparator) const;
+
+  /// Get the number of variables in the snapshot.
+  /**
+   * \return The number of variables.
+   */
+  RCPPUTILS_PUBLIC
+  size_t
+  size() const noexcept;
+
+  /// Get a snapshot of the environment shared by the whole process.
+  /**
+   * The shared snapshot is taken on first use and replaced by refresh_process_snapshot().
+   * Holders of the returned pointer keep their snapshot, and its views, alive.
+   *
+   * \return The shared snapshot.
+   */
+  RCPPUTILS_PUBLIC
+  static
+  std::shared_ptr<const EnvSnapshot>
+  process_snapshot();
+
+  /// Replace the snapshot returned by process_snapshot() with a fresh one.
+  RCPPUTILS_PUBLIC
+  static
+  void
+  refresh_process_snapshot();
+
+  /// The platform's separator between the items of path lists.
+#ifdef _WIN32
+  static constexpr char kPathListSeparator = ';';
+#else
+  static constexpr char kPathListSeparator = ':';
+#endif
+
+private:
+  const std::pair<std::string_view, std::string_view> * find(std::string_view name) const noexcept;
+
+  std::unique_ptr<char[]> buffer_;
+  std::vector<std::pair<std::string_view, std::string_view>> entries_;
+};
+
 }  // namespace rcpputils
 
 #endif  // RCPPUTILS__GET_ENV_HPP_
@@ -0,0 +1,351 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/*! \file instrumentation.hpp
+ * \brief Low overhead counters, latency histograms and scoped timers.
+ *
+ * Counters and histograms are sharded per thread: each thread updates its own cache line with a
+ * relaxed atomic, so concurrent writers do not contend. Readers sum the shards, which they may
+ * do at any time without stopping the writers.
+ *
+ * Metrics are usually named and owned by the process-wide registry, through the macros:
+ *
+ * \code
+ * void load_plugins()
+ * {
+ *   RCPPUTILS_TRACE_SCOPE("my_package.load_plugins");
+ *   RCPPUTILS_COUNTER_INCREMENT("my_package.plugin_loads");
+ *   ...
+ * }
+ * \endcode
+ *
+ * and read with rcpputils::instrumentation::snapshot().
+ * Defining `RCPPUTILS_DISABLE_INSTRUMENTATION` before including this header turns the macros
+ * into no-ops, removing their cost entirely; the classes and functions remain available.
+ */
+
+#ifndef RCPPUTILS__INSTRUMENTATION_HPP_
+#define RCPPUTILS__INSTRUMENTATION_HPP_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "rcpputils/visibility_control.hpp"
+
+namespace rcpputils
+{
+namespace instrumentation
+{
+
+/// Number of shards of each counter and histogram.
+constexpr std::size_t kShards = 16;
+
+namespace detail
+{
+
+/// Get the shard the calling thread writes to; threads are assigned shards round-robin.
+inline std::size_t this_thread_shard() noexcept
+{
+  static std::atomic<std::size_t> next_shard{0u};
+  thread_local const std::size_t shard =
+    next_shard.fetch_add(1u, std::memory_order_relaxed) % kShards;
+  return shard;
+}
+
+}  // namespace detail
+
+/// A monotonically increasing count, sharded per thread.
+class Counter
+{
+public:
+  /// Add value to the count.
+  void add(std::uint64_t value = 1u) noexcept
+  {
+    shards_[detail::this_thread_shard()].value.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  /// Get the count, summed over all shards.
+  std::uint64_t value() const noexcept
+  {
+    std::uint64_t sum = 0u;
+    for (const auto & shard : shards_) {
+      sum += shard.value.load(std::memory_order_relaxed);
+    }
+    return sum;
+  }
+
+  /// Reset the count to zero; increments made concurrently may be lost.
+  void reset() noexcept
+  {
+    for (auto & shard : shards_) {
+      shard.value.store(0u, std::memory_order_relaxed);
+    }
+  }
+
+private:
+  struct alignas(64) Shard
+  {
+    std::atomic<std::uint64_t> value{0u};
+  };
+
+  std::array<Shard, kShards> shards_{};
+};
+
+/// A histogram of durations, sharded per thread.
+/**
+ * Durations are counted in power of two buckets: bucket `i` counts durations of
+ * `[2^i, 2^(i+1))` nanoseconds, bucket 0 also counts durations shorter than a nanosecond and the
+ * last bucket also counts all longer durations.
+ *
+ * A snapshot taken while durations are being recorded may be slightly inconsistent, e.g. its
+ * count may not match the sum of its buckets.
+ */
+class Histogram
+{
+public:
+  /// Number of buckets; the last one starts at about 9 minutes.
+  static constexpr std::size_t kBuckets = 40;
+
+  /// Summary of the recorded durations.
+  struct Snapshot
+  {
+    /// Number of durations recorded.
+    std::uint64_t count = 0u;
+    /// Sum of the durations recorded.
+    std::chrono::nanoseconds total{0};
+    /// Number of durations in each bucket.
+    std::array<std::uint64_t, kBuckets> buckets{};
+  };
+
+  /// Record a duration.
+  void record(std::chrono::nanoseconds duration) noexcept
+  {
+    const std::uint64_t nanoseconds = to_nanoseconds(duration);
+    Shard & shard = shards_[detail::this_thread_shard()];
+    shard.count.fetch_add(1u, std::memory_order_relaxed);
+    shard.total.fetch_add(nanoseconds, std::memory_order_relaxed);
+    shard.buckets[bucket_of(nanoseconds)].fetch_add(1u, std::memory_order_relaxed);
+  }
+
+  /// Get the recorded durations, summed over all shards.
+  Snapshot snapshot() const noexcept
+  {
+    Snapshot snapshot;
+    std::uint64_t total = 0u;
+    for (const auto & shard : shards_) {
+      snapshot.count += shard.count.load(std::memory_order_relaxed);
+      total += shard.total.load(std::memory_order_relaxed);
+      for (std::size_t i = 0; i < kBuckets; ++i) {
+        snapshot.buckets[i] += shard.buckets[i].load(std::memory_order_relaxed);
+      }
+    }
+    snapshot.total = std::chrono::nanoseconds(total);
+    return snapshot;
+  }
+
+  /// Reset all buckets to zero; durations recorded concurrently may be lost.
+  void reset() noexcept
+  {
+    for (auto & shard : shards_) {
+      shard.count.store(0u, std::memory_order_relaxed);
+      shard.total.store(0u, std::memory_order_relaxed);
+      for (auto & bucket : shard.buckets) {
+        bucket.store(0u, std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /// Get the bucket a duration of nanoseconds is counted in.
+  static constexpr std::size_t bucket_of(std::uint64_t nanoseconds) noexcept
+  {
+    if (nanoseconds < 2u) {
+      return 0u;
+    }
+#if defined(__GNUC__) || defined(__clang__)
+    const std::size_t bucket = 63u - static_cast<std::size_t>(__builtin_clzll(nanoseconds));
+#else
+    std::size_t bucket = 0;
+    for (; nanoseconds > 1u; nanoseconds >>= 1) {
+      ++bucket;
+    }
+#endif
+    return bucket < kBuckets ? bucket : kBuckets - 1u;
+  }
+
+  /// Get the bucket a duration is counted in.
+  static constexpr std::size_t bucket_of(std::chrono::nanoseconds duration) noexcept
+  {
+    return bucket_of(to_nanoseconds(duration));
+  }
+
+private:
+  /// Negative durations are counted as zero.
+  static constexpr std::uint64_t to_nanoseconds(std::chrono::nanoseconds duration) noexcept
+  {
+    return static_cast<std::uint64_t>(duration.count() > 0 ? duration.count() : 0);
+  }
+
+  struct alignas(64) Shard
+  {
+    std::atomic<std::uint64_t> count{0u};
+    std::atomic<std::uint64_t> total{0u};
+    std::array<std::atomic<std::uint64_t>, kBuckets> buckets{};
+  };
+
+  std::array<Shard, kShards> shards_{};
+};
+
+/// Record the time spent in a scope into a histogram.
+class ScopedTimer
+{
+public:
+  /// Start timing.
+  /**
+   * \param[in] histogram The histogram which records the duration, and must outlive the timer.
+   */
+  explicit ScopedTimer(Histogram & histogram) noexcept
+  : histogram_(&histogram), start_(std::chrono::steady_clock::now())
+  {}
+
+  /// Stop timing and record the duration, unless cancelled.
+  ~ScopedTimer()
+  {
+    if (histogram_ != nullptr) {
+      histogram_->record(elapsed());
+    }
+  }
+
+  ScopedTimer(const ScopedTimer &) = delete;
+  ScopedTimer & operator=(const ScopedTimer &) = delete;
+
+  /// Get the time elapsed since the timer started.
+  std::chrono::nanoseconds elapsed() const noexcept
+  {
+    return std::chrono::steady_clock::now() - start_;
+  }
+
+  /// Do not record anything when the timer is destroyed.
+  void cancel() noexcept
+  {
+    histogram_ = nullptr;
+  }
+
+private:
+  Histogram * histogram_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+/// Get the counter of the process-wide registry with the given name, creating it if needed.
+/**
+ * Metrics are never destroyed, so the returned reference may be cached, e.g. in a function-local
+ * static, and used without further lookups; this is what the macros do.
+ * Counters and histograms are named independently of each other.
+ *
+ * \param[in] name The name of the counter.
+ * \return The counter.
+ */
+RCPPUTILS_PUBLIC
+Counter & counter(std::string_view name);
+
+/// Get the histogram of the process-wide registry with the given name, creating it if needed.
+/**
+ * \param[in] name The name of the histogram.
+ * \return The histogram, see counter() for its lifetime.
+ */
+RCPPUTILS_PUBLIC
+Histogram & histogram(std::string_view name);
+
+/// The value of a registered counter.
+struct CounterSnapshot
+{
+  std::string name;
+  std::uint64_t value;
+};
+
+/// The recorded durations of a registered histogram.
+struct HistogramSnapshot
+{
+  std::string name;
+  Histogram::Snapshot histogram;
+};
+
+/// The values of all registered metrics, each sorted by name.
+struct Snapshot
+{
+  std::vector<CounterSnapshot> counters;
+  std::vector<HistogramSnapshot> histograms;
+};
+
+/// Read all the metrics of the process-wide registry.
+/**
+ * Writers are never blocked; only registering new metrics waits for the snapshot to complete.
+ *
+ * \return The values of all registered metrics.
+ */
+RCPPUTILS_PUBLIC
+Snapshot snapshot();
+
+/// Reset all the metrics of the process-wide registry to zero; they remain registered.
+RCPPUTILS_PUBLIC
+void reset();
+
+}  // namespace instrumentation
+}  // namespace rcpputils
+
+#define RCPPUTILS_INSTRUMENTATION_CONCAT_IMPL(a, b) a ## b
+#define RCPPUTILS_INSTRUMENTATION_CONCAT(a, b) RCPPUTILS_INSTRUMENTATION_CONCAT_IMPL(a, b)
+
+#ifndef RCPPUTILS_DISABLE_INSTRUMENTATION
+
+/// Time the rest of the enclosing scope into the registered histogram named name.
+/**
+ * The histogram is looked up once per call site.
+ */
+#define RCPPUTILS_TRACE_SCOPE(name) \
+  static ::rcpputils::instrumentation::Histogram & \
+  RCPPUTILS_INSTRUMENTATION_CONCAT(rcpputils_trace_histogram_, __LINE__) = \
+    ::rcpputils::instrumentation::histogram(name); \
+  const ::rcpputils::instrumentation::ScopedTimer \
+  RCPPUTILS_INSTRUMENTATION_CONCAT(rcpputils_trace_timer_, __LINE__)( \
+    RCPPUTILS_INSTRUMENTATION_CONCAT(rcpputils_trace_histogram_, __LINE__))
+
+/// Add value to the registered counter named name, which is looked up once per call site.
+#define RCPPUTILS_COUNTER_ADD(name, value) \
+  do { \
+    static ::rcpputils::instrumentation::Counter & rcpputils_counter = \
+      ::rcpputils::instrumentation::counter(name); \
+    rcpputils_counter.add(value); \
+  } while (0)
+
+#else
+
+#define RCPPUTILS_TRACE_SCOPE(name) static_assert(true, "")
+
+#define RCPPUTILS_COUNTER_ADD(name, value) \
+  do { \
+    (void) sizeof(value); \
+  } while (0)
+
+#endif
+
+/// Add one to the registered counter named name.
+#define RCPPUTILS_COUNTER_INCREMENT(name) RCPPUTILS_COUNTER_ADD(name, 1u)
+
+#endif  // RCPPUTILS__INSTRUMENTATION_HPP_
@@ -19,36 +19,132 @@
 #ifndef RCPPUTILS__JOIN_HPP_
 #define RCPPUTILS__JOIN_HPP_
 
-#include <algorithm>
+#include <cstddef>
 #include <iterator>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <type_traits>
 
 namespace rcpputils
 {
 
+namespace detail
+{
+
+/// Type of the values of a range.
+template<typename ContainerT>
+using range_value_t = std::remove_cv_t<
+  std::remove_reference_t<decltype(*std::begin(std::declval<const ContainerT &>()))>>;
+
+/// Whether values of type ValueT can be appended to a string without formatting.
+template<typename ValueT, typename CharT>
+constexpr bool is_string_like_v =
+  std::is_convertible<const ValueT &, std::basic_string_view<CharT>>::value;
+
+template<typename CharT, typename Traits, typename Allocator, typename ContainerT>
+void
+append_join_impl(
+  std::basic_string<CharT, Traits, Allocator> & output,
+  const ContainerT & container,
+  std::basic_string_view<CharT> delim)
+{
+  using value_type = range_value_t<ContainerT>;
+  auto it = std::begin(container);
+  const auto end = std::end(container);
+  if (it == end) {
+    return;
+  }
+  if constexpr (is_string_like_v<value_type, CharT>) {
+    // Compute the exact final length, so the output is allocated at most once.
+    std::size_t size = 0u;
+    std::size_t count = 0u;
+    for (auto size_it = it; size_it != end; ++size_it, ++count) {
+      size += std::basic_string_view<CharT>(*size_it).size();
+    }
+    output.reserve(output.size() + size + (count - 1u) * delim.size());
+    output.append(std::basic_string_view<CharT>(*it));
+    for (++it; it != end; ++it) {
+      output.append(delim);
+      output.append(std::basic_string_view<CharT>(*it));
+    }
+  } else {
+    std::basic_ostringstream<CharT> s;
+    s << *it;
+    for (++it; it != end; ++it) {
+      s << delim << *it;
+    }
+    output.append(s.str());
+  }
+}
+
+}  // namespace detail
+
+/// Append values in a container turned into strings by a given delimiter to a string
+/**
+ * Values convertible to `std::basic_string_view<CharT>`, like `std::basic_string`,
+ * `std::basic_string_view` and `const CharT *`, are appended directly after reserving the
+ * exact final length, so they only allocate through the allocator of output.
+ * Other values are formatted through a `std::basic_ostringstream`, which uses the global heap.
+ *
+ * \param[inout] output is the string to append the joined values to.
+ * \param[in] container is a range of values to be turned into string and joined, it may be any
+ *   type supporting `std::begin` and `std::end`, like standard containers, arrays and spans.
+ * \param[in] delim is a delimiter to join values turned into strings, nullptr is an empty one.
+ * \tparam CharT is the string character type.
+ * \tparam Traits is the string character traits type.
+ * \tparam Allocator is the string allocator type.
+ * \tparam ContainerT is the container type.
+ */
+template<typename CharT, typename Traits, typename Allocator, typename ContainerT>
+void
+append_join(
+  std::basic_string<CharT, Traits, Allocator> & output,
+  const ContainerT & container,
+  const CharT * delim)
+{
+  const std::basic_string_view<CharT> delim_view =
+    delim ? std::basic_string_view<CharT>(delim) : std::basic_string_view<CharT>();
+  detail::append_join_impl(output, container, delim_view);
+}
+
 /// Join values in a container turned into strings by a given delimiter
 /**
- * \param[in] container is a collection of values to be turned into string and joined.
- * \param[in] delim is a delimiter to join values turned into strings.
+ * See append_join() for the handling of the container values.
+ *
+ * \param[in] container is a range of values to be turned into string and joined.
+ * \param[in] delim is a delimiter to join values turned into strings, nullptr is an empty one.
  * \tparam CharT is the string character type.
- * \tparam ValueT is the container value type.
- * \tparam AllocatorT is the container allocator type.
- * \tparam ContainerT is the container template type.
+ * \tparam ContainerT is the container type.
  * \return joined string
  */
-template<
-  typename CharT, typename ValueT, typename AllocatorT,
-  template<typename T, class A> class ContainerT>
+template<typename ContainerT, typename CharT>
 std::basic_string<CharT>
-join(const ContainerT<ValueT, AllocatorT> & container, const CharT * delim)
+join(const ContainerT & container, const CharT * delim)
 {
-  std::basic_ostringstream<CharT> s;
-  std::copy(container.begin(), container.end(), std::ostream_iterator<ValueT, CharT>(s, delim));
-  std::basic_string<CharT> result = s.str();
-  if (delim) {
-    result = result.substr(0, result.length() - strlen(delim));
-  }
+  std::basic_string<CharT> result;
+  append_join(result, container, delim);
+  return result;
+}
+
+/// Join values in a container turned into strings by a given delimiter, using an allocator
+/**
+ * See append_join() for the handling of the container values.
+ *
+ * \param[in] container is a range of values to be turned into string and joined.
+ * \param[in] delim is a delimiter to join values turned into strings, nullptr is an empty one.
+ * \param[in] allocator is the allocator of the result, like rcpputils::ArenaAllocator.
+ * \tparam CharT is the string character type.
+ * \tparam ContainerT is the container type.
+ * \tparam AllocatorT is the string allocator type.
+ * \return joined string
+ */
+template<typename ContainerT, typename CharT, typename AllocatorT>
+std::basic_string<CharT, std::char_traits<CharT>, AllocatorT>
+join(const ContainerT & container, const CharT * delim, const AllocatorT & allocator)
+{
+  std::basic_string<CharT, std::char_traits<CharT>, AllocatorT> result(allocator);
+  append_join(result, container, delim);
   return result;
 }
 
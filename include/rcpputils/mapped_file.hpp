@@ -0,0 +1,172 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/*! \file mapped_file.hpp
+ * \brief Read-only views of whole files, memory mapped where the file system allows it.
+ */
+
+#ifndef RCPPUTILS__MAPPED_FILE_HPP_
+#define RCPPUTILS__MAPPED_FILE_HPP_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+#include "rcpputils/filesystem_helper.hpp"
+#include "rcpputils/visibility_control.hpp"
+
+namespace rcpputils
+{
+namespace fs
+{
+
+/// How the contents of a mapped_file are going to be read.
+/**
+ * These map to the `madvise` advice of the same name on POSIX and are ignored on Windows, and
+ * when the contents had to be read into a buffer.
+ */
+enum class access_advice
+{
+  /// No particular access pattern.
+  normal,
+  /// The contents are read once from start to end; pages are read ahead aggressively.
+  sequential,
+  /// The contents are accessed in random order; read ahead is disabled.
+  random,
+  /// The contents are needed soon; paging them in starts right away.
+  will_need
+};
+
+/// A read-only view of the whole contents of a file.
+/**
+ * Regular files are memory mapped (`mmap` on POSIX, `CreateFileMapping` on Windows), so the
+ * contents are read straight from the page cache without being copied.
+ * Pipes, character devices and files which report a size of zero (e.g. in `/proc`) cannot be
+ * mapped; their contents are read into a buffer owned by the mapped_file instead.
+ *
+ * The view remains valid until the mapped_file is closed, destroyed or assigned to.
+ * Changes made to a mapped file by other processes may or may not be visible through it, and
+ * truncating a mapped file while it is being read is undefined behavior.
+ */
+class mapped_file
+{
+public:
+  /// Construct a mapped_file that does not view any file.
+  mapped_file() noexcept = default;
+
+  /// Open and map a file.
+  /**
+   * \param[in] p The path to the file.
+   * \param[in] advice How the contents are going to be read.
+   * \throws std::system_error if the file cannot be opened, mapped or read.
+   */
+  RCPPUTILS_PUBLIC
+  explicit mapped_file(const path & p, access_advice advice = access_advice::normal);
+
+  /// Open and map a file, without throwing.
+  /**
+   * \param[in] p The path to the file.
+   * \param[out] ec Set to the error if the file cannot be opened, mapped or read, cleared
+   *   otherwise; on error, the mapped_file does not view any file.
+   * \param[in] advice How the contents are going to be read.
+   */
+  RCPPUTILS_PUBLIC
+  mapped_file(
+    const path & p, std::error_code & ec, access_advice advice = access_advice::normal) noexcept;
+
+  RCPPUTILS_PUBLIC
+  mapped_file(mapped_file && other) noexcept;
+
+  RCPPUTILS_PUBLIC
+  mapped_file & operator=(mapped_file && other) noexcept;
+
+  mapped_file(const mapped_file &) = delete;
+  mapped_file & operator=(const mapped_file &) = delete;
+
+  RCPPUTILS_PUBLIC
+  ~mapped_file();
+
+  /// Give a new hint about how the contents are going to be read.
+  /**
+   * \param[in] advice How the contents are going to be read.
+   * \return true if the hint was passed to the operating system, false if it was ignored.
+   */
+  RCPPUTILS_PUBLIC
+  bool advise(access_advice advice) noexcept;
+
+  /// Unmap the file, or release the buffer holding its contents.
+  RCPPUTILS_PUBLIC
+  void close() noexcept;
+
+  /// Check whether a file was opened.
+  bool is_open() const noexcept
+  {
+    return is_open_;
+  }
+
+  /// Check whether the contents are memory mapped rather than read into a buffer.
+  bool is_mapped() const noexcept
+  {
+    return mapping_ != nullptr;
+  }
+
+  /// Get a pointer to the first byte of the contents, which may be null if they are empty.
+  const char * data() const noexcept
+  {
+    return data_;
+  }
+
+  /// Get the size of the contents, in bytes.
+  std::size_t size() const noexcept
+  {
+    return size_;
+  }
+
+  /// Check whether the contents are empty.
+  bool empty() const noexcept
+  {
+    return size_ == 0u;
+  }
+
+  /// Get a view of the contents.
+  std::string_view view() const noexcept
+  {
+    return {data_, size_};
+  }
+
+  const char * begin() const noexcept
+  {
+    return data_;
+  }
+
+  const char * end() const noexcept
+  {
+    return data_ + size_;
+  }
+
+private:
+  void open(const path & p, access_advice advice, std::error_code & ec);
+
+  void * mapping_ = nullptr;
+  const char * data_ = nullptr;
+  std::size_t size_ = 0u;
+  std::string buffer_;
+  bool is_open_ = false;
+};
+
+}  // namespace fs
+}  // namespace rcpputils
+
+#endif  // RCPPUTILS__MAPPED_FILE_HPP_
@@ -0,0 +1,494 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/*! \file mutex.hpp
+ * \brief Mutexes and scoped guards annotated for clang's thread safety analysis.
+ *
+ * rcpputils::Mutex, rcpputils::SharedMutex and rcpputils::SpinLock are capabilities, so data
+ * members can be declared `RCPPUTILS_TSA_GUARDED_BY` them without writing an annotated wrapper:
+ *
+ *     class Counter
+ *     {
+ *     public:
+ *       void increment()
+ *       {
+ *         rcpputils::LockGuard<rcpputils::Mutex> lock(mutex_);
+ *         ++count_;
+ *       }
+ *
+ *     private:
+ *       rcpputils::Mutex mutex_;
+ *       int count_ RCPPUTILS_TSA_GUARDED_BY(mutex_) = 0;
+ *     };
+ *
+ * Every lock optionally records contention into a rcpputils::LockStats, passed to its
+ * constructor. Without one the only overhead is a null pointer check.
+ */
+
+#ifndef RCPPUTILS__MUTEX_HPP_
+#define RCPPUTILS__MUTEX_HPP_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+
+#include "rcpputils/detail/cpu_relax.hpp"
+#include "rcpputils/instrumentation.hpp"
+#include "rcpputils/thread_safety_annotations.hpp"
+
+namespace rcpputils
+{
+
+/// Contention statistics of one or more locks.
+/**
+ * An acquisition is uncontended if the lock was free, and contended if the thread had to wait.
+ * The time spent waiting for contended acquisitions is recorded in an
+ * rcpputils::instrumentation::Histogram, see it for the bucket bounds.
+ *
+ * All members may be used concurrently; like the histogram, the counters are sharded per thread
+ * and updated with relaxed atomics, so a snapshot taken while the locks are in use may be
+ * slightly inconsistent.
+ */
+class LockStats
+{
+public:
+  /// Number of buckets of the wait time histogram.
+  static constexpr std::size_t kHistogramBuckets = instrumentation::Histogram::kBuckets;
+
+  /// Record an acquisition which did not have to wait.
+  void record_uncontended() noexcept
+  {
+    uncontended_.add();
+  }
+
+  /// Record an acquisition which waited for wait.
+  void record_contended(std::chrono::nanoseconds wait) noexcept
+  {
+    waits_.record(wait);
+  }
+
+  /// Get the number of acquisitions which did not have to wait.
+  std::uint64_t uncontended_count() const noexcept
+  {
+    return uncontended_.value();
+  }
+
+  /// Get the number of acquisitions which had to wait.
+  std::uint64_t contended_count() const noexcept
+  {
+    return waits_.snapshot().count;
+  }
+
+  /// Get the total time spent waiting by contended acquisitions.
+  std::chrono::nanoseconds total_wait() const noexcept
+  {
+    return waits_.snapshot().total;
+  }
+
+  /// Get the wait time histogram, see the class documentation for the bucket bounds.
+  std::array<std::uint64_t, kHistogramBuckets> wait_histogram() const noexcept
+  {
+    return waits_.snapshot().buckets;
+  }
+
+  /// Get the histogram bucket a wait time is counted in.
+  static constexpr std::size_t bucket_of(std::chrono::nanoseconds wait) noexcept
+  {
+    return instrumentation::Histogram::bucket_of(wait);
+  }
+
+  /// Reset all counters to zero.
+  void reset() noexcept
+  {
+    uncontended_.reset();
+    waits_.reset();
+  }
+
+private:
+  instrumentation::Counter uncontended_;
+  instrumentation::Histogram waits_;
+};
+
+namespace detail
+{
+
+// The analysis cannot follow the wrapped lock into these helpers, callers carry the annotations.
+template<typename Lockable>
+void lock_and_record(Lockable & lockable, LockStats * stats)
+RCPPUTILS_TSA_NO_THREAD_SAFETY_ANALYSIS
+{
+  if (stats == nullptr) {
+    lockable.lock();
+    return;
+  }
+  if (lockable.try_lock()) {
+    stats->record_uncontended();
+    return;
+  }
+  const auto start = std::chrono::steady_clock::now();
+  lockable.lock();
+  stats->record_contended(std::chrono::steady_clock::now() - start);
+}
+
+template<typename SharedLockable>
+void lock_shared_and_record(SharedLockable & lockable, LockStats * stats)
+RCPPUTILS_TSA_NO_THREAD_SAFETY_ANALYSIS
+{
+  if (stats == nullptr) {
+    lockable.lock_shared();
+    return;
+  }
+  if (lockable.try_lock_shared()) {
+    stats->record_uncontended();
+    return;
+  }
+  const auto start = std::chrono::steady_clock::now();
+  lockable.lock_shared();
+  stats->record_contended(std::chrono::steady_clock::now() - start);
+}
+
+}  // namespace detail
+
+/// A std::mutex which is a capability for the thread safety analysis.
+class RCPPUTILS_TSA_CAPABILITY("mutex") Mutex
+{
+public:
+  /// Create a mutex which does not record contention.
+  Mutex() = default;
+
+  /// Create a mutex which records contention into stats.
+  /**
+   * \param[in] stats statistics to update, which must outlive the mutex; may be shared by
+   * several locks, or nullptr
+   */
+  explicit Mutex(LockStats * stats) noexcept
+  : stats_(stats)
+  {}
+
+  Mutex(const Mutex &) = delete;
+  Mutex & operator=(const Mutex &) = delete;
+
+  /// Acquire the mutex, waiting while another thread holds it.
+  void lock() RCPPUTILS_TSA_ACQUIRE() RCPPUTILS_TSA_NO_THREAD_SAFETY_ANALYSIS
+  {
+    detail::lock_and_record(mutex_, stats_);
+  }
+
+  /// Acquire the mutex if it is free.
+  /**
+   * \return true if the mutex was acquired.
+   */
+  bool try_lock() RCPPUTILS_TSA_TRY_ACQUIRE(true) RCPPUTILS_TSA_NO_THREAD_SAFETY_ANALYSIS
+  {
+    return mutex_.try_lock();
+  }
+
+  /// Release the mutex.
+  void unlock() RCPPUTILS_TSA_RELEASE() RCPPUTILS_TSA_NO_THREAD_SAFETY_ANALYSIS
+  {
+    mutex_.unlock();
+  }
+
+  /// Get the statistics this mutex records into, or nullptr.
+  LockStats * stats() const noexcept
+  {
+    return stats_;
+  }
+
+private:
+  std::mutex mutex_;
+  LockStats * const stats_ = nullptr;
+};
+
+/// A std::shared_mutex which is a capability for the thread safety analysis.
+class RCPPUTILS_TSA_CAPABILITY("shared_mutex") SharedMutex
+{
+public:
+  /// Create a mutex which does not record contention.
+  SharedMutex() = default;
+
+  /// Create a mutex which records contention of both exclusive and shared acquisitions.
+  /// \copydetails Mutex::Mutex(LockStats *)
+  explicit SharedMutex(LockStats * stats) noexcept
+  : stats_(stats)
+  {}
+
+  SharedMutex(const SharedMutex &) = delete;
+  SharedMutex & operator=(const SharedMutex &) = delete;
+
+  /// Acquire exclusive ownership, waiting while other threads hold any ownership.
+  void lock() RCPPUTILS_TSA_ACQUIRE() RCPPUTILS_TSA_NO_THREAD_SAFETY_ANALYSIS
+  {
+    detail::lock_and_record(mutex_, stats_);
+  }
+
+  /// Acquire exclusive ownership if the mutex is free.
+  /**
+   * \return true if the mutex was acquired.
+   */
+  bool try_lock() RCPPUTILS_TSA_TRY_ACQUIRE(true) RCPPUTILS_TSA_NO_THREAD_SAFETY_ANALYSIS
+  {
+    return mutex_.try_lock();
+  }
+
+  /// Release exclusive ownership.
+  void unlock() RCPPUTILS_TSA_RELEASE() RCPPUTILS_TSA_NO_THREAD_SAFETY_ANALYSIS
+  {
+    mutex_.unlock();
+  }
+
+  /// Acquire shared ownership, waiting while another thread holds exclusive ownership.
+  void lock_shared() RCPPUTILS_TSA_ACQUIRE_SHARED() RCPPUTILS_TSA_NO_THREAD_SAFETY_ANALYSIS
+  {
+    detail::lock_shared_and_record(mutex_, stats_);
+  }
+
+  /// Acquire shared ownership if no thread holds exclusive ownership.
+  /**
+   * \return true if the mutex was acquired.
+   */
+  bool try_lock_shared()
+  RCPPUTILS_TSA_TRY_ACQUIRE_SHARED(true) RCPPUTILS_TSA_NO_THREAD_SAFETY_ANALYSIS
+  {
+    return mutex_.try_lock_shared();
+  }
+
+  /// Release shared ownership.
+  void unlock_shared() RCPPUTILS_TSA_RELEASE_SHARED() RCPPUTILS_TSA_NO_THREAD_SAFETY_ANALYSIS
+  {
+    mutex_.unlock_shared();
+  }
+
+  /// \copydoc Mutex::stats()
+  LockStats * stats() const noexcept
+  {
+    return stats_;
+  }
+
+private:
+  std::shared_mutex mutex_;
+  LockStats * const stats_ = nullptr;
+};
+
+/// A lock which busy-waits instead of sleeping, for very short critical sections.
+/**
+ * Waiting threads only read the lock word, so they do not steal its cache line from the owner,
+ * and back off exponentially with pause instructions between reads. After kMaxBackoff pause
+ * instructions per read they yield the processor instead, so a preempted owner can make
+ * progress.
+ */
+class RCPPUTILS_TSA_CAPABILITY("mutex") SpinLock
+{
+public:
+  /// Maximum number of pause instructions between two reads of the lock word.
+  static constexpr unsigned kMaxBackoff = 64;
+
+  /// Create a lock which does not record contention.
+  SpinLock() = default;
+
+  /// Create a lock which records contention into stats.
+  /// \copydetails Mutex::Mutex(LockStats *)
+  explicit SpinLock(LockStats * stats) noexcept
+  : stats_(stats)
+  {}
+
+  SpinLock(const SpinLock &) = delete;
+  SpinLock & operator=(const SpinLock &) = delete;
+
+  /// Acquire the lock, spinning while another thread holds it.
+  void lock() noexcept RCPPUTILS_TSA_ACQUIRE()
+  {
+    if (try_lock()) {
+      if (stats_ != nullptr) {
+        stats_->record_uncontended();
+      }
+      return;
+    }
+    if (stats_ == nullptr) {
+      spin();
+      return;
+    }
+    const auto start = std::chrono::steady_clock::now();
+    spin();
+    stats_->record_contended(std::chrono::steady_clock::now() - start);
+  }
+
+  /// Acquire the lock if it is free.
+  /**
+   * \return true if the lock was acquired.
+   */
+  bool try_lock() noexcept RCPPUTILS_TSA_TRY_ACQUIRE(true)
+  {
+    // Test first, so a failing attempt does not take the cache line exclusively.
+    return !locked_.load(std::memory_order_relaxed) &&
+           !locked_.exchange(true, std::memory_order_acquire);
+  }
+
+  /// Release the lock.
+  void unlock() noexcept RCPPUTILS_TSA_RELEASE()
+  {
+    locked_.store(false, std::memory_order_release);
+  }
+
+  /// \copydoc Mutex::stats()
+  LockStats * stats() const noexcept
+  {
+    return stats_;
+  }
+
+private:
+  void spin() noexcept RCPPUTILS_TSA_ACQUIRE() RCPPUTILS_TSA_NO_THREAD_SAFETY_ANALYSIS
+  {
+    unsigned backoff = 1;
+    do {
+      while (locked_.load(std::memory_order_relaxed)) {
+        if (backoff < kMaxBackoff) {
+          for (unsigned i = 0; i < backoff; ++i) {
+            detail::cpu_relax();
+          }
+          backoff <<= 1;
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    } while (locked_.exchange(true, std::memory_order_acquire));
+  }
+
+  std::atomic<bool> locked_{false};
+  LockStats * const stats_ = nullptr;
+};
+
+/// Scoped exclusive ownership of a lock, for the duration of a scope.
+/**
+ * \tparam Lockable a type with lock() and unlock(), such as rcpputils::Mutex
+ */
+template<typename Lockable>
+class RCPPUTILS_TSA_SCOPED_CAPABILITY LockGuard
+{
+public:
+  /// Acquire lockable.
+  explicit LockGuard(Lockable & lockable) RCPPUTILS_TSA_ACQUIRE(lockable)
+  : lockable_(lockable)
+  {
+    lockable_.lock();
+  }
+
+  /// Adopt lockable, which the calling thread already holds.
+  LockGuard(Lockable & lockable, std::adopt_lock_t) RCPPUTILS_TSA_REQUIRES(lockable)
+  : lockable_(lockable)
+  {}
+
+  LockGuard(const LockGuard &) = delete;
+  LockGuard & operator=(const LockGuard &) = delete;
+
+  /// Release the lock.
+  ~LockGuard() RCPPUTILS_TSA_RELEASE()
+  {
+    lockable_.unlock();
+  }
+
+private:
+  Lockable & lockable_;
+};
+
+/// Scoped shared ownership of a lock, for the duration of a scope.
+/**
+ * \tparam SharedLockable a type with lock_shared() and unlock_shared(), such as
+ * rcpputils::SharedMutex
+ */
+template<typename SharedLockable>
+class RCPPUTILS_TSA_SCOPED_CAPABILITY SharedLockGuard
+{
+public:
+  /// Acquire shared ownership of lockable.
+  explicit SharedLockGuard(SharedLockable & lockable) RCPPUTILS_TSA_ACQUIRE_SHARED(lockable)
+  : lockable_(lockable)
+  {
+    lockable_.lock_shared();
+  }
+
+  SharedLockGuard(const SharedLockGuard &) = delete;
+  SharedLockGuard & operator=(const SharedLockGuard &) = delete;
+
+  /// Release shared ownership.
+  ~SharedLockGuard() RCPPUTILS_TSA_RELEASE()
+  {
+    lockable_.unlock_shared();
+  }
+
+private:
+  SharedLockable & lockable_;
+};
+
+/// Scoped exclusive ownership of a lock which can be released and acquired again in the scope.
+/**
+ * It can be used with std::condition_variable_any, which unlocks it while waiting.
+ *
+ * \tparam Lockable a type with lock() and unlock(), such as rcpputils::Mutex
+ */
+template<typename Lockable>
+class RCPPUTILS_TSA_SCOPED_CAPABILITY UniqueLock
+{
+public:
+  /// Acquire lockable.
+  explicit UniqueLock(Lockable & lockable) RCPPUTILS_TSA_ACQUIRE(lockable)
+  : lockable_(lockable), owns_(true)
+  {
+    lockable_.lock();
+  }
+
+  UniqueLock(const UniqueLock &) = delete;
+  UniqueLock & operator=(const UniqueLock &) = delete;
+
+  /// Release the lock, if it is held.
+  ~UniqueLock() RCPPUTILS_TSA_RELEASE()
+  {
+    if (owns_) {
+      lockable_.unlock();
+    }
+  }
+
+  /// Acquire the lock again, after unlock().
+  void lock() RCPPUTILS_TSA_ACQUIRE()
+  {
+    lockable_.lock();
+    owns_ = true;
+  }
+
+  /// Release the lock before the end of the scope.
+  void unlock() RCPPUTILS_TSA_RELEASE()
+  {
+    owns_ = false;
+    lockable_.unlock();
+  }
+
+  /// Check if the lock is currently held by this guard.
+  bool owns_lock() const noexcept
+  {
+    return owns_;
+  }
+
+private:
+  Lockable & lockable_;
+  bool owns_;
+};
+
+}  // namespace rcpputils
+
+#endif  // RCPPUTILS__MUTEX_HPP_
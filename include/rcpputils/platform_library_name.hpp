@@ -0,0 +1,173 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/*! \file platform_library_name.hpp
+ * \brief Platform specific shared library file names.
+ *
+ * The file name of a library named `name` is:
+ *  * Linux: `lib{name}.so`, `lib{name}d.so` for debug builds
+ *  * Apple: `lib{name}.dylib`, `lib{name}d.dylib` for debug builds
+ *  * Windows: `{name}.dll`, `{name}d.dll` for debug builds
+ *
+ * Names can be built at compile time for known library names, or written into a caller
+ * provided buffer at run time.
+ */
+
+#ifndef RCPPUTILS__PLATFORM_LIBRARY_NAME_HPP_
+#define RCPPUTILS__PLATFORM_LIBRARY_NAME_HPP_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace rcpputils
+{
+
+#ifdef _WIN32
+/// Prefix of shared library file names on this platform.
+inline constexpr std::string_view kPlatformLibraryPrefix = "";
+/// Extension of shared library file names on this platform.
+inline constexpr std::string_view kPlatformLibraryExtension = ".dll";
+#elif __APPLE__
+inline constexpr std::string_view kPlatformLibraryPrefix = "lib";
+inline constexpr std::string_view kPlatformLibraryExtension = ".dylib";
+#else
+inline constexpr std::string_view kPlatformLibraryPrefix = "lib";
+inline constexpr std::string_view kPlatformLibraryExtension = ".so";
+#endif
+
+/// Suffix appended to the library name of debug builds.
+inline constexpr std::string_view kPlatformLibraryDebugSuffix = "d";
+
+/// Get the length of the platform specific name of a library.
+/**
+ * \param[in] library_name library base name (without prefix and extension)
+ * \param[in] debug if true the length of the debug library name is returned
+ * \return The number of characters of the name, not including a terminating null character.
+ */
+constexpr std::size_t platform_library_name_size(
+  std::string_view library_name, bool debug = false) noexcept
+{
+  return kPlatformLibraryPrefix.size() + library_name.size() +
+         (debug ? kPlatformLibraryDebugSuffix.size() : 0u) + kPlatformLibraryExtension.size();
+}
+
+/// Write the platform specific name of a library into a buffer.
+/**
+ * Nothing is written if the buffer is too small, so callers can query the required size first
+ * or retry with a bigger buffer. The name is null-terminated if the buffer has room for it.
+ *
+ * \param[in] library_name library base name (without prefix and extension)
+ * \param[in] debug if true the debug library name is written
+ * \param[out] buffer destination of the name
+ * \param[in] buffer_size capacity of buffer, in characters
+ * \return The length of the name, as platform_library_name_size(); the name was written if this
+ * is not greater than buffer_size.
+ */
+constexpr std::size_t write_platform_library_name(
+  std::string_view library_name, bool debug, char * buffer, std::size_t buffer_size) noexcept
+{
+  const std::size_t size = platform_library_name_size(library_name, debug);
+  if (size > buffer_size) {
+    return size;
+  }
+  std::size_t pos = 0;
+  auto write = [&buffer, &pos](std::string_view part) {
+      for (char c : part) {
+        buffer[pos++] = c;
+      }
+    };
+  write(kPlatformLibraryPrefix);
+  write(library_name);
+  if (debug) {
+    write(kPlatformLibraryDebugSuffix);
+  }
+  write(kPlatformLibraryExtension);
+  if (pos < buffer_size) {
+    buffer[pos] = '\0';
+  }
+  return size;
+}
+
+/// Append the platform specific name of a library to a string.
+/**
+ * \param[inout] out The string to append to; it grows at most once.
+ * \param[in] library_name library base name (without prefix and extension)
+ * \param[in] debug if true the debug library name is appended
+ */
+template<typename Traits, typename Allocator>
+void append_platform_library_name(
+  std::basic_string<char, Traits, Allocator> & out, std::string_view library_name,
+  bool debug = false)
+{
+  out.reserve(out.size() + platform_library_name_size(library_name, debug));
+  out.append(kPlatformLibraryPrefix.data(), kPlatformLibraryPrefix.size());
+  out.append(library_name.data(), library_name.size());
+  if (debug) {
+    out.append(kPlatformLibraryDebugSuffix.data(), kPlatformLibraryDebugSuffix.size());
+  }
+  out.append(kPlatformLibraryExtension.data(), kPlatformLibraryExtension.size());
+}
+
+/// A library name built at compile time, see make_platform_library_name().
+template<std::size_t N>
+struct fixed_platform_library_name
+{
+  /// The null-terminated name.
+  char data[N + 1];
+  /// The length of the name.
+  std::size_t size;
+
+  /// Get the null-terminated name.
+  constexpr const char * c_str() const noexcept
+  {
+    return data;
+  }
+
+  /// Get the name as a string view.
+  constexpr std::string_view view() const noexcept
+  {
+    return std::string_view(data, size);
+  }
+
+  /// Get the name as a string view.
+  constexpr operator std::string_view() const noexcept
+  {
+    return view();
+  }
+};
+
+/// Build the platform specific name of a known library at compile time.
+/**
+ * For example, `constexpr auto name = make_platform_library_name("rmw_fastrtps_cpp");` yields
+ * `"librmw_fastrtps_cpp.so"` on Linux without any run time work.
+ *
+ * \tparam Debug if true the debug library name is built
+ * \param[in] library_name library base name (without prefix and extension), as a string literal
+ * \return The name, in a fixed-size buffer.
+ */
+template<bool Debug = false, std::size_t LiteralSize>
+constexpr auto make_platform_library_name(const char (&library_name)[LiteralSize]) noexcept
+{
+  constexpr std::size_t capacity = kPlatformLibraryPrefix.size() + (LiteralSize - 1u) +
+    (Debug ? kPlatformLibraryDebugSuffix.size() : 0u) + kPlatformLibraryExtension.size();
+  fixed_platform_library_name<capacity> name{};
+  name.size = write_platform_library_name(
+    std::string_view(library_name, LiteralSize - 1u), Debug, name.data, capacity + 1u);
+  return name;
+}
+
+}  // namespace rcpputils
+
+#endif  // RCPPUTILS__PLATFORM_LIBRARY_NAME_HPP_
@@ -21,27 +21,69 @@
 
 #include <memory>
 #include <type_traits>
+#include <utility>
 
 namespace rcpputils
 {
 
-namespace details
+/// Customization point describing smart pointer types.
+/**
+ * The primary template describes types that are not smart pointers.
+ * It is specialized for `std::shared_ptr<T>`, `std::unique_ptr<T, Deleter>` with any deleter
+ * and `std::weak_ptr<T>`; specialize it for other smart pointer types so that is_pointer,
+ * remove_pointer and to_address recognize them:
+ *
+ * ```
+ * namespace rcpputils
+ * {
+ * template<class T>
+ * struct smart_pointer_traits<my::observer_ptr<T>>
+ * {
+ *   static constexpr bool is_smart_pointer = true;
+ *   using element_type = T;
+ * };
+ * }  // namespace rcpputils
+ * ```
+ *
+ * Specializations are looked up for the type without cv-qualifiers.
+ */
+template<class T>
+struct smart_pointer_traits
 {
+  /// Indicates whether T is a smart pointer.
+  static constexpr bool is_smart_pointer = false;
+};
 
 template<class T>
-struct is_smart_pointer_helper : std::false_type
-{};
+struct smart_pointer_traits<std::shared_ptr<T>>
+{
+  static constexpr bool is_smart_pointer = true;
+  using element_type = T;
+};
+
+template<class T, class Deleter>
+struct smart_pointer_traits<std::unique_ptr<T, Deleter>>
+{
+  static constexpr bool is_smart_pointer = true;
+  using element_type = T;
+};
 
 template<class T>
-struct is_smart_pointer_helper<std::shared_ptr<T>>: std::true_type
-{};
+struct smart_pointer_traits<std::weak_ptr<T>>
+{
+  static constexpr bool is_smart_pointer = true;
+  using element_type = T;
+};
+
+namespace details
+{
 
 template<class T>
-struct is_smart_pointer_helper<std::unique_ptr<T>>: std::true_type
-{};
+using remove_cvref_t = std::remove_cv_t<std::remove_reference_t<T>>;
 
 template<class T>
-struct is_smart_pointer : is_smart_pointer_helper<typename std::remove_cv<T>::type>
+struct is_smart_pointer
+  : std::bool_constant<smart_pointer_traits<std::remove_cv_t<T>>::is_smart_pointer>
 {};
 
 template<
@@ -56,9 +98,38 @@ struct remove_pointer
 template<class T>
 struct remove_pointer<T, true>
 {
-  using type = typename std::remove_pointer<
-    decltype(std::declval<typename std::remove_volatile<T>::type>().get())>::type;
+  using type = std::remove_extent_t<
+    typename smart_pointer_traits<std::remove_cv_t<T>>::element_type>;
 };
+
+template<class T, class = void>
+struct has_pointer_traits_to_address : std::false_type
+{};
+
+template<class T>
+struct has_pointer_traits_to_address<
+  T, std::void_t<decltype(std::pointer_traits<T>::to_address(std::declval<const T &>()))>>
+  : std::true_type
+{};
+
+template<class T, class = void>
+struct has_arrow_operator : std::false_type
+{};
+
+template<class T>
+struct has_arrow_operator<T, std::void_t<decltype(std::declval<const T &>().operator->())>>
+  : std::true_type
+{};
+
+template<class T, class = void>
+struct has_get : std::false_type
+{};
+
+template<class T>
+struct has_get<T, std::void_t<decltype(std::declval<const T &>().get())>>
+  : std::true_type
+{};
+
 }  // namespace details
 
 /// Type traits for validating if T is of type pointer or smart pointer
@@ -66,7 +137,8 @@ struct remove_pointer<T, true>
  * In comparison to the existing type trait for pointer in the stdlib `std::is_pointer<T>`
  * https://en.cppreference.com/w/cpp/types/is_pointer this trait is enhancing it for
  * checking of smart pointer types as well.
- * The valid pointer types are T*, std::shared_pointer<T> and std::unique_ptr<T>
+ * The valid pointer types are T*, std::shared_ptr<T>, std::unique_ptr<T, Deleter>,
+ * std::weak_ptr<T> and the types smart_pointer_traits is specialized for.
  *
  * Potential use cases are for static assert when passing a template parameter requiring this
  * parameter to be of type pointer without specifying which type of pointer (raw, smart).
@@ -92,21 +164,174 @@ struct is_pointer
     details::is_smart_pointer<typename std::remove_reference<T>::type>::value;
 };
 
+/// Whether T is a pointer or smart pointer, see is_pointer.
+template<class T>
+inline constexpr bool is_pointer_v = is_pointer<T>::value;
+
 /// Type traits for deducing the data type of T from a pointer or smart pointer.
 /**
  * In comparison to the existing type trait for pointer in the stdlib `std::remove_pointer<T>`
  * https://en.cppreference.com/w/cpp/types/remove_pointer this trait is enhancing it for
  * checking of smart pointer types as well.
- * The valid pointer types are T*, std::shared_pointer<T> and std::unique_ptr<T>
+ * The valid pointer types are the ones of is_pointer; for smart pointers to arrays, such as
+ * `std::unique_ptr<T[]>`, the type is the array element type T.
  *
  */
 template<class T>
 struct remove_pointer
 {
   using type = typename details::remove_pointer<
-    typename std::remove_reference<T>::type, details::is_smart_pointer<T>::value>::type;
+    typename std::remove_reference<T>::type,
+    details::is_smart_pointer<typename std::remove_reference<T>::type>::value>::type;
 };
 
+/// The data type of a pointer or smart pointer, see remove_pointer.
+template<class T>
+using remove_pointer_t = typename remove_pointer<T>::type;
+
+/// Type traits for checking if T is a std::shared_ptr, ignoring cv-qualifiers and references.
+template<class T>
+struct is_shared_pointer : std::false_type
+{};
+
+template<class T>
+struct is_shared_pointer<std::shared_ptr<T>>: std::true_type
+{};
+
+template<class T>
+struct is_shared_pointer<T &>: is_shared_pointer<T>
+{};
+
+template<class T>
+struct is_shared_pointer<T &&>: is_shared_pointer<T>
+{};
+
+template<class T>
+struct is_shared_pointer<const T>: is_shared_pointer<T>
+{};
+
+template<class T>
+struct is_shared_pointer<volatile T>: is_shared_pointer<T>
+{};
+
+template<class T>
+struct is_shared_pointer<const volatile T>: is_shared_pointer<T>
+{};
+
+/// Whether T is a std::shared_ptr, see is_shared_pointer.
+template<class T>
+inline constexpr bool is_shared_pointer_v = is_shared_pointer<T>::value;
+
+/// Type traits for checking if T is a std::unique_ptr with any deleter, ignoring cv-qualifiers
+/// and references.
+/**
+ * Unique pointers are move-only, so generic code can use this trait to pick a branch that takes
+ * ownership of the pointee without copying it.
+ */
+template<class T>
+struct is_unique_pointer : std::false_type
+{};
+
+template<class T, class Deleter>
+struct is_unique_pointer<std::unique_ptr<T, Deleter>>: std::true_type
+{};
+
+template<class T>
+struct is_unique_pointer<T &>: is_unique_pointer<T>
+{};
+
+template<class T>
+struct is_unique_pointer<T &&>: is_unique_pointer<T>
+{};
+
+template<class T>
+struct is_unique_pointer<const T>: is_unique_pointer<T>
+{};
+
+template<class T>
+struct is_unique_pointer<volatile T>: is_unique_pointer<T>
+{};
+
+template<class T>
+struct is_unique_pointer<const volatile T>: is_unique_pointer<T>
+{};
+
+/// Whether T is a std::unique_ptr, see is_unique_pointer.
+template<class T>
+inline constexpr bool is_unique_pointer_v = is_unique_pointer<T>::value;
+
+/// Type traits for checking if T is a std::weak_ptr, ignoring cv-qualifiers and references.
+template<class T>
+struct is_weak_pointer : std::false_type
+{};
+
+template<class T>
+struct is_weak_pointer<std::weak_ptr<T>>: std::true_type
+{};
+
+template<class T>
+struct is_weak_pointer<T &>: is_weak_pointer<T>
+{};
+
+template<class T>
+struct is_weak_pointer<T &&>: is_weak_pointer<T>
+{};
+
+template<class T>
+struct is_weak_pointer<const T>: is_weak_pointer<T>
+{};
+
+template<class T>
+struct is_weak_pointer<volatile T>: is_weak_pointer<T>
+{};
+
+template<class T>
+struct is_weak_pointer<const volatile T>: is_weak_pointer<T>
+{};
+
+/// Whether T is a std::weak_ptr, see is_weak_pointer.
+template<class T>
+inline constexpr bool is_weak_pointer_v = is_weak_pointer<T>::value;
+
+/// Get the address a raw pointer represents, without forming a reference to the pointee.
+/**
+ * Like C++20's `std::to_address`.
+ *
+ * \param[in] p The pointer, which may be null and need not point to a constructed object.
+ * \return p itself.
+ */
+template<class T>
+constexpr T * to_address(T * p) noexcept
+{
+  static_assert(!std::is_function<T>::value, "to_address() requires an object pointer");
+  return p;
+}
+
+/// Get the address a fancy or smart pointer represents, without dereferencing it.
+/**
+ * The address is `std::pointer_traits<Ptr>::to_address(p)` when it is defined, otherwise the
+ * address of `p.operator->()` when it is defined (e.g. std::shared_ptr, std::unique_ptr,
+ * iterators), otherwise `p.get()` (e.g. `std::unique_ptr<T[]>`).
+ * std::weak_ptr has no address; lock it first.
+ *
+ * \param[in] p The pointer, which may be null.
+ * \return The raw pointer to the pointee of p.
+ */
+template<class Ptr, std::enable_if_t<!std::is_pointer<Ptr>::value, int> = 0>
+constexpr auto to_address(const Ptr & p) noexcept
+{
+  if constexpr (details::has_pointer_traits_to_address<Ptr>::value) {
+    return std::pointer_traits<Ptr>::to_address(p);
+  } else if constexpr (details::has_arrow_operator<Ptr>::value) {
+    return rcpputils::to_address(p.operator->());
+  } else {
+    static_assert(
+      details::has_get<Ptr>::value,
+      "to_address() requires a pointer with pointer_traits::to_address, operator-> or get()");
+    return rcpputils::to_address(p.get());
+  }
+}
+
 }  // namespace rcpputils
 
 #endif  // RCPPUTILS__POINTER_TRAITS_HPP_
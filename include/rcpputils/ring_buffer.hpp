@@ -0,0 +1,747 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/*! \file ring_buffer.hpp
+ * \brief Bounded lock-free queues for handing values between threads.
+ *
+ * Two variants are provided:
+ *  * SpscRingBuffer, for exactly one producer thread and one consumer thread
+ *  * MpmcRingBuffer, for any number of producer and consumer threads
+ *
+ * Both have a fixed capacity, rounded up to a power of two, and never allocate after
+ * construction. The `try_*` operations never block and report whether they succeeded.
+ * The blocking push() and pop() operations wait according to a wait policy:
+ *  * SpinWait busy-waits, for the lowest latency when both sides have their own core
+ *  * YieldWait yields the processor between attempts
+ *  * FutexWait sleeps in the kernel until the other side makes progress (Linux only, other
+ *    platforms fall back to yielding)
+ *
+ * Example:
+ *
+ *     rcpputils::SpscRingBuffer<int, rcpputils::FutexWait> queue(1024);
+ *     std::thread producer([&queue] {for (int i = 0; i < 100; ++i) {queue.push(i);}});
+ *     for (int i = 0; i < 100; ++i) {
+ *       assert(queue.pop() == i);
+ *     }
+ *     producer.join();
+ */
+
+#ifndef RCPPUTILS__RING_BUFFER_HPP_
+#define RCPPUTILS__RING_BUFFER_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "rcpputils/detail/cpu_relax.hpp"
+
+namespace rcpputils
+{
+
+/// Assumed size of a cache line; indices written by different threads are kept this far apart.
+inline constexpr std::size_t kCacheLineSize = 64;
+
+namespace detail
+{
+
+/// Round up to the next power of two, at least minimum.
+inline std::size_t ring_buffer_capacity(std::size_t requested, std::size_t minimum)
+{
+  if (requested == 0) {
+    throw std::invalid_argument("ring buffer capacity must be greater than zero");
+  }
+  if (requested > (std::size_t(1) << (sizeof(std::size_t) * 8 - 2))) {
+    throw std::length_error("ring buffer capacity is too large");
+  }
+  std::size_t capacity = minimum;
+  while (capacity < requested) {
+    capacity <<= 1;
+  }
+  return capacity;
+}
+
+/// Uninitialized storage for one element.
+template<typename T>
+struct alignas(T) RingBufferStorage
+{
+  unsigned char bytes[sizeof(T)];
+
+  T * get() noexcept
+  {
+    return std::launder(reinterpret_cast<T *>(bytes));
+  }
+
+  template<typename ... Args>
+  void construct(Args && ... args) noexcept(std::is_nothrow_constructible<T, Args...>::value)
+  {
+    ::new (static_cast<void *>(bytes)) T(std::forward<Args>(args)...);
+  }
+
+  void destroy() noexcept
+  {
+    get()->~T();
+  }
+};
+
+/// Retry try_operation until it succeeds, waiting on policy in between, see SpinWait.
+template<typename WaitPolicy, typename TryOperation>
+void wait_until(WaitPolicy & policy, TryOperation && try_operation)
+{
+  for (unsigned attempt = 0; attempt < WaitPolicy::kYieldAttempts; ++attempt) {
+    if (try_operation()) {
+      return;
+    }
+    std::this_thread::yield();
+  }
+  while (!try_operation()) {
+    const std::uint32_t token = policy.prepare_wait();
+    if (try_operation()) {
+      policy.cancel_wait();
+      return;
+    }
+    policy.wait(token);
+  }
+}
+
+}  // namespace detail
+
+/// Wait policy which busy-waits.
+/**
+ * A wait policy is used by the blocking queue operations, with the protocol:
+ *
+ *     while (!try_operation()) {
+ *       auto token = policy.prepare_wait();
+ *       if (try_operation()) {policy.cancel_wait(); break;}
+ *       policy.wait(token);
+ *     }
+ *
+ * and the other side calls notify() after each successful operation.
+ * wait() may return spuriously. Before that protocol starts, the operation is retried
+ * kYieldAttempts times, yielding in between.
+ */
+class SpinWait
+{
+public:
+  /// Number of attempts before the wait protocol starts.
+  static constexpr unsigned kYieldAttempts = 0;
+
+  /// Announce the caller is about to wait, see the class documentation.
+  std::uint32_t prepare_wait() noexcept
+  {
+    return 0;
+  }
+
+  /// Withdraw a prepare_wait() without waiting.
+  void cancel_wait() noexcept {}
+
+  /// Wait for a notification after the prepare_wait() which returned token.
+  void wait(std::uint32_t token) noexcept
+  {
+    (void)token;
+    detail::cpu_relax();
+  }
+
+  /// Wake up waiting threads.
+  void notify() noexcept {}
+};
+
+/// Wait policy which yields the processor between attempts.
+class YieldWait
+{
+public:
+  /// \copydoc SpinWait::kYieldAttempts
+  static constexpr unsigned kYieldAttempts = 0;
+
+  /// \copydoc SpinWait::prepare_wait()
+  std::uint32_t prepare_wait() noexcept
+  {
+    return 0;
+  }
+
+  /// \copydoc SpinWait::cancel_wait()
+  void cancel_wait() noexcept {}
+
+  /// \copydoc SpinWait::wait()
+  void wait(std::uint32_t token) noexcept
+  {
+    (void)token;
+    std::this_thread::yield();
+  }
+
+  /// \copydoc SpinWait::notify()
+  void notify() noexcept {}
+};
+
+/// Wait policy which sleeps in the kernel until notified.
+/**
+ * Waiting threads yield a few times before going to sleep, since hand-offs are often only
+ * a few microseconds apart. notify() only costs a system call while a thread is actually
+ * sleeping. On platforms without futexes waiting threads yield instead.
+ */
+class FutexWait
+{
+public:
+  /// \copydoc SpinWait::kYieldAttempts
+  static constexpr unsigned kYieldAttempts = 64;
+
+  /// \copydoc SpinWait::prepare_wait()
+  std::uint32_t prepare_wait() noexcept
+  {
+    waiters_.fetch_add(1, std::memory_order_seq_cst);
+    return epoch_.load(std::memory_order_seq_cst);
+  }
+
+  /// \copydoc SpinWait::cancel_wait()
+  void cancel_wait() noexcept
+  {
+    waiters_.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  /// \copydoc SpinWait::wait()
+  void wait(std::uint32_t token) noexcept
+  {
+#ifdef __linux__
+    // Returns immediately if notify() ran since prepare_wait().
+    syscall(
+      SYS_futex, reinterpret_cast<std::uint32_t *>(&epoch_), FUTEX_WAIT_PRIVATE, token,
+      nullptr, nullptr, 0);
+#else
+    (void)token;
+    std::this_thread::yield();
+#endif
+    waiters_.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  /// \copydoc SpinWait::notify()
+  void notify() noexcept
+  {
+    // Pairs with prepare_wait(): either the waiter sees the new element, or this sees the waiter.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters_.load(std::memory_order_relaxed) == 0) {
+      return;
+    }
+    epoch_.fetch_add(1, std::memory_order_seq_cst);
+#ifdef __linux__
+    syscall(
+      SYS_futex, reinterpret_cast<std::uint32_t *>(&epoch_), FUTEX_WAKE_PRIVATE, INT32_MAX,
+      nullptr, nullptr, 0);
+#endif
+  }
+
+private:
+  static_assert(
+    sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t),
+    "futex word must be a plain 32 bit integer");
+
+  std::atomic<std::uint32_t> epoch_{0};
+  std::atomic<std::uint32_t> waiters_{0};
+};
+
+/// Bounded lock-free queue for one producer thread and one consumer thread.
+/**
+ * At any time at most one thread may call the push operations, and at most one thread the pop
+ * operations. The producer and the consumer index live on separate cache lines, and each side
+ * keeps a cached copy of the other side's index so it only reads the shared one when the
+ * queue looks full (or empty).
+ *
+ * \tparam T element type; its move constructor and destructor must not throw
+ * \tparam WaitPolicy how the blocking push() and pop() wait, see SpinWait
+ */
+template<typename T, typename WaitPolicy = SpinWait>
+class SpscRingBuffer
+{
+  static_assert(
+    std::is_nothrow_move_constructible<T>::value && std::is_nothrow_destructible<T>::value,
+    "ring buffer elements must be nothrow move constructible and destructible");
+
+public:
+  using value_type = T;
+
+  /// Create an empty queue.
+  /**
+   * \param[in] capacity minimum number of elements the queue can hold; rounded up to a power of
+   * two
+   * \throws std::invalid_argument if capacity is zero
+   * \throws std::length_error if capacity is too large
+   */
+  explicit SpscRingBuffer(std::size_t capacity)
+  : mask_(detail::ring_buffer_capacity(capacity, 1) - 1),
+    slots_(new detail::RingBufferStorage<T>[mask_ + 1])
+  {}
+
+  SpscRingBuffer(const SpscRingBuffer &) = delete;
+  SpscRingBuffer & operator=(const SpscRingBuffer &) = delete;
+
+  ~SpscRingBuffer()
+  {
+    const std::size_t tail = tail_.load(std::memory_order_relaxed);
+    for (std::size_t i = head_.load(std::memory_order_relaxed); i != tail; ++i) {
+      slots_[i & mask_].destroy();
+    }
+  }
+
+  /// Get the number of elements the queue can hold.
+  std::size_t capacity() const noexcept
+  {
+    return mask_ + 1;
+  }
+
+  /// Get the number of queued elements; only a snapshot while other threads use the queue.
+  std::size_t size() const noexcept
+  {
+    const std::size_t head = head_.load(std::memory_order_acquire);
+    return tail_.load(std::memory_order_acquire) - head;
+  }
+
+  /// Check if the queue is empty; only a snapshot while other threads use the queue.
+  bool empty() const noexcept
+  {
+    return size() == 0;
+  }
+
+  /// Construct an element in place at the end of the queue, if there is room.
+  /**
+   * Producer only.
+   * \return true if the element was queued, false if the queue was full.
+   */
+  template<typename ... Args>
+  bool try_emplace(Args && ... args)
+  {
+    const std::size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - cached_head_ > mask_) {
+      cached_head_ = head_.load(std::memory_order_acquire);
+      if (tail - cached_head_ > mask_) {
+        return false;
+      }
+    }
+    slots_[tail & mask_].construct(std::forward<Args>(args)...);
+    tail_.store(tail + 1, std::memory_order_release);
+    not_empty_.notify();
+    return true;
+  }
+
+  /// Copy an element to the end of the queue, if there is room.
+  /// \copydetails try_emplace()
+  bool try_push(const T & value)
+  {
+    return try_emplace(value);
+  }
+
+  /// Move an element to the end of the queue, if there is room.
+  /// \copydetails try_emplace()
+  bool try_push(T && value)
+  {
+    return try_emplace(std::move(value));
+  }
+
+  /// Queue as many of count elements as there is room for, with a single index update.
+  /**
+   * Producer only. Elements are copied, use std::make_move_iterator() to move them instead.
+   * If a constructor throws, the elements constructed before it are queued and the exception
+   * is rethrown.
+   *
+   * \param[in] first iterator to the first element to queue
+   * \param[in] count number of elements available from first
+   * \return The number of elements queued, from the front of the range.
+   */
+  template<typename InputIt>
+  std::size_t try_push_n(InputIt first, std::size_t count)
+  {
+    const std::size_t tail = tail_.load(std::memory_order_relaxed);
+    std::size_t room = capacity() - (tail - cached_head_);
+    if (room < count) {
+      cached_head_ = head_.load(std::memory_order_acquire);
+      room = capacity() - (tail - cached_head_);
+    }
+    const std::size_t n = count < room ? count : room;
+    std::size_t i = 0;
+    try {
+      for (; i < n; ++i, ++first) {
+        slots_[(tail + i) & mask_].construct(*first);
+      }
+    } catch (...) {
+      publish(tail, i);
+      throw;
+    }
+    publish(tail, n);
+    return n;
+  }
+
+  /// Move the element at the front of the queue into value, if there is one.
+  /**
+   * Consumer only.
+   * \return true if an element was taken, false if the queue was empty.
+   */
+  bool try_pop(T & value)
+  {
+    const std::size_t head = head_.load(std::memory_order_relaxed);
+    if (head == cached_tail_) {
+      cached_tail_ = tail_.load(std::memory_order_acquire);
+      if (head == cached_tail_) {
+        return false;
+      }
+    }
+    auto & slot = slots_[head & mask_];
+    value = std::move(*slot.get());
+    slot.destroy();
+    head_.store(head + 1, std::memory_order_release);
+    not_full_.notify();
+    return true;
+  }
+
+  /// Take up to max_count elements from the front of the queue, with a single index update.
+  /**
+   * Consumer only.
+   * \param[out] out output iterator the elements are moved to, in queue order
+   * \param[in] max_count maximum number of elements to take
+   * \return The number of elements taken.
+   */
+  template<typename OutputIt>
+  std::size_t try_pop_n(OutputIt out, std::size_t max_count)
+  {
+    const std::size_t head = head_.load(std::memory_order_relaxed);
+    std::size_t available = cached_tail_ - head;
+    if (available < max_count) {
+      cached_tail_ = tail_.load(std::memory_order_acquire);
+      available = cached_tail_ - head;
+    }
+    const std::size_t n = max_count < available ? max_count : available;
+    for (std::size_t i = 0; i < n; ++i) {
+      auto & slot = slots_[(head + i) & mask_];
+      *out = std::move(*slot.get());
+      ++out;
+      slot.destroy();
+    }
+    if (n != 0) {
+      head_.store(head + n, std::memory_order_release);
+      not_full_.notify();
+    }
+    return n;
+  }
+
+  /// Move an element to the end of the queue, waiting while it is full.
+  void push(T value)
+  {
+    detail::wait_until(not_full_, [this, &value]() {return try_emplace(std::move(value));});
+  }
+
+  /// Take the element at the front of the queue, waiting while it is empty.
+  T pop()
+  {
+    const std::size_t head = head_.load(std::memory_order_relaxed);
+    if (head == cached_tail_) {
+      detail::wait_until(
+        not_empty_, [this, head]() {
+          cached_tail_ = tail_.load(std::memory_order_acquire);
+          return head != cached_tail_;
+        });
+    }
+    auto & slot = slots_[head & mask_];
+    T value(std::move(*slot.get()));
+    slot.destroy();
+    head_.store(head + 1, std::memory_order_release);
+    not_full_.notify();
+    return value;
+  }
+
+private:
+  void publish(std::size_t tail, std::size_t n) noexcept
+  {
+    if (n != 0) {
+      tail_.store(tail + n, std::memory_order_release);
+      not_empty_.notify();
+    }
+  }
+
+  // Consumer side.
+  alignas(kCacheLineSize) std::atomic<std::size_t> head_{0};
+  std::size_t cached_tail_{0};
+  WaitPolicy not_full_;
+
+  // Producer side.
+  alignas(kCacheLineSize) std::atomic<std::size_t> tail_{0};
+  std::size_t cached_head_{0};
+  WaitPolicy not_empty_;
+
+  // Read-only after construction.
+  alignas(kCacheLineSize) const std::size_t mask_;
+  std::unique_ptr<detail::RingBufferStorage<T>[]> slots_;
+};
+
+/// Bounded lock-free queue for any number of producer and consumer threads.
+/**
+ * Every slot carries a sequence number telling whether it is ready to be written or read in the
+ * current round, so producers and consumers only contend on their own index (Dmitry Vyukov's
+ * bounded MPMC queue).
+ *
+ * \tparam T element type; its move constructor and destructor must not throw
+ * \tparam WaitPolicy how the blocking push() and pop() wait, see SpinWait
+ */
+template<typename T, typename WaitPolicy = SpinWait>
+class MpmcRingBuffer
+{
+  static_assert(
+    std::is_nothrow_move_constructible<T>::value && std::is_nothrow_destructible<T>::value,
+    "ring buffer elements must be nothrow move constructible and destructible");
+
+public:
+  using value_type = T;
+
+  /// Create an empty queue.
+  /**
+   * \param[in] capacity minimum number of elements the queue can hold; rounded up to a power of
+   * two, and at least 2
+   * \throws std::invalid_argument if capacity is zero
+   * \throws std::length_error if capacity is too large
+   */
+  explicit MpmcRingBuffer(std::size_t capacity)
+  : mask_(detail::ring_buffer_capacity(capacity, 2) - 1),
+    cells_(new Cell[mask_ + 1])
+  {
+    for (std::size_t i = 0; i <= mask_; ++i) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  MpmcRingBuffer(const MpmcRingBuffer &) = delete;
+  MpmcRingBuffer & operator=(const MpmcRingBuffer &) = delete;
+
+  ~MpmcRingBuffer()
+  {
+    const std::size_t tail = enqueue_pos_.load(std::memory_order_relaxed);
+    for (std::size_t i = dequeue_pos_.load(std::memory_order_relaxed); i != tail; ++i) {
+      cells_[i & mask_].storage.destroy();
+    }
+  }
+
+  /// Get the number of elements the queue can hold.
+  std::size_t capacity() const noexcept
+  {
+    return mask_ + 1;
+  }
+
+  /// Get the number of queued elements; only a snapshot while other threads use the queue.
+  /**
+   * Elements still being written or read by other threads are included.
+   */
+  std::size_t size() const noexcept
+  {
+    const std::size_t head = dequeue_pos_.load(std::memory_order_acquire);
+    const std::size_t tail = enqueue_pos_.load(std::memory_order_acquire);
+    return tail > head ? tail - head : 0;
+  }
+
+  /// Check if the queue is empty; only a snapshot while other threads use the queue.
+  bool empty() const noexcept
+  {
+    return size() == 0;
+  }
+
+  /// Construct an element at the end of the queue, if there is room.
+  /**
+   * The element is constructed before a slot is claimed, so a throwing constructor leaves the
+   * queue unchanged.
+   * \return true if the element was queued, false if the queue was full.
+   */
+  template<typename ... Args>
+  bool try_emplace(Args && ... args)
+  {
+    return enqueue(T(std::forward<Args>(args)...));
+  }
+
+  /// Copy an element to the end of the queue, if there is room.
+  /// \copydetails try_emplace()
+  bool try_push(const T & value)
+  {
+    return enqueue(T(value));
+  }
+
+  /// Move an element to the end of the queue, if there is room.
+  /// \copydetails try_emplace()
+  bool try_push(T && value)
+  {
+    return enqueue(std::move(value));
+  }
+
+  /// Queue as many of count elements as there is room for.
+  /**
+   * Elements of one batch may be interleaved with those of other producers.
+   * Elements are copied, use std::make_move_iterator() to move them instead.
+   * Each element is constructed before its slot is claimed, so a throwing constructor leaves the
+   * elements queued so far in place and the queue usable.
+   *
+   * \param[in] first iterator to the first element to queue
+   * \param[in] count number of elements available from first
+   * \return The number of elements queued, from the front of the range.
+   */
+  template<typename InputIt>
+  std::size_t try_push_n(InputIt first, std::size_t count)
+  {
+    std::size_t n = 0;
+    for (; n < count; ++n, ++first) {
+      if (!enqueue(T(*first), false)) {
+        break;
+      }
+    }
+    if (n != 0) {
+      not_empty_.notify();
+    }
+    return n;
+  }
+
+  /// Move the element at the front of the queue into value, if there is one.
+  /**
+   * \return true if an element was taken, false if the queue was empty.
+   */
+  bool try_pop(T & value)
+  {
+    return dequeue(
+      [&value](T && element) {
+        value = std::move(element);
+      });
+  }
+
+  /// Take up to max_count elements from the front of the queue.
+  /**
+   * \param[out] out output iterator the elements are moved to, in the order they were taken
+   * \param[in] max_count maximum number of elements to take
+   * \return The number of elements taken.
+   */
+  template<typename OutputIt>
+  std::size_t try_pop_n(OutputIt out, std::size_t max_count)
+  {
+    std::size_t n = 0;
+    auto sink = [&out](T && element) {
+        *out = std::move(element);
+        ++out;
+      };
+    while (n < max_count && dequeue(sink, false)) {
+      ++n;
+    }
+    if (n != 0) {
+      not_full_.notify();
+    }
+    return n;
+  }
+
+  /// Move an element to the end of the queue, waiting while it is full.
+  void push(T value)
+  {
+    detail::wait_until(not_full_, [this, &value]() {return enqueue(std::move(value));});
+  }
+
+  /// Take the element at the front of the queue, waiting while it is empty.
+  T pop()
+  {
+    // Park the element in an uninitialized slot, so T needs no default constructor.
+    detail::RingBufferStorage<T> result;
+    auto sink = [&result](T && element) {
+        result.construct(std::move(element));
+      };
+    detail::wait_until(not_empty_, [this, &sink]() {return dequeue(sink);});
+    T value(std::move(*result.get()));
+    result.destroy();
+    return value;
+  }
+
+private:
+  struct Cell
+  {
+    std::atomic<std::size_t> sequence;
+    detail::RingBufferStorage<T> storage;
+  };
+
+  // Takes an element that already exists: once the slot is claimed nothing may throw, or the cell
+  // would never be published and consumers would stop at it.
+  bool enqueue(T && value, bool notify = true)
+  {
+    std::size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    Cell * cell;
+    for (;; ) {
+      cell = &cells_[pos & mask_];
+      const std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      const auto diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos);
+      if (diff == 0) {
+        if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = enqueue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+    cell->storage.construct(std::move(value));
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    if (notify) {
+      not_empty_.notify();
+    }
+    return true;
+  }
+
+  template<typename Sink>
+  bool dequeue(Sink && sink, bool notify = true)
+  {
+    std::size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    Cell * cell;
+    for (;; ) {
+      cell = &cells_[pos & mask_];
+      const std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      const auto diff =
+        static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos + 1);
+      if (diff == 0) {
+        if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = dequeue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+    sink(std::move(*cell->storage.get()));
+    cell->storage.destroy();
+    cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+    if (notify) {
+      not_full_.notify();
+    }
+    return true;
+  }
+
+  alignas(kCacheLineSize) std::atomic<std::size_t> enqueue_pos_{0};
+  WaitPolicy not_full_;
+
+  alignas(kCacheLineSize) std::atomic<std::size_t> dequeue_pos_{0};
+  WaitPolicy not_empty_;
+
+  alignas(kCacheLineSize) const std::size_t mask_;
+  std::unique_ptr<Cell[]> cells_;
+};
+
+}  // namespace rcpputils
+
+#endif  // RCPPUTILS__RING_BUFFER_HPP_
@@ -15,8 +15,14 @@
 #ifndef RCPPUTILS__SHARED_LIBRARY_HPP_
 #define RCPPUTILS__SHARED_LIBRARY_HPP_
 
+#include <cstddef>
+#include <future>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <stdexcept>
+#include <system_error>
+#include <type_traits>
 
 #include "rcutils/shared_library.h"
 #include "rcpputils/visibility_control.hpp"
@@ -24,6 +30,79 @@
 namespace rcpputils
 {
 
+namespace detail
+{
+class SymbolCache;
+}  // namespace detail
+
+/// Error conditions reported by the non-throwing shared library API.
+enum class shared_library_errc
+{
+  /// The dynamic loader could not load the library.
+  load_failed = 1,
+  /// The dynamic loader could not unload the library.
+  unload_failed,
+  /// The library is not loaded.
+  not_loaded,
+  /// The library does not contain the requested symbol.
+  symbol_not_found,
+  /// A platform library name could not be built from the given name.
+  invalid_library_name
+};
+
+/// Get the error category of shared_library_errc values.
+/**
+ * \return The category, whose message() describes each shared_library_errc.
+ */
+RCPPUTILS_PUBLIC
+const std::error_category &
+shared_library_category() noexcept;
+
+/// Make an error code of the shared library category.
+/**
+ * \param[in] e The error condition.
+ * \return The error code for e.
+ */
+inline std::error_code make_error_code(shared_library_errc e) noexcept
+{
+  return {static_cast<int>(e), shared_library_category()};
+}
+
+/// Options controlling how the dynamic loader opens a shared library.
+/**
+ * These map to the `dlopen` flags of the same name and are ignored on Windows.
+ * They only take effect when the library is not already loaded in the process; otherwise the
+ * loader keeps the existing binding, except that `RTLD_GLOBAL` and `RTLD_NODELETE` can still
+ * be added.
+ */
+struct SharedLibraryLoadOptions
+{
+  /// When undefined symbols of the library are bound.
+  enum class Binding
+  {
+    /// Bind symbols on first use (`RTLD_LAZY`).
+    lazy,
+    /// Bind all symbols while loading (`RTLD_NOW`).
+    now
+  };
+
+  /// Who can see the symbols of the library.
+  enum class Visibility
+  {
+    /// Only lookups through the library handle (`RTLD_LOCAL`).
+    local,
+    /// Also libraries loaded afterwards (`RTLD_GLOBAL`).
+    global
+  };
+
+  /// When undefined symbols of the library are bound.
+  Binding binding = Binding::lazy;
+  /// Who can see the symbols of the library.
+  Visibility visibility = Visibility::local;
+  /// Keep the library mapped after it is unloaded (`RTLD_NODELETE`).
+  bool no_delete = false;
+};
+
 /**
  * This class is an abstraction of rcutils shared library to be able to used it
  *  with modern C++.
@@ -41,18 +120,67 @@ public:
   RCPPUTILS_PUBLIC
   explicit SharedLibrary(const std::string & library_path);
 
+  /// The library is loaded in the constructor, with the given loader options.
+  /**
+   * \param[in] library_path The library string path.
+   * \param[in] options How the dynamic loader opens the library.
+   * \throws std::bad_alloc if allocating storage for the callback fails
+   * \throws std::runtime_error if there are some invalid arguments or the library
+   * was not load properly
+   */
+  RCPPUTILS_PUBLIC
+  SharedLibrary(const std::string & library_path, const SharedLibraryLoadOptions & options);
+
+  /// The library is loaded in the constructor, reporting failures through an error code.
+  /**
+   * Failures don't throw and don't copy the loader's error message. On failure the library
+   * is left unloaded.
+   *
+   * \param[in] library_path The library string path.
+   * \param[out] ec Set to the reason of the failure, cleared otherwise.
+   * \throws std::bad_alloc if allocating storage for the symbol cache fails
+   */
+  RCPPUTILS_PUBLIC
+  SharedLibrary(const std::string & library_path, std::error_code & ec);
+
+  /// The library is loaded in the constructor, reporting failures through an error code.
+  /**
+   * \param[in] library_path The library string path.
+   * \param[in] options How the dynamic loader opens the library.
+   * \param[out] ec Set to the reason of the failure, cleared otherwise.
+   * \throws std::bad_alloc if allocating storage for the symbol cache fails
+   */
+  RCPPUTILS_PUBLIC
+  SharedLibrary(
+    const std::string & library_path, const SharedLibraryLoadOptions & options,
+    std::error_code & ec);
+
   /// The library is unloaded in the deconstructor
   RCPPUTILS_PUBLIC
   virtual ~SharedLibrary();
 
+  SharedLibrary(const SharedLibrary &) = delete;
+  SharedLibrary & operator=(const SharedLibrary &) = delete;
+
   /// Unload library
   /**
+   * Symbols resolved so far are forgotten. This must not be called while other threads
+   * look up symbols in this library.
+   *
   * \throws std::runtime_error if the library is not unloaded properly
    */
   RCPPUTILS_PUBLIC
   void
   unload_library();
 
+  /// Unload library, reporting failures through an error code.
+  /**
+   * \param[out] ec Set to the reason of the failure, cleared otherwise.
+   */
+  RCPPUTILS_PUBLIC
+  void
+  unload_library(std::error_code & ec) noexcept;
+
   /// Return true if the shared library contains a specific symbol name otherwise returns false.
   /**
    * \param[in] symbol_name name of the symbol inside the shared library
@@ -73,6 +201,68 @@ public:
   void *
   get_symbol(const std::string & symbol_name);
 
+  /// Return shared library symbol pointer, reporting failures through an error code.
+  /**
+   * \param[in] symbol_name name of the symbol inside the shared library
+   * \param[out] ec Set to shared_library_errc::symbol_not_found or
+   * shared_library_errc::not_loaded on failure, cleared otherwise.
+   * \return shared library symbol pointer, or nullptr on failure
+   * \throws std::bad_alloc if allocating storage for the cache entry fails
+   */
+  RCPPUTILS_PUBLIC
+  void *
+  get_symbol(std::string_view symbol_name, std::error_code & ec);
+
+  /// Return shared library symbol pointer, converted to the requested pointer type.
+  /**
+   * \tparam T Function or object pointer type of the symbol.
+   * \param[in] symbol_name name of the symbol inside the shared library
+   * \return shared library symbol pointer
+   * \throws std::runtime_error if the symbol doesn't exist in the shared library
+   */
+  template<typename T>
+  T
+  get_symbol(std::string_view symbol_name)
+  {
+    static_assert(std::is_pointer<T>::value, "get_symbol<T>() requires a pointer type");
+    void * symbol = try_get_symbol(symbol_name);
+    if (!symbol) {
+      throw_symbol_not_found(symbol_name);
+    }
+    return reinterpret_cast<T>(symbol);
+  }
+
+  /// Return shared library symbol pointer, or nullptr if it doesn't exist.
+  /**
+   * Lookups are cached per library, both for found and missing symbols: only the first
+   * lookup of a name queries the dynamic loader, and later lookups of the same name from any
+   * thread read the cache without taking a lock.
+   *
+   * \param[in] symbol_name name of the symbol inside the shared library
+   * \return shared library symbol pointer, or nullptr if the symbol doesn't exist or the
+   * library is not loaded
+   * \throws std::bad_alloc if allocating storage for the cache entry fails
+   */
+  RCPPUTILS_PUBLIC
+  void *
+  try_get_symbol(std::string_view symbol_name);
+
+  /// Return shared library symbol pointer, converted to the requested pointer type, or nullptr.
+  /**
+   * \tparam T Function or object pointer type of the symbol.
+   * \param[in] symbol_name name of the symbol inside the shared library
+   * \return shared library symbol pointer, or nullptr if the symbol doesn't exist or the
+   * library is not loaded
+   * \throws std::bad_alloc if allocating storage for the cache entry fails
+   */
+  template<typename T>
+  T
+  try_get_symbol(std::string_view symbol_name)
+  {
+    static_assert(std::is_pointer<T>::value, "try_get_symbol<T>() requires a pointer type");
+    return reinterpret_cast<T>(try_get_symbol(symbol_name));
+  }
+
   /// Return shared library path
   /**
    * \return shared library path or it throws an std::runtime_error if it's not defined
@@ -83,23 +273,157 @@ public:
   get_library_path();
 
 private:
+  [[noreturn]] RCPPUTILS_PUBLIC
+  void
+  throw_symbol_not_found(std::string_view symbol_name);
+
+  void
+  load(
+    const std::string & library_path, const SharedLibraryLoadOptions & options,
+    std::error_code & ec, std::string * error_message);
+
   rcutils_shared_library_t lib;
+  std::unique_ptr<detail::SymbolCache> symbols_;
+};
+
+/// Process-wide registry that loads each shared library at most once.
+/**
+ * Libraries are keyed by their canonical path, so every component asking for the same library
+ * shares a single SharedLibrary instance, including its symbol cache. A library is unloaded when
+ * the last `std::shared_ptr` to it is released, unless deferred unload is enabled.
+ *
+ * All member functions are thread-safe.
+ */
+class SharedLibraryRegistry
+{
+public:
+  /// Get the registry of the process.
+  RCPPUTILS_PUBLIC
+  static
+  SharedLibraryRegistry &
+  instance();
+
+  SharedLibraryRegistry(const SharedLibraryRegistry &) = delete;
+  SharedLibraryRegistry & operator=(const SharedLibraryRegistry &) = delete;
+
+  /// Get the library at the given path, loading it if it is not loaded yet.
+  /**
+   * \param[in] library_path The library string path.
+   * \return The shared library instance for the canonical form of the path.
+   * \throws std::bad_alloc if allocating storage fails
+   * \throws std::runtime_error if the library was not loaded properly
+   */
+  RCPPUTILS_PUBLIC
+  std::shared_ptr<SharedLibrary>
+  load(const std::string & library_path);
+
+  /// Get the library at the given path, loading it with the given options if it is not loaded.
+  /**
+   * Loads of different libraries run concurrently; concurrent loads of the same library wait
+   * for a single load. The options of an already loaded library are not changed.
+   *
+   * \param[in] library_path The library string path.
+   * \param[in] options How the dynamic loader opens the library.
+   * \return The shared library instance for the canonical form of the path.
+   * \throws std::bad_alloc if allocating storage fails
+   * \throws std::runtime_error if the library was not loaded properly
+   */
+  RCPPUTILS_PUBLIC
+  std::shared_ptr<SharedLibrary>
+  load(const std::string & library_path, const SharedLibraryLoadOptions & options);
+
+  /// Load a library in the background.
+  /**
+   * The load runs like load() on a small pool of worker threads shared by the process, so a
+   * set of libraries can be opened concurrently while the caller keeps initializing.
+   *
+   * \param[in] library_path The library string path.
+   * \param[in] options How the dynamic loader opens the library.
+   * \return A future for the shared library instance; it rethrows the exceptions of load().
+   */
+  RCPPUTILS_PUBLIC
+  std::future<std::shared_ptr<SharedLibrary>>
+  load_async(
+    const std::string & library_path,
+    const SharedLibraryLoadOptions & options = SharedLibraryLoadOptions());
+
+  /// Keep libraries loaded after their last user releases them.
+  /**
+   * While enabled, the registry holds a reference to every library it loads, so creating and
+   * destroying components in a loop does not unload and reload their libraries. Retained
+   * libraries are unloaded by release_deferred(), or at process shutdown.
+   * Disabling deferred unload releases the retained libraries.
+   *
+   * \param[in] enabled Whether to defer unloading.
+   */
+  RCPPUTILS_PUBLIC
+  void
+  set_deferred_unload(bool enabled);
+
+  /// Check whether unloading is deferred.
+  /**
+   * \return true if set_deferred_unload(true) is in effect.
+   */
+  RCPPUTILS_PUBLIC
+  bool
+  deferred_unload() const;
+
+  /// Release the libraries retained because of deferred unload.
+  /**
+   * Libraries without other users are unloaded.
+   */
+  RCPPUTILS_PUBLIC
+  void
+  release_deferred();
+
+  /// Get the number of libraries currently loaded through the registry.
+  /**
+   * \return The number of live library instances.
+   */
+  RCPPUTILS_PUBLIC
+  size_t
+  size() const;
+
+private:
+  SharedLibraryRegistry();
+
+  struct Impl;
+  std::shared_ptr<Impl> impl_;
 };
 
 /// Get the platform specific library name
 /**
- * The maximum file name size is 1024 characters, if the input library_name is bigger than
- * this value then the method throws an exception.
+ * The name follows the rules of rcpputils/platform_library_name.hpp, which also provides
+ * compile-time and caller-buffer variants. There is no limit on the length of the name.
  *
- * \param[in] symbol_name library base name (without prefix and extension)
+ * \param[in] library_name library base name (without prefix and extension)
  * \param[in] debug if true the library will return a debug library name, otherwise
  * it returns a normal library path
  * \return platform specific library name
- * \throws std::runtime_error if it's not able to create the library name
+ * \throws std::runtime_error if library_name contains a null character
+ */
+RCPPUTILS_PUBLIC
+std::string get_platform_library_name(const std::string & library_name, bool debug = false);
+
+/// Get the platform specific library name, reporting failures through an error code.
+/**
+ * \param[in] library_name library base name (without prefix and extension)
+ * \param[in] debug if true the library will return a debug library name, otherwise
+ * it returns a normal library path
+ * \param[out] ec Set to shared_library_errc::invalid_library_name if library_name contains a
+ * null character, cleared otherwise.
+ * \return platform specific library name, or "" on failure
  */
 RCPPUTILS_PUBLIC
-std::string get_platform_library_name(std::string library_name, bool debug = false);
+std::string get_platform_library_name(
+  const std::string & library_name, bool debug, std::error_code & ec);
 
 }  // namespace rcpputils
 
+namespace std
+{
+template<>
+struct is_error_code_enum<rcpputils::shared_library_errc>: true_type {};
+}  // namespace std
+
 #endif  // RCPPUTILS__SHARED_LIBRARY_HPP_
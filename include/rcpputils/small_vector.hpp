@@ -0,0 +1,722 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/*! \file small_vector.hpp
+ * \brief A vector which stores up to N elements inline, without allocating.
+ *
+ * rcpputils::small_vector has the interface of `std::vector`, but its first N elements live
+ * inside the object itself; only growing beyond N allocates storage from the allocator.
+ * Short sequences, like the tokens of a topic name or the components of a path, then cost no
+ * heap allocation at all:
+ *
+ *     auto tokens = rcpputils::split<rcpputils::small_vector<std::string_view, 8>>(topic, '/');
+ *
+ * Unlike `std::vector`, moving a small_vector which uses its inline storage moves its elements
+ * one by one, and invalidates iterators into the source.
+ */
+
+#ifndef RCPPUTILS__SMALL_VECTOR_HPP_
+#define RCPPUTILS__SMALL_VECTOR_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace rcpputils
+{
+
+/// A sequence container storing up to N elements inline; see the file documentation.
+/**
+ * \tparam T The element type.
+ * \tparam N The number of elements stored inline, at least 1.
+ * \tparam Allocator The allocator used once the container grows beyond N elements.
+ */
+template<typename T, std::size_t N, typename Allocator = std::allocator<T>>
+class small_vector
+{
+  static_assert(N > 0u, "small_vector needs an inline capacity of at least one element");
+  static_assert(
+    std::is_same<typename Allocator::value_type, T>::value,
+    "Allocator::value_type must be T");
+
+  using allocator_traits = std::allocator_traits<Allocator>;
+
+public:
+  using value_type = T;
+  using allocator_type = Allocator;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference = value_type &;
+  using const_reference = const value_type &;
+  using pointer = value_type *;
+  using const_pointer = const value_type *;
+  using iterator = value_type *;
+  using const_iterator = const value_type *;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  /// Number of elements stored without allocating.
+  static constexpr size_type inline_capacity = N;
+
+  small_vector() noexcept(noexcept(Allocator()))
+  : small_vector(Allocator())
+  {}
+
+  explicit small_vector(const Allocator & allocator) noexcept
+  : allocator_(allocator), data_(inline_data())
+  {}
+
+  explicit small_vector(size_type count, const Allocator & allocator = Allocator())
+  : small_vector(allocator)
+  {
+    resize(count);
+  }
+
+  small_vector(size_type count, const T & value, const Allocator & allocator = Allocator())
+  : small_vector(allocator)
+  {
+    assign(count, value);
+  }
+
+  template<
+    typename InputIt,
+    typename = typename std::iterator_traits<InputIt>::iterator_category>
+  small_vector(InputIt first, InputIt last, const Allocator & allocator = Allocator())
+  : small_vector(allocator)
+  {
+    assign(first, last);
+  }
+
+  small_vector(std::initializer_list<T> values, const Allocator & allocator = Allocator())
+  : small_vector(allocator)
+  {
+    assign(values.begin(), values.end());
+  }
+
+  small_vector(const small_vector & other)
+  : small_vector(allocator_traits::select_on_container_copy_construction(other.allocator_))
+  {
+    assign(other.begin(), other.end());
+  }
+
+  small_vector(const small_vector & other, const Allocator & allocator)
+  : small_vector(allocator)
+  {
+    assign(other.begin(), other.end());
+  }
+
+  small_vector(small_vector && other) noexcept(std::is_nothrow_move_constructible<T>::value)
+  : small_vector(std::move(other.allocator_))
+  {
+    take(other);
+  }
+
+  small_vector(small_vector && other, const Allocator & allocator)
+  : small_vector(allocator)
+  {
+    if (other.allocator_ == allocator_) {
+      take(other);
+    } else {
+      assign(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+      other.clear();
+    }
+  }
+
+  ~small_vector()
+  {
+    clear();
+    release_heap();
+  }
+
+  small_vector & operator=(const small_vector & other)
+  {
+    if (this != &other) {
+      if constexpr (allocator_traits::propagate_on_container_copy_assignment::value) {
+        if (allocator_ != other.allocator_) {
+          // Storage from the old allocator cannot be returned through the new one.
+          clear();
+          release_heap();
+        }
+        allocator_ = other.allocator_;
+      }
+      assign(other.begin(), other.end());
+    }
+    return *this;
+  }
+
+  small_vector & operator=(small_vector && other) noexcept(
+    std::is_nothrow_move_constructible<T>::value &&
+    std::is_nothrow_move_assignable<T>::value &&
+    (allocator_traits::propagate_on_container_move_assignment::value ||
+    allocator_traits::is_always_equal::value))
+  {
+    if (this == &other) {
+      return *this;
+    }
+    constexpr bool propagate = allocator_traits::propagate_on_container_move_assignment::value;
+    if (propagate || allocator_ == other.allocator_) {
+      clear();
+      release_heap();
+      if constexpr (propagate) {
+        allocator_ = std::move(other.allocator_);
+      }
+      take(other);
+    } else {
+      assign(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+      other.clear();
+    }
+    return *this;
+  }
+
+  small_vector & operator=(std::initializer_list<T> values)
+  {
+    assign(values.begin(), values.end());
+    return *this;
+  }
+
+  void assign(size_type count, const T & value)
+  {
+    if (count > capacity()) {
+      // value may be an element of this vector.
+      small_vector replacement(count, value, allocator_);
+      *this = std::move(replacement);
+      return;
+    }
+    std::fill_n(begin(), std::min(count, size_), value);
+    if (count > size_) {
+      construct_at_end(count - size_, value);
+    } else {
+      destroy_from(begin() + count);
+    }
+  }
+
+  template<
+    typename InputIt,
+    typename = typename std::iterator_traits<InputIt>::iterator_category>
+  void assign(InputIt first, InputIt last)
+  {
+    iterator out = begin();
+    for (; first != last && out != end(); ++first, ++out) {
+      *out = *first;
+    }
+    if (out != end()) {
+      destroy_from(out);
+    } else {
+      for (; first != last; ++first) {
+        emplace_back(*first);
+      }
+    }
+  }
+
+  void assign(std::initializer_list<T> values)
+  {
+    assign(values.begin(), values.end());
+  }
+
+  allocator_type get_allocator() const noexcept
+  {
+    return allocator_;
+  }
+
+  reference at(size_type pos)
+  {
+    if (pos >= size_) {
+      throw std::out_of_range("small_vector::at: index out of range");
+    }
+    return data_[pos];
+  }
+
+  const_reference at(size_type pos) const
+  {
+    if (pos >= size_) {
+      throw std::out_of_range("small_vector::at: index out of range");
+    }
+    return data_[pos];
+  }
+
+  reference operator[](size_type pos) noexcept
+  {
+    return data_[pos];
+  }
+
+  const_reference operator[](size_type pos) const noexcept
+  {
+    return data_[pos];
+  }
+
+  reference front() noexcept
+  {
+    return data_[0];
+  }
+
+  const_reference front() const noexcept
+  {
+    return data_[0];
+  }
+
+  reference back() noexcept
+  {
+    return data_[size_ - 1u];
+  }
+
+  const_reference back() const noexcept
+  {
+    return data_[size_ - 1u];
+  }
+
+  T * data() noexcept
+  {
+    return data_;
+  }
+
+  const T * data() const noexcept
+  {
+    return data_;
+  }
+
+  iterator begin() noexcept
+  {
+    return data_;
+  }
+
+  const_iterator begin() const noexcept
+  {
+    return data_;
+  }
+
+  const_iterator cbegin() const noexcept
+  {
+    return data_;
+  }
+
+  iterator end() noexcept
+  {
+    return data_ + size_;
+  }
+
+  const_iterator end() const noexcept
+  {
+    return data_ + size_;
+  }
+
+  const_iterator cend() const noexcept
+  {
+    return data_ + size_;
+  }
+
+  reverse_iterator rbegin() noexcept
+  {
+    return reverse_iterator(end());
+  }
+
+  const_reverse_iterator rbegin() const noexcept
+  {
+    return const_reverse_iterator(end());
+  }
+
+  const_reverse_iterator crbegin() const noexcept
+  {
+    return rbegin();
+  }
+
+  reverse_iterator rend() noexcept
+  {
+    return reverse_iterator(begin());
+  }
+
+  const_reverse_iterator rend() const noexcept
+  {
+    return const_reverse_iterator(begin());
+  }
+
+  const_reverse_iterator crend() const noexcept
+  {
+    return rend();
+  }
+
+  bool empty() const noexcept
+  {
+    return size_ == 0u;
+  }
+
+  size_type size() const noexcept
+  {
+    return size_;
+  }
+
+  size_type max_size() const noexcept
+  {
+    return std::min<size_type>(
+      allocator_traits::max_size(allocator_),
+      std::numeric_limits<difference_type>::max() / sizeof(T));
+  }
+
+  size_type capacity() const noexcept
+  {
+    return capacity_;
+  }
+
+  /// Check whether the elements are stored inline, rather than in allocated storage.
+  bool is_inline() const noexcept
+  {
+    return data_ == inline_data();
+  }
+
+  void reserve(size_type new_capacity)
+  {
+    if (new_capacity > capacity_) {
+      reallocate(new_capacity);
+    }
+  }
+
+  /// Release unused allocated storage, moving the elements back inline if they fit.
+  void shrink_to_fit()
+  {
+    if (is_inline() || size_ == capacity_) {
+      return;
+    }
+    if (size_ <= N) {
+      T * heap = data_;
+      const size_type heap_capacity = capacity_;
+      relocate(heap, size_, inline_data());
+      allocator_traits::deallocate(allocator_, heap, heap_capacity);
+      data_ = inline_data();
+      capacity_ = N;
+    } else {
+      reallocate(size_);
+    }
+  }
+
+  void clear() noexcept
+  {
+    destroy_from(begin());
+  }
+
+  iterator insert(const_iterator pos, const T & value)
+  {
+    return emplace(pos, value);
+  }
+
+  iterator insert(const_iterator pos, T && value)
+  {
+    return emplace(pos, std::move(value));
+  }
+
+  iterator insert(const_iterator pos, size_type count, const T & value)
+  {
+    const size_type offset = static_cast<size_type>(pos - begin());
+    const size_type old_size = size_;
+    if (size_ + count > capacity_) {
+      // value may be an element of this vector.
+      T copy(value);
+      reserve(grown_capacity(size_ + count));
+      construct_at_end(count, copy);
+    } else {
+      construct_at_end(count, value);
+    }
+    std::rotate(begin() + offset, begin() + old_size, end());
+    return begin() + offset;
+  }
+
+  template<
+    typename InputIt,
+    typename = typename std::iterator_traits<InputIt>::iterator_category>
+  iterator insert(const_iterator pos, InputIt first, InputIt last)
+  {
+    const size_type offset = static_cast<size_type>(pos - begin());
+    const size_type old_size = size_;
+    for (; first != last; ++first) {
+      emplace_back(*first);
+    }
+    std::rotate(begin() + offset, begin() + old_size, end());
+    return begin() + offset;
+  }
+
+  iterator insert(const_iterator pos, std::initializer_list<T> values)
+  {
+    return insert(pos, values.begin(), values.end());
+  }
+
+  template<typename ... Args>
+  iterator emplace(const_iterator pos, Args && ... args)
+  {
+    const size_type offset = static_cast<size_type>(pos - begin());
+    if (offset == size_) {
+      emplace_back(std::forward<Args>(args)...);
+    } else {
+      // The arguments may refer to elements which are about to move.
+      T value(std::forward<Args>(args)...);
+      emplace_back(std::move(value));
+      std::rotate(begin() + offset, end() - 1, end());
+    }
+    return begin() + offset;
+  }
+
+  iterator erase(const_iterator pos)
+  {
+    return erase(pos, pos + 1);
+  }
+
+  iterator erase(const_iterator first, const_iterator last)
+  {
+    iterator out = begin() + (first - cbegin());
+    if (first != last) {
+      destroy_from(std::move(begin() + (last - cbegin()), end(), out));
+    }
+    return out;
+  }
+
+  void push_back(const T & value)
+  {
+    emplace_back(value);
+  }
+
+  void push_back(T && value)
+  {
+    emplace_back(std::move(value));
+  }
+
+  template<typename ... Args>
+  reference emplace_back(Args && ... args)
+  {
+    if (size_ == capacity_) {
+      return grow_and_emplace_back(std::forward<Args>(args)...);
+    }
+    allocator_traits::construct(allocator_, data_ + size_, std::forward<Args>(args)...);
+    return data_[size_++];
+  }
+
+  void pop_back() noexcept
+  {
+    allocator_traits::destroy(allocator_, data_ + --size_);
+  }
+
+  void resize(size_type count)
+  {
+    if (count < size_) {
+      destroy_from(begin() + count);
+      return;
+    }
+    reserve(count);
+    while (size_ < count) {
+      emplace_back();
+    }
+  }
+
+  void resize(size_type count, const value_type & value)
+  {
+    if (count < size_) {
+      destroy_from(begin() + count);
+    } else if (count > size_) {
+      insert(end(), count - size_, value);
+    }
+  }
+
+  void swap(small_vector & other) noexcept(
+    std::is_nothrow_move_constructible<T>::value &&
+    std::is_nothrow_move_assignable<T>::value &&
+    (allocator_traits::propagate_on_container_move_assignment::value ||
+    allocator_traits::is_always_equal::value))
+  {
+    if (this != &other) {
+      small_vector tmp(std::move(other));
+      other = std::move(*this);
+      *this = std::move(tmp);
+    }
+  }
+
+private:
+  T * inline_data() noexcept
+  {
+    return reinterpret_cast<T *>(inline_storage_);
+  }
+
+  const T * inline_data() const noexcept
+  {
+    return reinterpret_cast<const T *>(inline_storage_);
+  }
+
+  size_type grown_capacity(size_type needed) const
+  {
+    if (needed > max_size()) {
+      throw std::length_error("small_vector: size exceeds max_size()");
+    }
+    return std::max(needed, capacity_ < max_size() / 2u ? 2u * capacity_ : max_size());
+  }
+
+  // Move, or copy when moving may throw and copying is possible, count elements from source to
+  // uninitialized storage at destination, then destroy them in source.
+  void relocate(T * source, size_type count, T * destination)
+  {
+    size_type constructed = 0u;
+    try {
+      for (; constructed < count; ++constructed) {
+        allocator_traits::construct(
+          allocator_, destination + constructed, std::move_if_noexcept(source[constructed]));
+      }
+    } catch (...) {
+      for (size_type i = 0; i < constructed; ++i) {
+        allocator_traits::destroy(allocator_, destination + i);
+      }
+      throw;
+    }
+    for (size_type i = 0; i < count; ++i) {
+      allocator_traits::destroy(allocator_, source + i);
+    }
+  }
+
+  void reallocate(size_type new_capacity)
+  {
+    T * new_data = allocator_traits::allocate(allocator_, new_capacity);
+    try {
+      relocate(data_, size_, new_data);
+    } catch (...) {
+      allocator_traits::deallocate(allocator_, new_data, new_capacity);
+      throw;
+    }
+    release_heap();
+    data_ = new_data;
+    capacity_ = new_capacity;
+  }
+
+  template<typename ... Args>
+  reference grow_and_emplace_back(Args && ... args)
+  {
+    const size_type new_capacity = grown_capacity(size_ + 1u);
+    T * new_data = allocator_traits::allocate(allocator_, new_capacity);
+    // Construct the new element first, the arguments may refer to existing elements.
+    try {
+      allocator_traits::construct(allocator_, new_data + size_, std::forward<Args>(args)...);
+    } catch (...) {
+      allocator_traits::deallocate(allocator_, new_data, new_capacity);
+      throw;
+    }
+    try {
+      relocate(data_, size_, new_data);
+    } catch (...) {
+      allocator_traits::destroy(allocator_, new_data + size_);
+      allocator_traits::deallocate(allocator_, new_data, new_capacity);
+      throw;
+    }
+    release_heap();
+    data_ = new_data;
+    capacity_ = new_capacity;
+    return data_[size_++];
+  }
+
+  void construct_at_end(size_type count, const T & value)
+  {
+    reserve(size_ + count);
+    for (size_type i = 0; i < count; ++i) {
+      allocator_traits::construct(allocator_, data_ + size_, value);
+      ++size_;
+    }
+  }
+
+  void destroy_from(iterator first) noexcept
+  {
+    for (iterator it = first; it != end(); ++it) {
+      allocator_traits::destroy(allocator_, it);
+    }
+    size_ = static_cast<size_type>(first - begin());
+  }
+
+  void release_heap() noexcept
+  {
+    if (!is_inline()) {
+      allocator_traits::deallocate(allocator_, data_, capacity_);
+      data_ = inline_data();
+      capacity_ = N;
+    }
+  }
+
+  // Take the elements of other, whose allocator can free our storage; this vector is empty.
+  void take(small_vector & other) noexcept(std::is_nothrow_move_constructible<T>::value)
+  {
+    if (other.is_inline()) {
+      relocate(other.data_, other.size_, data_);
+      size_ = std::exchange(other.size_, 0u);
+    } else {
+      data_ = std::exchange(other.data_, other.inline_data());
+      size_ = std::exchange(other.size_, 0u);
+      capacity_ = std::exchange(other.capacity_, N);
+    }
+  }
+
+  Allocator allocator_;
+  T * data_;
+  size_type size_ = 0u;
+  size_type capacity_ = N;
+  alignas(T) unsigned char inline_storage_[sizeof(T) * N];
+};
+
+template<typename T, std::size_t N, typename Allocator>
+bool operator==(
+  const small_vector<T, N, Allocator> & lhs, const small_vector<T, N, Allocator> & rhs)
+{
+  return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template<typename T, std::size_t N, typename Allocator>
+bool operator!=(
+  const small_vector<T, N, Allocator> & lhs, const small_vector<T, N, Allocator> & rhs)
+{
+  return !(lhs == rhs);
+}
+
+template<typename T, std::size_t N, typename Allocator>
+bool operator<(
+  const small_vector<T, N, Allocator> & lhs, const small_vector<T, N, Allocator> & rhs)
+{
+  return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template<typename T, std::size_t N, typename Allocator>
+bool operator>(
+  const small_vector<T, N, Allocator> & lhs, const small_vector<T, N, Allocator> & rhs)
+{
+  return rhs < lhs;
+}
+
+template<typename T, std::size_t N, typename Allocator>
+bool operator<=(
+  const small_vector<T, N, Allocator> & lhs, const small_vector<T, N, Allocator> & rhs)
+{
+  return !(rhs < lhs);
+}
+
+template<typename T, std::size_t N, typename Allocator>
+bool operator>=(
+  const small_vector<T, N, Allocator> & lhs, const small_vector<T, N, Allocator> & rhs)
+{
+  return !(lhs < rhs);
+}
+
+template<typename T, std::size_t N, typename Allocator>
+void swap(
+  small_vector<T, N, Allocator> & lhs,
+  small_vector<T, N, Allocator> & rhs) noexcept(noexcept(lhs.swap(rhs)))
+{
+  lhs.swap(rhs);
+}
+
+}  // namespace rcpputils
+
+#endif  // RCPPUTILS__SMALL_VECTOR_HPP_
@@ -40,14 +40,243 @@
 #ifndef RCPPUTILS__SPLIT_HPP_
 #define RCPPUTILS__SPLIT_HPP_
 
+#include <cstddef>
 #include <iterator>
-#include <sstream>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
+#include "rcpputils/detail/scan.hpp"
+
 namespace rcpputils
 {
 
+namespace detail
+{
+
+/// Delimiter matching a single character.
+struct char_delimiter
+{
+  char delim;
+
+  std::size_t find(std::string_view input, std::size_t pos) const noexcept
+  {
+    return scan_find(input, delim, pos);
+  }
+
+  std::size_t size() const noexcept
+  {
+    return 1u;
+  }
+};
+
+/// Delimiter matching a multi-character sequence.
+/**
+ * An empty sequence never matches, so the input is yielded as a single token.
+ */
+struct string_delimiter
+{
+  std::string_view delim;
+
+  std::size_t find(std::string_view input, std::size_t pos) const noexcept
+  {
+    return delim.empty() ? std::string_view::npos : scan_find(input, delim, pos);
+  }
+
+  std::size_t size() const noexcept
+  {
+    return delim.size();
+  }
+};
+
+/// Delimiter matching any single character out of a set.
+struct any_of_delimiter
+{
+  std::string_view delims;
+
+  std::size_t find(std::string_view input, std::size_t pos) const noexcept
+  {
+    return scan_find_first_of(input, delims, pos);
+  }
+
+  std::size_t size() const noexcept
+  {
+    return 1u;
+  }
+};
+
+}  // namespace detail
+
+/// Lazy, non-owning range over the tokens of a string split by a delimiter.
+/**
+ * Tokens are yielded as `std::string_view`s into the original input, which must outlive the
+ * view and all of its iterators.
+ * No memory is allocated while iterating.
+ *
+ * Tokenization follows the same rules as `std::getline`: an empty input yields no tokens and
+ * a trailing delimiter does not yield a trailing empty token.
+ * If `skip_empty` is set, empty tokens are not yielded at all.
+ *
+ * \tparam DelimiterT the delimiter matching policy, see `split_view` and `split_any_view`.
+ */
+template<class DelimiterT>
+class basic_split_view
+{
+public:
+  /// Forward iterator over the tokens of the view.
+  class iterator
+  {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::string_view;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const std::string_view *;
+    using reference = const std::string_view &;
+
+    /// Construct a past-the-end iterator.
+    iterator() = default;
+
+    reference operator*() const noexcept
+    {
+      return token_;
+    }
+
+    pointer operator->() const noexcept
+    {
+      return &token_;
+    }
+
+    iterator & operator++()
+    {
+      advance();
+      return *this;
+    }
+
+    iterator operator++(int)
+    {
+      iterator copy(*this);
+      advance();
+      return copy;
+    }
+
+    bool operator==(const iterator & other) const noexcept
+    {
+      return next_ == other.next_ && token_.data() == other.token_.data();
+    }
+
+    bool operator!=(const iterator & other) const noexcept
+    {
+      return !(*this == other);
+    }
+
+private:
+    friend class basic_split_view;
+
+    iterator(std::string_view input, DelimiterT delim, bool skip_empty)
+    : input_(input), delim_(delim), skip_empty_(skip_empty), next_(0u)
+    {
+      advance();
+    }
+
+    void advance()
+    {
+      while (next_ < input_.size()) {
+        const std::size_t start = next_;
+        std::size_t pos = delim_.find(input_, start);
+        if (pos == std::string_view::npos) {
+          pos = input_.size();
+          next_ = pos;
+        } else {
+          next_ = pos + delim_.size();
+        }
+        token_ = input_.substr(start, pos - start);
+        if (!skip_empty_ || !token_.empty()) {
+          return;
+        }
+      }
+      // Exhausted, compare equal to the default constructed iterator.
+      next_ = std::string_view::npos;
+      token_ = std::string_view();
+    }
+
+    std::string_view input_;
+    DelimiterT delim_{};
+    bool skip_empty_{false};
+    std::size_t next_{std::string_view::npos};
+    std::string_view token_;
+  };
+
+  using const_iterator = iterator;
+
+  /// Construct a view over the tokens of input.
+  /**
+   * \param[in] input the input string to be split
+   * \param[in] delim the delimiter used to split the input string
+   * \param[in] skip_empty if true, empty tokens are not yielded
+   */
+  constexpr basic_split_view(std::string_view input, DelimiterT delim, bool skip_empty = false)
+  : input_(input), delim_(delim), skip_empty_(skip_empty)
+  {}
+
+  iterator begin() const
+  {
+    return iterator(input_, delim_, skip_empty_);
+  }
+
+  iterator end() const
+  {
+    return iterator();
+  }
+
+private:
+  std::string_view input_;
+  DelimiterT delim_;
+  bool skip_empty_;
+};
+
+/// Lazily split a specified input into tokens using a delimiter.
+/**
+ * \param[in] input the input string to be split, it must outlive the returned view
+ * \param[in] delim the delimiter used to split the input string
+ * \param[in] skip_empty if true, empty tokens are not yielded
+ * \return A range of `std::string_view` tokens.
+ */
+inline basic_split_view<detail::char_delimiter>
+split_view(std::string_view input, char delim, bool skip_empty = false)
+{
+  return basic_split_view<detail::char_delimiter>(input, detail::char_delimiter{delim}, skip_empty);
+}
+
+/// Lazily split a specified input into tokens using a multi-character delimiter.
+/**
+ * \param[in] input the input string to be split, it must outlive the returned view
+ * \param[in] delim the character sequence used to split the input string, it must outlive the
+ *   returned view
+ * \param[in] skip_empty if true, empty tokens are not yielded
+ * \return A range of `std::string_view` tokens.
+ */
+inline basic_split_view<detail::string_delimiter>
+split_view(std::string_view input, std::string_view delim, bool skip_empty = false)
+{
+  return basic_split_view<detail::string_delimiter>(
+    input, detail::string_delimiter{delim}, skip_empty);
+}
+
+/// Lazily split a specified input into tokens on any character out of a set of delimiters.
+/**
+ * \param[in] input the input string to be split, it must outlive the returned view
+ * \param[in] delims the set of delimiter characters, it must outlive the returned view
+ * \param[in] skip_empty if true, empty tokens are not yielded
+ * \return A range of `std::string_view` tokens.
+ */
+inline basic_split_view<detail::any_of_delimiter>
+split_any_view(std::string_view input, std::string_view delims, bool skip_empty = false)
+{
+  return basic_split_view<detail::any_of_delimiter>(
+    input, detail::any_of_delimiter{delims}, skip_empty);
+}
+
 /// Split a specified input into tokens using a delimiter and a type erased insert iterator.
 /**
  * The returned vector will contain the tokens split from the input
@@ -64,16 +293,10 @@ template<
       decltype(std::declval<InsertIterator>().operator=(std::declval<std::string>()))>::value
   >::type * = nullptr>
 void
-split(const std::string & input, char delim, InsertIterator & it, bool skip_empty = false)
+split(std::string_view input, char delim, InsertIterator & it, bool skip_empty = false)
 {
-  std::stringstream ss;
-  ss.str(input);
-  std::string item;
-  while (std::getline(ss, item, delim)) {
-    if (skip_empty && item == "") {
-      continue;
-    }
-    it = item;
+  for (const std::string_view token : split_view(input, delim, skip_empty)) {
+    it = std::string(token);
   }
 }
 
@@ -86,11 +309,38 @@ split(const std::string & input, char delim, InsertIterator & it, bool skip_empt
  * \return A vector of tokens.
  */
 inline std::vector<std::string>
-split(const std::string & input, char delim, bool skip_empty = false)
+split(std::string_view input, char delim, bool skip_empty = false)
 {
   std::vector<std::string> result;
-  auto it = std::back_inserter(result);
-  split(input, delim, it, skip_empty);
+  for (const std::string_view token : split_view(input, delim, skip_empty)) {
+    result.emplace_back(token);
+  }
+  return result;
+}
+
+/// Split a specified input into tokens using a delimiter, into a container of choice.
+/**
+ * The container must be default constructible and support `emplace_back()` of a
+ * `std::string_view`. With `std::string_view` elements the tokens refer into the input, and
+ * a container with inline storage such as `small_vector<std::string_view, 8>` splits short
+ * inputs without allocating:
+ *
+ *     auto tokens = rcpputils::split<rcpputils::small_vector<std::string_view, 8>>(topic, '/');
+ *
+ * \tparam ContainerT The type of the returned container.
+ * \param[in] input the input string to be split, it must outlive string_view tokens
+ * \param[in] delim the delimiter used to split the input string
+ * \param[in] skip_empty if true, empty tokens are not added to the container
+ * \return A container of tokens.
+ */
+template<class ContainerT>
+ContainerT
+split(std::string_view input, char delim, bool skip_empty = false)
+{
+  ContainerT result;
+  for (const std::string_view token : split_view(input, delim, skip_empty)) {
+    result.emplace_back(token);
+  }
   return result;
 }
 }  // namespace rcpputils
@@ -0,0 +1,239 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/*! \file temp_file.hpp
+ * \brief Uniquely named temporary files and directories, removed when their handle is destroyed.
+ *
+ * Names are generated and the entries created in a single atomic step (`mkdtemp`, `mkstemp` and
+ * `O_TMPFILE` on POSIX, exclusive creation on Windows), so there is no window between checking
+ * that a name is free and using it.
+ */
+
+#ifndef RCPPUTILS__TEMP_FILE_HPP_
+#define RCPPUTILS__TEMP_FILE_HPP_
+
+#include <cstdint>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include "rcpputils/filesystem_helper.hpp"
+#include "rcpputils/visibility_control.hpp"
+
+namespace rcpputils
+{
+namespace fs
+{
+
+/// A temporary directory, removed with all its contents when the handle is destroyed.
+class temp_directory
+{
+public:
+  /// Construct a handle that does not own any directory.
+  temp_directory() noexcept = default;
+
+  /// Take ownership of an existing directory.
+  /**
+   * \param[in] p The path to the directory, which is removed when the handle is destroyed.
+   */
+  explicit temp_directory(fs::path p) noexcept
+  : path_(std::move(p))
+  {}
+
+  RCPPUTILS_PUBLIC
+  temp_directory(temp_directory && other) noexcept;
+
+  RCPPUTILS_PUBLIC
+  temp_directory & operator=(temp_directory && other) noexcept;
+
+  temp_directory(const temp_directory &) = delete;
+  temp_directory & operator=(const temp_directory &) = delete;
+
+  RCPPUTILS_PUBLIC
+  ~temp_directory();
+
+  /// Get the path to the directory, which is empty if the handle does not own a directory.
+  const fs::path & path() const noexcept
+  {
+    return path_;
+  }
+
+  /// Give up ownership of the directory, which is then kept on destruction.
+  /**
+   * \return The path to the directory.
+   */
+  RCPPUTILS_PUBLIC
+  fs::path release() noexcept;
+
+  /// Remove the directory and its contents now.
+  /**
+   * \param[out] ec Set to the error if the directory cannot be removed, cleared otherwise.
+   * \return The number of files and directories removed.
+   */
+  RCPPUTILS_PUBLIC
+  std::uintmax_t remove(std::error_code & ec) noexcept;
+
+private:
+  fs::path path_;
+};
+
+/// A temporary file, open for reading and writing, removed when the handle is destroyed.
+/**
+ * Anonymous temporary files have no name in the file system at all; they exist only as long as
+ * their descriptor is open.
+ */
+class temp_file
+{
+public:
+  /// Construct a handle that does not own any file.
+  temp_file() noexcept = default;
+
+  /// Take ownership of an open file.
+  /**
+   * \param[in] fd The file descriptor, which is closed when the handle is destroyed.
+   * \param[in] p The path to the file, which is removed when the handle is destroyed, or an
+   *   empty path if the file has no name.
+   */
+  temp_file(int fd, fs::path p) noexcept
+  : fd_(fd), path_(std::move(p))
+  {}
+
+  RCPPUTILS_PUBLIC
+  temp_file(temp_file && other) noexcept;
+
+  RCPPUTILS_PUBLIC
+  temp_file & operator=(temp_file && other) noexcept;
+
+  temp_file(const temp_file &) = delete;
+  temp_file & operator=(const temp_file &) = delete;
+
+  RCPPUTILS_PUBLIC
+  ~temp_file();
+
+  /// Check whether the handle owns an open file.
+  bool is_open() const noexcept
+  {
+    return fd_ >= 0;
+  }
+
+  /// Check whether the file has no name in the file system.
+  bool is_anonymous() const noexcept
+  {
+    return fd_ >= 0 && path_.empty();
+  }
+
+  /// Get the file descriptor (from the C runtime on Windows), or -1 if no file is owned.
+  int native_handle() const noexcept
+  {
+    return fd_;
+  }
+
+  /// Get the path to the file, which is empty for anonymous files.
+  const fs::path & path() const noexcept
+  {
+    return path_;
+  }
+
+  /// Close the file and give up ownership of it, so it is kept on destruction.
+  /**
+   * An anonymous file is gone once closed.
+   * \return The path to the file.
+   */
+  RCPPUTILS_PUBLIC
+  fs::path release() noexcept;
+
+  /// Close and remove the file now.
+  RCPPUTILS_PUBLIC
+  void close() noexcept;
+
+private:
+  int fd_ = -1;
+  fs::path path_;
+};
+
+/// Create a uniquely named directory.
+/**
+ * The name is the prefix followed by six random characters.
+ *
+ * \param[in] prefix The beginning of the directory name, which must not contain separators.
+ * \param[in] parent The directory in which to create the directory, which must exist.
+ * \return The handle owning the new directory.
+ * \throws std::system_error if the directory cannot be created.
+ */
+RCPPUTILS_PUBLIC
+temp_directory create_temp_directory(
+  const std::string & prefix = "rcpputils_", const path & parent = temp_directory_path());
+
+/// Create a uniquely named directory, without throwing.
+/**
+ * \param[in] prefix The beginning of the directory name, which must not contain separators.
+ * \param[in] parent The directory in which to create the directory, which must exist.
+ * \param[out] ec Set to the error if the directory cannot be created, cleared otherwise.
+ * \return The handle owning the new directory, which owns nothing on error.
+ */
+RCPPUTILS_PUBLIC
+temp_directory create_temp_directory(
+  const std::string & prefix, const path & parent, std::error_code & ec) noexcept;
+
+/// Create and open a uniquely named file.
+/**
+ * The name is the prefix followed by six random characters, and the file is created with
+ * permissions for its owner only.
+ *
+ * \param[in] prefix The beginning of the file name, which must not contain separators.
+ * \param[in] parent The directory in which to create the file, which must exist.
+ * \return The handle owning the new file.
+ * \throws std::system_error if the file cannot be created.
+ */
+RCPPUTILS_PUBLIC
+temp_file create_temp_file(
+  const std::string & prefix = "rcpputils_", const path & parent = temp_directory_path());
+
+/// Create and open a uniquely named file, without throwing.
+/**
+ * \param[in] prefix The beginning of the file name, which must not contain separators.
+ * \param[in] parent The directory in which to create the file, which must exist.
+ * \param[out] ec Set to the error if the file cannot be created, cleared otherwise.
+ * \return The handle owning the new file, which owns nothing on error.
+ */
+RCPPUTILS_PUBLIC
+temp_file create_temp_file(
+  const std::string & prefix, const path & parent, std::error_code & ec) noexcept;
+
+/// Create and open a scratch file which has no name in the file system.
+/**
+ * On Linux the file is created with `O_TMPFILE` when the file system supports it; elsewhere a
+ * uniquely named file is created and immediately unlinked (on Windows, it is deleted on close).
+ * Either way, nothing is left behind even if the process is killed.
+ *
+ * \param[in] parent The directory on whose file system to create the file, which must exist.
+ * \return The handle owning the new file.
+ * \throws std::system_error if the file cannot be created.
+ */
+RCPPUTILS_PUBLIC
+temp_file create_anonymous_temp_file(const path & parent = temp_directory_path());
+
+/// Create and open a scratch file which has no name in the file system, without throwing.
+/**
+ * \param[in] parent The directory on whose file system to create the file, which must exist.
+ * \param[out] ec Set to the error if the file cannot be created, cleared otherwise.
+ * \return The handle owning the new file, which owns nothing on error.
+ */
+RCPPUTILS_PUBLIC
+temp_file create_anonymous_temp_file(const path & parent, std::error_code & ec) noexcept;
+
+}  // namespace fs
+}  // namespace rcpputils
+
+#endif  // RCPPUTILS__TEMP_FILE_HPP_
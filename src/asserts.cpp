@@ -12,6 +12,10 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
 #include "rcpputils/asserts.hpp"
 
 namespace rcpputils
@@ -21,6 +25,16 @@ AssertionException::AssertionException(const char * msg)
   msg_ = msg;
 }
 
+AssertionException::AssertionException(std::string_view msg)
+: msg_(msg)
+{
+}
+
+AssertionException::AssertionException(std::string_view msg, const SourceLocation & location)
+: msg_(msg), location_(location)
+{
+}
+
 const char * AssertionException::what() const throw()
 {
   return msg_.c_str();
@@ -31,8 +45,45 @@ IllegalStateException::IllegalStateException(const char * msg)
   msg_ = msg;
 }
 
+IllegalStateException::IllegalStateException(std::string_view msg)
+: msg_(msg)
+{
+}
+
+IllegalStateException::IllegalStateException(
+  std::string_view msg, const SourceLocation & location)
+: msg_(msg), location_(location)
+{
+}
+
 const char * IllegalStateException::what() const throw()
 {
   return msg_.c_str();
 }
+
+InvalidArgumentException::InvalidArgumentException(
+  std::string_view msg, const SourceLocation & location)
+: std::invalid_argument(std::string(msg)), location_(location)
+{
+}
+
+namespace detail
+{
+
+void throw_invalid_argument(std::string_view msg, const SourceLocation & location)
+{
+  throw InvalidArgumentException{msg, location};
+}
+
+void throw_illegal_state(std::string_view msg, const SourceLocation & location)
+{
+  throw IllegalStateException{msg, location};
+}
+
+void throw_assertion(std::string_view msg, const SourceLocation & location)
+{
+  throw AssertionException{msg, location};
+}
+
+}  // namespace detail
 }  // namespace rcpputils
@@ -14,17 +14,41 @@
 
 #include "rcpputils/find_library.hpp"
 
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <link.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 #include <cassert>
+#include <cctype>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
 
+#include <algorithm>
 #include <fstream>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <system_error>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "rcutils/filesystem.h"
 #include "rcutils/get_env.h"
 
+#include "rcpputils/filesystem_helper.hpp"
+#include "rcpputils/instrumentation.hpp"
+#include "rcpputils/platform_library_name.hpp"
 #include "rcpputils/split.hpp"
 #include "rcpputils/get_env.hpp"
 
@@ -37,37 +61,714 @@ namespace
 #ifdef _WIN32
 static constexpr char kPathVar[] = "PATH";
 static constexpr char kPathSeparator = ';';
-static constexpr char kSolibPrefix[] = "";
-static constexpr char kSolibExtension[] = ".dll";
 #elif __APPLE__
 static constexpr char kPathVar[] = "DYLD_LIBRARY_PATH";
 static constexpr char kPathSeparator = ':';
-static constexpr char kSolibPrefix[] = "lib";
-static constexpr char kSolibExtension[] = ".dylib";
 #else
 static constexpr char kPathVar[] = "LD_LIBRARY_PATH";
 static constexpr char kPathSeparator = ':';
-static constexpr char kSolibPrefix[] = "lib";
-static constexpr char kSolibExtension[] = ".so";
 #endif
 
+std::string library_filename(const std::string & library_name)
+{
+  std::string filename;
+  append_platform_library_name(filename, library_name);
+  return filename;
+}
+
+// File names are matched the way the platform's file system compares them.
+std::string index_key(std::string filename)
+{
+#ifdef _WIN32
+  std::transform(
+    filename.begin(), filename.end(), filename.begin(),
+    [](unsigned char c) {return static_cast<char>(std::tolower(c));});
+#endif
+  return filename;
+}
+
+// The modification time of a directory, which changes when entries are added or removed.
+struct DirectoryStamp
+{
+  bool exists = false;
+  std::int64_t seconds = 0;
+  std::int64_t nanoseconds = 0;
+
+  bool operator==(const DirectoryStamp & other) const noexcept
+  {
+    return exists == other.exists && seconds == other.seconds &&
+           nanoseconds == other.nanoseconds;
+  }
+};
+
+DirectoryStamp stamp_of(const std::string & directory)
+{
+  DirectoryStamp stamp;
+#ifdef _WIN32
+  struct _stat64 st;
+  if (_stat64(directory.c_str(), &st) == 0) {
+    stamp.exists = true;
+    stamp.seconds = static_cast<std::int64_t>(st.st_mtime);
+  }
+#else
+  struct stat st;
+  if (stat(directory.c_str(), &st) == 0) {
+    stamp.exists = true;
+#ifdef __APPLE__
+    stamp.seconds = static_cast<std::int64_t>(st.st_mtimespec.tv_sec);
+    stamp.nanoseconds = static_cast<std::int64_t>(st.st_mtimespec.tv_nsec);
+#else
+    stamp.seconds = static_cast<std::int64_t>(st.st_mtim.tv_sec);
+    stamp.nanoseconds = static_cast<std::int64_t>(st.st_mtim.tv_nsec);
+#endif
+  }
+#endif
+  return stamp;
+}
+
+std::shared_ptr<const LibrarySearcher> environment_searcher(const std::string & search_path)
+{
+  static std::mutex mutex;
+  static std::shared_ptr<const LibrarySearcher> searcher;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!searcher || searcher->search_path() != search_path) {
+    // Misses are not cached, so libraries installed later are found, as they were before
+    // lookups were cached.
+    searcher = std::make_shared<const LibrarySearcher>(search_path, false);
+  }
+  return searcher;
+}
+
+std::shared_ptr<const LibrarySearcher> environment_searcher()
+{
+  return environment_searcher(get_env_var(kPathVar));
+}
+
 }  // namespace
 
-std::string find_library_path(const std::string & library_name)
+struct LibrarySearcher::Impl
+{
+  // A directory listing, immutable once built so it can be read without holding the mutex.
+  struct Listing
+  {
+    DirectoryStamp stamp;
+    // The modification time may not tell apart changes made right before and after listing.
+    bool racy = false;
+    std::unordered_set<std::string> filenames;
+  };
+
+  Impl(std::string search_path_value, bool cache_misses_value)
+  : search_path(std::move(search_path_value)), cache_misses(cache_misses_value)
+  {
+    for (const auto entry : rcpputils::split_view(search_path, kPathSeparator)) {
+      if (!entry.empty()) {
+        search_directories.emplace_back(entry);
+      }
+    }
+    listings.resize(search_directories.size());
+  }
+
+  static std::shared_ptr<const Listing> list(const std::string & directory)
+  {
+    auto listing = std::make_shared<Listing>();
+    listing->stamp = stamp_of(directory);
+    listing->racy = listing->stamp.exists &&
+      listing->stamp.seconds + 1 >= static_cast<std::int64_t>(std::time(nullptr));
+    std::error_code ec;
+    for (auto it = fs::directory_iterator(fs::path(directory), ec);
+      !ec && it != fs::directory_iterator(); it.increment(ec))
+    {
+      // The type comes from the listing itself; symbolic links are confirmed on a match.
+      if (it->symlink_status().type() != fs::file_type::directory) {
+        listing->filenames.insert(index_key(it->path().filename().string()));
+      }
+    }
+    return listing;
+  }
+
+  // Whether a listing still reflects the directory, so that a missing name is really missing.
+  static bool is_current(const Listing & listing, const std::string & directory)
+  {
+    return !listing.racy && stamp_of(directory) == listing.stamp;
+  }
+
+  static std::string probe(
+    const Listing & listing, const std::string & directory, const std::string & filename)
+  {
+    if (listing.filenames.count(index_key(filename)) == 0) {
+      return "";
+    }
+    std::string path = directory + "/" + filename;
+    // Confirm the match, e.g. symbolic links in the listing may be dangling.
+    if (!rcutils_is_file(path.c_str())) {
+      return "";
+    }
+    return path;
+  }
+
+  const std::string search_path;
+  const bool cache_misses;
+  std::vector<std::string> search_directories;
+
+  // Only guards the fields below; the file system is never accessed with it held.
+  std::mutex mutex;
+  std::vector<std::shared_ptr<const Listing>> listings;
+  std::unordered_map<std::string, std::string> resolved;
+  // Incremented by refresh(), so that lookups started before it do not publish their results.
+  std::uint64_t generation = 0;
+};
+
+LibrarySearcher::LibrarySearcher()
+: LibrarySearcher(get_env_var(kPathVar))
+{}
+
+LibrarySearcher::LibrarySearcher(const std::string & search_path)
+: LibrarySearcher(search_path, true)
+{}
+
+LibrarySearcher::LibrarySearcher(const std::string & search_path, bool cache_misses)
+: impl_(std::make_unique<Impl>(search_path, cache_misses))
+{}
+
+LibrarySearcher::~LibrarySearcher() = default;
+
+LibrarySearcher::LibrarySearcher(LibrarySearcher && other) noexcept = default;
+
+LibrarySearcher & LibrarySearcher::operator=(LibrarySearcher && other) noexcept = default;
+
+std::string LibrarySearcher::find(const std::string & library_name) const
+{
+  return find(std::vector<std::string>{library_name}).front();
+}
+
+std::vector<std::string> LibrarySearcher::find(
+  const std::vector<std::string> & library_names) const
 {
-  std::string search_path = get_env_var(kPathVar);
-  std::vector<std::string> search_paths = rcpputils::split(search_path, kPathSeparator);
+  std::vector<std::string> paths(library_names.size());
+  std::vector<size_t> pending;
+  std::vector<std::shared_ptr<const Impl::Listing>> listings;
+  std::uint64_t generation;
+  {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    for (size_t i = 0; i < library_names.size(); ++i) {
+      auto it = impl_->resolved.find(library_names[i]);
+      if (it != impl_->resolved.end()) {
+        paths[i] = it->second;
+      } else {
+        pending.push_back(i);
+      }
+    }
+    listings = impl_->listings;
+    generation = impl_->generation;
+  }
+
+  if (!impl_->cache_misses) {
+    // Only found libraries are cached, and they may have been removed since.
+    for (size_t i = 0; i < paths.size(); ++i) {
+      if (!paths[i].empty() && !rcutils_is_file(paths[i].c_str())) {
+        paths[i].clear();
+        pending.push_back(i);
+      }
+    }
+  }
 
-  std::string filename = kSolibPrefix;
-  filename += library_name + kSolibExtension;
+  // Walk the search path once for the whole batch; directories after the one
+  // resolving the last pending name are never listed.
+  std::vector<std::string> filenames(library_names.size());
+  for (size_t i : pending) {
+    filenames[i] = library_filename(library_names[i]);
+  }
+  std::vector<bool> relisted(listings.size(), false);
+  for (size_t d = 0; d < listings.size() && !pending.empty(); ++d) {
+    const std::string & directory = impl_->search_directories[d];
+    if (!listings[d] || (!impl_->cache_misses && !Impl::is_current(*listings[d], directory))) {
+      listings[d] = Impl::list(directory);
+      relisted[d] = true;
+    }
+    auto still_pending = pending.begin();
+    for (size_t i : pending) {
+      paths[i] = Impl::probe(*listings[d], directory, filenames[i]);
+      if (paths[i].empty()) {
+        *still_pending++ = i;
+      }
+    }
+    pending.erase(still_pending, pending.end());
+  }
 
-  for (const auto & search_path : search_paths) {
-    std::string path = search_path + "/" + filename;
-    if (rcutils_is_file(path.c_str())) {
-      return path;
+  std::lock_guard<std::mutex> lock(impl_->mutex);
+  if (generation == impl_->generation) {
+    for (size_t d = 0; d < listings.size(); ++d) {
+      if (relisted[d]) {
+        impl_->listings[d] = listings[d];
+      }
+    }
+    for (size_t i = 0; i < library_names.size(); ++i) {
+      if (!paths[i].empty()) {
+        impl_->resolved[library_names[i]] = paths[i];
+      } else if (impl_->cache_misses) {
+        impl_->resolved.emplace(library_names[i], paths[i]);
+      } else {
+        impl_->resolved.erase(library_names[i]);
+      }
     }
   }
-  return "";
+  return paths;
+}
+
+void LibrarySearcher::refresh()
+{
+  std::lock_guard<std::mutex> lock(impl_->mutex);
+  for (auto & listing : impl_->listings) {
+    listing.reset();
+  }
+  impl_->resolved.clear();
+  ++impl_->generation;
+}
+
+const std::string & LibrarySearcher::search_path() const noexcept
+{
+  return impl_->search_path;
+}
+
+const std::vector<std::string> & LibrarySearcher::search_directories() const noexcept
+{
+  return impl_->search_directories;
+}
+
+namespace
+{
+
+#ifdef __linux__
+
+// Layout of the "new" ld.so.cache format written by ldconfig since glibc 2.2, see
+// glibc's sysdeps/generic/dl-cache.h.
+constexpr char kLoaderCachePath[] = "/etc/ld.so.cache";
+constexpr char kLoaderCacheOldMagic[] = "ld.so-1.7.0";
+constexpr char kLoaderCacheNewMagic[] = "glibc-ld.so.cache1.1";
+
+struct LoaderCacheOldEntry
+{
+  int32_t flags;
+  uint32_t key;
+  uint32_t value;
+};
+
+struct LoaderCacheNewHeader
+{
+  char magic[sizeof(kLoaderCacheNewMagic) - 1];
+  uint32_t nlibs;
+  uint32_t len_strings;
+  uint8_t flags;
+  uint8_t padding[3];
+  uint32_t extension_offset;
+  uint32_t unused[3];
+};
+
+struct LoaderCacheNewEntry
+{
+  int32_t flags;
+  uint32_t key;
+  uint32_t value;
+  uint32_t osversion;
+  uint64_t hwcap;
+};
+
+static_assert(sizeof(LoaderCacheNewHeader) == 48, "unexpected ld.so.cache header layout");
+static_assert(sizeof(LoaderCacheNewEntry) == 24, "unexpected ld.so.cache entry layout");
+
+constexpr int32_t kLoaderCacheFlagElf = 0x0001;
+constexpr int32_t kLoaderCacheFlagElfLibc6 = 0x0003;
+
+// The entry flags the loader of this architecture accepts, or 0 if unknown.
+#if defined(__x86_64__) && defined(__LP64__)
+constexpr int32_t kLoaderCacheDefaultFlags = kLoaderCacheFlagElfLibc6 | 0x0300;
+#elif defined(__aarch64__)
+constexpr int32_t kLoaderCacheDefaultFlags = kLoaderCacheFlagElfLibc6 | 0x0a00;
+#elif defined(__arm__) && defined(__ARM_PCS_VFP)
+constexpr int32_t kLoaderCacheDefaultFlags = kLoaderCacheFlagElfLibc6 | 0x0900;
+#elif defined(__i386__)
+constexpr int32_t kLoaderCacheDefaultFlags = kLoaderCacheFlagElfLibc6;
+#elif defined(__powerpc64__)
+constexpr int32_t kLoaderCacheDefaultFlags = kLoaderCacheFlagElfLibc6 | 0x0500;
+#else
+constexpr int32_t kLoaderCacheDefaultFlags = 0;
+#endif
+
+// Same ordering as glibc's _dl_cache_libcmp(): runs of digits compare numerically.
+int loader_cache_compare(const char * p1, const char * p2)
+{
+  while (*p1 != '\0') {
+    if (*p1 >= '0' && *p1 <= '9') {
+      if (*p2 >= '0' && *p2 <= '9') {
+        int val1 = *p1++ - '0';
+        int val2 = *p2++ - '0';
+        while (*p1 >= '0' && *p1 <= '9') {
+          val1 = val1 * 10 + *p1++ - '0';
+        }
+        while (*p2 >= '0' && *p2 <= '9') {
+          val2 = val2 * 10 + *p2++ - '0';
+        }
+        if (val1 != val2) {
+          return val1 - val2;
+        }
+      } else {
+        return 1;
+      }
+    } else if (*p2 >= '0' && *p2 <= '9') {
+      return -1;
+    } else if (*p1 != *p2) {
+      return *p1 - *p2;
+    } else {
+      ++p1;
+      ++p2;
+    }
+  }
+  return *p1 - *p2;
+}
+
+/// Read-only view of the dynamic loader's cache, mapped for the lifetime of the process.
+class LoaderCache
+{
+public:
+  LoaderCache()
+  {
+    int fd = open(kLoaderCachePath, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      return;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+      void * data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data != MAP_FAILED) {
+        data_ = static_cast<const char *>(data);
+        size_ = static_cast<size_t>(st.st_size);
+      }
+    }
+    close(fd);
+    if (data_ != nullptr && !parse()) {
+      unmap();
+    }
+  }
+
+  ~LoaderCache()
+  {
+    unmap();
+  }
+
+  LoaderCache(const LoaderCache &) = delete;
+  LoaderCache & operator=(const LoaderCache &) = delete;
+
+  /// Find the path registered for a file name, or "" if there is none.
+  std::string find(const std::string & filename) const
+  {
+    if (count_ == 0) {
+      return "";
+    }
+    // Entries are sorted in decreasing loader_cache_compare() order.
+    size_t left = 0;
+    size_t right = count_;
+    while (left < right) {
+      const size_t middle = left + (right - left) / 2;
+      const char * key = string_at(entries_[middle].key);
+      if (key == nullptr) {
+        return "";
+      }
+      const int cmp = loader_cache_compare(filename.c_str(), key);
+      if (cmp < 0) {
+        left = middle + 1;
+      } else {
+        right = middle;
+      }
+    }
+    // left is now the first entry whose key is not greater than the name; several entries may
+    // share a key, e.g. for other architectures or hardware capabilities.
+    for (size_t i = left; i < count_; ++i) {
+      const LoaderCacheNewEntry & entry = entries_[i];
+      const char * key = string_at(entry.key);
+      if (key == nullptr || loader_cache_compare(filename.c_str(), key) != 0) {
+        break;
+      }
+      if ((entry.flags == kLoaderCacheFlagElf || entry.flags == kLoaderCacheDefaultFlags) &&
+        entry.hwcap == 0)
+      {
+        const char * value = string_at(entry.value);
+        if (value != nullptr) {
+          return value;
+        }
+      }
+    }
+    return "";
+  }
+
+private:
+  bool parse()
+  {
+    if (kLoaderCacheDefaultFlags == 0) {
+      return false;
+    }
+    size_t offset = 0;
+    const size_t old_magic_size = sizeof(kLoaderCacheOldMagic) - 1;
+    if (size_ >= 16 &&
+      std::memcmp(data_, kLoaderCacheOldMagic, old_magic_size) == 0)
+    {
+      // Old-format header, padded to 12 bytes, followed by the new format, 8-byte aligned.
+      uint32_t old_count;
+      std::memcpy(&old_count, data_ + 12, sizeof(old_count));
+      offset = 16 + static_cast<size_t>(old_count) * sizeof(LoaderCacheOldEntry);
+      offset = (offset + alignof(LoaderCacheNewEntry) - 1) & ~(alignof(LoaderCacheNewEntry) - 1);
+    }
+    if (offset > size_ || size_ - offset < sizeof(LoaderCacheNewHeader)) {
+      return false;
+    }
+    const auto * header = reinterpret_cast<const LoaderCacheNewHeader *>(data_ + offset);
+    if (std::memcmp(header->magic, kLoaderCacheNewMagic, sizeof(header->magic)) != 0) {
+      return false;
+    }
+    const size_t table_size = size_ - offset;
+    const size_t entries_size = static_cast<size_t>(header->nlibs) * sizeof(LoaderCacheNewEntry);
+    if (table_size - sizeof(LoaderCacheNewHeader) < entries_size) {
+      return false;
+    }
+    // String offsets are relative to the start of the new-format header.
+    table_ = data_ + offset;
+    table_size_ = table_size;
+    entries_ = reinterpret_cast<const LoaderCacheNewEntry *>(header + 1);
+    count_ = header->nlibs;
+    return true;
+  }
+
+  const char * string_at(uint32_t offset) const noexcept
+  {
+    if (offset >= table_size_ ||
+      std::memchr(table_ + offset, '\0', table_size_ - offset) == nullptr)
+    {
+      return nullptr;
+    }
+    return table_ + offset;
+  }
+
+  void unmap() noexcept
+  {
+    if (data_ != nullptr) {
+      munmap(const_cast<char *>(data_), size_);
+    }
+    data_ = nullptr;
+    size_ = 0;
+    count_ = 0;
+  }
+
+  const char * data_ = nullptr;
+  size_t size_ = 0;
+  const char * table_ = nullptr;
+  size_t table_size_ = 0;
+  const LoaderCacheNewEntry * entries_ = nullptr;
+  size_t count_ = 0;
+};
+
+struct DynamicPaths
+{
+  std::string rpath;
+  std::string runpath;
+};
+
+int read_dynamic_paths(struct dl_phdr_info * info, size_t, void * data)
+{
+  auto * paths = static_cast<DynamicPaths *>(data);
+  for (ElfW(Half) i = 0; i < info->dlpi_phnum; ++i) {
+    const ElfW(Phdr) & phdr = info->dlpi_phdr[i];
+    if (phdr.p_type != PT_DYNAMIC) {
+      continue;
+    }
+    const auto * dyn = reinterpret_cast<const ElfW(Dyn) *>(info->dlpi_addr + phdr.p_vaddr);
+    ElfW(Addr) strtab = 0;
+    const ElfW(Dyn) * rpath = nullptr;
+    const ElfW(Dyn) * runpath = nullptr;
+    for (; dyn->d_tag != DT_NULL; ++dyn) {
+      if (dyn->d_tag == DT_STRTAB) {
+        strtab = dyn->d_un.d_ptr;
+      } else if (dyn->d_tag == DT_RPATH) {
+        rpath = dyn;
+      } else if (dyn->d_tag == DT_RUNPATH) {
+        runpath = dyn;
+      }
+    }
+    if (strtab == 0) {
+      break;
+    }
+    // glibc relocates the dynamic section in place, other loaders leave it as linked.
+    if (strtab < info->dlpi_addr) {
+      strtab += info->dlpi_addr;
+    }
+    const char * strings = reinterpret_cast<const char *>(strtab);
+    if (rpath != nullptr) {
+      paths->rpath = strings + rpath->d_un.d_val;
+    }
+    if (runpath != nullptr) {
+      paths->runpath = strings + runpath->d_un.d_val;
+    }
+    break;
+  }
+  // The first object reported is the executable itself.
+  return 1;
+}
+
+std::string executable_directory()
+{
+  std::string buffer(4096, '\0');
+  const ssize_t length = readlink("/proc/self/exe", &buffer[0], buffer.size());
+  if (length <= 0 || static_cast<size_t>(length) >= buffer.size()) {
+    return "";
+  }
+  buffer.resize(static_cast<size_t>(length));
+  return buffer.substr(0, buffer.find_last_of('/'));
+}
+
+// Expand $ORIGIN and drop entries with dynamic string tokens the loader would substitute
+// differently, e.g. $LIB or $PLATFORM.
+std::string expand_dynamic_path(const std::string & dynamic_path, const std::string & origin)
+{
+  std::string expanded;
+  for (const auto entry : rcpputils::split_view(dynamic_path, ':')) {
+    std::string dir(entry);
+    for (const char * token : {"${ORIGIN}", "$ORIGIN"}) {
+      for (size_t pos = dir.find(token); pos != std::string::npos; pos = dir.find(token, pos)) {
+        dir.replace(pos, std::strlen(token), origin);
+        pos += origin.size();
+      }
+    }
+    if (dir.empty() || dir.find('$') != std::string::npos) {
+      continue;
+    }
+    if (!expanded.empty()) {
+      expanded += kPathSeparator;
+    }
+    expanded += dir;
+  }
+  return expanded;
+}
+
+#endif  // __linux__
+
+/// The library sources that don't change during the lifetime of the process.
+struct LoaderSources
+{
+  LoaderSources()
+  {
+#ifdef __linux__
+    DynamicPaths paths;
+    dl_iterate_phdr(read_dynamic_paths, &paths);
+    const std::string origin = executable_directory();
+    rpath = LibrarySearcher(expand_dynamic_path(paths.rpath, origin));
+    runpath = LibrarySearcher(expand_dynamic_path(paths.runpath, origin));
+#if defined(__LP64__)
+    system_directories = LibrarySearcher("/lib64:/usr/lib64:/lib:/usr/lib");
+#else
+    system_directories = LibrarySearcher("/lib:/usr/lib");
+#endif
+#elif __APPLE__
+    system_directories = LibrarySearcher("/usr/local/lib:/usr/lib");
+#endif
+  }
+
+  LibrarySearcher rpath{""};
+  LibrarySearcher runpath{""};
+#ifdef __linux__
+  LoaderCache loader_cache;
+#endif
+  LibrarySearcher system_directories{""};
+};
+
+const LoaderSources & loader_sources()
+{
+  static const LoaderSources sources;
+  return sources;
+}
+
+}  // namespace
+
+LibraryLocation find_library_location(const std::string & library_name)
+{
+  return find_library_locations(std::vector<std::string>{library_name}).front();
+}
+
+std::vector<LibraryLocation> find_library_locations(
+  const std::vector<std::string> & library_names)
+{
+  const LoaderSources & sources = loader_sources();
+  const auto search_path = environment_searcher();
+
+  std::vector<LibraryLocation> locations(library_names.size());
+  std::vector<size_t> pending(library_names.size());
+  for (size_t i = 0; i < pending.size(); ++i) {
+    pending[i] = i;
+  }
+
+  auto resolve = [&](const LibrarySearcher & searcher, LibrarySource source) {
+      if (pending.empty() || searcher.search_directories().empty()) {
+        return;
+      }
+      std::vector<std::string> names;
+      names.reserve(pending.size());
+      for (size_t i : pending) {
+        names.push_back(library_names[i]);
+      }
+      const std::vector<std::string> paths = searcher.find(names);
+      auto still_pending = pending.begin();
+      for (size_t j = 0; j < paths.size(); ++j) {
+        if (paths[j].empty()) {
+          *still_pending++ = pending[j];
+        } else {
+          locations[pending[j]] = {paths[j], source};
+        }
+      }
+      pending.erase(still_pending, pending.end());
+    };
+
+  // DT_RPATH is ignored by the loader when DT_RUNPATH is present.
+  if (sources.runpath.search_directories().empty()) {
+    resolve(sources.rpath, LibrarySource::rpath);
+  }
+  resolve(*search_path, LibrarySource::search_path);
+  resolve(sources.runpath, LibrarySource::runpath);
+#ifdef __linux__
+  auto still_pending = pending.begin();
+  for (size_t i : pending) {
+    std::string path = sources.loader_cache.find(library_filename(library_names[i]));
+    if (path.empty()) {
+      *still_pending++ = i;
+    } else {
+      locations[i] = {std::move(path), LibrarySource::loader_cache};
+    }
+  }
+  pending.erase(still_pending, pending.end());
+#endif
+  resolve(sources.system_directories, LibrarySource::system_directory);
+  return locations;
+}
+
+std::string find_library_path(const std::string & library_name)
+{
+  RCPPUTILS_TRACE_SCOPE("rcpputils.find_library_path");
+  return environment_searcher()->find(library_name);
+}
+
+std::string find_library_path(const std::string & library_name, std::error_code & ec)
+{
+  RCPPUTILS_TRACE_SCOPE("rcpputils.find_library_path");
+  ec.clear();
+  const char * search_path{};
+  if (rcutils_get_env(kPathVar, &search_path) != nullptr) {
+    ec = std::make_error_code(std::errc::invalid_argument);
+    return "";
+  }
+  return environment_searcher(search_path != nullptr ? search_path : "")->find(library_name);
+}
+
+std::vector<std::string> find_library_paths(const std::vector<std::string> & library_names)
+{
+  RCPPUTILS_TRACE_SCOPE("rcpputils.find_library_paths");
+  return environment_searcher()->find(library_names);
 }
 
 }  // namespace rcpputils
@@ -0,0 +1,261 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rcpputils/get_env.hpp"
+
+#include <stdlib.h>
+#ifdef __APPLE__
+#include <crt_externs.h>
+#elif !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "rcpputils/split.hpp"
+
+#if !defined(_WIN32) && !defined(__APPLE__)
+extern "C" char ** environ;
+#endif
+
+namespace rcpputils
+{
+
+namespace
+{
+
+char ** process_environment()
+{
+#ifdef _WIN32
+  return _environ;
+#elif __APPLE__
+  return *_NSGetEnviron();
+#else
+  return environ;
+#endif
+}
+
+char fold_case(char c)
+{
+  return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+}
+
+// Order of variable names; the Windows environment ignores case.
+int compare_names(std::string_view lhs, std::string_view rhs) noexcept
+{
+#ifdef _WIN32
+  const size_t size = std::min(lhs.size(), rhs.size());
+  for (size_t i = 0; i < size; ++i) {
+    const char l = fold_case(lhs[i]);
+    const char r = fold_case(rhs[i]);
+    if (l != r) {
+      return l < r ? -1 : 1;
+    }
+  }
+  return lhs.size() < rhs.size() ? -1 : (lhs.size() > rhs.size() ? 1 : 0);
+#else
+  return lhs.compare(rhs);
+#endif
+}
+
+bool equals_ignoring_case(std::string_view lhs, std::string_view rhs) noexcept
+{
+  if (lhs.size() != rhs.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < lhs.size(); ++i) {
+    if (fold_case(lhs[i]) != fold_case(rhs[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::mutex process_snapshot_mutex;
+std::shared_ptr<const EnvSnapshot> process_snapshot_instance;
+
+}  // namespace
+
+EnvSnapshot::EnvSnapshot()
+{
+  refresh();
+}
+
+EnvSnapshot::~EnvSnapshot() = default;
+
+EnvSnapshot::EnvSnapshot(EnvSnapshot &&) noexcept = default;
+
+EnvSnapshot & EnvSnapshot::operator=(EnvSnapshot &&) noexcept = default;
+
+void EnvSnapshot::refresh()
+{
+  char ** environment = process_environment();
+
+  // Copy everything into one buffer first, so the views below never move.
+  size_t total_size = 0;
+  size_t count = 0;
+  for (char ** it = environment; it != nullptr && *it != nullptr; ++it) {
+    total_size += std::strlen(*it) + 1;
+    ++count;
+  }
+  auto buffer = std::make_unique<char[]>(total_size + 1);
+  std::vector<std::pair<std::string_view, std::string_view>> entries;
+  entries.reserve(count);
+
+  char * out = buffer.get();
+  for (size_t i = 0; i < count; ++i) {
+    const size_t length = std::strlen(environment[i]);
+    std::memcpy(out, environment[i], length + 1);
+    const std::string_view entry(out, length);
+    out += length + 1;
+    // Windows keeps per-drive working directories as "=C:=C:\path"; the name may start with '='.
+    const size_t equals = entry.find('=', 1);
+    if (equals == std::string_view::npos) {
+      continue;
+    }
+    entries.emplace_back(entry.substr(0, equals), entry.substr(equals + 1));
+  }
+
+  // Keep the first definition of duplicated names, which is the one getenv() returns.
+  std::stable_sort(
+    entries.begin(), entries.end(), [](const auto & lhs, const auto & rhs) {
+      return compare_names(lhs.first, rhs.first) < 0;
+    });
+  entries.erase(
+    std::unique(
+      entries.begin(), entries.end(), [](const auto & lhs, const auto & rhs) {
+        return compare_names(lhs.first, rhs.first) == 0;
+      }),
+    entries.end());
+
+  buffer_ = std::move(buffer);
+  entries_ = std::move(entries);
+}
+
+const std::pair<std::string_view, std::string_view> * EnvSnapshot::find(
+  std::string_view name) const noexcept
+{
+  auto it = std::lower_bound(
+    entries_.begin(), entries_.end(), name, [](const auto & entry, std::string_view key) {
+      return compare_names(entry.first, key) < 0;
+    });
+  if (it == entries_.end() || compare_names(it->first, name) != 0) {
+    return nullptr;
+  }
+  return &*it;
+}
+
+std::optional<std::string_view> EnvSnapshot::get(std::string_view name) const noexcept
+{
+  const auto * entry = find(name);
+  if (entry == nullptr) {
+    return std::nullopt;
+  }
+  return entry->second;
+}
+
+std::string_view EnvSnapshot::get_or(
+  std::string_view name, std::string_view default_value) const noexcept
+{
+  const auto * entry = find(name);
+  return entry != nullptr ? entry->second : default_value;
+}
+
+bool EnvSnapshot::contains(std::string_view name) const noexcept
+{
+  return find(name) != nullptr;
+}
+
+std::optional<bool> EnvSnapshot::get_bool(std::string_view name) const noexcept
+{
+  const auto * entry = find(name);
+  if (entry == nullptr) {
+    return std::nullopt;
+  }
+  const std::string_view value = entry->second;
+  for (const char * truthy : {"1", "true", "yes", "on"}) {
+    if (equals_ignoring_case(value, truthy)) {
+      return true;
+    }
+  }
+  for (const char * falsy : {"0", "false", "no", "off"}) {
+    if (equals_ignoring_case(value, falsy)) {
+      return false;
+    }
+  }
+  return std::nullopt;
+}
+
+std::optional<int64_t> EnvSnapshot::get_int(std::string_view name) const noexcept
+{
+  const auto * entry = find(name);
+  if (entry == nullptr || entry->second.empty()) {
+    return std::nullopt;
+  }
+  const std::string_view value = entry->second;
+  int64_t result = 0;
+  const auto parsed = std::from_chars(value.data(), value.data() + value.size(), result);
+  if (parsed.ec != std::errc() || parsed.ptr != value.data() + value.size()) {
+    return std::nullopt;
+  }
+  return result;
+}
+
+std::vector<std::string_view> EnvSnapshot::get_list(
+  std::string_view name, char separator) const
+{
+  std::vector<std::string_view> items;
+  const auto * entry = find(name);
+  if (entry == nullptr) {
+    return items;
+  }
+  for (const auto item : split_view(entry->second, separator)) {
+    if (!item.empty()) {
+      items.push_back(item);
+    }
+  }
+  return items;
+}
+
+size_t EnvSnapshot::size() const noexcept
+{
+  return entries_.size();
+}
+
+std::shared_ptr<const EnvSnapshot> EnvSnapshot::process_snapshot()
+{
+  std::lock_guard<std::mutex> lock(process_snapshot_mutex);
+  if (!process_snapshot_instance) {
+    process_snapshot_instance = std::make_shared<const EnvSnapshot>();
+  }
+  return process_snapshot_instance;
+}
+
+void EnvSnapshot::refresh_process_snapshot()
+{
+  auto snapshot = std::make_shared<const EnvSnapshot>();
+  std::lock_guard<std::mutex> lock(process_snapshot_mutex);
+  process_snapshot_instance = std::move(snapshot);
+}
+
+}  // namespace rcpputils
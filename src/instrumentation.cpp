@@ -0,0 +1,123 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#include "rcpputils/instrumentation.hpp"
+
+namespace rcpputils
+{
+namespace instrumentation
+{
+
+namespace
+{
+
+// Metrics are heap allocated so their addresses never change, and are only read or reset
+// through the registry; writers hold direct references and never take the mutex.
+class Registry
+{
+public:
+  Counter & counter(std::string_view name)
+  {
+    return find_or_create(counters_, name);
+  }
+
+  Histogram & histogram(std::string_view name)
+  {
+    return find_or_create(histograms_, name);
+  }
+
+  Snapshot snapshot() const
+  {
+    Snapshot result;
+    std::lock_guard<std::mutex> lock(mutex_);
+    result.counters.reserve(counters_.size());
+    for (const auto & [name, metric] : counters_) {
+      result.counters.push_back({name, metric->value()});
+    }
+    result.histograms.reserve(histograms_.size());
+    for (const auto & [name, metric] : histograms_) {
+      result.histograms.push_back({name, metric->snapshot()});
+    }
+    return result;
+  }
+
+  void reset()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto & entry : counters_) {
+      entry.second->reset();
+    }
+    for (auto & entry : histograms_) {
+      entry.second->reset();
+    }
+  }
+
+private:
+  template<typename MetricT>
+  using Metrics = std::map<std::string, std::unique_ptr<MetricT>, std::less<>>;
+
+  template<typename MetricT>
+  MetricT & find_or_create(Metrics<MetricT> & metrics, std::string_view name)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = metrics.find(name);
+    if (it == metrics.end()) {
+      it = metrics.emplace(std::string(name), std::make_unique<MetricT>()).first;
+    }
+    return *it->second;
+  }
+
+  mutable std::mutex mutex_;
+  Metrics<Counter> counters_;
+  Metrics<Histogram> histograms_;
+};
+
+Registry & registry()
+{
+  // Never destroyed, so that metrics can be updated from static destructors.
+  static Registry * instance = new Registry();
+  return *instance;
+}
+
+}  // namespace
+
+Counter & counter(std::string_view name)
+{
+  return registry().counter(name);
+}
+
+Histogram & histogram(std::string_view name)
+{
+  return registry().histogram(name);
+}
+
+Snapshot snapshot()
+{
+  return registry().snapshot();
+}
+
+void reset()
+{
+  registry().reset();
+}
+
+}  // namespace instrumentation
+}  // namespace rcpputils
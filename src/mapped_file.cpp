@@ -0,0 +1,355 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include "rcpputils/mapped_file.hpp"
+
+namespace rcpputils
+{
+namespace fs
+{
+
+namespace
+{
+
+// Chunk size used when the contents have to be read into a buffer.
+constexpr std::size_t kReadChunkSize = 64u * 1024u;
+
+#ifdef _WIN32
+
+std::error_code last_error() noexcept
+{
+  return {static_cast<int>(GetLastError()), std::system_category()};
+}
+
+class FileHandle
+{
+public:
+  explicit FileHandle(HANDLE handle) noexcept
+  : handle_(handle)
+  {}
+
+  ~FileHandle()
+  {
+    if (handle_ != nullptr && handle_ != INVALID_HANDLE_VALUE) {
+      CloseHandle(handle_);
+    }
+  }
+
+  FileHandle(const FileHandle &) = delete;
+  FileHandle & operator=(const FileHandle &) = delete;
+
+  HANDLE get() const noexcept
+  {
+    return handle_;
+  }
+
+private:
+  HANDLE handle_;
+};
+
+void read_all(HANDLE file, std::string & buffer, std::error_code & ec)
+{
+  std::size_t used = 0u;
+  for (;; ) {
+    buffer.resize(used + kReadChunkSize);
+    DWORD count = 0;
+    if (!ReadFile(file, &buffer[used], static_cast<DWORD>(kReadChunkSize), &count, nullptr)) {
+      // The write end of a pipe was closed.
+      if (GetLastError() == ERROR_BROKEN_PIPE) {
+        break;
+      }
+      ec = last_error();
+      return;
+    }
+    if (count == 0) {
+      break;
+    }
+    used += count;
+  }
+  buffer.resize(used);
+}
+
+#else
+
+std::error_code last_error() noexcept
+{
+  return {errno, std::system_category()};
+}
+
+class FileDescriptor
+{
+public:
+  explicit FileDescriptor(int fd) noexcept
+  : fd_(fd)
+  {}
+
+  ~FileDescriptor()
+  {
+    if (fd_ >= 0) {
+      ::close(fd_);
+    }
+  }
+
+  FileDescriptor(const FileDescriptor &) = delete;
+  FileDescriptor & operator=(const FileDescriptor &) = delete;
+
+  int get() const noexcept
+  {
+    return fd_;
+  }
+
+private:
+  int fd_;
+};
+
+void read_all(int fd, std::size_t size_hint, std::string & buffer, std::error_code & ec)
+{
+  std::size_t used = 0u;
+  // One extra byte detects the end of the file without a second, larger resize.
+  std::size_t capacity = size_hint > 0u ? size_hint + 1u : kReadChunkSize;
+  for (;; ) {
+    buffer.resize(capacity);
+    const ssize_t count = ::read(fd, &buffer[used], capacity - used);
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      ec = last_error();
+      return;
+    }
+    if (count == 0) {
+      break;
+    }
+    used += static_cast<std::size_t>(count);
+    if (used == capacity) {
+      capacity += capacity < kReadChunkSize ? kReadChunkSize : capacity;
+    }
+  }
+  buffer.resize(used);
+}
+
+int to_madvise(access_advice advice) noexcept
+{
+  switch (advice) {
+    case access_advice::sequential:
+      return MADV_SEQUENTIAL;
+    case access_advice::random:
+      return MADV_RANDOM;
+    case access_advice::will_need:
+      return MADV_WILLNEED;
+    case access_advice::normal:
+    default:
+      return MADV_NORMAL;
+  }
+}
+
+#endif
+
+}  // namespace
+
+mapped_file::mapped_file(const path & p, access_advice advice)
+{
+  std::error_code ec;
+  open(p, advice, ec);
+  if (ec) {
+    close();
+    throw std::system_error{ec, "cannot map file: " + p.string()};
+  }
+}
+
+mapped_file::mapped_file(const path & p, std::error_code & ec, access_advice advice) noexcept
+{
+  ec.clear();
+  try {
+    open(p, advice, ec);
+  } catch (const std::bad_alloc &) {
+    ec = std::make_error_code(std::errc::not_enough_memory);
+  }
+  if (ec) {
+    close();
+  }
+}
+
+mapped_file::mapped_file(mapped_file && other) noexcept
+{
+  *this = std::move(other);
+}
+
+mapped_file & mapped_file::operator=(mapped_file && other) noexcept
+{
+  if (this != &other) {
+    close();
+    mapping_ = std::exchange(other.mapping_, nullptr);
+    size_ = std::exchange(other.size_, 0u);
+    is_open_ = std::exchange(other.is_open_, false);
+    buffer_ = std::move(other.buffer_);
+    other.buffer_.clear();
+    // A short buffer may have been stored inline, so point into the moved-to copy.
+    data_ = mapping_ != nullptr ? std::exchange(other.data_, nullptr) : buffer_.data();
+    other.data_ = nullptr;
+  }
+  return *this;
+}
+
+mapped_file::~mapped_file()
+{
+  close();
+}
+
+void mapped_file::open(const path & p, access_advice advice, std::error_code & ec)
+{
+#ifdef _WIN32
+  const DWORD flags =
+    advice == access_advice::sequential ? FILE_FLAG_SEQUENTIAL_SCAN :
+    advice == access_advice::random ? FILE_FLAG_RANDOM_ACCESS : FILE_ATTRIBUTE_NORMAL;
+  FileHandle file(
+    CreateFileA(
+      p.string().c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+      nullptr, OPEN_EXISTING, flags, nullptr));
+  if (file.get() == INVALID_HANDLE_VALUE) {
+    ec = last_error();
+    return;
+  }
+  LARGE_INTEGER file_size{};
+  if (GetFileType(file.get()) != FILE_TYPE_DISK || !GetFileSizeEx(file.get(), &file_size) ||
+    file_size.QuadPart == 0)
+  {
+    read_all(file.get(), buffer_, ec);
+    if (!ec) {
+      data_ = buffer_.data();
+      size_ = buffer_.size();
+      is_open_ = true;
+    }
+    return;
+  }
+  if (static_cast<std::uint64_t>(file_size.QuadPart) > std::numeric_limits<std::size_t>::max()) {
+    ec = std::make_error_code(std::errc::file_too_large);
+    return;
+  }
+  // The view keeps the mapping alive, so neither handle is needed once it is created.
+  FileHandle mapping(CreateFileMappingA(file.get(), nullptr, PAGE_READONLY, 0, 0, nullptr));
+  if (mapping.get() == nullptr) {
+    ec = last_error();
+    return;
+  }
+  mapping_ = MapViewOfFile(mapping.get(), FILE_MAP_READ, 0, 0, 0);
+  if (mapping_ == nullptr) {
+    ec = last_error();
+    return;
+  }
+  data_ = static_cast<const char *>(mapping_);
+  size_ = static_cast<std::size_t>(file_size.QuadPart);
+  is_open_ = true;
+#else
+  int fd;
+  do {
+    fd = ::open(p.string().c_str(), O_RDONLY | O_CLOEXEC);
+  } while (fd < 0 && errno == EINTR);
+  const FileDescriptor file(fd);
+  if (file.get() < 0) {
+    ec = last_error();
+    return;
+  }
+  struct stat st;
+  if (::fstat(file.get(), &st) != 0) {
+    ec = last_error();
+    return;
+  }
+  if (S_ISDIR(st.st_mode)) {
+    ec = std::make_error_code(std::errc::is_a_directory);
+    return;
+  }
+  if (static_cast<std::uintmax_t>(st.st_size) > std::numeric_limits<std::size_t>::max()) {
+    ec = std::make_error_code(std::errc::file_too_large);
+    return;
+  }
+  const std::size_t file_size = static_cast<std::size_t>(st.st_size);
+  if (S_ISREG(st.st_mode) && file_size > 0u) {
+    void * mapping = ::mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, file.get(), 0);
+    if (mapping != MAP_FAILED) {
+      mapping_ = mapping;
+      data_ = static_cast<const char *>(mapping_);
+      size_ = file_size;
+      is_open_ = true;
+      if (advice != access_advice::normal) {
+        advise(advice);
+      }
+      return;
+    }
+    // Some file systems do not support mapping; read the file instead.
+  }
+  if (S_ISREG(st.st_mode) && advice == access_advice::sequential) {
+    ::posix_fadvise(file.get(), 0, 0, POSIX_FADV_SEQUENTIAL);
+  }
+  read_all(file.get(), S_ISREG(st.st_mode) ? file_size : 0u, buffer_, ec);
+  if (!ec) {
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+    is_open_ = true;
+  }
+#endif
+}
+
+bool mapped_file::advise(access_advice advice) noexcept
+{
+#ifdef _WIN32
+  (void)advice;
+  return false;
+#else
+  if (mapping_ == nullptr) {
+    return false;
+  }
+  return ::madvise(mapping_, size_, to_madvise(advice)) == 0;
+#endif
+}
+
+void mapped_file::close() noexcept
+{
+  if (mapping_ != nullptr) {
+#ifdef _WIN32
+    UnmapViewOfFile(mapping_);
+#else
+    ::munmap(mapping_, size_);
+#endif
+    mapping_ = nullptr;
+  }
+  std::string().swap(buffer_);
+  data_ = nullptr;
+  size_ = 0u;
+  is_open_ = false;
+}
+
+}  // namespace fs
+}  // namespace rcpputils
@@ -12,30 +12,252 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#ifndef _WIN32
+#include <dlfcn.h>
+#endif
+#include <stdlib.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "rcutils/error_handling.h"
 
+#include "rcpputils/instrumentation.hpp"
+#include "rcpputils/platform_library_name.hpp"
 #include "rcpputils/shared_library.hpp"
 
 namespace rcpputils
 {
+
+namespace detail
+{
+
+/// Symbols resolved in a library, readable without locking.
+/**
+ * Each bucket is a singly-linked list whose head is published with release semantics;
+ * nodes are never modified or freed while they are reachable, except by clear().
+ * Writers are serialized by a mutex.
+ */
+class SymbolCache
+{
+public:
+  ~SymbolCache()
+  {
+    clear();
+  }
+
+  /// Look up a cached symbol; returns false if the name was never resolved.
+  bool find(std::string_view name, void *& symbol) const noexcept
+  {
+    const Node * node = buckets_[bucket(name)].load(std::memory_order_acquire);
+    for (; node != nullptr; node = node->next) {
+      if (node->name == name) {
+        symbol = node->symbol;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// Return the cached symbol, resolving and caching it first if needed.
+  template<typename ResolveT>
+  void * find_or_resolve(std::string_view name, ResolveT && resolve)
+  {
+    void * symbol = nullptr;
+    if (find(name, symbol)) {
+      return symbol;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Another thread may have resolved it in the meantime.
+    if (find(name, symbol)) {
+      return symbol;
+    }
+    auto & head = buckets_[bucket(name)];
+    Node * node = new Node{std::string(name), nullptr, head.load(std::memory_order_relaxed)};
+    node->symbol = resolve(node->name.c_str());
+    head.store(node, std::memory_order_release);
+    return node->symbol;
+  }
+
+  /// Forget all symbols; must not race with find().
+  void clear() noexcept
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto & head : buckets_) {
+      Node * node = head.exchange(nullptr, std::memory_order_acq_rel);
+      while (node != nullptr) {
+        Node * next = node->next;
+        delete node;
+        node = next;
+      }
+    }
+  }
+
+private:
+  struct Node
+  {
+    std::string name;
+    void * symbol;
+    Node * next;
+  };
+
+  static constexpr size_t kBucketCount = 32;
+
+  static size_t bucket(std::string_view name) noexcept
+  {
+    return std::hash<std::string_view>{}(name) % kBucketCount;
+  }
+
+  std::array<std::atomic<Node *>, kBucketCount> buckets_{};
+  std::mutex mutex_;
+};
+
+}  // namespace detail
+
+namespace
+{
+
+class SharedLibraryCategory : public std::error_category
+{
+public:
+  const char * name() const noexcept override
+  {
+    return "rcpputils.shared_library";
+  }
+
+  std::string message(int condition) const override
+  {
+    switch (static_cast<shared_library_errc>(condition)) {
+      case shared_library_errc::load_failed:
+        return "the library could not be loaded";
+      case shared_library_errc::unload_failed:
+        return "the library could not be unloaded";
+      case shared_library_errc::not_loaded:
+        return "the library is not loaded";
+      case shared_library_errc::symbol_not_found:
+        return "the symbol could not be found in the library";
+      case shared_library_errc::invalid_library_name:
+        return "the library name is not valid";
+    }
+    return "unknown shared library error";
+  }
+};
+
+// Clear the pending rcutils error, copying its message only if the caller asked for it.
+void take_rcutils_error(std::string * error_message)
+{
+  if (error_message != nullptr) {
+    *error_message = rcutils_get_error_string().str;
+  }
+  rcutils_reset_error();
+}
+
+}  // namespace
+
+const std::error_category & shared_library_category() noexcept
+{
+  static const SharedLibraryCategory category;
+  return category;
+}
+
 SharedLibrary::SharedLibrary(const std::string & library_path)
+: SharedLibrary(library_path, SharedLibraryLoadOptions())
+{}
+
+SharedLibrary::SharedLibrary(
+  const std::string & library_path, const SharedLibraryLoadOptions & options)
+: lib(rcutils_get_zero_initialized_shared_library()),
+  symbols_(std::make_unique<detail::SymbolCache>())
+{
+  std::error_code ec;
+  std::string error_message;
+  load(library_path, options, ec, &error_message);
+  if (ec) {
+    if (ec == std::errc::not_enough_memory) {
+      throw std::bad_alloc();
+    }
+    throw std::runtime_error{error_message};
+  }
+}
+
+SharedLibrary::SharedLibrary(const std::string & library_path, std::error_code & ec)
+: SharedLibrary(library_path, SharedLibraryLoadOptions(), ec)
+{}
+
+SharedLibrary::SharedLibrary(
+  const std::string & library_path, const SharedLibraryLoadOptions & options,
+  std::error_code & ec)
+: lib(rcutils_get_zero_initialized_shared_library()),
+  symbols_(std::make_unique<detail::SymbolCache>())
 {
-  lib = rcutils_get_zero_initialized_shared_library();
+  load(library_path, options, ec, nullptr);
+}
+
+void SharedLibrary::load(
+  const std::string & library_path, const SharedLibraryLoadOptions & options,
+  std::error_code & ec, std::string * error_message)
+{
+  RCPPUTILS_TRACE_SCOPE("rcpputils.shared_library.load");
+  ec.clear();
+#ifndef _WIN32
+  // rcutils always opens libraries with RTLD_LAZY | RTLD_LOCAL. Opening the library first with
+  // the requested flags makes the loader apply them; rcutils then gets the same handle, and the
+  // extra reference is dropped once it holds its own.
+  void * preopened = nullptr;
+  const SharedLibraryLoadOptions defaults;
+  if (options.binding != defaults.binding || options.visibility != defaults.visibility ||
+    options.no_delete != defaults.no_delete)
+  {
+    int flags = options.binding == SharedLibraryLoadOptions::Binding::now ? RTLD_NOW : RTLD_LAZY;
+    flags |= options.visibility == SharedLibraryLoadOptions::Visibility::global ?
+      RTLD_GLOBAL : RTLD_LOCAL;
+    if (options.no_delete) {
+      flags |= RTLD_NODELETE;
+    }
+    preopened = dlopen(library_path.c_str(), flags);
+    if (preopened == nullptr) {
+      const char * error = dlerror();
+      if (error_message != nullptr) {
+        *error_message = error != nullptr ? error : "failed to load " + library_path;
+      }
+      ec = shared_library_errc::load_failed;
+      return;
+    }
+  }
+#else
+  (void) options;
+#endif
+
   rcutils_ret_t ret = rcutils_load_shared_library(
     &lib,
     library_path.c_str(),
     rcutils_get_default_allocator());
+#ifndef _WIN32
+  if (preopened != nullptr) {
+    dlclose(preopened);
+  }
+#endif
   if (ret != RCUTILS_RET_OK) {
     if (ret == RCUTILS_RET_BAD_ALLOC) {
-      throw std::bad_alloc();
+      ec = std::make_error_code(std::errc::not_enough_memory);
     } else {
-      std::string rcutils_error_str(rcutils_get_error_string().str);
-      rcutils_reset_error();
-      throw std::runtime_error{rcutils_error_str};
+      ec = shared_library_errc::load_failed;
     }
+    take_rcutils_error(error_message);
   }
 }
 
@@ -52,29 +274,83 @@ SharedLibrary::~SharedLibrary()
 
 void SharedLibrary::unload_library()
 {
+  symbols_->clear();
   rcutils_ret_t ret = rcutils_unload_shared_library(&lib);
   if (ret != RCUTILS_RET_OK) {
-    std::string rcutils_error_str(rcutils_get_error_string().str);
-    rcutils_reset_error();
+    std::string rcutils_error_str;
+    take_rcutils_error(&rcutils_error_str);
     throw std::runtime_error{rcutils_error_str};
   }
 }
 
+void SharedLibrary::unload_library(std::error_code & ec) noexcept
+{
+  ec.clear();
+  if (!rcutils_is_shared_library_loaded(&lib)) {
+    ec = shared_library_errc::not_loaded;
+    return;
+  }
+  symbols_->clear();
+  if (rcutils_unload_shared_library(&lib) != RCUTILS_RET_OK) {
+    ec = shared_library_errc::unload_failed;
+    take_rcutils_error(nullptr);
+  }
+}
+
 void * SharedLibrary::get_symbol(const std::string & symbol_name)
 {
-  void * lib_symbol = rcutils_get_symbol(&lib, symbol_name.c_str());
+  void * lib_symbol = try_get_symbol(symbol_name);
+  if (!lib_symbol) {
+    throw_symbol_not_found(symbol_name);
+  }
+  return lib_symbol;
+}
 
+void * SharedLibrary::get_symbol(std::string_view symbol_name, std::error_code & ec)
+{
+  ec.clear();
+  if (!rcutils_is_shared_library_loaded(&lib)) {
+    ec = shared_library_errc::not_loaded;
+    return nullptr;
+  }
+  void * lib_symbol = try_get_symbol(symbol_name);
   if (!lib_symbol) {
-    std::string rcutils_error_str(rcutils_get_error_string().str);
-    rcutils_reset_error();
-    throw std::runtime_error{rcutils_error_str};
+    ec = shared_library_errc::symbol_not_found;
   }
   return lib_symbol;
 }
 
+void * SharedLibrary::try_get_symbol(std::string_view symbol_name)
+{
+  if (!rcutils_is_shared_library_loaded(&lib)) {
+    return nullptr;
+  }
+  // Cached lookups take a few nanoseconds, so they are only counted; resolutions are timed.
+  RCPPUTILS_COUNTER_INCREMENT("rcpputils.shared_library.get_symbol");
+  return symbols_->find_or_resolve(
+    symbol_name, [this](const char * name) {
+      RCPPUTILS_TRACE_SCOPE("rcpputils.shared_library.resolve_symbol");
+      void * lib_symbol = rcutils_get_symbol(&lib, name);
+      if (!lib_symbol) {
+        rcutils_reset_error();
+      }
+      return lib_symbol;
+    });
+}
+
+void SharedLibrary::throw_symbol_not_found(std::string_view symbol_name)
+{
+  std::string error_str = "symbol '";
+  error_str += symbol_name;
+  error_str += "' could not be found in library '";
+  error_str += lib.library_path != nullptr ? lib.library_path : "";
+  error_str += "'";
+  throw std::runtime_error{error_str};
+}
+
 bool SharedLibrary::has_symbol(const std::string & symbol_name)
 {
-  return rcutils_has_symbol(&lib, symbol_name.c_str());
+  return try_get_symbol(symbol_name) != nullptr;
 }
 
 std::string SharedLibrary::get_library_path()
@@ -85,20 +361,270 @@ std::string SharedLibrary::get_library_path()
   throw std::runtime_error{"Library path is not defined"};
 }
 
-std::string get_platform_library_name(std::string library_name, bool debug)
+namespace
 {
-  char library_name_platform[1024]{};
-  rcutils_ret_t ret = rcutils_get_platform_library_name(
-    library_name.c_str(),
-    library_name_platform,
-    1024,
-    debug);
-  if (ret != RCUTILS_RET_OK) {
-    std::string rcutils_error_str(rcutils_get_error_string().str);
-    rcutils_reset_error();
-    throw std::runtime_error{rcutils_error_str};
+
+// Resolve symbolic links and relative components, so that different spellings of the path of a
+// library share a registry entry. Names the platform resolves through its search path are kept
+// as given.
+std::string canonical_library_path(const std::string & library_path)
+{
+#ifdef _WIN32
+  char * resolved = _fullpath(nullptr, library_path.c_str(), 0);
+#else
+  char * resolved = realpath(library_path.c_str(), nullptr);
+#endif
+  if (resolved == nullptr) {
+    return library_path;
+  }
+  std::string canonical(resolved);
+  free(resolved);
+  return canonical;
+}
+
+/// A few worker threads running background loads for the whole process.
+class LoadPool
+{
+public:
+  LoadPool()
+  : thread_count_(std::clamp(std::thread::hardware_concurrency(), 1u, 4u))
+  {}
+
+  ~LoadPool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    condition_.notify_all();
+    for (auto & worker : workers_) {
+      worker.join();
+    }
+  }
+
+  LoadPool(const LoadPool &) = delete;
+  LoadPool & operator=(const LoadPool &) = delete;
+
+  static LoadPool & instance()
+  {
+    static LoadPool pool;
+    return pool;
+  }
+
+  void post(std::function<void()> job)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      jobs_.push_back(std::move(job));
+      // Workers are started on demand, so processes that never load asynchronously don't
+      // pay for them.
+      if (workers_.size() < thread_count_ && workers_.size() < jobs_.size() + busy_) {
+        workers_.emplace_back([this]() {run();});
+      }
+    }
+    condition_.notify_one();
+  }
+
+private:
+  void run()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      condition_.wait(lock, [this]() {return stopping_ || !jobs_.empty();});
+      if (jobs_.empty()) {
+        return;
+      }
+      std::function<void()> job = std::move(jobs_.front());
+      jobs_.pop_front();
+      ++busy_;
+      lock.unlock();
+      job();
+      lock.lock();
+      --busy_;
+    }
+  }
+
+  const size_t thread_count_;
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  std::deque<std::function<void()>> jobs_;
+  std::vector<std::thread> workers_;
+  size_t busy_ = 0;
+  bool stopping_ = false;
+};
+
+}  // namespace
+
+struct SharedLibraryRegistry::Impl
+{
+  struct Entry
+  {
+    // Serializes loading of this library; held while the loader runs.
+    std::mutex load_mutex;
+    // Guarded by Impl::mutex.
+    std::weak_ptr<SharedLibrary> library;
+  };
+
+  mutable std::mutex mutex;
+  std::unordered_map<std::string, std::shared_ptr<Entry>> libraries;
+  std::unordered_map<std::string, std::shared_ptr<SharedLibrary>> retained;
+  bool defer_unload = false;
+
+  // Must be called with mutex held. Drop the entry of a key nobody holds or is loading.
+  void erase_if_unused(const std::string & key)
+  {
+    auto it = libraries.find(key);
+    if (it != libraries.end() && it->second.use_count() == 1 && it->second->library.expired()) {
+      libraries.erase(it);
+    }
+  }
+};
+
+SharedLibraryRegistry::SharedLibraryRegistry()
+: impl_(std::make_shared<Impl>())
+{}
+
+SharedLibraryRegistry & SharedLibraryRegistry::instance()
+{
+  static SharedLibraryRegistry registry;
+  return registry;
+}
+
+std::shared_ptr<SharedLibrary> SharedLibraryRegistry::load(const std::string & library_path)
+{
+  return load(library_path, SharedLibraryLoadOptions());
+}
+
+std::shared_ptr<SharedLibrary> SharedLibraryRegistry::load(
+  const std::string & library_path, const SharedLibraryLoadOptions & options)
+{
+  const std::string key = canonical_library_path(library_path);
+
+  std::shared_ptr<Impl::Entry> entry;
+  {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    auto & slot = impl_->libraries[key];
+    if (!slot) {
+      slot = std::make_shared<Impl::Entry>();
+    } else if (auto library = slot->library.lock()) {
+      return library;
+    }
+    entry = slot;
+  }
+
+  // Only loads of the same library wait for each other.
+  std::lock_guard<std::mutex> load_lock(entry->load_mutex);
+  {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    if (auto library = entry->library.lock()) {
+      return library;
+    }
+  }
+
+  // The deleter may outlive the registry during static destruction, so it only holds a weak
+  // reference to it.
+  auto deleter = [weak_impl = std::weak_ptr<Impl>(impl_), key](SharedLibrary * library) {
+      if (auto impl = weak_impl.lock()) {
+        std::lock_guard<std::mutex> lock(impl->mutex);
+        impl->erase_if_unused(key);
+      }
+      delete library;
+    };
+  std::shared_ptr<SharedLibrary> library;
+  try {
+    library.reset(new SharedLibrary(library_path, options), std::move(deleter));
+  } catch (...) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    entry.reset();
+    impl_->erase_if_unused(key);
+    throw;
+  }
+
+  std::lock_guard<std::mutex> lock(impl_->mutex);
+  entry->library = library;
+  if (impl_->defer_unload) {
+    impl_->retained[key] = library;
+  }
+  return library;
+}
+
+std::future<std::shared_ptr<SharedLibrary>> SharedLibraryRegistry::load_async(
+  const std::string & library_path, const SharedLibraryLoadOptions & options)
+{
+  auto task = std::make_shared<std::packaged_task<std::shared_ptr<SharedLibrary>()>>(
+    [this, library_path, options]() {return load(library_path, options);});
+  auto future = task->get_future();
+  LoadPool::instance().post([task]() {(*task)();});
+  return future;
+}
+
+void SharedLibraryRegistry::set_deferred_unload(bool enabled)
+{
+  std::unordered_map<std::string, std::shared_ptr<SharedLibrary>> released;
+  {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    impl_->defer_unload = enabled;
+    if (enabled) {
+      for (const auto & entry : impl_->libraries) {
+        if (auto library = entry.second->library.lock()) {
+          impl_->retained.emplace(entry.first, std::move(library));
+        }
+      }
+    } else {
+      released.swap(impl_->retained);
+    }
+  }
+  // Libraries are unloaded here, outside of the lock their deleters take.
+}
+
+bool SharedLibraryRegistry::deferred_unload() const
+{
+  std::lock_guard<std::mutex> lock(impl_->mutex);
+  return impl_->defer_unload;
+}
+
+void SharedLibraryRegistry::release_deferred()
+{
+  std::unordered_map<std::string, std::shared_ptr<SharedLibrary>> released;
+  {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    released.swap(impl_->retained);
+  }
+}
+
+size_t SharedLibraryRegistry::size() const
+{
+  std::lock_guard<std::mutex> lock(impl_->mutex);
+  size_t count = 0;
+  for (const auto & entry : impl_->libraries) {
+    if (!entry.second->library.expired()) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+std::string get_platform_library_name(const std::string & library_name, bool debug)
+{
+  std::error_code ec;
+  std::string name = get_platform_library_name(library_name, debug, ec);
+  if (ec) {
+    throw std::runtime_error{"library name must not contain null characters"};
+  }
+  return name;
+}
+
+std::string get_platform_library_name(
+  const std::string & library_name, bool debug, std::error_code & ec)
+{
+  ec.clear();
+  if (library_name.find('\0') != std::string::npos) {
+    ec = shared_library_errc::invalid_library_name;
+    return std::string();
   }
-  return std::string(library_name_platform);
+  std::string name;
+  append_platform_library_name(name, library_name, debug);
+  return name;
 }
 
 }  // namespace rcpputils
@@ -0,0 +1,375 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifdef _WIN32
+#include <direct.h>
+#include <fcntl.h>
+#include <io.h>
+#include <share.h>
+#include <sys/stat.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+#endif
+
+#include <cstdint>
+#include <new>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#ifdef _WIN32
+#include <atomic>
+#include <chrono>
+#include <random>
+#endif
+
+#include "rcpputils/temp_file.hpp"
+
+namespace rcpputils
+{
+namespace fs
+{
+
+namespace
+{
+
+constexpr char kUniqueSuffixPlaceholder[] = "XXXXXX";
+constexpr std::size_t kUniqueSuffixLength = sizeof(kUniqueSuffixPlaceholder) - 1u;
+
+void close_descriptor(int fd) noexcept
+{
+#ifdef _WIN32
+  _close(fd);
+#else
+  ::close(fd);
+#endif
+}
+
+void remove_entry(const char * name, bool is_directory) noexcept
+{
+#ifdef _WIN32
+  if (is_directory) {
+    _rmdir(name);
+  } else {
+    _unlink(name);
+  }
+#else
+  if (is_directory) {
+    ::rmdir(name);
+  } else {
+    ::unlink(name);
+  }
+#endif
+}
+
+// Build the template parent/prefixXXXXXX, whose placeholder is replaced in place.
+bool make_template(
+  const std::string & prefix, const path & parent, std::string & name, std::error_code & ec)
+{
+  if (prefix.find_first_of("/\\") != std::string::npos) {
+    ec = std::make_error_code(std::errc::invalid_argument);
+    return false;
+  }
+  name = (parent / (prefix + kUniqueSuffixPlaceholder)).string();
+  return true;
+}
+
+#ifdef _WIN32
+
+// Windows has no mkdtemp or mkstemp: fill the placeholder with random characters and retry
+// while the name is taken.
+constexpr int kMaxAttempts = 100;
+
+template<typename CreateFunction>
+bool create_unique(std::string & name, CreateFunction create, std::error_code & ec)
+{
+  static constexpr char kCharacters[] =
+    "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+  static std::atomic<std::uint64_t> counter{0u};
+  thread_local std::minstd_rand generator(
+    static_cast<std::minstd_rand::result_type>(
+      std::random_device{}() ^
+      static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count()) ^
+      counter.fetch_add(1u)));
+  std::uniform_int_distribution<std::size_t> character(0u, sizeof(kCharacters) - 2u);
+  const std::size_t suffix = name.size() - kUniqueSuffixLength;
+  for (int attempt = 0; attempt < kMaxAttempts; ++attempt) {
+    for (std::size_t i = 0; i < kUniqueSuffixLength; ++i) {
+      name[suffix + i] = kCharacters[character(generator)];
+    }
+    if (create(name.c_str())) {
+      return true;
+    }
+    if (errno != EEXIST) {
+      break;
+    }
+  }
+  ec = {errno, std::generic_category()};
+  return false;
+}
+
+int open_unique_file(std::string & name, int extra_flags, std::error_code & ec)
+{
+  int fd = -1;
+  const bool created = create_unique(
+    name, [&fd, extra_flags](const char * candidate) {
+      return _sopen_s(
+        &fd, candidate, _O_CREAT | _O_EXCL | _O_RDWR | _O_BINARY | _O_NOINHERIT | extra_flags,
+        _SH_DENYNO, _S_IREAD | _S_IWRITE) == 0;
+    }, ec);
+  return created ? fd : -1;
+}
+
+#else
+
+int open_unique_file(std::string & name, std::error_code & ec)
+{
+#ifdef __linux__
+  const int fd = ::mkostemp(&name[0], O_CLOEXEC);
+#else
+  const int fd = ::mkstemp(&name[0]);
+  if (fd >= 0) {
+    ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+  }
+#endif
+  if (fd < 0) {
+    ec = {errno, std::generic_category()};
+  }
+  return fd;
+}
+
+#endif
+
+}  // namespace
+
+temp_directory::temp_directory(temp_directory && other) noexcept
+: path_(other.release())
+{}
+
+temp_directory & temp_directory::operator=(temp_directory && other) noexcept
+{
+  if (this != &other) {
+    std::error_code ec;
+    remove(ec);
+    path_ = other.release();
+  }
+  return *this;
+}
+
+temp_directory::~temp_directory()
+{
+  std::error_code ec;
+  remove(ec);
+}
+
+fs::path temp_directory::release() noexcept
+{
+  fs::path p = std::move(path_);
+  path_ = fs::path();
+  return p;
+}
+
+std::uintmax_t temp_directory::remove(std::error_code & ec) noexcept
+{
+  ec.clear();
+  if (path_.empty()) {
+    return 0u;
+  }
+  const std::uintmax_t count = remove_all(path_, ec);
+  if (!ec) {
+    path_ = fs::path();
+  }
+  return count;
+}
+
+temp_file::temp_file(temp_file && other) noexcept
+: fd_(std::exchange(other.fd_, -1)), path_(std::move(other.path_))
+{
+  other.path_ = fs::path();
+}
+
+temp_file & temp_file::operator=(temp_file && other) noexcept
+{
+  if (this != &other) {
+    close();
+    fd_ = std::exchange(other.fd_, -1);
+    path_ = std::move(other.path_);
+    other.path_ = fs::path();
+  }
+  return *this;
+}
+
+temp_file::~temp_file()
+{
+  close();
+}
+
+fs::path temp_file::release() noexcept
+{
+  if (fd_ >= 0) {
+    close_descriptor(std::exchange(fd_, -1));
+  }
+  fs::path p = std::move(path_);
+  path_ = fs::path();
+  return p;
+}
+
+void temp_file::close() noexcept
+{
+  // Windows cannot delete a file which is still open.
+  if (fd_ >= 0) {
+    close_descriptor(std::exchange(fd_, -1));
+  }
+  if (!path_.empty()) {
+    remove_entry(path_.c_str(), false);
+    path_ = fs::path();
+  }
+}
+
+temp_directory create_temp_directory(const std::string & prefix, const path & parent)
+{
+  std::error_code ec;
+  temp_directory directory = create_temp_directory(prefix, parent, ec);
+  if (ec) {
+    throw std::system_error{ec, "cannot create temporary directory in " + parent.string()};
+  }
+  return directory;
+}
+
+temp_directory create_temp_directory(
+  const std::string & prefix, const path & parent, std::error_code & ec) noexcept
+{
+  ec.clear();
+  try {
+    std::string name;
+    if (!make_template(prefix, parent, name, ec)) {
+      return {};
+    }
+#ifdef _WIN32
+    if (!create_unique(name, [](const char * candidate) {return _mkdir(candidate) == 0;}, ec)) {
+      return {};
+    }
+#else
+    if (::mkdtemp(&name[0]) == nullptr) {
+      ec = {errno, std::generic_category()};
+      return {};
+    }
+#endif
+    try {
+      return temp_directory(path(name));
+    } catch (const std::bad_alloc &) {
+      remove_entry(name.c_str(), true);
+      throw;
+    }
+  } catch (const std::bad_alloc &) {
+    ec = std::make_error_code(std::errc::not_enough_memory);
+    return {};
+  }
+}
+
+temp_file create_temp_file(const std::string & prefix, const path & parent)
+{
+  std::error_code ec;
+  temp_file file = create_temp_file(prefix, parent, ec);
+  if (ec) {
+    throw std::system_error{ec, "cannot create temporary file in " + parent.string()};
+  }
+  return file;
+}
+
+temp_file create_temp_file(
+  const std::string & prefix, const path & parent, std::error_code & ec) noexcept
+{
+  ec.clear();
+  try {
+    std::string name;
+    if (!make_template(prefix, parent, name, ec)) {
+      return {};
+    }
+#ifdef _WIN32
+    const int fd = open_unique_file(name, 0, ec);
+#else
+    const int fd = open_unique_file(name, ec);
+#endif
+    if (fd < 0) {
+      return {};
+    }
+    try {
+      return temp_file(fd, path(name));
+    } catch (const std::bad_alloc &) {
+      close_descriptor(fd);
+      remove_entry(name.c_str(), false);
+      throw;
+    }
+  } catch (const std::bad_alloc &) {
+    ec = std::make_error_code(std::errc::not_enough_memory);
+    return {};
+  }
+}
+
+temp_file create_anonymous_temp_file(const path & parent)
+{
+  std::error_code ec;
+  temp_file file = create_anonymous_temp_file(parent, ec);
+  if (ec) {
+    throw std::system_error{ec, "cannot create anonymous temporary file in " + parent.string()};
+  }
+  return file;
+}
+
+temp_file create_anonymous_temp_file(const path & parent, std::error_code & ec) noexcept
+{
+  ec.clear();
+#if defined(__linux__) && defined(O_TMPFILE)
+  int fd;
+  do {
+    fd = ::open(parent.c_str(), O_TMPFILE | O_RDWR | O_CLOEXEC, 0600);
+  } while (fd < 0 && errno == EINTR);
+  if (fd >= 0) {
+    return temp_file(fd, path());
+  }
+  // Kernels and file systems without O_TMPFILE support report one of these.
+  if (errno != EOPNOTSUPP && errno != EISDIR && errno != EINVAL) {
+    ec = {errno, std::generic_category()};
+    return {};
+  }
+#endif
+  try {
+    std::string name;
+    make_template("rcpputils_", parent, name, ec);
+#ifdef _WIN32
+    // The file is deleted when its last handle is closed, including when the process dies.
+    const int fd = open_unique_file(name, _O_TEMPORARY, ec);
+    if (fd < 0) {
+      return {};
+    }
+#else
+    const int fd = open_unique_file(name, ec);
+    if (fd < 0) {
+      return {};
+    }
+    remove_entry(name.c_str(), false);
+#endif
+    return temp_file(fd, path());
+  } catch (const std::bad_alloc &) {
+    ec = std::make_error_code(std::errc::not_enough_memory);
+    return {};
+  }
+}
+
+}  // namespace fs
+}  // namespace rcpputils
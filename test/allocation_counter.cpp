@@ -0,0 +1,86 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#include "allocation_counter.hpp"
+
+namespace
+{
+
+std::atomic<std::size_t> g_allocations{0u};
+std::atomic<std::size_t> g_allocated_bytes{0u};
+
+void * counted_allocate(std::size_t size)
+{
+  g_allocations.fetch_add(1u, std::memory_order_relaxed);
+  g_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+  if (void * ptr = std::malloc(size == 0u ? 1u : size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+}  // namespace
+
+// The array and sized forms of delete default to these; the aligned forms are left alone.
+// Keeping the replacements out of the sources using them prevents the compiler from inlining
+// them and warning about a free() of memory it saw coming from operator new.
+void * operator new(std::size_t size)
+{
+  return counted_allocate(size);
+}
+
+void * operator new[](std::size_t size)
+{
+  return counted_allocate(size);
+}
+
+void operator delete(void * ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete[](void * ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void * ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete[](void * ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+namespace rcpputils_test
+{
+
+std::size_t allocation_count() noexcept
+{
+  return g_allocations.load(std::memory_order_relaxed);
+}
+
+std::size_t allocated_bytes() noexcept
+{
+  return g_allocated_bytes.load(std::memory_order_relaxed);
+}
+
+}  // namespace rcpputils_test
@@ -0,0 +1,63 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/*! \file allocation_counter.hpp
+ * \brief Heap allocation accounting shared by the tests and the benchmarks.
+ *
+ * allocation_counter.cpp replaces the global `operator new` of every executable it is linked
+ * into with one counting the calls and the bytes requested, in all threads.
+ */
+
+#ifndef TEST__ALLOCATION_COUNTER_HPP_
+#define TEST__ALLOCATION_COUNTER_HPP_
+
+#include <cstddef>
+
+namespace rcpputils_test
+{
+
+/// Number of calls to the global operator new since the start of the process.
+std::size_t allocation_count() noexcept;
+
+/// Number of bytes requested from the global operator new since the start of the process.
+std::size_t allocated_bytes() noexcept;
+
+/// Count the heap allocations made since it was constructed.
+class AllocationCounter
+{
+public:
+  AllocationCounter() noexcept
+  : allocations_(allocation_count()), bytes_(allocated_bytes())
+  {}
+
+  /// Number of calls to the global operator new since construction.
+  std::size_t count() const noexcept
+  {
+    return allocation_count() - allocations_;
+  }
+
+  /// Number of bytes requested from the global operator new since construction.
+  std::size_t bytes() const noexcept
+  {
+    return allocated_bytes() - bytes_;
+  }
+
+private:
+  const std::size_t allocations_;
+  const std::size_t bytes_;
+};
+
+}  // namespace rcpputils_test
+
+#endif  // TEST__ALLOCATION_COUNTER_HPP_
@@ -0,0 +1,205 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "rcpputils/allocators.hpp"
+#include "rcpputils/find_and_replace.hpp"
+#include "rcpputils/join.hpp"
+
+#include "allocation_counter.hpp"
+
+namespace
+{
+
+using arena_string =
+  std::basic_string<char, std::char_traits<char>, rcpputils::ArenaAllocator<char>>;
+
+bool is_aligned(const void * pointer, std::size_t alignment)
+{
+  return reinterpret_cast<std::uintptr_t>(pointer) % alignment == 0u;
+}
+
+}  // namespace
+
+TEST(test_allocators, pool_allocator_containers) {
+  std::list<int, rcpputils::PoolAllocator<int>> list;
+  for (int i = 0; i < 1000; ++i) {
+    list.push_back(i);
+  }
+  std::map<int, std::string, std::less<int>,
+    rcpputils::PoolAllocator<std::pair<const int, std::string>, 16>> map;
+  for (int i = 0; i < 100; ++i) {
+    map.emplace(i, std::to_string(i));
+  }
+  EXPECT_EQ(list.size(), 1000u);
+  EXPECT_EQ(map.at(42), "42");
+
+  // Freed nodes are reused without going back to the heap.
+  list.clear();
+  const std::size_t before = rcpputils_test::allocation_count();
+  for (int i = 0; i < 1000; ++i) {
+    list.push_back(i);
+  }
+  EXPECT_EQ(rcpputils_test::allocation_count(), before);
+
+  // Arrays fall back to std::allocator.
+  std::vector<double, rcpputils::PoolAllocator<double>> vector(100, 1.5);
+  EXPECT_EQ(vector[99], 1.5);
+
+  rcpputils::PoolAllocator<int> int_allocator;
+  rcpputils::PoolAllocator<double> double_allocator(int_allocator);
+  EXPECT_TRUE(int_allocator == double_allocator);
+  EXPECT_FALSE(int_allocator != double_allocator);
+}
+
+TEST(test_allocators, pool_allocator_alignment) {
+  struct alignas(64) Aligned
+  {
+    char data[3];
+  };
+  rcpputils::PoolAllocator<Aligned> allocator;
+  std::vector<Aligned *> objects;
+  for (int i = 0; i < 200; ++i) {
+    objects.push_back(allocator.allocate(1));
+    EXPECT_TRUE(is_aligned(objects.back(), 64u));
+  }
+  for (Aligned * object : objects) {
+    allocator.deallocate(object, 1);
+  }
+}
+
+TEST(test_allocators, pool_allocator_across_threads) {
+  // Nodes allocated by one thread and freed by another.
+  std::vector<std::list<int, rcpputils::PoolAllocator<int, 8>>> lists(4);
+  std::vector<std::thread> threads;
+  for (auto & list : lists) {
+    threads.emplace_back(
+      [&list]() {
+        for (int i = 0; i < 5000; ++i) {
+          list.push_back(i);
+        }
+      });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  for (auto & list : lists) {
+    EXPECT_EQ(list.size(), 5000u);
+    EXPECT_EQ(list.back(), 4999);
+    list.clear();
+  }
+}
+
+TEST(test_allocators, monotonic_arena) {
+  alignas(std::max_align_t) char buffer[256];
+  rcpputils::MonotonicArena arena(buffer, sizeof(buffer));
+  EXPECT_EQ(arena.capacity(), sizeof(buffer));
+
+  void * first = arena.allocate(10, 1);
+  EXPECT_EQ(first, buffer);
+  void * aligned = arena.allocate(8, 8);
+  EXPECT_TRUE(is_aligned(aligned, 8u));
+  EXPECT_EQ(static_cast<char *>(aligned), buffer + 16);
+  EXPECT_EQ(arena.bytes_used(), 24u);
+
+  // The last allocation can be given back.
+  arena.deallocate(aligned, 8);
+  EXPECT_EQ(arena.bytes_used(), 16u);
+  arena.deallocate(first, 10);
+  EXPECT_EQ(arena.bytes_used(), 16u);
+
+  // Overflow into heap blocks.
+  void * large = arena.allocate(1000, 64);
+  EXPECT_TRUE(is_aligned(large, 64u));
+  EXPECT_GE(arena.capacity(), sizeof(buffer) + 1000u);
+  EXPECT_GE(arena.bytes_used(), 1016u);
+  const std::size_t capacity = arena.capacity();
+
+  // Blocks are kept by reset().
+  arena.reset();
+  EXPECT_EQ(arena.bytes_used(), 0u);
+  EXPECT_EQ(arena.allocate(10, 1), buffer);
+  arena.allocate(1000, 64);
+  EXPECT_EQ(arena.capacity(), capacity);
+
+  arena.release();
+  EXPECT_EQ(arena.capacity(), sizeof(buffer));
+  EXPECT_EQ(arena.allocate(10, 1), buffer);
+}
+
+TEST(test_allocators, arena_allocator_containers) {
+  rcpputils::MonotonicArena arena(128);
+  rcpputils::ArenaAllocator<int> allocator(arena);
+  std::vector<int, rcpputils::ArenaAllocator<int>> vector(allocator);
+  for (int i = 0; i < 1000; ++i) {
+    vector.push_back(i);
+  }
+  EXPECT_EQ(vector[999], 999);
+  EXPECT_GE(arena.bytes_used(), 1000u * sizeof(int));
+
+  std::map<int, int, std::less<int>, rcpputils::ArenaAllocator<std::pair<const int, int>>> map(
+    allocator);
+  map[1] = 2;
+  EXPECT_EQ(map.get_allocator().arena(), &arena);
+
+  rcpputils::MonotonicArena other_arena;
+  EXPECT_TRUE(allocator == rcpputils::ArenaAllocator<char>(arena));
+  EXPECT_TRUE(allocator != rcpputils::ArenaAllocator<int>(other_arena));
+}
+
+TEST(test_allocators, string_helpers_in_arena) {
+  alignas(std::max_align_t) char buffer[4096];
+  rcpputils::MonotonicArena arena(buffer, sizeof(buffer));
+  const rcpputils::ArenaAllocator<char> allocator(arena);
+  const std::vector<std::string_view> tokens{"ns", "my_node_with_a_long_name", "topic"};
+  const rcpputils::FindAndReplaceSet<char> mangling{{"/", "__"}, {"_", "-"}};
+
+  const std::size_t before = rcpputils_test::allocation_count();
+  for (int i = 0; i < 10; ++i) {
+    {
+      arena_string joined = rcpputils::join(tokens, "/", allocator);
+      EXPECT_EQ(joined, "ns/my_node_with_a_long_name/topic");
+
+      arena_string replaced = rcpputils::find_and_replace(joined, "/", "::");
+      EXPECT_EQ(replaced, "ns::my_node_with_a_long_name::topic");
+      EXPECT_EQ(replaced.get_allocator(), allocator);
+
+      const std::size_t count = rcpputils::find_and_replace_in_place(
+        replaced, std::string_view(replaced).substr(2, 2), "/");
+      EXPECT_EQ(count, 2u);
+      EXPECT_EQ(replaced, "ns/my_node_with_a_long_name/topic");
+
+      arena_string mangled = rcpputils::find_and_replace(joined, mangling);
+      EXPECT_EQ(mangled, "ns__my-node-with-a-long-name__topic");
+      EXPECT_EQ(mangled.get_allocator(), allocator);
+
+      arena_string appended(allocator);
+      rcpputils::append_join(appended, tokens, ".");
+      EXPECT_EQ(appended, "ns.my_node_with_a_long_name.topic");
+    }
+    arena.reset();
+  }
+  EXPECT_EQ(rcpputils_test::allocation_count(), before);
+  EXPECT_EQ(arena.capacity(), sizeof(buffer));
+}
@@ -12,13 +12,35 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstddef>
+#include <cstdint>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 
 #include "gtest/gtest.h"
 
 #include "rcpputils/asserts.hpp"
 
+#include "allocation_counter.hpp"
+
+namespace
+{
+
+template<typename ExceptionT, typename CallableT>
+std::string message_of(CallableT && callable)
+{
+  try {
+    callable();
+  } catch (const ExceptionT & ex) {
+    return ex.what();
+  }
+  ADD_FAILURE() << "no exception was thrown";
+  return {};
+}
+
+}  // namespace
+
 TEST(test_asserts, require_throws_if_condition_is_false) {
   EXPECT_THROW(rcpputils::require_true(false), std::invalid_argument);
 }
@@ -69,7 +91,161 @@ TEST(test_asserts, check_does_not_throw_if_condition_is_true) {
   EXPECT_NO_THROW(rcpputils::check_true(true));
 }
 
+TEST(test_asserts, string_view_and_string_messages) {
+  const std::string_view view = std::string_view("an error message here").substr(3, 13);
+  EXPECT_EQ(
+    message_of<std::invalid_argument>([&]() {rcpputils::require_true(false, view);}),
+    "error message");
+  EXPECT_EQ(
+    message_of<rcpputils::IllegalStateException>([&]() {rcpputils::check_true(false, view);}),
+    "error message");
+  const std::string str = "error message";
+  EXPECT_EQ(
+    message_of<std::invalid_argument>([&]() {rcpputils::require_true(false, str);}), str);
+  EXPECT_EQ(
+    message_of<rcpputils::IllegalStateException>([&]() {rcpputils::check_true(false, str);}),
+    str);
+  EXPECT_NO_THROW(rcpputils::require_true(true, view));
+  EXPECT_NO_THROW(rcpputils::check_true(true, str));
+}
+
+TEST(test_asserts, passing_checks_do_not_allocate) {
+  const std::size_t before = rcpputils_test::allocation_count();
+  for (int i = 0; i < 100; ++i) {
+    rcpputils::require_true(i >= 0, "negative index");
+    rcpputils::check_true(i < 100, "index out of range");
+    rcpputils::assert_true(i != 100);
+    rcpputils::check_true(true, std::string_view("still valid"));
+    RCPPUTILS_REQUIRE_TRUE(i >= 0, "negative index");
+    RCPPUTILS_CHECK_TRUE(i < 100, "index out of range");
+    RCPPUTILS_ASSERT_TRUE(i != 100, "index out of range");
+  }
+  EXPECT_EQ(rcpputils_test::allocation_count(), before);
+}
+
+TEST(test_asserts, macros_prefix_the_location) {
+  const std::string location = std::string(__FILE__) + ":";
+  const std::string require_message = message_of<std::invalid_argument>(
+    []() {RCPPUTILS_REQUIRE_TRUE(1 + 1 == 3, "bad argument");});
+  EXPECT_EQ(require_message.rfind(location, 0), 0u) << require_message;
+  EXPECT_EQ(
+    require_message.substr(require_message.size() - std::string(": bad argument").size()),
+    ": bad argument");
+
+  const std::string check_message = message_of<rcpputils::IllegalStateException>(
+    []() {RCPPUTILS_CHECK_TRUE(false, "bad state");});
+  EXPECT_EQ(check_message.rfind(location, 0), 0u) << check_message;
+  EXPECT_NE(check_message.find(": bad state"), std::string::npos);
+
+  EXPECT_NO_THROW(RCPPUTILS_REQUIRE_TRUE(true, "bad argument"));
+  EXPECT_NO_THROW(RCPPUTILS_CHECK_TRUE(true, "bad state"));
+}
+
+TEST(test_asserts, lazy_messages_are_built_on_failure_only) {
+  int calls = 0;
+  const auto make_message = [&calls]() {
+      ++calls;
+      return "size " + std::to_string(42) + " exceeds " + std::to_string(10);
+    };
+  rcpputils::require_true(true, make_message);
+  rcpputils::check_true(true, make_message);
+  rcpputils::assert_true(true, make_message);
+  EXPECT_EQ(calls, 0);
+
+  EXPECT_EQ(
+    message_of<std::invalid_argument>([&]() {rcpputils::require_true(false, make_message);}),
+    "size 42 exceeds 10");
+  EXPECT_EQ(
+    message_of<rcpputils::IllegalStateException>(
+      [&]() {rcpputils::check_true(false, make_message);}),
+    "size 42 exceeds 10");
+  EXPECT_EQ(calls, 2);
+
+  // Factories may return anything convertible to std::string_view.
+  EXPECT_EQ(
+    message_of<rcpputils::IllegalStateException>(
+      []() {rcpputils::check_true(false, []() {return "static message";});}),
+    "static message");
+}
+
+TEST(test_asserts, exceptions_carry_the_location) {
+  std::uint_least32_t line = 0u;
+  try {
+    line = __LINE__ + 1u;
+    rcpputils::check_true(false, []() {return std::string("bad state");});
+    ADD_FAILURE() << "no exception was thrown";
+  } catch (const rcpputils::IllegalStateException & ex) {
+#if defined(RCPPUTILS_HAS_BUILTIN_SOURCE_LOCATION)
+    EXPECT_STREQ(ex.file(), __FILE__);
+    EXPECT_EQ(ex.line(), line);
+    EXPECT_NE(std::string(ex.function()).find("TestBody"), std::string::npos) << ex.function();
+#endif
+    EXPECT_STREQ(ex.what(), "bad state");
+  }
+
+  try {
+    line = __LINE__ + 1u;
+    RCPPUTILS_REQUIRE_TRUE(false, "bad argument");
+    ADD_FAILURE() << "no exception was thrown";
+  } catch (const rcpputils::InvalidArgumentException & ex) {
+    EXPECT_STREQ(ex.file(), __FILE__);
+    EXPECT_EQ(ex.line(), line);
+    EXPECT_STREQ(ex.function(), "TestBody");
+  }
+
+  // Without a location, the fields are empty.
+  try {
+    rcpputils::check_true(false, "bad state");
+  } catch (const rcpputils::IllegalStateException & ex) {
+    EXPECT_STREQ(ex.file(), "");
+    EXPECT_EQ(ex.line(), 0u);
+    EXPECT_STREQ(ex.function(), "");
+  }
+  line = __LINE__ + 1u;
+  const rcpputils::AssertionException assertion("failed", RCPPUTILS_CURRENT_SOURCE_LOCATION());
+  EXPECT_STREQ(assertion.what(), "failed");
+  EXPECT_STREQ(assertion.file(), __FILE__);
+  EXPECT_EQ(assertion.line(), line);
+}
+
+TEST(test_asserts, format_macros) {
+  const std::size_t size = 42u;
+  const double ratio = 0.5;
+  int evaluations = 0;
+  const auto count = [&evaluations]() {return ++evaluations;};
+  RCPPUTILS_REQUIRE_TRUE_FMT(size > 0u, "empty input, count ", count());
+  RCPPUTILS_CHECK_TRUE_FMT(ratio < 1.0, "ratio ", ratio, " too large, count ", count());
+  EXPECT_EQ(evaluations, 0);
+
+  const std::string require_message = message_of<std::invalid_argument>(
+    [&]() {RCPPUTILS_REQUIRE_TRUE_FMT(size < 10u, "size ", size, " exceeds ", 10);});
+  EXPECT_EQ(require_message.rfind(std::string(__FILE__) + ":", 0), 0u) << require_message;
+  EXPECT_NE(require_message.find(": size 42 exceeds 10"), std::string::npos) << require_message;
+
+  const std::string check_message = message_of<rcpputils::IllegalStateException>(
+    [&]() {RCPPUTILS_CHECK_TRUE_FMT(ratio > 1.0, "ratio ", ratio, " count ", count());});
+  EXPECT_NE(check_message.find(": ratio 0.5 count 1"), std::string::npos) << check_message;
+  EXPECT_EQ(evaluations, 1);
+}
+
 #ifndef NDEBUG
+TEST(test_asserts, assert_macro_throws_if_condition_is_false_and_ndebug_not_set) {
+  const std::string message = message_of<rcpputils::AssertionException>(
+    []() {RCPPUTILS_ASSERT_TRUE(false, "bad result");});
+  EXPECT_EQ(message.rfind(std::string(__FILE__) + ":", 0), 0u) << message;
+  EXPECT_NE(message.find(": bad result"), std::string::npos);
+
+  int evaluations = 0;
+  RCPPUTILS_ASSERT_TRUE(++evaluations == 1, "evaluated once");
+  EXPECT_EQ(evaluations, 1);
+
+  const std::string format_message = message_of<rcpputils::AssertionException>(
+    []() {RCPPUTILS_ASSERT_TRUE_FMT(1 > 2, "expected ", 1, " > ", 2);});
+  EXPECT_NE(format_message.find(": expected 1 > 2"), std::string::npos) << format_message;
+  EXPECT_THROW(
+    rcpputils::assert_true(false, []() {return "lazy";}), rcpputils::AssertionException);
+}
+
 TEST(test_asserts, assert_true_throws_if_condition_is_false_and_ndebug_not_set) {
   EXPECT_THROW(rcpputils::assert_true(false), rcpputils::AssertionException);
 }
@@ -101,4 +277,12 @@ TEST(test_asserts, ros_assert_does_not_throw_if_ndebug_set) {
   EXPECT_NO_THROW(rcpputils::assert_true(false));
   EXPECT_NO_THROW(rcpputils::assert_true(true));
 }
+
+TEST(test_asserts, assert_macro_does_not_evaluate_if_ndebug_set) {
+  int evaluations = 0;
+  EXPECT_NO_THROW(RCPPUTILS_ASSERT_TRUE(++evaluations == 0, "not evaluated"));
+  EXPECT_NO_THROW(RCPPUTILS_ASSERT_TRUE_FMT(++evaluations == 0, "count ", ++evaluations));
+  EXPECT_NO_THROW(rcpputils::assert_true(false, [&evaluations]() {return ++evaluations, "x";}));
+  EXPECT_EQ(evaluations, 0);
+}
 #endif
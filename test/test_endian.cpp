@@ -14,6 +14,11 @@
 
 #include "gtest/gtest.h"
 
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
 #include "rcpputils/endian.hpp"
 
 // Basic runtime endianness check
@@ -54,3 +59,97 @@ TEST(test_endian, runtime_endianness)
     std::cout << "Runtime reports: big endian" << std::endl;
   }
 }
+
+TEST(test_endian, byteswap)
+{
+  static_assert(rcpputils::byteswap(std::uint8_t{0x12}) == 0x12, "8 bit byteswap");
+  static_assert(rcpputils::byteswap(std::uint16_t{0x1234}) == 0x3412, "16 bit byteswap");
+  static_assert(rcpputils::byteswap(std::uint32_t{0x12345678}) == 0x78563412, "32 bit byteswap");
+  static_assert(
+    rcpputils::byteswap(std::uint64_t{0x0123456789ABCDEF}) == 0xEFCDAB8967452301,
+    "64 bit byteswap");
+  static_assert(rcpputils::byteswap(std::int16_t{0x0080}) == -32768, "signed byteswap");
+  static_assert(
+    rcpputils::byteswap(rcpputils::byteswap(std::int64_t{-42})) == -42, "signed round trip");
+
+  const float f = 1.5f;
+  const float swapped_f = rcpputils::byteswap(f);
+  std::uint32_t f_bits, swapped_f_bits;
+  std::memcpy(&f_bits, &f, sizeof(f));
+  std::memcpy(&swapped_f_bits, &swapped_f, sizeof(f));
+  EXPECT_EQ(swapped_f_bits, rcpputils::byteswap(f_bits));
+  EXPECT_EQ(rcpputils::byteswap(swapped_f), f);
+
+  const double d = -1234.5678;
+  EXPECT_EQ(rcpputils::byteswap(rcpputils::byteswap(d)), d);
+}
+
+TEST(test_endian, to_and_from)
+{
+  constexpr std::uint32_t value = 0x12345678;
+  constexpr bool little = rcpputils::endian::native == rcpputils::endian::little;
+  static_assert(
+    rcpputils::to_big(value) == (little ? 0x78563412u : value), "to_big");
+  static_assert(
+    rcpputils::to_little(value) == (little ? value : 0x78563412u), "to_little");
+  static_assert(rcpputils::from_big(rcpputils::to_big(value)) == value, "big round trip");
+  static_assert(
+    rcpputils::from_little(rcpputils::to_little(value)) == value, "little round trip");
+
+  // The byte representation is the requested one, whatever the host.
+  const std::uint16_t big = rcpputils::to_big(std::uint16_t{0x0102});
+  unsigned char bytes[2];
+  std::memcpy(bytes, &big, sizeof(big));
+  EXPECT_EQ(bytes[0], 0x01);
+  EXPECT_EQ(bytes[1], 0x02);
+  EXPECT_EQ(rcpputils::from_big(rcpputils::to_big(2.5)), 2.5);
+}
+
+template<typename T>
+void check_byteswap_n()
+{
+  // Cover the vector loops and every tail length.
+  for (std::size_t count = 0; count < 300; count += (count < 70 ? 1 : 37)) {
+    std::vector<T> input(count);
+    for (std::size_t i = 0; i < count; ++i) {
+      input[i] = static_cast<T>(0x0102030405060708ull * (i + 1));
+    }
+    std::vector<T> output(count + 1, T{0});
+    rcpputils::byteswap_n(input.data(), count, output.data());
+    for (std::size_t i = 0; i < count; ++i) {
+      ASSERT_EQ(output[i], rcpputils::byteswap(input[i])) << count << " " << i;
+    }
+    EXPECT_EQ(output[count], T{0});
+
+    std::vector<T> in_place = input;
+    rcpputils::byteswap_n(in_place);
+    for (std::size_t i = 0; i < count; ++i) {
+      ASSERT_EQ(in_place[i], rcpputils::byteswap(input[i])) << count << " " << i;
+    }
+  }
+}
+
+TEST(test_endian, byteswap_n)
+{
+  std::cout << "Byte swapping kernel: " << rcpputils::detail::byteswap_kernel_name << std::endl;
+  check_byteswap_n<std::uint8_t>();
+  check_byteswap_n<std::uint16_t>();
+  check_byteswap_n<std::int32_t>();
+  check_byteswap_n<std::uint64_t>();
+
+  std::array<float, 37> floats;
+  for (std::size_t i = 0; i < floats.size(); ++i) {
+    floats[i] = static_cast<float>(i) * 0.25f;
+  }
+  std::array<float, 37> swapped = floats;
+  rcpputils::byteswap_n(swapped);
+  rcpputils::byteswap_n(swapped.data(), swapped.size());
+  EXPECT_EQ(swapped, floats);
+
+  std::vector<double> doubles{1.0, 2.0, 3.0};
+  rcpputils::to_big_n(doubles.data(), doubles.size());
+  rcpputils::from_big_n(doubles.data(), doubles.size());
+  rcpputils::to_little_n(doubles.data(), doubles.size());
+  rcpputils::from_little_n(doubles.data(), doubles.size());
+  EXPECT_EQ(doubles, (std::vector<double>{1.0, 2.0, 3.0}));
+}
@@ -14,10 +14,21 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <fstream>
+#include <iterator>
 #include <string>
+#include <system_error>
+#include <type_traits>
+#include <vector>
 
 #include "rcpputils/filesystem_helper.hpp"
+#include "rcpputils/temp_file.hpp"
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 #ifdef _WIN32
 static constexpr const bool is_win32 = true;
@@ -58,6 +69,87 @@ TEST(TestFilesystemHelper, join_path)
   }
 }
 
+TEST(TestFilesystemHelper, iterate_elements)
+{
+  {
+    const auto p = path("");
+    EXPECT_EQ(p.cbegin(), p.cend());
+  }
+  {
+    const auto p = path("/foo//bar\\baz/");
+    const std::vector<std::string> expected{"", "foo", "", "bar", "baz"};
+    const std::vector<std::string> forward(p.cbegin(), p.cend());
+    EXPECT_EQ(expected, forward);
+
+    std::vector<std::string> backward;
+    for (auto it = p.cend(); it != p.cbegin(); ) {
+      backward.insert(backward.begin(), *--it);
+    }
+    EXPECT_EQ(expected, backward);
+
+    std::vector<std::string> range_for;
+    for (const auto & element : p) {
+      range_for.push_back(element);
+    }
+    EXPECT_EQ(expected, range_for);
+  }
+  {
+    const auto p = path("foo") / "bar";
+    auto it = p.cbegin();
+    EXPECT_EQ(3u, it->size());
+    EXPECT_EQ("foo", *it++);
+    EXPECT_EQ("bar", *it);
+    EXPECT_EQ(p.cend(), ++it);
+    EXPECT_EQ(2, std::distance(p.cbegin(), p.cend()));
+  }
+  {
+    using iterator = path::const_iterator;
+    static_assert(std::is_same_v<std::iterator_traits<iterator>::reference, const std::string &>);
+    static_assert(std::is_same_v<std::iterator_traits<iterator>::pointer, const std::string *>);
+    const auto p = path("foo") / "bar";
+    const auto it = p.cbegin();
+    const std::string & element = *it;
+    EXPECT_EQ(&element, &*it);
+    EXPECT_EQ(&element, it.operator->());
+    EXPECT_EQ("bar", *std::prev(p.cend()));
+    EXPECT_EQ("foo", element);
+  }
+}
+
+TEST(TestFilesystemHelper, concat_path)
+{
+  auto p = path("foo");
+  p += "bar/baz";
+  p.concat(".txt");
+  p += path("\\qux");
+  if (is_win32) {
+    EXPECT_EQ("foobar\\baz.txt\\qux", p.string());
+  } else {
+    EXPECT_EQ("foobar/baz.txt/qux", p.string());
+  }
+
+  auto self = path("foo");
+  self /= self;
+  self += self;
+  EXPECT_EQ((path("foo") / "foo").string() + (path("foo") / "foo").string(), self.string());
+
+  auto native_self = path("foo");
+  native_self /= native_self.native();
+  EXPECT_EQ((path("foo") / "foo").string(), native_self.string());
+}
+
+TEST(TestFilesystemHelper, join_temporary_path)
+{
+  const auto base = path("base");
+  const auto p = path("foo") / "bar" / base / std::string("baz\\qux");
+  EXPECT_EQ((base / "x").string(), path("base/x").string());
+  if (is_win32) {
+    EXPECT_EQ("foo\\bar\\base\\baz\\qux", p.string());
+  } else {
+    EXPECT_EQ("foo/bar/base/baz/qux", p.string());
+  }
+}
+
 TEST(TestFilesystemHelper, parent_path)
 {
   auto p = path("my") / path("path");
@@ -65,6 +157,58 @@ TEST(TestFilesystemHelper, parent_path)
   EXPECT_EQ(p.parent_path().string(), path("my").string());
 }
 
+TEST(TestFilesystemHelper, parent_path_of_absolute_and_edge_paths)
+{
+  const auto native = [](const char * p) {return path(p).string();};
+  EXPECT_EQ(path("/usr/lib/libfoo.so").parent_path().string(), native("/usr/lib"));
+  EXPECT_EQ(path("/usr").parent_path().string(), native("/"));
+  EXPECT_EQ(path("usr/lib/").parent_path().string(), native("usr"));
+  EXPECT_EQ(path("./libfoo.so").parent_path().string(), ".");
+  EXPECT_EQ(path("libfoo.so").parent_path().string(), "");
+  EXPECT_EQ(path("/").parent_path().string(), "");
+  EXPECT_EQ(path("").parent_path().string(), "");
+}
+
+TEST(TestFilesystemHelper, path_views)
+{
+  const path p("/bags/run_1/metadata.db3.zstd");
+  EXPECT_EQ(rcpputils::fs::parent_path_view(p), path("/bags/run_1").string());
+  EXPECT_EQ(rcpputils::fs::filename_view(p), "metadata.db3.zstd");
+  EXPECT_EQ(rcpputils::fs::extension_view(p), ".zstd");
+  EXPECT_EQ(rcpputils::fs::stem_view(p), "metadata.db3");
+  EXPECT_EQ(p.stem().string(), "metadata.db3");
+  // Views point into the path.
+  EXPECT_EQ(rcpputils::fs::filename_view(p).data(), p.c_str() + p.native().size() - 17u);
+  EXPECT_EQ(rcpputils::fs::parent_path_view(p).data(), p.c_str());
+
+  // Only the filename has an extension.
+  const path dotted_directory("/opt/ros.rolling/lib");
+  EXPECT_EQ(rcpputils::fs::extension_view(dotted_directory), "");
+  EXPECT_EQ(rcpputils::fs::stem_view(dotted_directory), "lib");
+
+  // A trailing separator is not part of the filename.
+  const path directory("/bags/run_1.d/");
+  EXPECT_EQ(rcpputils::fs::filename_view(directory), "run_1.d");
+  EXPECT_EQ(rcpputils::fs::extension_view(directory), ".d");
+  EXPECT_EQ(rcpputils::fs::parent_path_view(directory), path("/bags").string());
+
+  // Hidden files, "." and ".." have no extension.
+  for (const char * name : {".bashrc", ".", ".."}) {
+    const path no_extension(name);
+    EXPECT_EQ(rcpputils::fs::extension_view(no_extension), "") << name;
+    EXPECT_EQ(rcpputils::fs::stem_view(no_extension), name);
+    EXPECT_EQ(no_extension.filename().string(), name);
+  }
+  EXPECT_EQ(path("file.").extension().string(), ".");
+  EXPECT_EQ(path("file.").stem().string(), "file");
+
+  const path empty;
+  EXPECT_EQ(rcpputils::fs::filename_view(empty), "");
+  EXPECT_EQ(rcpputils::fs::extension_view(empty), "");
+  EXPECT_EQ(rcpputils::fs::stem_view(empty), "");
+  EXPECT_EQ(rcpputils::fs::parent_path_view(empty), "");
+}
+
 TEST(TestFilesystemHelper, to_native_path)
 {
   {
@@ -222,6 +366,285 @@ TEST(TestFilesystemHelper, filesystem_manipulation)
   EXPECT_TRUE(rcpputils::fs::remove(temp_dir.parent_path()));
 }
 
+TEST(TestFilesystemHelper, create_directories_in_existing_tree)
+{
+  const auto scratch = rcpputils::fs::create_temp_directory();
+  const auto root = scratch.path() / "root";
+  const auto deep = root / "session_1" / "logs" / "node";
+
+  std::error_code ec;
+  EXPECT_TRUE(rcpputils::fs::create_directories(deep, ec)) << ec.message();
+  EXPECT_FALSE(ec);
+  EXPECT_TRUE(rcpputils::fs::is_directory(deep));
+  // Existing directories are not an error, with or without a trailing separator.
+  EXPECT_TRUE(rcpputils::fs::create_directories(deep));
+  EXPECT_TRUE(rcpputils::fs::create_directories(path(deep.string() + "/")));
+  EXPECT_TRUE(rcpputils::fs::create_directories(root / "session_1" / "bags"));
+  EXPECT_TRUE(rcpputils::fs::create_directories(path(root.string() + "//session_2")));
+  EXPECT_TRUE(rcpputils::fs::is_directory(root / "session_2"));
+
+  // A file in the way.
+  const auto file = root / "file.txt";
+  std::ofstream(file.string()) << "contents";
+  EXPECT_FALSE(rcpputils::fs::create_directories(file, ec));
+  EXPECT_EQ(ec, std::errc::file_exists);
+  EXPECT_FALSE(rcpputils::fs::create_directories(file / "below", ec));
+  EXPECT_TRUE(ec);
+  EXPECT_FALSE(rcpputils::fs::create_directories(path(), ec));
+  EXPECT_TRUE(ec);
+
+  // Many directories under one parent.
+  const std::vector<std::string> names{"camera", "lidar", "lidar/front", "lidar/rear", "camera"};
+  const auto session = root / "session_3";
+  EXPECT_TRUE(rcpputils::fs::create_directories(session, names, ec)) << ec.message();
+  for (const std::string & name : names) {
+    EXPECT_TRUE(rcpputils::fs::is_directory(session / name)) << name;
+  }
+  EXPECT_FALSE(rcpputils::fs::create_directories(root, {"session_1", "file.txt"}, ec));
+  EXPECT_TRUE(ec);
+  EXPECT_FALSE(rcpputils::fs::create_directories(file, {"below"}));
+
+  EXPECT_EQ(rcpputils::fs::remove_all(root), 12u);
+  EXPECT_FALSE(rcpputils::fs::exists(root));
+}
+
+TEST(TestFilesystemHelper, create_directories_under_unwritable_ancestor)
+{
+#ifdef _WIN32
+  GTEST_SKIP() << "directory permissions are not POSIX modes";
+#else
+  const auto scratch = rcpputils::fs::create_temp_directory();
+  auto locked = scratch.path() / "locked";
+  ASSERT_TRUE(rcpputils::fs::create_directories(locked));
+  ASSERT_EQ(chmod(locked.c_str(), S_IRUSR | S_IXUSR), 0);
+  if (access(locked.c_str(), W_OK) == 0) {
+    // Permissions are not enforced for root, but creating directories in sysfs is not permitted.
+    ASSERT_EQ(chmod(locked.c_str(), S_IRWXU), 0);
+    locked = path("/sys");
+    if (!rcpputils::fs::is_directory(locked)) {
+      GTEST_SKIP() << "permissions are not enforced";
+    }
+  }
+
+  // The error creating the first missing ancestor is reported, not that of its children.
+  std::error_code ec;
+  EXPECT_FALSE(
+    rcpputils::fs::create_directories(locked / "rcpputils_test" / "logs" / "node", ec));
+  EXPECT_TRUE(ec == std::errc::permission_denied || ec == std::errc::operation_not_permitted) <<
+    ec.message();
+  EXPECT_FALSE(rcpputils::fs::exists(locked / "rcpputils_test"));
+  chmod((scratch.path() / "locked").c_str(), S_IRWXU);
+#endif
+}
+
+TEST(TestFilesystemHelper, remove_all)
+{
+  const auto scratch = rcpputils::fs::create_temp_directory();
+  const auto root = scratch.path() / "root";
+  const auto outside = scratch.path() / "outside";
+
+  // Nothing to remove.
+  std::error_code ec;
+  EXPECT_EQ(rcpputils::fs::remove_all(root, ec), 0u);
+  EXPECT_FALSE(ec);
+
+  // A single file.
+  ASSERT_TRUE(rcpputils::fs::create_directories(root));
+  std::ofstream((root / "single.txt").string()) << "contents";
+  EXPECT_EQ(rcpputils::fs::remove_all(root / "single.txt"), 1u);
+  EXPECT_TRUE(rcpputils::fs::exists(root));
+
+  // A tree with files and empty directories.
+  ASSERT_TRUE(rcpputils::fs::create_directories(root, {"a", "a/b", "a/b/c", "d"}));
+  for (const char * name : {"top.txt", "a/one.txt", "a/b/two.txt", "a/b/c/three.txt"}) {
+    std::ofstream((root / name).string()) << name;
+  }
+  ASSERT_TRUE(rcpputils::fs::create_directories(outside));
+  std::ofstream((outside / "keep.txt").string()) << "kept";
+#ifndef _WIN32
+  // Symbolic links are removed, not followed.
+  ASSERT_EQ(0, symlink(outside.string().c_str(), (root / "a" / "link").string().c_str()));
+  EXPECT_EQ(rcpputils::fs::remove_all(root, ec), 10u) << ec.message();
+#else
+  EXPECT_EQ(rcpputils::fs::remove_all(root, ec), 9u) << ec.message();
+#endif
+  EXPECT_FALSE(ec);
+  EXPECT_FALSE(rcpputils::fs::exists(root));
+  EXPECT_TRUE(rcpputils::fs::exists(outside / "keep.txt"));
+  EXPECT_EQ(rcpputils::fs::remove_all(outside), 2u);
+}
+
+TEST(TestFilesystemHelper, file_status)
+{
+  auto dir = path(build_directory_path()) / "status";
+  ASSERT_TRUE(rcpputils::fs::create_directories(dir));
+  auto file = dir / "status_file.txt";
+  {
+    std::ofstream output_buffer{file.string()};
+    output_buffer << "status";
+  }
+
+  auto dir_status = rcpputils::fs::status(dir);
+  EXPECT_TRUE(rcpputils::fs::status_known(dir_status));
+  EXPECT_TRUE(rcpputils::fs::exists(dir_status));
+  EXPECT_TRUE(rcpputils::fs::is_directory(dir_status));
+  EXPECT_FALSE(rcpputils::fs::is_regular_file(dir_status));
+
+  auto file_status = rcpputils::fs::status(file);
+  EXPECT_TRUE(rcpputils::fs::exists(file_status));
+  EXPECT_TRUE(rcpputils::fs::is_regular_file(file_status));
+  EXPECT_EQ(file_status.type(), rcpputils::fs::file_type::regular);
+  EXPECT_EQ(file_status.size(), 6u);
+
+  std::error_code ec;
+  auto missing = dir / "missing.txt";
+  auto missing_status = rcpputils::fs::status(missing, ec);
+  EXPECT_TRUE(ec);
+  EXPECT_TRUE(rcpputils::fs::status_known(missing_status));
+  EXPECT_EQ(missing_status.type(), rcpputils::fs::file_type::not_found);
+  EXPECT_NO_THROW(rcpputils::fs::status(missing));
+  EXPECT_FALSE(rcpputils::fs::exists(missing, ec));
+  EXPECT_FALSE(ec);
+  EXPECT_TRUE(rcpputils::fs::exists(file, ec));
+  EXPECT_FALSE(ec);
+  EXPECT_TRUE(rcpputils::fs::is_regular_file(file, ec));
+  EXPECT_FALSE(rcpputils::fs::is_directory(file, ec));
+  EXPECT_TRUE(rcpputils::fs::is_directory(dir, ec));
+
+  EXPECT_EQ(rcpputils::fs::file_size(file, ec), 6u);
+  EXPECT_FALSE(ec);
+  EXPECT_EQ(rcpputils::fs::file_size(dir, ec), static_cast<uint64_t>(-1));
+  EXPECT_EQ(ec, std::errc::is_a_directory);
+  EXPECT_EQ(rcpputils::fs::file_size(missing, ec), static_cast<uint64_t>(-1));
+  EXPECT_TRUE(ec);
+
+#ifndef _WIN32
+  auto link = dir / "status_link";
+  ASSERT_EQ(0, symlink("status_file.txt", link.string().c_str()));
+  EXPECT_TRUE(rcpputils::fs::is_symlink(link));
+  EXPECT_FALSE(rcpputils::fs::is_symlink(file));
+  EXPECT_TRUE(rcpputils::fs::is_regular_file(rcpputils::fs::status(link)));
+  EXPECT_EQ(rcpputils::fs::symlink_status(link).type(), rcpputils::fs::file_type::symlink);
+  EXPECT_TRUE(rcpputils::fs::remove(link));
+#endif
+
+  EXPECT_TRUE(rcpputils::fs::remove(file));
+  EXPECT_TRUE(rcpputils::fs::remove(dir));
+}
+
+TEST(TestFilesystemHelper, directory_iterator)
+{
+  auto dir = path(build_directory_path()) / "listing";
+  ASSERT_TRUE(rcpputils::fs::create_directories(dir / "sub" / "nested"));
+  for (const auto & file : {dir / "a.txt", dir / "b.txt", dir / "sub" / "c.txt"}) {
+    std::ofstream output_buffer{file.string()};
+  }
+
+  std::vector<std::string> names;
+  for (const auto & entry : rcpputils::fs::directory_iterator(dir)) {
+    names.push_back(entry.path().filename().string());
+    EXPECT_TRUE(entry.exists());
+    EXPECT_EQ(entry.is_directory(), names.back() == "sub");
+    EXPECT_EQ(entry.is_regular_file(), names.back() != "sub");
+    EXPECT_FALSE(entry.is_symlink());
+  }
+  std::sort(names.begin(), names.end());
+  EXPECT_EQ(names, (std::vector<std::string>{"a.txt", "b.txt", "sub"}));
+
+  std::vector<std::string> relative;
+  for (auto it = rcpputils::fs::recursive_directory_iterator(dir);
+    it != rcpputils::fs::recursive_directory_iterator(); ++it)
+  {
+    const std::string entry = it->path().string();
+    relative.push_back(entry.substr(dir.string().size() + 1));
+    EXPECT_EQ(
+      it.depth(),
+      std::count(relative.back().begin(), relative.back().end(), rcpputils::fs::kPreferredSeparator));
+  }
+  std::sort(relative.begin(), relative.end());
+  const std::string sep(1, rcpputils::fs::kPreferredSeparator);
+  EXPECT_EQ(
+    relative,
+    (std::vector<std::string>{
+    "a.txt", "b.txt", "sub", "sub" + sep + "c.txt", "sub" + sep + "nested"}));
+
+  size_t skipped_count = 0;
+  for (auto it = rcpputils::fs::recursive_directory_iterator(dir);
+    it != rcpputils::fs::recursive_directory_iterator(); ++it)
+  {
+    if (it->is_directory()) {
+      it.disable_recursion_pending();
+    }
+    ++skipped_count;
+  }
+  EXPECT_EQ(skipped_count, 3u);
+
+  auto empty_dir = dir / "sub" / "nested";
+  EXPECT_EQ(
+    rcpputils::fs::directory_iterator(empty_dir), rcpputils::fs::directory_iterator());
+
+  std::error_code ec;
+  rcpputils::fs::directory_iterator missing(dir / "missing", ec);
+  EXPECT_TRUE(ec);
+  EXPECT_EQ(missing, rcpputils::fs::directory_iterator());
+  EXPECT_THROW(rcpputils::fs::directory_iterator(dir / "a.txt"), std::system_error);
+
+  EXPECT_TRUE(rcpputils::fs::remove(dir / "sub" / "nested"));
+  EXPECT_TRUE(rcpputils::fs::remove(dir / "sub" / "c.txt"));
+  EXPECT_TRUE(rcpputils::fs::remove(dir / "sub"));
+  EXPECT_TRUE(rcpputils::fs::remove(dir / "a.txt"));
+  EXPECT_TRUE(rcpputils::fs::remove(dir / "b.txt"));
+  EXPECT_TRUE(rcpputils::fs::remove(dir));
+}
+
+TEST(TestFilesystemHelper, recursive_directory_iterator_unopenable_subdirectory)
+{
+  const auto scratch = rcpputils::fs::create_temp_directory();
+  const auto root = scratch.path();
+  for (const char * name : {"a", "locked", "z"}) {
+    ASSERT_TRUE(rcpputils::fs::create_directories(root / name));
+    std::ofstream output_buffer{(root / name / "file.txt").string()};
+  }
+  const auto locked = root / "locked";
+  bool enforced = false;
+#ifndef _WIN32
+  ASSERT_EQ(chmod(locked.c_str(), 0), 0);
+  enforced = access(locked.c_str(), R_OK) != 0;
+#endif
+
+  std::vector<std::string> visited;
+  size_t errors = 0;
+  std::error_code ec;
+  const rcpputils::fs::recursive_directory_iterator end;
+  for (auto it = rcpputils::fs::recursive_directory_iterator(root, ec); it != end;
+    it.increment(ec))
+  {
+    if (ec) {
+      // The walk stays on the directory it could not descend into.
+      ++errors;
+      EXPECT_EQ(it->path().string(), locked.string());
+      EXPECT_FALSE(it.recursion_pending());
+      continue;
+    }
+    visited.push_back(it->path().string().substr(root.string().size() + 1));
+    if (!enforced && it->path().string() == locked.string()) {
+      // Permissions are not enforced for root, but a directory removed before it is opened is an
+      // error all the same.
+      ASSERT_TRUE(rcpputils::fs::remove(locked / "file.txt"));
+      ASSERT_TRUE(rcpputils::fs::remove(locked));
+    }
+  }
+  EXPECT_EQ(errors, 1u);
+  std::sort(visited.begin(), visited.end());
+  const std::string sep(1, rcpputils::fs::kPreferredSeparator);
+  EXPECT_EQ(
+    visited,
+    (std::vector<std::string>{"a", "a" + sep + "file.txt", "locked", "z", "z" + sep + "file.txt"}));
+#ifndef _WIN32
+  chmod(locked.c_str(), S_IRWXU);
+#endif
+}
+
 TEST(TestFilesystemHelper, remove_extension)
 {
   auto p = path("foo.txt");
@@ -243,6 +666,18 @@ TEST(TestFilesystemHelper, remove_extensions_overcount)
   EXPECT_EQ("foo", p.string());
 }
 
+TEST(TestFilesystemHelper, remove_extension_only_from_filename)
+{
+  EXPECT_EQ(
+    rcpputils::fs::remove_extension(path("/opt/ros.rolling/lib")).string(),
+    path("/opt/ros.rolling/lib").string());
+  EXPECT_EQ(
+    rcpputils::fs::remove_extension(path("/opt/ros.rolling/log.tar.gz"), 2).string(),
+    path("/opt/ros.rolling/log").string());
+  EXPECT_EQ(rcpputils::fs::remove_extension(path(".bashrc")).string(), ".bashrc");
+  EXPECT_EQ(rcpputils::fs::remove_extension(path("./foo")).string(), path("./foo").string());
+}
+
 TEST(TestFilesystemHelper, remove_extension_no_extension)
 {
   auto p = path("foo");
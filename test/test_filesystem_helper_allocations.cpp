@@ -0,0 +1,124 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include "rcpputils/filesystem_helper.hpp"
+
+#include "allocation_counter.hpp"
+
+using path = rcpputils::fs::path;
+using rcpputils_test::AllocationCounter;
+
+namespace
+{
+
+// Long enough to never fit in the small string buffer.
+const std::string kPrefix = "/opt/ros/workspace/install/some_package_with_a_long_name";
+
+}  // namespace
+
+TEST(TestFilesystemHelperAllocations, construct)
+{
+  {
+    const AllocationCounter counter;
+    const path p(kPrefix);
+    EXPECT_EQ(1u, counter.count());
+  }
+  {
+    std::string str = kPrefix;
+    const AllocationCounter counter;
+    const path p(std::move(str));
+    EXPECT_EQ(0u, counter.count());
+  }
+  {
+    path p(kPrefix);
+    const AllocationCounter counter;
+    path moved(std::move(p));
+    path assigned;
+    assigned = std::move(moved);
+    EXPECT_EQ(0u, counter.count());
+  }
+}
+
+TEST(TestFilesystemHelperAllocations, append)
+{
+  const path base(kPrefix);
+  {
+    // An lvalue is copied once, into storage large enough for the result.
+    const AllocationCounter counter;
+    const path p = base / "share";
+    EXPECT_EQ(1u, counter.count());
+  }
+  {
+    const path element("share");
+    const AllocationCounter counter;
+    const path p = base / element;
+    EXPECT_EQ(1u, counter.count());
+  }
+  {
+    // Temporaries are appended to, reusing their storage.
+    std::string str = kPrefix;
+    str.reserve(256u);
+    const AllocationCounter counter;
+    const path p = path(std::move(str)) / "share" / "pkg" / path("package.xml");
+    EXPECT_EQ(0u, counter.count());
+    EXPECT_EQ(kPrefix + "/share/pkg/package.xml", path(p.string()).string());
+  }
+}
+
+TEST(TestFilesystemHelperAllocations, iterate)
+{
+  const path p(kPrefix);
+  const AllocationCounter counter;
+  std::size_t elements = 0u;
+  for (auto it = p.cbegin(); it != p.cend(); ++it) {
+    ++elements;
+  }
+  EXPECT_EQ(6u, elements);
+  EXPECT_EQ(0u, counter.count());
+}
+
+TEST(TestFilesystemHelperAllocations, status)
+{
+  const path p = path(kPrefix) / "missing";
+  const AllocationCounter counter;
+  std::error_code ec;
+  EXPECT_EQ(rcpputils::fs::file_type::not_found, rcpputils::fs::status(p, ec).type());
+  EXPECT_EQ(
+    rcpputils::fs::file_type::not_found, rcpputils::fs::symlink_status(p, ec).type());
+  EXPECT_FALSE(rcpputils::fs::exists(p, ec));
+  EXPECT_FALSE(rcpputils::fs::is_regular_file(p, ec));
+  EXPECT_FALSE(rcpputils::fs::is_directory(p, ec));
+  EXPECT_EQ(static_cast<uint64_t>(-1), rcpputils::fs::file_size(p, ec));
+  EXPECT_EQ(0u, counter.count());
+}
+
+TEST(TestFilesystemHelperAllocations, directory_entry_status)
+{
+  rcpputils::fs::directory_entry entry(path(kPrefix) / "missing", rcpputils::fs::file_status());
+  const AllocationCounter counter;
+  EXPECT_EQ(rcpputils::fs::file_type::not_found, entry.status().type());
+  EXPECT_EQ(rcpputils::fs::file_type::not_found, entry.symlink_status().type());
+  std::error_code ec;
+  entry.refresh(ec);
+  EXPECT_FALSE(entry.exists());
+  EXPECT_EQ(0u, counter.count());
+}
@@ -13,7 +13,11 @@
 // limitations under the License.
 
 #include <gtest/gtest.h>
+
+#include <iterator>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include "rcpputils/find_and_replace.hpp"
 
@@ -88,3 +92,161 @@ TEST(test_find_and_replace, find_and_replace_various_input_types) {
 
   rcpputils::find_and_replace("foo", "foo", std::string("bar"));
 }
+
+TEST(test_find_and_replace, find_and_replace_string_view) {
+  const std::string_view input = "/ns/node/topic";
+  auto ret = rcpputils::find_and_replace(input, std::string_view("/"), "__");
+  EXPECT_EQ("__ns__node__topic", ret);
+}
+
+TEST(test_find_and_replace, find_and_replace_size) {
+  EXPECT_EQ(0u, rcpputils::find_and_replace_size("", "foo", "bar"));
+  EXPECT_EQ(3u, rcpputils::find_and_replace_size("foo", "", "bar"));
+  EXPECT_EQ(0u, rcpputils::find_and_replace_size("foo", "foo", ""));
+  EXPECT_EQ(12u, rcpputils::find_and_replace_size("foobarfoobar", "foo", "baz"));
+  EXPECT_EQ(16u, rcpputils::find_and_replace_size("foobarfoobar", "foo", "bazz5"));
+  EXPECT_EQ(3u, rcpputils::find_and_replace_size("aaaaa", "aa", "b"));
+}
+
+TEST(test_find_and_replace, find_and_replace_output_iterator) {
+  {
+    std::string output;
+    rcpputils::find_and_replace("foobarfoobar", "foo", "baz", std::back_inserter(output));
+    EXPECT_EQ("bazbarbazbar", output);
+  }
+  {
+    std::vector<char> output;
+    rcpputils::find_and_replace(
+      std::string("foo"), std::string(""), "bar", std::back_inserter(output));
+    EXPECT_EQ("foo", std::string(output.begin(), output.end()));
+  }
+  {
+    const std::string input = "/ns/node/topic";
+    char buffer[32] = {};
+    const std::size_t size = rcpputils::find_and_replace_size(input, "/", "__");
+    ASSERT_LT(size, sizeof(buffer));
+    char * end = rcpputils::find_and_replace(input, "/", "__", buffer);
+    EXPECT_EQ(buffer + size, end);
+    EXPECT_STREQ("__ns__node__topic", buffer);
+  }
+}
+
+TEST(test_find_and_replace, find_and_replace_in_place) {
+  // Same size
+  {
+    std::string str = "foobarfoobar";
+    EXPECT_EQ(2u, rcpputils::find_and_replace_in_place(str, "foo", "baz"));
+    EXPECT_EQ("bazbarbazbar", str);
+  }
+  // Shrinking
+  {
+    std::string str = "foobarfoobarfoo";
+    EXPECT_EQ(3u, rcpputils::find_and_replace_in_place(str, "foo", "z"));
+    EXPECT_EQ("zbarzbarz", str);
+  }
+  {
+    std::string str = "foobar";
+    EXPECT_EQ(1u, rcpputils::find_and_replace_in_place(str, "foobar", ""));
+    EXPECT_EQ("", str);
+  }
+  // Growing
+  {
+    std::string str = "/ns/node/topic/";
+    EXPECT_EQ(4u, rcpputils::find_and_replace_in_place(str, "/", "___"));
+    EXPECT_EQ("___ns___node___topic___", str);
+  }
+  {
+    std::string str = "foobar";
+    EXPECT_EQ(1u, rcpputils::find_and_replace_in_place(str, "foo", "barfoo"));
+    EXPECT_EQ("barfoobar", str);
+  }
+  // Matches do not overlap
+  {
+    std::string str = "aaaaa";
+    EXPECT_EQ(2u, rcpputils::find_and_replace_in_place(str, "aa", "bbb"));
+    EXPECT_EQ("bbbbbba", str);
+  }
+  // No occurrences, empty find, find == replace
+  {
+    std::string str = "foo";
+    EXPECT_EQ(0u, rcpputils::find_and_replace_in_place(str, "bar", "bazbaz"));
+    EXPECT_EQ(0u, rcpputils::find_and_replace_in_place(str, "", "bar"));
+    EXPECT_EQ(0u, rcpputils::find_and_replace_in_place(str, "foo", "foo"));
+    EXPECT_EQ("foo", str);
+  }
+  // Arguments pointing into the modified string
+  {
+    std::string str = "abcabc";
+    EXPECT_EQ(2u, rcpputils::find_and_replace_in_place(
+        str, std::string_view(str).substr(0, 1), std::string_view(str).substr(0, 3)));
+    EXPECT_EQ("abcbcabcbc", str);
+  }
+  // Wide strings
+  {
+    std::wstring str = L"foobar";
+    EXPECT_EQ(1u, rcpputils::find_and_replace_in_place(str, L"foo", L"bazbaz"));
+    EXPECT_EQ(std::wstring(L"bazbazbar"), str);
+  }
+}
+
+TEST(test_find_and_replace, find_and_replace_matches_copy) {
+  // The in place and output iterator variants agree with the copying one.
+  const std::string inputs[] = {
+    "", "a", "ab", "aab", "abab", "bbbaaabbbaaa", "aaaaaaaaaaaaaaaaaaab"};
+  const std::string finds[] = {"a", "aa", "ab", "b", "aaab", "c"};
+  const std::string replaces[] = {"", "x", "xy", "xyzw"};
+  for (const auto & input : inputs) {
+    for (const auto & find : finds) {
+      for (const auto & replace : replaces) {
+        std::string expected = input;
+        for (std::size_t pos = expected.find(find); pos != std::string::npos;
+          pos = expected.find(find, pos + replace.size()))
+        {
+          expected.replace(pos, find.size(), replace);
+        }
+        EXPECT_EQ(expected, rcpputils::find_and_replace(input, find, replace));
+        std::string in_place = input;
+        rcpputils::find_and_replace_in_place(in_place, find, replace);
+        EXPECT_EQ(expected, in_place);
+        std::string output;
+        rcpputils::find_and_replace(input, find, replace, std::back_inserter(output));
+        EXPECT_EQ(expected, output);
+        EXPECT_EQ(expected.size(), rcpputils::find_and_replace_size(input, find, replace));
+      }
+    }
+  }
+}
+
+TEST(test_find_and_replace, find_and_replace_set) {
+  {
+    const rcpputils::FindAndReplaceSet<char> empty;
+    EXPECT_EQ("foo", empty.apply("foo"));
+  }
+  {
+    const rcpputils::FindAndReplaceSet<char> set{{"/", "__"}, {"::", "_"}, {"", "ignored"}};
+    EXPECT_EQ("", set.apply(""));
+    EXPECT_EQ("__ns__my_pkg_msg", set.apply("/ns/my_pkg::msg"));
+    EXPECT_EQ("foo:bar", set.apply("foo:bar"));
+    EXPECT_EQ(16u, set.size("/ns/my_pkg::msg"));
+    EXPECT_EQ("__ns__my_pkg_msg", rcpputils::find_and_replace("/ns/my_pkg::msg", set));
+  }
+  // The longest find string wins, and replacements are not scanned again
+  {
+    rcpputils::FindAndReplaceSet<char> set;
+    set.add("foo", "1");
+    set.add("foobar", "2");
+    set.add("bar", "foo");
+    set.add("foo", "not used");
+    EXPECT_EQ("2foo21fo", set.apply("foobarbarfoobarfoofo"));
+  }
+  {
+    const rcpputils::FindAndReplaceSet<char> set{{"a", "b"}, {"b", "a"}};
+    std::string output;
+    set.apply("abba", std::back_inserter(output));
+    EXPECT_EQ("baab", output);
+  }
+  {
+    const rcpputils::FindAndReplaceSet<wchar_t> set{{L"foo", L"bar"}, {L"bar", L"foo"}};
+    EXPECT_EQ(std::wstring(L"barfoo"), set.apply(L"foobar"));
+  }
+}
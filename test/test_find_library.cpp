@@ -14,12 +14,19 @@
 
 #include <stdlib.h>
 
+#include <fstream>
 #include <string>
+#include <system_error>
+#include <vector>
 
 #include "gtest/gtest.h"
 
+#include "rcutils/filesystem.h"
 #include "rcutils/get_env.h"
+#include "rcpputils/filesystem_helper.hpp"
 #include "rcpputils/find_library.hpp"
+#include "rcpputils/shared_library.hpp"
+#include "rcpputils/temp_file.hpp"
 
 namespace rcpputils
 {
@@ -67,6 +74,161 @@ TEST(test_find_library, find_library)
     "this_is_a_junk_libray_name_please_dont_define_this_if_you_do_then_"
     "you_are_really_naughty");
   EXPECT_EQ(bad_path, "");
+
+  std::error_code ec;
+  EXPECT_EQ(find_library_path("test_library", ec), expected_library_path);
+  EXPECT_FALSE(ec);
+
+  // Batch lookups keep the order of the names.
+  const std::vector<std::string> batch = find_library_paths(
+    {"this_is_a_junk_libray_name", "test_library"});
+  ASSERT_EQ(batch.size(), 2u);
+  EXPECT_EQ(batch[0], "");
+  EXPECT_EQ(batch[1], expected_library_path);
+
+  // A changed environment invalidates the cached lookups.
+#ifdef _WIN32
+  EXPECT_EQ(_putenv_s(env_var, "this_directory_does_not_exist"), 0);
+#else
+  EXPECT_EQ(setenv(env_var, "this_directory_does_not_exist", override), 0);
+#endif
+  EXPECT_EQ(find_library_path("test_library"), "");
+#ifdef _WIN32
+  EXPECT_EQ(_putenv_s(env_var, test_lib_dir), 0);
+#else
+  EXPECT_EQ(setenv(env_var, test_lib_dir, override), 0);
+#endif
+  EXPECT_EQ(find_library_path("test_library"), expected_library_path);
+}
+
+TEST(test_find_library, find_library_location)
+{
+  const char * expected_library_path{};
+  EXPECT_EQ(rcutils_get_env("_TEST_LIBRARY", &expected_library_path), nullptr);
+  ASSERT_NE(expected_library_path, nullptr);
+  const char * test_lib_dir{};
+  EXPECT_EQ(rcutils_get_env("_TEST_LIBRARY_DIR", &test_lib_dir), nullptr);
+  ASSERT_NE(test_lib_dir, nullptr);
+
+  const char * env_var{};
+#ifdef _WIN32
+  env_var = "PATH";
+#elif __APPLE__
+  env_var = "DYLD_LIBRARY_PATH";
+#else
+  env_var = "LD_LIBRARY_PATH";
+#endif
+
+#ifdef _WIN32
+  EXPECT_EQ(_putenv_s(env_var, test_lib_dir), 0);
+#else
+  EXPECT_EQ(setenv(env_var, test_lib_dir, 1), 0);
+#endif
+  LibraryLocation location = find_library_location("test_library");
+  EXPECT_EQ(location.path, expected_library_path);
+  EXPECT_TRUE(
+    location.source == LibrarySource::search_path || location.source == LibrarySource::rpath);
+
+  location = find_library_location(
+    "this_is_a_junk_libray_name_please_dont_define_this_if_you_do_then_"
+    "you_are_really_naughty");
+  EXPECT_EQ(location.path, "");
+  EXPECT_EQ(location.source, LibrarySource::not_found);
+
+#ifdef __linux__
+  // The test executable links against test_library, so the build tree is in its run path.
+  EXPECT_EQ(setenv(env_var, "this_directory_does_not_exist", 1), 0);
+  location = find_library_location("test_library");
+  EXPECT_EQ(location.path, expected_library_path);
+  EXPECT_TRUE(
+    location.source == LibrarySource::runpath || location.source == LibrarySource::rpath);
+
+  // Whatever the system provides must point to existing files.
+  for (const auto & system_location : find_library_locations({"z", "m", "dl", "pthread"})) {
+    if (system_location.source != LibrarySource::not_found) {
+      EXPECT_TRUE(rcutils_is_file(system_location.path.c_str())) << system_location.path;
+    }
+  }
+  EXPECT_EQ(setenv(env_var, test_lib_dir, 1), 0);
+#endif
+}
+
+TEST(test_find_library, library_searcher)
+{
+  const char * test_lib_dir{};
+  EXPECT_EQ(rcutils_get_env("_TEST_LIBRARY_DIR", &test_lib_dir), nullptr);
+  ASSERT_NE(test_lib_dir, nullptr);
+  const char * expected_library_path{};
+  EXPECT_EQ(rcutils_get_env("_TEST_LIBRARY", &expected_library_path), nullptr);
+  ASSERT_NE(expected_library_path, nullptr);
+
+#ifdef _WIN32
+  const std::string separator = ";";
+#else
+  const std::string separator = ":";
+#endif
+  const std::string search_path =
+    std::string("this_directory_does_not_exist") + separator + separator + test_lib_dir;
+  LibrarySearcher searcher(search_path);
+  EXPECT_EQ(searcher.search_path(), search_path);
+  EXPECT_EQ(
+    searcher.search_directories(),
+    (std::vector<std::string>{"this_directory_does_not_exist", test_lib_dir}));
+
+  EXPECT_EQ(searcher.find("test_library"), expected_library_path);
+  EXPECT_EQ(searcher.find("this_is_a_junk_libray_name"), "");
+  EXPECT_EQ(
+    searcher.find(std::vector<std::string>{"test_library", "test_library"}),
+    (std::vector<std::string>{expected_library_path, expected_library_path}));
+  EXPECT_TRUE(searcher.find(std::vector<std::string>{}).empty());
+
+  searcher.refresh();
+  EXPECT_EQ(searcher.find("test_library"), expected_library_path);
+
+  LibrarySearcher empty("");
+  EXPECT_TRUE(empty.search_directories().empty());
+  EXPECT_EQ(empty.find("test_library"), "");
+}
+
+TEST(test_find_library, libraries_installed_later)
+{
+  const auto scratch = fs::create_temp_directory();
+  const std::string directory = scratch.path().string();
+  const std::string filename = get_platform_library_name("installed_later");
+  const std::string expected_path = directory + "/" + filename;
+
+  LibrarySearcher caching(directory);
+  LibrarySearcher not_caching(directory, false);
+  EXPECT_EQ(caching.find("installed_later"), "");
+  EXPECT_EQ(not_caching.find("installed_later"), "");
+
+  const char * env_var{};
+#ifdef _WIN32
+  env_var = "PATH";
+  EXPECT_EQ(_putenv_s(env_var, directory.c_str()), 0);
+#else
+#  ifdef __APPLE__
+  env_var = "DYLD_LIBRARY_PATH";
+#  else
+  env_var = "LD_LIBRARY_PATH";
+#  endif
+  EXPECT_EQ(setenv(env_var, directory.c_str(), 1), 0);
+#endif
+  EXPECT_EQ(find_library_path("installed_later"), "");
+
+  std::ofstream(expected_path) << "not really a library";
+  // The process-wide searcher does not remember misses.
+  EXPECT_EQ(find_library_path("installed_later"), expected_path);
+  EXPECT_EQ(not_caching.find("installed_later"), expected_path);
+  // Searchers caching misses only see it once refreshed.
+  EXPECT_EQ(caching.find("installed_later"), "");
+  caching.refresh();
+  EXPECT_EQ(caching.find("installed_later"), expected_path);
+
+  // Nor does it keep reporting libraries which were removed.
+  ASSERT_TRUE(fs::remove(fs::path(expected_path)));
+  EXPECT_EQ(find_library_path("installed_later"), "");
+  EXPECT_EQ(not_caching.find("installed_later"), "");
 }
 
 }  // namespace
@@ -16,7 +16,12 @@
 
 #include <rcpputils/get_env.hpp>
 
+#include <stdlib.h>
+
 #include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 /* Tests get_env_var.
  *
@@ -24,6 +29,9 @@
  *
  *   - EMPTY_TEST=
  *   - NORMAL_TEST=foo
+ *   - BOOL_TEST=Yes
+ *   - INT_TEST=-42
+ *   - LIST_TEST=a,b,,c
  *
  * These are set in the call to `ament_add_gtest()` in the `CMakeLists.txt`.
  */
@@ -37,3 +45,61 @@ TEST(TestGetEnv, test_get_env) {
   env = rcpputils::get_env_var("EMPTY_TEST");
   EXPECT_STREQ("", env.c_str());
 }
+
+TEST(TestGetEnv, test_env_snapshot) {
+  rcpputils::EnvSnapshot env;
+  EXPECT_GT(env.size(), 0u);
+
+  ASSERT_TRUE(env.get("NORMAL_TEST").has_value());
+  EXPECT_EQ(*env.get("NORMAL_TEST"), "foo");
+  ASSERT_TRUE(env.get("EMPTY_TEST").has_value());
+  EXPECT_EQ(*env.get("EMPTY_TEST"), "");
+  EXPECT_FALSE(env.get("SHOULD_NOT_EXIST_TEST").has_value());
+  EXPECT_TRUE(env.contains("EMPTY_TEST"));
+  EXPECT_FALSE(env.contains("SHOULD_NOT_EXIST_TEST"));
+  EXPECT_EQ(env.get_or("SHOULD_NOT_EXIST_TEST", "fallback"), "fallback");
+  EXPECT_EQ(env.get_or("NORMAL_TEST", "fallback"), "foo");
+
+  EXPECT_EQ(env.get_bool("BOOL_TEST"), true);
+  EXPECT_FALSE(env.get_bool("NORMAL_TEST").has_value());
+  EXPECT_FALSE(env.get_bool("SHOULD_NOT_EXIST_TEST").has_value());
+  EXPECT_EQ(env.get_int("INT_TEST"), -42);
+  EXPECT_FALSE(env.get_int("NORMAL_TEST").has_value());
+  EXPECT_FALSE(env.get_int("EMPTY_TEST").has_value());
+
+  EXPECT_EQ(
+    env.get_list("LIST_TEST", ','), (std::vector<std::string_view>{"a", "b", "c"}));
+  EXPECT_EQ(env.get_list("NORMAL_TEST"), (std::vector<std::string_view>{"foo"}));
+  EXPECT_TRUE(env.get_list("SHOULD_NOT_EXIST_TEST").empty());
+}
+
+TEST(TestGetEnv, test_env_snapshot_refresh) {
+#ifdef _WIN32
+  ASSERT_EQ(_putenv_s("SNAPSHOT_TEST", "before"), 0);
+#else
+  ASSERT_EQ(setenv("SNAPSHOT_TEST", "before", 1), 0);
+#endif
+  rcpputils::EnvSnapshot env;
+  rcpputils::EnvSnapshot::refresh_process_snapshot();
+  auto process_env = rcpputils::EnvSnapshot::process_snapshot();
+  EXPECT_EQ(process_env, rcpputils::EnvSnapshot::process_snapshot());
+  EXPECT_EQ(env.get_or("SNAPSHOT_TEST", ""), "before");
+  EXPECT_EQ(process_env->get_or("SNAPSHOT_TEST", ""), "before");
+
+#ifdef _WIN32
+  ASSERT_EQ(_putenv_s("SNAPSHOT_TEST", "after"), 0);
+#else
+  ASSERT_EQ(setenv("SNAPSHOT_TEST", "after", 1), 0);
+#endif
+  // Snapshots don't see changes until refreshed.
+  EXPECT_EQ(env.get_or("SNAPSHOT_TEST", ""), "before");
+  env.refresh();
+  EXPECT_EQ(env.get_or("SNAPSHOT_TEST", ""), "after");
+
+  rcpputils::EnvSnapshot::refresh_process_snapshot();
+  EXPECT_EQ(process_env->get_or("SNAPSHOT_TEST", ""), "before");
+  EXPECT_EQ(rcpputils::EnvSnapshot::process_snapshot()->get_or("SNAPSHOT_TEST", ""), "after");
+
+  rcpputils::EnvSnapshot moved(std::move(env));
+  EXPECT_EQ(moved.get_or("SNAPSHOT_TEST", ""), "after");
+}
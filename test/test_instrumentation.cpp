@@ -0,0 +1,199 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rcpputils/instrumentation.hpp"
+
+namespace instrumentation = rcpputils::instrumentation;
+
+namespace
+{
+
+const instrumentation::CounterSnapshot * find_counter(
+  const instrumentation::Snapshot & snapshot, const std::string & name)
+{
+  auto it = std::find_if(
+    snapshot.counters.begin(), snapshot.counters.end(),
+    [&name](const auto & counter) {return counter.name == name;});
+  return it != snapshot.counters.end() ? &*it : nullptr;
+}
+
+const instrumentation::HistogramSnapshot * find_histogram(
+  const instrumentation::Snapshot & snapshot, const std::string & name)
+{
+  auto it = std::find_if(
+    snapshot.histograms.begin(), snapshot.histograms.end(),
+    [&name](const auto & histogram) {return histogram.name == name;});
+  return it != snapshot.histograms.end() ? &*it : nullptr;
+}
+
+void traced_function()
+{
+  RCPPUTILS_TRACE_SCOPE("test.traced_function");
+  RCPPUTILS_COUNTER_INCREMENT("test.traced_function_calls");
+  std::this_thread::sleep_for(std::chrono::microseconds(100));
+}
+
+}  // namespace
+
+TEST(test_instrumentation, histogram_buckets) {
+  using instrumentation::Histogram;
+  EXPECT_EQ(Histogram::bucket_of(0u), 0u);
+  EXPECT_EQ(Histogram::bucket_of(1u), 0u);
+  EXPECT_EQ(Histogram::bucket_of(2u), 1u);
+  EXPECT_EQ(Histogram::bucket_of(3u), 1u);
+  EXPECT_EQ(Histogram::bucket_of(1024u), 10u);
+  EXPECT_EQ(Histogram::bucket_of(2047u), 10u);
+  EXPECT_EQ(Histogram::bucket_of(UINT64_MAX), Histogram::kBuckets - 1u);
+  EXPECT_EQ(Histogram::bucket_of(std::chrono::nanoseconds(-5)), 0u);
+  EXPECT_EQ(Histogram::bucket_of(std::chrono::microseconds(1)), 9u);
+
+  Histogram histogram;
+  histogram.record(std::chrono::nanoseconds(-5));
+  histogram.record(std::chrono::nanoseconds(1500));
+  histogram.record(std::chrono::hours(1));
+  const auto snapshot = histogram.snapshot();
+  EXPECT_EQ(snapshot.count, 3u);
+  EXPECT_EQ(snapshot.total, std::chrono::hours(1) + std::chrono::nanoseconds(1500));
+  EXPECT_EQ(snapshot.buckets[0], 1u);
+  EXPECT_EQ(snapshot.buckets[10], 1u);
+  EXPECT_EQ(snapshot.buckets[Histogram::kBuckets - 1], 1u);
+
+  histogram.reset();
+  EXPECT_EQ(histogram.snapshot().count, 0u);
+}
+
+TEST(test_instrumentation, sharded_counter) {
+  constexpr int kThreads = 8;
+  constexpr int kIncrements = 10000;
+  instrumentation::Counter counter;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreads; ++i) {
+    threads.emplace_back(
+      [&counter]() {
+        for (int j = 0; j < kIncrements; ++j) {
+          counter.add();
+        }
+      });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(counter.value(), static_cast<std::uint64_t>(kThreads * kIncrements));
+  counter.add(5u);
+  EXPECT_EQ(counter.value(), static_cast<std::uint64_t>(kThreads * kIncrements + 5));
+  counter.reset();
+  EXPECT_EQ(counter.value(), 0u);
+}
+
+TEST(test_instrumentation, scoped_timer) {
+  instrumentation::Histogram histogram;
+  {
+    instrumentation::ScopedTimer timer(histogram);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    EXPECT_GE(timer.elapsed(), std::chrono::milliseconds(2));
+  }
+  {
+    instrumentation::ScopedTimer cancelled(histogram);
+    cancelled.cancel();
+  }
+  const auto snapshot = histogram.snapshot();
+  EXPECT_EQ(snapshot.count, 1u);
+  EXPECT_GE(snapshot.total, std::chrono::milliseconds(2));
+  EXPECT_EQ(std::accumulate(snapshot.buckets.begin(), snapshot.buckets.end(), uint64_t(0)), 1u);
+}
+
+TEST(test_instrumentation, registry) {
+  instrumentation::Counter & counter = instrumentation::counter("test.registry.counter");
+  EXPECT_EQ(&counter, &instrumentation::counter(std::string("test.registry.counter")));
+  // Counters and histograms are named independently.
+  instrumentation::Histogram & histogram = instrumentation::histogram("test.registry.counter");
+
+  counter.add(3u);
+  histogram.record(std::chrono::microseconds(1));
+  auto snapshot = instrumentation::snapshot();
+  ASSERT_NE(find_counter(snapshot, "test.registry.counter"), nullptr);
+  EXPECT_EQ(find_counter(snapshot, "test.registry.counter")->value, 3u);
+  ASSERT_NE(find_histogram(snapshot, "test.registry.counter"), nullptr);
+  EXPECT_EQ(find_histogram(snapshot, "test.registry.counter")->histogram.count, 1u);
+  EXPECT_TRUE(
+    std::is_sorted(
+      snapshot.counters.begin(), snapshot.counters.end(),
+      [](const auto & a, const auto & b) {return a.name < b.name;}));
+
+  instrumentation::reset();
+  snapshot = instrumentation::snapshot();
+  ASSERT_NE(find_counter(snapshot, "test.registry.counter"), nullptr);
+  EXPECT_EQ(find_counter(snapshot, "test.registry.counter")->value, 0u);
+  EXPECT_EQ(counter.value(), 0u);
+}
+
+TEST(test_instrumentation, snapshot_with_concurrent_writers) {
+  instrumentation::Counter & counter = instrumentation::counter("test.concurrent.counter");
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> writers;
+  for (int i = 0; i < 4; ++i) {
+    writers.emplace_back(
+      [&]() {
+        while (!stop.load(std::memory_order_relaxed)) {
+          counter.add();
+        }
+      });
+  }
+  // Snapshots are monotonic, and new metrics can be registered, while writers are running.
+  std::uint64_t previous = 0u;
+  for (int i = 0; i < 100; ++i) {
+    instrumentation::counter("test.concurrent.registered_" + std::to_string(i));
+    const auto snapshot = instrumentation::snapshot();
+    const auto * value = find_counter(snapshot, "test.concurrent.counter");
+    ASSERT_NE(value, nullptr);
+    EXPECT_GE(value->value, previous);
+    previous = value->value;
+  }
+  stop = true;
+  for (auto & writer : writers) {
+    writer.join();
+  }
+  EXPECT_GE(counter.value(), previous);
+}
+
+TEST(test_instrumentation, macros) {
+  for (int i = 0; i < 3; ++i) {
+    traced_function();
+  }
+  const auto snapshot = instrumentation::snapshot();
+  const auto * calls = find_counter(snapshot, "test.traced_function_calls");
+  const auto * durations = find_histogram(snapshot, "test.traced_function");
+#ifndef RCPPUTILS_DISABLE_INSTRUMENTATION
+  ASSERT_NE(calls, nullptr);
+  EXPECT_EQ(calls->value, 3u);
+  ASSERT_NE(durations, nullptr);
+  EXPECT_EQ(durations->histogram.count, 3u);
+  EXPECT_GE(durations->histogram.total, std::chrono::microseconds(300));
+#else
+  // Nothing is registered.
+  EXPECT_EQ(calls, nullptr);
+  EXPECT_EQ(durations, nullptr);
+#endif
+}
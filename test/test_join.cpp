@@ -14,8 +14,11 @@
 
 #include <gtest/gtest.h>
 
+#include <array>
 #include <list>
+#include <set>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "rcpputils/join.hpp"
@@ -92,3 +95,60 @@ TEST(test_join, join_ints_list) {
     EXPECT_EQ("1, 2, 3", rcpputils::join(many_elements, ", "));
   }
 }
+
+TEST(test_join, join_string_like_values) {
+  {
+    const std::vector<std::string_view> elements{"foo", "bar", "baz"};
+    EXPECT_EQ("foo/bar/baz", rcpputils::join(elements, "/"));
+  }
+  {
+    const std::vector<const char *> elements{"foo", "bar", "baz"};
+    EXPECT_EQ("foo::bar::baz", rcpputils::join(elements, "::"));
+  }
+  {
+    const std::wstring elements[] = {L"foo", L"bar"};
+    EXPECT_EQ(std::wstring(L"foo, bar"), rcpputils::join(elements, L", "));
+  }
+}
+
+TEST(test_join, join_any_range) {
+  {
+    const std::array<std::string, 3> elements{"foo", "bar", "baz"};
+    EXPECT_EQ("foo:bar:baz", rcpputils::join(elements, ":"));
+  }
+  {
+    const std::array<int, 0> elements{};
+    EXPECT_EQ("", rcpputils::join(elements, ":"));
+  }
+  {
+    const double elements[] = {0.5, 1.25};
+    EXPECT_EQ("0.5 1.25", rcpputils::join(elements, " "));
+  }
+  {
+    const std::set<std::string> elements{"b", "a"};
+    EXPECT_EQ("a,b", rcpputils::join(elements, ","));
+  }
+}
+
+TEST(test_join, join_null_delimiter) {
+  const std::vector<std::string> strings{"foo", "bar"};
+  EXPECT_EQ("foobar", rcpputils::join(strings, static_cast<const char *>(nullptr)));
+  const std::vector<int> ints{1, 2};
+  EXPECT_EQ("12", rcpputils::join(ints, static_cast<const char *>(nullptr)));
+}
+
+TEST(test_join, append_join) {
+  {
+    std::string output = "PATH=";
+    const std::vector<std::string> elements{"/opt/ros/lib", "/usr/lib"};
+    rcpputils::append_join(output, elements, ":");
+    EXPECT_EQ("PATH=/opt/ros/lib:/usr/lib", output);
+    rcpputils::append_join(output, std::vector<std::string>{}, ":");
+    EXPECT_EQ("PATH=/opt/ros/lib:/usr/lib", output);
+  }
+  {
+    std::string output = "values: ";
+    rcpputils::append_join(output, std::list<int>{1, 2, 3}, ", ");
+    EXPECT_EQ("values: 1, 2, 3", output);
+  }
+}
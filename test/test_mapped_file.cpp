@@ -0,0 +1,163 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
+#include "rcpputils/filesystem_helper.hpp"
+#include "rcpputils/mapped_file.hpp"
+#include "rcpputils/temp_file.hpp"
+
+using path = rcpputils::fs::path;
+
+class TestMappedFile : public ::testing::Test
+{
+protected:
+  path write_file(const std::string & name, const std::string & contents)
+  {
+    const path file = directory_ / name;
+    std::ofstream(file.string(), std::ios::binary) << contents;
+    return file;
+  }
+
+  const rcpputils::fs::temp_directory scratch_ = rcpputils::fs::create_temp_directory();
+  const path directory_ = scratch_.path();
+};
+
+TEST_F(TestMappedFile, regular_file) {
+  std::string contents = "<package format=\"3\">\n";
+  for (int i = 0; i < 10000; ++i) {
+    contents += "  <depend>rcutils</depend>\n";
+  }
+  contents += std::string("\0</package>\n", 12);
+  const path file = write_file("package.xml", contents);
+
+  const rcpputils::fs::mapped_file mapped(file);
+  EXPECT_TRUE(mapped.is_open());
+  EXPECT_TRUE(mapped.is_mapped());
+  EXPECT_FALSE(mapped.empty());
+  EXPECT_EQ(mapped.size(), contents.size());
+  EXPECT_EQ(mapped.view(), contents);
+  EXPECT_EQ(std::string(mapped.begin(), mapped.end()), contents);
+  EXPECT_EQ(mapped.data(), mapped.view().data());
+}
+
+TEST_F(TestMappedFile, advice) {
+  const std::string contents(100000, 'x');
+  const path file = write_file("parameters.yaml", contents);
+  for (auto advice : {rcpputils::fs::access_advice::normal,
+      rcpputils::fs::access_advice::sequential,
+      rcpputils::fs::access_advice::random,
+      rcpputils::fs::access_advice::will_need})
+  {
+    rcpputils::fs::mapped_file mapped(file, advice);
+    EXPECT_EQ(mapped.view(), contents);
+#ifndef _WIN32
+    EXPECT_TRUE(mapped.advise(advice));
+#endif
+  }
+}
+
+TEST_F(TestMappedFile, empty_file) {
+  const rcpputils::fs::mapped_file mapped(write_file("empty", ""));
+  EXPECT_TRUE(mapped.is_open());
+  EXPECT_TRUE(mapped.empty());
+  EXPECT_EQ(mapped.view(), "");
+}
+
+TEST_F(TestMappedFile, errors) {
+  EXPECT_THROW(rcpputils::fs::mapped_file(directory_ / "missing"), std::system_error);
+
+  std::error_code ec;
+  rcpputils::fs::mapped_file missing(directory_ / "missing", ec);
+  EXPECT_EQ(ec, std::errc::no_such_file_or_directory);
+  EXPECT_FALSE(missing.is_open());
+  EXPECT_TRUE(missing.empty());
+  EXPECT_FALSE(missing.advise(rcpputils::fs::access_advice::sequential));
+
+#ifndef _WIN32
+  rcpputils::fs::mapped_file directory(directory_, ec);
+  EXPECT_EQ(ec, std::errc::is_a_directory);
+  EXPECT_FALSE(directory.is_open());
+#endif
+
+  rcpputils::fs::mapped_file file(write_file("file", "contents"), ec);
+  EXPECT_FALSE(ec);
+  EXPECT_TRUE(file.is_open());
+}
+
+TEST_F(TestMappedFile, move_and_close) {
+  const std::string contents = "ament index resource";
+  rcpputils::fs::mapped_file mapped(write_file("resource", contents));
+  rcpputils::fs::mapped_file moved(std::move(mapped));
+  EXPECT_FALSE(mapped.is_open());  // NOLINT(bugprone-use-after-move)
+  EXPECT_EQ(moved.view(), contents);
+
+  rcpputils::fs::mapped_file assigned;
+  EXPECT_FALSE(assigned.is_open());
+  assigned = std::move(moved);
+  EXPECT_EQ(assigned.view(), contents);
+
+  assigned.close();
+  EXPECT_FALSE(assigned.is_open());
+  EXPECT_TRUE(assigned.empty());
+}
+
+#ifndef _WIN32
+TEST_F(TestMappedFile, special_files) {
+  // Files in /proc report a size of zero but are not empty.
+  std::error_code ec;
+  const rcpputils::fs::mapped_file status(path("/proc/self/status"), ec);
+  if (!ec) {
+    EXPECT_FALSE(status.is_mapped());
+    EXPECT_NE(status.view().find("Name:"), std::string::npos);
+  }
+
+  const rcpputils::fs::mapped_file null(path("/dev/null"));
+  EXPECT_FALSE(null.is_mapped());
+  EXPECT_TRUE(null.empty());
+
+  // A pipe is read until its write end is closed, and its buffer survives a move.
+  const path fifo = directory_ / "fifo";
+  ASSERT_EQ(0, mkfifo(fifo.string().c_str(), 0600));
+  const std::string contents(200000, 'y');
+  std::thread writer(
+    [&]() {
+      std::ofstream(fifo.string(), std::ios::binary) << contents;
+    });
+  rcpputils::fs::mapped_file piped(fifo);
+  writer.join();
+  EXPECT_FALSE(piped.is_mapped());
+  EXPECT_EQ(piped.view(), contents);
+
+  const std::string short_contents = "short";
+  std::thread short_writer(
+    [&]() {
+      std::ofstream(fifo.string(), std::ios::binary) << short_contents;
+    });
+  rcpputils::fs::mapped_file short_piped(fifo);
+  short_writer.join();
+  const rcpputils::fs::mapped_file moved(std::move(short_piped));
+  EXPECT_EQ(moved.view(), short_contents);
+}
+#endif
@@ -0,0 +1,212 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include "rcpputils/mutex.hpp"
+
+namespace
+{
+
+// Probe a lock from a thread which may already hold it, outside of the analysis.
+template<typename Lockable>
+bool try_lock_and_unlock(Lockable & lockable) RCPPUTILS_TSA_NO_THREAD_SAFETY_ANALYSIS
+{
+  if (!lockable.try_lock()) {
+    return false;
+  }
+  lockable.unlock();
+  return true;
+}
+
+template<typename SharedLockable>
+bool try_lock_shared_and_unlock(SharedLockable & lockable)
+RCPPUTILS_TSA_NO_THREAD_SAFETY_ANALYSIS
+{
+  if (!lockable.try_lock_shared()) {
+    return false;
+  }
+  lockable.unlock_shared();
+  return true;
+}
+
+template<typename Lockable>
+struct Guarded
+{
+  Guarded() = default;
+
+  explicit Guarded(rcpputils::LockStats * stats)
+  : mutex(stats)
+  {}
+
+  void increment()
+  {
+    rcpputils::LockGuard<Lockable> lock(mutex);
+    ++value;
+  }
+
+  Lockable mutex;
+  int value RCPPUTILS_TSA_GUARDED_BY(mutex) = 0;
+};
+
+template<typename Lockable>
+void check_exclusion()
+{
+  constexpr int kThreads = 4;
+  constexpr int kIncrements = 10000;
+  rcpputils::LockStats stats;
+  Guarded<Lockable> guarded(&stats);
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreads; ++i) {
+    threads.emplace_back(
+      [&guarded]() {
+        for (int j = 0; j < kIncrements; ++j) {
+          guarded.increment();
+        }
+      });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+
+  rcpputils::LockGuard<Lockable> lock(guarded.mutex);
+  EXPECT_EQ(guarded.value, kThreads * kIncrements);
+  const auto histogram = stats.wait_histogram();
+  EXPECT_EQ(
+    stats.uncontended_count() + stats.contended_count(), kThreads * kIncrements + 1u);
+  EXPECT_EQ(
+    std::accumulate(histogram.begin(), histogram.end(), uint64_t(0)), stats.contended_count());
+}
+
+template<typename Lockable>
+void check_contention_is_recorded()
+{
+  rcpputils::LockStats stats;
+  Lockable mutex(&stats);
+  EXPECT_EQ(mutex.stats(), &stats);
+
+  mutex.lock();
+  EXPECT_EQ(stats.uncontended_count(), 1u);
+  EXPECT_FALSE(try_lock_and_unlock(mutex));
+
+  std::atomic<bool> started{false};
+  std::thread waiter(
+    [&]() {
+      started = true;
+      rcpputils::LockGuard<Lockable> lock(mutex);
+    });
+  while (!started) {
+    std::this_thread::yield();
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  mutex.unlock();
+  waiter.join();
+
+  EXPECT_EQ(stats.uncontended_count(), 1u);
+  EXPECT_EQ(stats.contended_count(), 1u);
+  EXPECT_GE(stats.total_wait(), std::chrono::milliseconds(10));
+  const auto histogram = stats.wait_histogram();
+  EXPECT_EQ(histogram[rcpputils::LockStats::bucket_of(stats.total_wait())], 1u);
+
+  stats.reset();
+  EXPECT_EQ(stats.uncontended_count(), 0u);
+  EXPECT_EQ(stats.contended_count(), 0u);
+  EXPECT_EQ(stats.total_wait().count(), 0);
+}
+
+}  // namespace
+
+TEST(test_mutex, histogram_buckets) {
+  using std::chrono::nanoseconds;
+  EXPECT_EQ(rcpputils::LockStats::bucket_of(nanoseconds(0)), 0u);
+  EXPECT_EQ(rcpputils::LockStats::bucket_of(nanoseconds(1)), 0u);
+  EXPECT_EQ(rcpputils::LockStats::bucket_of(nanoseconds(2)), 1u);
+  EXPECT_EQ(rcpputils::LockStats::bucket_of(nanoseconds(3)), 1u);
+  EXPECT_EQ(rcpputils::LockStats::bucket_of(nanoseconds(1024)), 10u);
+  EXPECT_EQ(rcpputils::LockStats::bucket_of(nanoseconds(2047)), 10u);
+  EXPECT_EQ(
+    rcpputils::LockStats::bucket_of(std::chrono::hours(24 * 365)),
+    rcpputils::LockStats::kHistogramBuckets - 1);
+}
+
+TEST(test_mutex, mutex) {
+  check_exclusion<rcpputils::Mutex>();
+  check_contention_is_recorded<rcpputils::Mutex>();
+
+  // Without statistics.
+  Guarded<rcpputils::Mutex> guarded;
+  guarded.increment();
+  EXPECT_EQ(guarded.mutex.stats(), nullptr);
+  guarded.mutex.lock();
+  rcpputils::LockGuard<rcpputils::Mutex> adopted(guarded.mutex, std::adopt_lock);
+  EXPECT_EQ(guarded.value, 1);
+}
+
+TEST(test_mutex, spin_lock) {
+  check_exclusion<rcpputils::SpinLock>();
+  check_contention_is_recorded<rcpputils::SpinLock>();
+}
+
+TEST(test_mutex, shared_mutex) {
+  check_exclusion<rcpputils::SharedMutex>();
+  check_contention_is_recorded<rcpputils::SharedMutex>();
+
+  rcpputils::LockStats stats;
+  rcpputils::SharedMutex mutex(&stats);
+  {
+    rcpputils::SharedLockGuard<rcpputils::SharedMutex> reader(mutex);
+    EXPECT_TRUE(try_lock_shared_and_unlock(mutex));
+    EXPECT_FALSE(try_lock_and_unlock(mutex));
+  }
+  {
+    rcpputils::LockGuard<rcpputils::SharedMutex> writer(mutex);
+    EXPECT_FALSE(try_lock_shared_and_unlock(mutex));
+  }
+  // The reader and the writer; the probes do not count.
+  EXPECT_EQ(stats.uncontended_count(), 2u);
+}
+
+TEST(test_mutex, unique_lock) {
+  rcpputils::Mutex mutex;
+  std::condition_variable_any condition;
+  bool ready = false;
+
+  std::thread notifier(
+    [&]() {
+      rcpputils::LockGuard<rcpputils::Mutex> lock(mutex);
+      ready = true;
+      condition.notify_one();
+    });
+  {
+    rcpputils::UniqueLock<rcpputils::Mutex> lock(mutex);
+    condition.wait(lock, [&ready]() {return ready;});
+    EXPECT_TRUE(lock.owns_lock());
+    lock.unlock();
+    EXPECT_FALSE(lock.owns_lock());
+    EXPECT_TRUE(try_lock_and_unlock(mutex));
+    lock.lock();
+    EXPECT_FALSE(try_lock_and_unlock(mutex));
+  }
+  EXPECT_TRUE(try_lock_and_unlock(mutex));
+  notifier.join();
+}
@@ -0,0 +1,75 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <string_view>
+
+#include "rcpputils/platform_library_name.hpp"
+
+#ifdef _WIN32
+static constexpr std::string_view kExpectedName = "dummy.dll";
+static constexpr std::string_view kExpectedDebugName = "dummyd.dll";
+#elif __APPLE__
+static constexpr std::string_view kExpectedName = "libdummy.dylib";
+static constexpr std::string_view kExpectedDebugName = "libdummyd.dylib";
+#else
+static constexpr std::string_view kExpectedName = "libdummy.so";
+static constexpr std::string_view kExpectedDebugName = "libdummyd.so";
+#endif
+
+TEST(test_platform_library_name, compile_time) {
+  constexpr auto name = rcpputils::make_platform_library_name("dummy");
+  static_assert(name.view() == kExpectedName, "unexpected compile-time library name");
+  constexpr auto debug_name = rcpputils::make_platform_library_name<true>("dummy");
+  static_assert(debug_name.view() == kExpectedDebugName, "unexpected compile-time library name");
+  static_assert(
+    rcpputils::platform_library_name_size("dummy") == kExpectedName.size(),
+    "unexpected library name size");
+
+  EXPECT_STREQ(name.c_str(), std::string(kExpectedName).c_str());
+  EXPECT_EQ(std::string_view(debug_name), kExpectedDebugName);
+}
+
+TEST(test_platform_library_name, caller_buffer) {
+  char buffer[32] = "untouched";
+  EXPECT_EQ(
+    rcpputils::write_platform_library_name("dummy", false, buffer, 4), kExpectedName.size());
+  EXPECT_STREQ(buffer, "untouched");
+
+  EXPECT_EQ(
+    rcpputils::write_platform_library_name("dummy", false, buffer, sizeof(buffer)),
+    kExpectedName.size());
+  EXPECT_EQ(std::string_view(buffer), kExpectedName);
+
+  // Exactly enough room for the name, without the terminating null character.
+  char exact[32] = {};
+  exact[kExpectedDebugName.size()] = 'x';
+  EXPECT_EQ(
+    rcpputils::write_platform_library_name("dummy", true, exact, kExpectedDebugName.size()),
+    kExpectedDebugName.size());
+  EXPECT_EQ(std::string_view(exact, kExpectedDebugName.size()), kExpectedDebugName);
+  EXPECT_EQ(exact[kExpectedDebugName.size()], 'x');
+}
+
+TEST(test_platform_library_name, append) {
+  std::string path = "prefix/";
+  rcpputils::append_platform_library_name(path, "dummy");
+  EXPECT_EQ(path, "prefix/" + std::string(kExpectedName));
+
+  std::string debug_path;
+  rcpputils::append_platform_library_name(debug_path, "dummy", true);
+  EXPECT_EQ(debug_path, kExpectedDebugName);
+}
@@ -14,8 +14,10 @@
 
 #include <gtest/gtest.h>
 
-#include <string>
 #include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
 
 #include "rcpputils/pointer_traits.hpp"
 
@@ -127,3 +129,115 @@ TEST(TestPointerTraits, remove_pointer) {
   EXPECT_TRUE(b_cvuptr);
   EXPECT_TRUE(b_cvuptrc);
 }
+
+namespace
+{
+
+struct FreeDeleter
+{
+  void operator()(int * p) const noexcept
+  {
+    delete p;
+  }
+};
+
+// A non-owning pointer, made known to the traits through the customization point.
+template<class T>
+class ObserverPtr
+{
+public:
+  constexpr explicit ObserverPtr(T * p) noexcept
+  : p_(p)
+  {}
+
+  constexpr T * operator->() const noexcept {return p_;}
+
+private:
+  T * p_;
+};
+
+}  // namespace
+
+namespace rcpputils
+{
+template<class T>
+struct smart_pointer_traits<ObserverPtr<T>>
+{
+  static constexpr bool is_smart_pointer = true;
+  using element_type = T;
+};
+}  // namespace rcpputils
+
+TEST(TestPointerTraits, custom_deleters_and_weak_pointers) {
+  using deleter_uptr = std::unique_ptr<int, FreeDeleter>;
+  using function_uptr = std::unique_ptr<int, void (*)(int *)>;
+  using array_uptr = std::unique_ptr<int[]>;
+  using wptr = std::weak_ptr<const int>;
+
+  static_assert(rcpputils::is_pointer<deleter_uptr>::value, "");
+  static_assert(rcpputils::is_pointer<const function_uptr &>::value, "");
+  static_assert(rcpputils::is_pointer_v<array_uptr>, "");
+  static_assert(rcpputils::is_pointer_v<wptr>, "");
+  static_assert(rcpputils::is_pointer_v<const volatile wptr>, "");
+  static_assert(rcpputils::is_pointer_v<ObserverPtr<POD>>, "");
+  static_assert(!rcpputils::is_pointer_v<std::string>, "");
+
+  static_assert(std::is_same<rcpputils::remove_pointer_t<deleter_uptr>, int>::value, "");
+  static_assert(std::is_same<rcpputils::remove_pointer_t<function_uptr &&>, int>::value, "");
+  static_assert(std::is_same<rcpputils::remove_pointer_t<array_uptr>, int>::value, "");
+  static_assert(std::is_same<rcpputils::remove_pointer_t<wptr>, const int>::value, "");
+  static_assert(std::is_same<rcpputils::remove_pointer_t<const wptr &>, const int>::value, "");
+  static_assert(
+    std::is_same<rcpputils::remove_pointer_t<std::shared_ptr<POD> &>, POD>::value, "");
+  static_assert(std::is_same<rcpputils::remove_pointer_t<ObserverPtr<POD>>, POD>::value, "");
+  static_assert(std::is_same<rcpputils::remove_pointer_t<int>, int>::value, "");
+}
+
+TEST(TestPointerTraits, ownership_traits) {
+  static_assert(rcpputils::is_shared_pointer_v<std::shared_ptr<int>>, "");
+  static_assert(rcpputils::is_shared_pointer_v<const std::shared_ptr<int> &>, "");
+  static_assert(!rcpputils::is_shared_pointer_v<std::unique_ptr<int>>, "");
+  static_assert(!rcpputils::is_shared_pointer_v<std::weak_ptr<int>>, "");
+  static_assert(!rcpputils::is_shared_pointer_v<int *>, "");
+
+  static_assert(rcpputils::is_unique_pointer_v<std::unique_ptr<int>>, "");
+  static_assert(rcpputils::is_unique_pointer_v<std::unique_ptr<int, FreeDeleter> &&>, "");
+  static_assert(rcpputils::is_unique_pointer_v<const volatile std::unique_ptr<int[]>>, "");
+  static_assert(!rcpputils::is_unique_pointer_v<std::shared_ptr<int>>, "");
+  static_assert(!rcpputils::is_unique_pointer_v<ObserverPtr<int>>, "");
+
+  static_assert(rcpputils::is_weak_pointer_v<std::weak_ptr<int>>, "");
+  static_assert(rcpputils::is_weak_pointer_v<std::weak_ptr<int> &>, "");
+  static_assert(!rcpputils::is_weak_pointer_v<std::shared_ptr<int>>, "");
+  static_assert(rcpputils::is_unique_pointer<std::unique_ptr<int>>::value, "");
+  static_assert(!rcpputils::is_shared_pointer<int>::value, "");
+}
+
+namespace
+{
+
+constexpr int g_value = 13;
+
+}  // namespace
+
+TEST(TestPointerTraits, to_address) {
+  static_assert(rcpputils::to_address(&g_value) == &g_value, "");
+  static_assert(rcpputils::to_address(ObserverPtr<const int>(&g_value)) == &g_value, "");
+  int * null = nullptr;
+  EXPECT_EQ(rcpputils::to_address(null), nullptr);
+
+  auto sptr = std::make_shared<int>(13);
+  EXPECT_EQ(rcpputils::to_address(sptr), sptr.get());
+  std::shared_ptr<int> null_sptr;
+  EXPECT_EQ(rcpputils::to_address(null_sptr), nullptr);
+
+  std::unique_ptr<int, FreeDeleter> uptr(new int(13));
+  EXPECT_EQ(rcpputils::to_address(uptr), uptr.get());
+  auto array_uptr = std::make_unique<int[]>(4);
+  EXPECT_EQ(rcpputils::to_address(array_uptr), array_uptr.get());
+
+  std::vector<int> values{1, 2, 3};
+  EXPECT_EQ(rcpputils::to_address(values.begin() + 1), values.data() + 1);
+  std::string str = "hello";
+  EXPECT_EQ(rcpputils::to_address(str.begin()), str.data());
+}
@@ -0,0 +1,278 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rcpputils/ring_buffer.hpp"
+
+namespace
+{
+
+struct Counted
+{
+  static int live;
+
+  explicit Counted(int v)
+  : value(v)
+  {
+    ++live;
+  }
+
+  Counted(const Counted & other)
+  : value(other.value)
+  {
+    ++live;
+  }
+
+  Counted(Counted && other) noexcept
+  : value(other.value)
+  {
+    ++live;
+  }
+
+  Counted & operator=(const Counted &) = default;
+  Counted & operator=(Counted &&) noexcept = default;
+
+  ~Counted()
+  {
+    --live;
+  }
+
+  int value;
+};
+
+int Counted::live = 0;
+
+// Copies throw when the value is negative; moves never do.
+struct ThrowingCopy
+{
+  explicit ThrowingCopy(int v)
+  : value(v)
+  {}
+
+  ThrowingCopy(const ThrowingCopy & other)
+  : value(other.value)
+  {
+    if (value < 0) {
+      throw std::runtime_error("copy failed");
+    }
+  }
+
+  ThrowingCopy(ThrowingCopy && other) noexcept = default;
+  ThrowingCopy & operator=(const ThrowingCopy &) = default;
+  ThrowingCopy & operator=(ThrowingCopy &&) noexcept = default;
+
+  int value;
+};
+
+template<typename Queue>
+void check_throwing_copy()
+{
+  Queue queue(4);
+  const ThrowingCopy bad(-1);
+  EXPECT_THROW(queue.try_push(bad), std::runtime_error);
+  EXPECT_TRUE(queue.empty());
+
+  std::vector<ThrowingCopy> batch;
+  for (int v : {1, 2, -1}) {
+    batch.emplace_back(v);
+  }
+  EXPECT_THROW(queue.try_push_n(batch.begin(), batch.size()), std::runtime_error);
+  EXPECT_TRUE(queue.try_push(ThrowingCopy(3)));
+  EXPECT_EQ(queue.size(), 3u);
+
+  // The queue still hands out everything queued around the failures.
+  ThrowingCopy out(0);
+  for (int expected : {1, 2, 3}) {
+    ASSERT_TRUE(queue.try_pop(out));
+    EXPECT_EQ(out.value, expected);
+  }
+  EXPECT_FALSE(queue.try_pop(out));
+}
+
+template<typename Queue>
+void check_single_thread()
+{
+  Queue queue(3);
+  EXPECT_EQ(queue.capacity(), 4u);
+  EXPECT_TRUE(queue.empty());
+
+  int value = 0;
+  EXPECT_FALSE(queue.try_pop(value));
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(queue.try_push(i));
+  }
+  EXPECT_FALSE(queue.try_push(4));
+  EXPECT_EQ(queue.size(), 4u);
+
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(queue.try_pop(value));
+    EXPECT_EQ(value, i);
+  }
+  EXPECT_FALSE(queue.try_pop(value));
+
+  // Wrap around the end of the storage a few times.
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_TRUE(queue.try_emplace(i));
+    EXPECT_EQ(queue.pop(), i);
+  }
+}
+
+template<typename Queue>
+void check_batches()
+{
+  Queue queue(8);
+  const std::vector<std::string> input{"a", "b", "c", "d", "e", "f"};
+  EXPECT_EQ(queue.try_push_n(input.begin(), input.size()), 6u);
+  EXPECT_EQ(queue.try_push_n(input.begin(), input.size()), 2u);
+
+  std::vector<std::string> output;
+  EXPECT_EQ(queue.try_pop_n(std::back_inserter(output), 3), 3u);
+  EXPECT_EQ(output, (std::vector<std::string>{"a", "b", "c"}));
+  EXPECT_EQ(queue.try_pop_n(std::back_inserter(output), 100), 5u);
+  EXPECT_EQ(output, (std::vector<std::string>{"a", "b", "c", "d", "e", "f", "a", "b"}));
+  EXPECT_EQ(queue.try_pop_n(std::back_inserter(output), 100), 0u);
+
+  // Move-only elements.
+  std::vector<std::unique_ptr<int>> owned;
+  owned.push_back(std::make_unique<int>(1));
+  owned.push_back(std::make_unique<int>(2));
+  typename Queue::template rebind<std::unique_ptr<int>> pointers(2);
+  EXPECT_EQ(pointers.try_push_n(std::make_move_iterator(owned.begin()), owned.size()), 2u);
+  EXPECT_EQ(owned[0], nullptr);
+  EXPECT_EQ(*pointers.pop(), 1);
+  EXPECT_EQ(*pointers.pop(), 2);
+}
+
+template<typename Queue>
+void check_threads(std::size_t producers, std::size_t consumers)
+{
+  constexpr int kPerProducer = 20000;
+  Queue queue(64);
+  std::atomic<long long> sum{0};
+  std::atomic<int> received{0};
+  const int total = static_cast<int>(producers) * kPerProducer;
+
+  std::vector<std::thread> threads;
+  for (std::size_t p = 0; p < producers; ++p) {
+    threads.emplace_back(
+      [&queue]() {
+        for (int i = 1; i <= kPerProducer; ++i) {
+          queue.push(i);
+        }
+      });
+  }
+  for (std::size_t c = 0; c < consumers; ++c) {
+    threads.emplace_back(
+      [&]() {
+        int last = 0;
+        while (received.fetch_add(1) < total) {
+          const int value = queue.pop();
+          // With a single producer the order is preserved.
+          if (producers == 1) {
+            EXPECT_GT(value, last);
+          }
+          last = value;
+          sum += value;
+        }
+      });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  const long long expected = static_cast<long long>(producers) * kPerProducer *
+    (kPerProducer + 1) / 2;
+  EXPECT_EQ(sum.load(), expected);
+  EXPECT_TRUE(queue.empty());
+}
+
+template<typename T, typename WaitPolicy = rcpputils::SpinWait>
+struct Spsc : rcpputils::SpscRingBuffer<T, WaitPolicy>
+{
+  using rcpputils::SpscRingBuffer<T, WaitPolicy>::SpscRingBuffer;
+  template<typename U>
+  using rebind = Spsc<U, WaitPolicy>;
+};
+
+template<typename T, typename WaitPolicy = rcpputils::SpinWait>
+struct Mpmc : rcpputils::MpmcRingBuffer<T, WaitPolicy>
+{
+  using rcpputils::MpmcRingBuffer<T, WaitPolicy>::MpmcRingBuffer;
+  template<typename U>
+  using rebind = Mpmc<U, WaitPolicy>;
+};
+
+}  // namespace
+
+TEST(test_ring_buffer, capacity) {
+  EXPECT_THROW(rcpputils::SpscRingBuffer<int>(0), std::invalid_argument);
+  EXPECT_THROW(rcpputils::MpmcRingBuffer<int>(0), std::invalid_argument);
+  EXPECT_EQ(rcpputils::SpscRingBuffer<int>(1).capacity(), 1u);
+  EXPECT_EQ(rcpputils::MpmcRingBuffer<int>(1).capacity(), 2u);
+  EXPECT_EQ(rcpputils::SpscRingBuffer<int>(1000).capacity(), 1024u);
+  EXPECT_EQ(rcpputils::MpmcRingBuffer<int>(1024).capacity(), 1024u);
+}
+
+TEST(test_ring_buffer, spsc_single_thread) {
+  check_single_thread<rcpputils::SpscRingBuffer<int>>();
+  check_batches<Spsc<std::string>>();
+}
+
+TEST(test_ring_buffer, mpmc_single_thread) {
+  check_single_thread<rcpputils::MpmcRingBuffer<int>>();
+  check_batches<Mpmc<std::string>>();
+}
+
+TEST(test_ring_buffer, destroys_remaining_elements) {
+  {
+    rcpputils::SpscRingBuffer<Counted> spsc(4);
+    rcpputils::MpmcRingBuffer<Counted> mpmc(4);
+    for (int i = 0; i < 3; ++i) {
+      spsc.try_emplace(i);
+      mpmc.try_emplace(i);
+    }
+    Counted out(0);
+    EXPECT_TRUE(spsc.try_pop(out));
+    EXPECT_TRUE(mpmc.try_pop(out));
+    EXPECT_EQ(Counted::live, 5);
+  }
+  EXPECT_EQ(Counted::live, 0);
+}
+
+TEST(test_ring_buffer, throwing_copy) {
+  check_throwing_copy<rcpputils::SpscRingBuffer<ThrowingCopy>>();
+  check_throwing_copy<rcpputils::MpmcRingBuffer<ThrowingCopy>>();
+}
+
+TEST(test_ring_buffer, spsc_threads) {
+  check_threads<rcpputils::SpscRingBuffer<int, rcpputils::SpinWait>>(1, 1);
+  check_threads<rcpputils::SpscRingBuffer<int, rcpputils::YieldWait>>(1, 1);
+  check_threads<rcpputils::SpscRingBuffer<int, rcpputils::FutexWait>>(1, 1);
+}
+
+TEST(test_ring_buffer, mpmc_threads) {
+  check_threads<rcpputils::MpmcRingBuffer<int, rcpputils::YieldWait>>(1, 1);
+  check_threads<rcpputils::MpmcRingBuffer<int, rcpputils::YieldWait>>(4, 4);
+  check_threads<rcpputils::MpmcRingBuffer<int, rcpputils::FutexWait>>(4, 2);
+  check_threads<rcpputils::MpmcRingBuffer<int, rcpputils::FutexWait>>(2, 4);
+}
@@ -0,0 +1,112 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <string_view>
+
+#include "rcpputils/detail/scan.hpp"
+
+namespace
+{
+
+// Inputs long enough to cover several vector blocks plus an unaligned tail.
+std::string make_input(std::mt19937 & gen, std::size_t size)
+{
+  // A small alphabet makes partial needle matches frequent.
+  std::uniform_int_distribution<int> dist('a', 'e');
+  std::string input(size, '\0');
+  for (auto & c : input) {
+    c = static_cast<char>(dist(gen));
+  }
+  return input;
+}
+
+}  // namespace
+
+TEST(test_scan, kernel_name)
+{
+  EXPECT_NE(nullptr, rcpputils::detail::scan_kernel_name);
+  std::cout << "Scanning kernel: " << rcpputils::detail::scan_kernel_name << std::endl;
+}
+
+TEST(test_scan, find_char)
+{
+  std::mt19937 gen(42);
+  for (std::size_t size = 0u; size < 100u; ++size) {
+    const std::string input = make_input(gen, size);
+    const std::string_view view(input);
+    for (std::size_t pos = 0u; pos <= size + 1u; ++pos) {
+      for (const char c : {'a', 'e', 'z', '\0'}) {
+        EXPECT_EQ(view.find(c, pos), rcpputils::detail::scan_find(view, c, pos));
+        EXPECT_EQ(view.find(c, pos), rcpputils::detail::scalar::find(view, c, pos));
+      }
+    }
+  }
+}
+
+TEST(test_scan, find_first_of)
+{
+  std::mt19937 gen(7);
+  const std::string_view sets[] = {"", "e", "de", "xyze", "zzzzzzzzd", "vwxyzq"};
+  for (std::size_t size = 0u; size < 100u; ++size) {
+    const std::string input = make_input(gen, size);
+    const std::string_view view(input);
+    for (std::size_t pos = 0u; pos <= size + 1u; ++pos) {
+      for (const auto set : sets) {
+        EXPECT_EQ(
+          view.find_first_of(set, pos), rcpputils::detail::scan_find_first_of(view, set, pos));
+        EXPECT_EQ(
+          view.find_first_of(set, pos), rcpputils::detail::scalar::find_first_of(view, set, pos));
+      }
+    }
+  }
+}
+
+TEST(test_scan, find_substring)
+{
+  std::mt19937 gen(1234);
+  const std::string_view needles[] = {
+    "", "a", "ab", "abc", "cabad", "eeee", "zz", "abcdeabcdeabcde"};
+  for (std::size_t size = 0u; size < 100u; ++size) {
+    const std::string input = make_input(gen, size);
+    const std::string_view view(input);
+    for (std::size_t pos = 0u; pos <= size + 1u; ++pos) {
+      for (const auto needle : needles) {
+        EXPECT_EQ(view.find(needle, pos), rcpputils::detail::scan_find(view, needle, pos)) <<
+          "input: " << input << " needle: " << needle << " pos: " << pos;
+        EXPECT_EQ(view.find(needle, pos), rcpputils::detail::scalar::find(view, needle, pos));
+      }
+    }
+  }
+}
+
+TEST(test_scan, find_at_block_boundaries)
+{
+  // Place a single match at every offset of a long input.
+  for (std::size_t size = 1u; size < 80u; ++size) {
+    for (std::size_t match = 0u; match < size; ++match) {
+      std::string input(size, '.');
+      input[match] = ':';
+      EXPECT_EQ(match, rcpputils::detail::scan_find(input, ':'));
+      EXPECT_EQ(match, rcpputils::detail::scan_find_first_of(input, ";:"));
+      if (match + 1u < size) {
+        input[match + 1u] = '/';
+        EXPECT_EQ(match, rcpputils::detail::scan_find(input, std::string_view(":/")));
+      }
+    }
+  }
+}
@@ -14,9 +14,16 @@
 
 #include <gtest/gtest.h>
 
+#include <cstdint>
+#include <future>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
 
+#include "rcpputils/instrumentation.hpp"
 #include "rcpputils/shared_library.hpp"
 
 TEST(test_shared_library, valid_load) {
@@ -65,8 +72,204 @@ TEST(test_shared_library, failed_test) {
   }
 }
 
-TEST(test_get_platform_library_name, failed_test) {
-  // create a string bigger than the internal buffer
+TEST(test_shared_library, typed_symbol_lookup) {
+  const std::string library_path = rcpputils::get_platform_library_name("dummy_shared_library");
+  rcpputils::SharedLibrary library(library_path);
+
+  using print_name_t = void (*)();
+  auto print_name = library.get_symbol<print_name_t>(std::string_view("print_name"));
+  ASSERT_NE(print_name, nullptr);
+  EXPECT_EQ(reinterpret_cast<void *>(print_name), library.get_symbol("print_name"));
+  EXPECT_EQ(library.try_get_symbol<print_name_t>("print_name"), print_name);
+
+  // A view that is not null-terminated at the symbol name.
+  const std::string padded = "print_name_and_more";
+  EXPECT_EQ(
+    library.try_get_symbol(std::string_view(padded).substr(0, 10)),
+    library.get_symbol("print_name"));
+
+  EXPECT_EQ(library.try_get_symbol("symbol"), nullptr);
+  EXPECT_EQ(library.try_get_symbol("symbol"), nullptr);
+  EXPECT_EQ(library.try_get_symbol<print_name_t>("symbol"), nullptr);
+  EXPECT_THROW(library.get_symbol<print_name_t>("symbol"), std::runtime_error);
+  EXPECT_FALSE(library.has_symbol("symbol"));
+
+  std::vector<std::thread> threads;
+  std::vector<void *> results(8);
+  for (size_t i = 0; i < results.size(); ++i) {
+    threads.emplace_back(
+      [&library, &results, i]() {
+        for (int j = 0; j < 1000; ++j) {
+          results[i] = library.try_get_symbol("print_name");
+        }
+      });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  for (void * result : results) {
+    EXPECT_EQ(result, reinterpret_cast<void *>(print_name));
+  }
+
+  library.unload_library();
+  EXPECT_EQ(library.try_get_symbol("print_name"), nullptr);
+  EXPECT_FALSE(library.has_symbol("print_name"));
+}
+
+TEST(test_shared_library_registry, shared_instances) {
+  const std::string library_path = rcpputils::get_platform_library_name("dummy_shared_library");
+  auto & registry = rcpputils::SharedLibraryRegistry::instance();
+  EXPECT_EQ(&registry, &rcpputils::SharedLibraryRegistry::instance());
+  ASSERT_FALSE(registry.deferred_unload());
+  const size_t initial_size = registry.size();
+
+  auto first = registry.load(library_path);
+  auto second = registry.load(library_path);
+  ASSERT_NE(first, nullptr);
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(registry.size(), initial_size + 1);
+  EXPECT_TRUE(first->has_symbol("print_name"));
+
+  std::weak_ptr<rcpputils::SharedLibrary> weak = first;
+  first.reset();
+  EXPECT_FALSE(weak.expired());
+  second.reset();
+  EXPECT_TRUE(weak.expired());
+  EXPECT_EQ(registry.size(), initial_size);
+
+  EXPECT_THROW(
+    registry.load(rcpputils::get_platform_library_name("error_library")), std::runtime_error);
+  EXPECT_EQ(registry.size(), initial_size);
+}
+
+TEST(test_shared_library_registry, deferred_unload) {
+  const std::string library_path = rcpputils::get_platform_library_name("dummy_shared_library");
+  auto & registry = rcpputils::SharedLibraryRegistry::instance();
+  const size_t initial_size = registry.size();
+
+  registry.set_deferred_unload(true);
+  EXPECT_TRUE(registry.deferred_unload());
+  std::weak_ptr<rcpputils::SharedLibrary> weak = registry.load(library_path);
+  EXPECT_FALSE(weak.expired());
+  EXPECT_EQ(registry.load(library_path), weak.lock());
+  EXPECT_EQ(registry.size(), initial_size + 1);
+
+  registry.release_deferred();
+  EXPECT_TRUE(weak.expired());
+  EXPECT_EQ(registry.size(), initial_size);
+
+  weak = registry.load(library_path);
+  EXPECT_FALSE(weak.expired());
+  registry.set_deferred_unload(false);
+  EXPECT_FALSE(registry.deferred_unload());
+  EXPECT_TRUE(weak.expired());
+}
+
+TEST(test_shared_library, load_options) {
+  const std::string library_path = rcpputils::get_platform_library_name("dummy_shared_library");
+
+  rcpputils::SharedLibraryLoadOptions options;
+  options.binding = rcpputils::SharedLibraryLoadOptions::Binding::now;
+  options.visibility = rcpputils::SharedLibraryLoadOptions::Visibility::global;
+  options.no_delete = true;
+  rcpputils::SharedLibrary library(library_path, options);
+  EXPECT_STREQ(library.get_library_path().c_str(), library_path.c_str());
+  EXPECT_TRUE(library.has_symbol("print_name"));
+
+  EXPECT_THROW(
+    rcpputils::SharedLibrary(rcpputils::get_platform_library_name("error_library"), options),
+    std::runtime_error);
+}
+
+TEST(test_shared_library_registry, load_async) {
+  const std::string library_path = rcpputils::get_platform_library_name("dummy_shared_library");
+  auto & registry = rcpputils::SharedLibraryRegistry::instance();
+
+  std::vector<std::future<std::shared_ptr<rcpputils::SharedLibrary>>> futures;
+  for (int i = 0; i < 8; ++i) {
+    futures.push_back(registry.load_async(library_path));
+  }
+  auto failing = registry.load_async(rcpputils::get_platform_library_name("error_library"));
+
+  std::shared_ptr<rcpputils::SharedLibrary> first = futures.front().get();
+  ASSERT_NE(first, nullptr);
+  for (size_t i = 1; i < futures.size(); ++i) {
+    EXPECT_EQ(futures[i].get(), first);
+  }
+  EXPECT_TRUE(first->has_symbol("print_name"));
+  EXPECT_THROW(failing.get(), std::runtime_error);
+}
+
+TEST(test_shared_library, error_code_api) {
+  std::error_code ec;
+  const std::string library_path =
+    rcpputils::get_platform_library_name("dummy_shared_library", false, ec);
+  EXPECT_FALSE(ec);
+  EXPECT_EQ(library_path, rcpputils::get_platform_library_name("dummy_shared_library"));
+
+  rcpputils::SharedLibrary missing(rcpputils::get_platform_library_name("error_library"), ec);
+  EXPECT_EQ(ec, rcpputils::shared_library_errc::load_failed);
+  EXPECT_STREQ(ec.category().name(), "rcpputils.shared_library");
+  EXPECT_FALSE(ec.message().empty());
+  EXPECT_EQ(missing.get_symbol("print_name", ec), nullptr);
+  EXPECT_EQ(ec, rcpputils::shared_library_errc::not_loaded);
+  missing.unload_library(ec);
+  EXPECT_EQ(ec, rcpputils::shared_library_errc::not_loaded);
+
+  rcpputils::SharedLibrary library(library_path, ec);
+  ASSERT_FALSE(ec);
+  EXPECT_NE(library.get_symbol("print_name", ec), nullptr);
+  EXPECT_FALSE(ec);
+  EXPECT_EQ(library.get_symbol("symbol", ec), nullptr);
+  EXPECT_EQ(ec, rcpputils::shared_library_errc::symbol_not_found);
+  library.unload_library(ec);
+  EXPECT_FALSE(ec);
+  library.unload_library(ec);
+  EXPECT_EQ(ec, rcpputils::shared_library_errc::not_loaded);
+
+  const std::string invalid_name("dummy\0library", 13);
+  EXPECT_EQ(rcpputils::get_platform_library_name(invalid_name, false, ec), "");
+  EXPECT_EQ(ec, rcpputils::shared_library_errc::invalid_library_name);
+}
+
+TEST(test_shared_library, instrumentation) {
+  const auto count = [](const std::string & name) -> std::uint64_t {
+      const auto snapshot = rcpputils::instrumentation::snapshot();
+      for (const auto & histogram : snapshot.histograms) {
+        if (histogram.name == name) {
+          return histogram.histogram.count;
+        }
+      }
+      for (const auto & counter : snapshot.counters) {
+        if (counter.name == name) {
+          return counter.value;
+        }
+      }
+      return 0u;
+    };
+  const std::uint64_t loads = count("rcpputils.shared_library.load");
+  const std::uint64_t lookups = count("rcpputils.shared_library.get_symbol");
+  const std::uint64_t resolutions = count("rcpputils.shared_library.resolve_symbol");
+
+  rcpputils::SharedLibrary library(rcpputils::get_platform_library_name("dummy_shared_library"));
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_NE(library.get_symbol("print_name"), nullptr);
+  }
+  // Only the first lookup resolves the symbol, the others hit the cache.
+  EXPECT_EQ(count("rcpputils.shared_library.load"), loads + 1u);
+  EXPECT_EQ(count("rcpputils.shared_library.get_symbol"), lookups + 3u);
+  EXPECT_EQ(count("rcpputils.shared_library.resolve_symbol"), resolutions + 1u);
+}
+
+TEST(test_get_platform_library_name, long_name) {
+  // Names are not limited by an internal buffer
   std::string str(2000, 'A');
+  const std::string name = rcpputils::get_platform_library_name(str);
+  EXPECT_NE(name.find(str), std::string::npos);
+  EXPECT_GT(name.size(), str.size());
+}
+
+TEST(test_get_platform_library_name, failed_test) {
+  const std::string str("dummy\0library", 13);
   EXPECT_THROW(rcpputils::get_platform_library_name(str), std::runtime_error);
 }
@@ -0,0 +1,329 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rcpputils/allocators.hpp"
+#include "rcpputils/small_vector.hpp"
+
+namespace
+{
+
+// Counts live instances, to check that every constructed element is destroyed.
+struct Tracked
+{
+  static int live;
+
+  Tracked(int v = 0)  // NOLINT(runtime/explicit)
+  : value(v)
+  {
+    ++live;
+  }
+
+  Tracked(const Tracked & other)
+  : value(other.value)
+  {
+    ++live;
+  }
+
+  Tracked(Tracked && other) noexcept
+  : value(other.value)
+  {
+    other.value = -1;
+    ++live;
+  }
+
+  Tracked & operator=(const Tracked &) = default;
+  Tracked & operator=(Tracked &&) = default;
+
+  ~Tracked()
+  {
+    --live;
+  }
+
+  bool operator==(const Tracked & other) const
+  {
+    return value == other.value;
+  }
+
+  int value;
+};
+
+int Tracked::live = 0;
+
+// Throws when copied after a countdown, to check the strong guarantee of growth.
+struct ThrowsOnCopy
+{
+  static int copies_left;
+
+  explicit ThrowsOnCopy(int v)
+  : value(v)
+  {}
+
+  ThrowsOnCopy(const ThrowsOnCopy & other)
+  : value(other.value)
+  {
+    if (copies_left-- == 0) {
+      throw std::runtime_error("copy");
+    }
+  }
+
+  // Not noexcept, so growth copies instead of moving.
+  ThrowsOnCopy(ThrowsOnCopy && other)
+  : ThrowsOnCopy(static_cast<const ThrowsOnCopy &>(other))
+  {}
+
+  ThrowsOnCopy & operator=(const ThrowsOnCopy &) = default;
+
+  int value;
+};
+
+int ThrowsOnCopy::copies_left = 0;
+
+// An allocator which counts its allocations, and is only equal to its copies.
+template<typename T>
+struct CountingAllocator
+{
+  using value_type = T;
+  using propagate_on_container_move_assignment = std::false_type;
+
+  explicit CountingAllocator(std::shared_ptr<int> counter)
+  : allocations(std::move(counter))
+  {}
+
+  template<typename U>
+  CountingAllocator(const CountingAllocator<U> & other)  // NOLINT(runtime/explicit)
+  : allocations(other.allocations)
+  {}
+
+  T * allocate(std::size_t n)
+  {
+    ++*allocations;
+    return std::allocator<T>().allocate(n);
+  }
+
+  void deallocate(T * p, std::size_t n)
+  {
+    --*allocations;
+    std::allocator<T>().deallocate(p, n);
+  }
+
+  template<typename U>
+  bool operator==(const CountingAllocator<U> & other) const
+  {
+    return allocations == other.allocations;
+  }
+
+  template<typename U>
+  bool operator!=(const CountingAllocator<U> & other) const
+  {
+    return !(*this == other);
+  }
+
+  std::shared_ptr<int> allocations;
+};
+
+}  // namespace
+
+TEST(test_small_vector, inline_storage) {
+  rcpputils::small_vector<int, 4> vector;
+  EXPECT_TRUE(vector.empty());
+  EXPECT_TRUE(vector.is_inline());
+  EXPECT_EQ(vector.capacity(), 4u);
+  EXPECT_EQ(decltype(vector)::inline_capacity, 4u);
+  static_assert(sizeof(vector) >= 4 * sizeof(int), "elements are stored inline");
+
+  for (int i = 0; i < 4; ++i) {
+    vector.push_back(i);
+  }
+  EXPECT_TRUE(vector.is_inline());
+  const int * inline_data = vector.data();
+  vector.push_back(4);
+  EXPECT_FALSE(vector.is_inline());
+  EXPECT_NE(vector.data(), inline_data);
+  EXPECT_GE(vector.capacity(), 5u);
+  EXPECT_EQ(vector, (rcpputils::small_vector<int, 4>{0, 1, 2, 3, 4}));
+
+  vector.resize(2);
+  vector.shrink_to_fit();
+  EXPECT_TRUE(vector.is_inline());
+  EXPECT_EQ(vector, (rcpputils::small_vector<int, 4>{0, 1}));
+}
+
+TEST(test_small_vector, element_access) {
+  rcpputils::small_vector<std::string, 2> vector{"a", "b", "c"};
+  EXPECT_EQ(vector.size(), 3u);
+  EXPECT_EQ(vector.front(), "a");
+  EXPECT_EQ(vector.back(), "c");
+  EXPECT_EQ(vector[1], "b");
+  EXPECT_EQ(vector.at(2), "c");
+  EXPECT_THROW(vector.at(3), std::out_of_range);
+  EXPECT_EQ(std::string(vector.rbegin()->c_str()), "c");
+  EXPECT_EQ(std::vector<std::string>(vector.begin(), vector.end()),
+    (std::vector<std::string>{"a", "b", "c"}));
+  const auto & const_vector = vector;
+  EXPECT_EQ(const_vector.cend() - const_vector.cbegin(), 3);
+  EXPECT_EQ(*const_vector.crbegin(), "c");
+}
+
+TEST(test_small_vector, modifiers) {
+  rcpputils::small_vector<std::string, 4> vector;
+  vector.emplace_back(3u, 'x');
+  EXPECT_EQ(vector.back(), "xxx");
+  vector.insert(vector.begin(), "first");
+  vector.insert(vector.end(), 2u, "end");
+  vector.insert(vector.begin() + 1, {"one", "two"});
+  EXPECT_EQ(
+    vector, (rcpputils::small_vector<std::string, 4>{"first", "one", "two", "xxx", "end", "end"}));
+
+  auto it = vector.erase(vector.begin() + 1, vector.begin() + 3);
+  EXPECT_EQ(*it, "xxx");
+  it = vector.erase(vector.begin());
+  EXPECT_EQ(*it, "xxx");
+  vector.pop_back();
+  EXPECT_EQ(vector, (rcpputils::small_vector<std::string, 4>{"xxx", "end"}));
+
+  // Arguments referring to elements stay valid while the vector grows.
+  rcpputils::small_vector<std::string, 2> aliased{"long enough to not fit in the SSO", "b"};
+  aliased.push_back(aliased[0]);
+  aliased.insert(aliased.begin(), aliased[2]);
+  aliased.insert(aliased.begin(), 4u, aliased.back());
+  EXPECT_EQ(aliased.size(), 8u);
+  EXPECT_EQ(aliased[0], "long enough to not fit in the SSO");
+  EXPECT_EQ(aliased[5], "long enough to not fit in the SSO");
+  EXPECT_EQ(aliased[6], "b");
+
+  vector.assign(5u, "five");
+  EXPECT_EQ(vector.size(), 5u);
+  vector.assign({"a"});
+  EXPECT_EQ(vector, (rcpputils::small_vector<std::string, 4>{"a"}));
+  vector.resize(3u, "r");
+  EXPECT_EQ(vector, (rcpputils::small_vector<std::string, 4>{"a", "r", "r"}));
+  vector.clear();
+  EXPECT_TRUE(vector.empty());
+}
+
+TEST(test_small_vector, lifetimes) {
+  ASSERT_EQ(Tracked::live, 0);
+  {
+    rcpputils::small_vector<Tracked, 3> vector;
+    for (int i = 0; i < 10; ++i) {
+      vector.emplace_back(i);
+    }
+    EXPECT_EQ(Tracked::live, 10);
+    vector.erase(vector.begin() + 2, vector.begin() + 5);
+    EXPECT_EQ(Tracked::live, 7);
+    vector.resize(2);
+    vector.shrink_to_fit();
+    EXPECT_EQ(Tracked::live, 2);
+
+    rcpputils::small_vector<Tracked, 3> copy(vector);
+    copy = vector;
+    EXPECT_EQ(Tracked::live, 4);
+    rcpputils::small_vector<Tracked, 3> moved(std::move(copy));
+    EXPECT_EQ(Tracked::live, 4);
+    EXPECT_TRUE(copy.empty());  // NOLINT(bugprone-use-after-move)
+  }
+  EXPECT_EQ(Tracked::live, 0);
+}
+
+TEST(test_small_vector, move_semantics) {
+  // Allocated storage is stolen.
+  rcpputils::small_vector<std::string, 2> heap{"a", "b", "c"};
+  const std::string * heap_data = heap.data();
+  rcpputils::small_vector<std::string, 2> stolen(std::move(heap));
+  EXPECT_EQ(stolen.data(), heap_data);
+  EXPECT_TRUE(heap.empty());  // NOLINT(bugprone-use-after-move)
+  EXPECT_TRUE(heap.is_inline());
+
+  // Inline elements are moved one by one.
+  rcpputils::small_vector<std::string, 2> small{"x"};
+  rcpputils::small_vector<std::string, 2> moved(std::move(small));
+  EXPECT_TRUE(moved.is_inline());
+  EXPECT_EQ(moved, (rcpputils::small_vector<std::string, 2>{"x"}));
+  EXPECT_TRUE(small.empty());  // NOLINT(bugprone-use-after-move)
+
+  moved = std::move(stolen);
+  EXPECT_EQ(moved.data(), heap_data);
+  EXPECT_EQ(moved.size(), 3u);
+
+  rcpputils::small_vector<std::string, 2> other{"y"};
+  swap(moved, other);
+  EXPECT_EQ(other.data(), heap_data);
+  EXPECT_EQ(moved, (rcpputils::small_vector<std::string, 2>{"y"}));
+
+  moved = moved;
+  moved = std::move(moved);
+  EXPECT_EQ(moved.size(), 1u);
+
+  EXPECT_TRUE(other < moved);
+  EXPECT_TRUE(moved > other);
+  EXPECT_TRUE(moved <= moved);
+  EXPECT_TRUE(moved != other);
+}
+
+TEST(test_small_vector, strong_guarantee_on_growth) {
+  rcpputils::small_vector<ThrowsOnCopy, 2> vector;
+  vector.emplace_back(1);
+  vector.emplace_back(2);
+  ThrowsOnCopy::copies_left = 1;
+  EXPECT_THROW(vector.emplace_back(3), std::runtime_error);
+  ASSERT_EQ(vector.size(), 2u);
+  EXPECT_TRUE(vector.is_inline());
+  EXPECT_EQ(vector[0].value, 1);
+  EXPECT_EQ(vector[1].value, 2);
+}
+
+TEST(test_small_vector, allocator) {
+  auto allocations = std::make_shared<int>(0);
+  using allocator_t = CountingAllocator<int>;
+  {
+    const allocator_t allocator(allocations);
+    rcpputils::small_vector<int, 4, allocator_t> vector(allocator);
+    vector.assign({1, 2, 3, 4});
+    EXPECT_EQ(*allocations, 0);
+    vector.push_back(5);
+    EXPECT_EQ(*allocations, 1);
+    EXPECT_EQ(vector.get_allocator(), allocator);
+
+    // Allocators which compare unequal do not exchange storage.
+    const allocator_t other_allocator(std::make_shared<int>(0));
+    rcpputils::small_vector<int, 4, allocator_t> other(other_allocator);
+    other = std::move(vector);
+    EXPECT_EQ(other.size(), 5u);
+    EXPECT_EQ(*other_allocator.allocations, 1);
+    EXPECT_EQ(other.get_allocator(), other_allocator);
+    // The moved-from vector keeps its storage, the new one allocates its own.
+    rcpputils::small_vector<int, 4, allocator_t> extended(std::move(other), allocator);
+    EXPECT_EQ(extended.size(), 5u);
+    EXPECT_EQ(*allocations, 2);
+  }
+  EXPECT_EQ(*allocations, 0);
+
+  rcpputils::MonotonicArena arena(1024);
+  rcpputils::small_vector<std::string, 2, rcpputils::ArenaAllocator<std::string>> arena_vector(
+    (rcpputils::ArenaAllocator<std::string>(arena)));
+  for (int i = 0; i < 8; ++i) {
+    arena_vector.emplace_back(1u, static_cast<char>('a' + i));
+  }
+  EXPECT_GT(arena.bytes_used(), 0u);
+  EXPECT_EQ(arena_vector[7], "h");
+}
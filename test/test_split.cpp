@@ -18,9 +18,11 @@
 #include <list>
 #include <set>
 #include <string>
+#include <string_view>
 #include <tuple>
 #include <vector>
 
+#include "rcpputils/small_vector.hpp"
 #include "rcpputils/split.hpp"
 
 TEST(test_split, split) {
@@ -314,3 +316,151 @@ TEST(test_split, custom_iterator_exception)
   TripleExtractor triple_it;
   ASSERT_THROW(rcpputils::split(s, '/', triple_it), std::out_of_range);
 }
+
+TEST(test_split, split_view)
+{
+  {
+    std::vector<std::string_view> tokens;
+    for (const auto token : rcpputils::split_view("", '/')) {
+      tokens.push_back(token);
+    }
+    EXPECT_EQ(0u, tokens.size());
+  }
+  {
+    const std::string s = "/my//hello/world/";
+    std::vector<std::string_view> tokens;
+    for (const auto token : rcpputils::split_view(s, '/')) {
+      tokens.push_back(token);
+    }
+    ASSERT_EQ(5u, tokens.size());
+    EXPECT_EQ("", tokens[0]);
+    EXPECT_EQ("my", tokens[1]);
+    EXPECT_EQ("", tokens[2]);
+    EXPECT_EQ("hello", tokens[3]);
+    EXPECT_EQ("world", tokens[4]);
+    // Tokens do not own their data, they point into the input.
+    EXPECT_EQ(s.data() + 1, tokens[1].data());
+    EXPECT_EQ(s.data() + 11, tokens[4].data());
+  }
+  {
+    std::vector<std::string_view> tokens;
+    for (const auto token : rcpputils::split_view("/my//hello/world/", '/', true)) {
+      tokens.push_back(token);
+    }
+    ASSERT_EQ(3u, tokens.size());
+    EXPECT_EQ("my", tokens[0]);
+    EXPECT_EQ("hello", tokens[1]);
+    EXPECT_EQ("world", tokens[2]);
+  }
+  {
+    std::vector<std::string_view> tokens;
+    for (const auto token : rcpputils::split_view("/", '/')) {
+      tokens.push_back(token);
+    }
+    ASSERT_EQ(1u, tokens.size());
+    EXPECT_EQ("", tokens[0]);
+  }
+}
+
+TEST(test_split, split_view_iterator)
+{
+  const auto view = rcpputils::split_view("a:b:c", ':');
+  auto it = view.begin();
+  EXPECT_EQ(3, std::distance(view.begin(), view.end()));
+  EXPECT_EQ("a", *it);
+  EXPECT_EQ(1u, it->size());
+  auto copy = it++;
+  EXPECT_EQ("a", *copy);
+  EXPECT_EQ("b", *it);
+  EXPECT_NE(copy, it);
+  ++copy;
+  EXPECT_EQ(copy, it);
+  ++it;
+  ++it;
+  EXPECT_EQ(view.end(), it);
+}
+
+TEST(test_split, split_view_multi_character_delimiter)
+{
+  {
+    std::vector<std::string_view> tokens;
+    for (const auto token : rcpputils::split_view("my_pkg::msg::::MyMessage::", "::")) {
+      tokens.push_back(token);
+    }
+    ASSERT_EQ(4u, tokens.size());
+    EXPECT_EQ("my_pkg", tokens[0]);
+    EXPECT_EQ("msg", tokens[1]);
+    EXPECT_EQ("", tokens[2]);
+    EXPECT_EQ("MyMessage", tokens[3]);
+  }
+  {
+    std::vector<std::string_view> tokens;
+    for (const auto token : rcpputils::split_view("my_pkg::msg::::MyMessage", "::", true)) {
+      tokens.push_back(token);
+    }
+    ASSERT_EQ(3u, tokens.size());
+    EXPECT_EQ("my_pkg", tokens[0]);
+    EXPECT_EQ("msg", tokens[1]);
+    EXPECT_EQ("MyMessage", tokens[2]);
+  }
+  {
+    // An empty delimiter never matches.
+    std::vector<std::string_view> tokens;
+    for (const auto token : rcpputils::split_view("hello", "")) {
+      tokens.push_back(token);
+    }
+    ASSERT_EQ(1u, tokens.size());
+    EXPECT_EQ("hello", tokens[0]);
+  }
+}
+
+TEST(test_split, split_any_view)
+{
+  {
+    std::vector<std::string_view> tokens;
+    for (const auto token : rcpputils::split_any_view("__ns:=/foo;bar:baz", ":=;")) {
+      tokens.push_back(token);
+    }
+    ASSERT_EQ(5u, tokens.size());
+    EXPECT_EQ("__ns", tokens[0]);
+    EXPECT_EQ("", tokens[1]);
+    EXPECT_EQ("/foo", tokens[2]);
+    EXPECT_EQ("bar", tokens[3]);
+    EXPECT_EQ("baz", tokens[4]);
+  }
+  {
+    std::vector<std::string_view> tokens;
+    for (const auto token : rcpputils::split_any_view("__ns:=/foo;bar:baz", ":=;", true)) {
+      tokens.push_back(token);
+    }
+    ASSERT_EQ(4u, tokens.size());
+    EXPECT_EQ("__ns", tokens[0]);
+    EXPECT_EQ("/foo", tokens[1]);
+  }
+}
+
+TEST(test_split, split_into_container)
+{
+  using tokens_t = rcpputils::small_vector<std::string_view, 8>;
+  const std::string topic = "/ns/my_node/topic";
+  const tokens_t tokens = rcpputils::split<tokens_t>(topic, '/', true);
+  ASSERT_EQ(3u, tokens.size());
+  EXPECT_TRUE(tokens.is_inline());
+  EXPECT_EQ("ns", tokens[0]);
+  EXPECT_EQ("my_node", tokens[1]);
+  EXPECT_EQ("topic", tokens[2]);
+  // The tokens refer into the input.
+  EXPECT_EQ(topic.data() + 1, tokens[0].data());
+
+  const auto with_empty = rcpputils::split<tokens_t>(topic, '/');
+  ASSERT_EQ(4u, with_empty.size());
+  EXPECT_EQ("", with_empty[0]);
+
+  const auto many = rcpputils::split<tokens_t>("a,b,c,d,e,f,g,h,i,j", ',');
+  ASSERT_EQ(10u, many.size());
+  EXPECT_FALSE(many.is_inline());
+  EXPECT_EQ("j", many.back());
+
+  const auto owned = rcpputils::split<std::list<std::string>>("a:b", ':');
+  EXPECT_EQ((std::list<std::string>{"a", "b"}), owned);
+}
@@ -0,0 +1,221 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "rcpputils/filesystem_helper.hpp"
+#include "rcpputils/temp_file.hpp"
+
+using path = rcpputils::fs::path;
+
+namespace
+{
+
+bool write_all(int fd, const std::string & contents)
+{
+#ifdef _WIN32
+  return _write(fd, contents.data(), static_cast<unsigned int>(contents.size())) ==
+         static_cast<int>(contents.size());
+#else
+  return ::write(fd, contents.data(), contents.size()) ==
+         static_cast<ssize_t>(contents.size());
+#endif
+}
+
+std::string read_all(const path & p)
+{
+  std::ifstream stream(p.string(), std::ios::binary);
+  return {std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()};
+}
+
+std::size_t count_entries(const path & p)
+{
+  std::size_t count = 0u;
+  for (auto it = rcpputils::fs::directory_iterator(p);
+    it != rcpputils::fs::directory_iterator(); ++it)
+  {
+    ++count;
+  }
+  return count;
+}
+
+}  // namespace
+
+TEST(TestTempFile, temp_directory) {
+  path kept;
+  {
+    const auto directory = rcpputils::fs::create_temp_directory("rcpputils_test_");
+    kept = directory.path();
+    EXPECT_TRUE(rcpputils::fs::is_directory(kept));
+    EXPECT_EQ(kept.parent_path().string(), rcpputils::fs::temp_directory_path().string());
+    const std::string name = kept.filename().string();
+    EXPECT_EQ(name.size(), std::string("rcpputils_test_").size() + 6u);
+    EXPECT_EQ(name.rfind("rcpputils_test_", 0), 0u);
+
+    // The contents are removed with the directory.
+    ASSERT_TRUE(rcpputils::fs::create_directories(kept / "nested" / "deeper"));
+    std::ofstream((kept / "nested" / "file.txt").string()) << "contents";
+  }
+  EXPECT_FALSE(rcpputils::fs::exists(kept));
+
+  // Directories in the same parent never share a name.
+  const auto parent = rcpputils::fs::create_temp_directory();
+  std::vector<rcpputils::fs::temp_directory> directories;
+  std::set<std::string> names;
+  for (int i = 0; i < 100; ++i) {
+    directories.push_back(rcpputils::fs::create_temp_directory("d", parent.path()));
+    names.insert(directories.back().path().string());
+  }
+  EXPECT_EQ(names.size(), 100u);
+  EXPECT_EQ(count_entries(parent.path()), 100u);
+  directories.clear();
+  EXPECT_EQ(count_entries(parent.path()), 0u);
+}
+
+TEST(TestTempFile, temp_directory_ownership) {
+  auto directory = rcpputils::fs::create_temp_directory();
+  const path p = directory.path();
+
+  rcpputils::fs::temp_directory moved(std::move(directory));
+  EXPECT_TRUE(directory.path().empty());  // NOLINT(bugprone-use-after-move)
+  EXPECT_EQ(moved.path().string(), p.string());
+
+  rcpputils::fs::temp_directory assigned;
+  assigned = std::move(moved);
+  EXPECT_TRUE(rcpputils::fs::is_directory(p));
+
+  const path released = assigned.release();
+  EXPECT_TRUE(assigned.path().empty());
+  EXPECT_EQ(released.string(), p.string());
+
+  {
+    rcpputils::fs::temp_directory adopted(released);
+    std::error_code ec;
+    EXPECT_EQ(adopted.remove(ec), 1u);
+    EXPECT_FALSE(ec);
+    EXPECT_TRUE(adopted.path().empty());
+  }
+  EXPECT_FALSE(rcpputils::fs::exists(p));
+}
+
+TEST(TestTempFile, temp_file) {
+  const auto parent = rcpputils::fs::create_temp_directory();
+  path kept;
+  {
+    const auto file = rcpputils::fs::create_temp_file("bag_", parent.path());
+    ASSERT_TRUE(file.is_open());
+    EXPECT_FALSE(file.is_anonymous());
+    kept = file.path();
+    EXPECT_TRUE(rcpputils::fs::is_regular_file(kept));
+    EXPECT_EQ(kept.filename().string().rfind("bag_", 0), 0u);
+    ASSERT_TRUE(write_all(file.native_handle(), "recorded data"));
+    EXPECT_EQ(read_all(kept), "recorded data");
+  }
+  EXPECT_FALSE(rcpputils::fs::exists(kept));
+
+  auto file = rcpputils::fs::create_temp_file("bag_", parent.path());
+  rcpputils::fs::temp_file moved(std::move(file));
+  EXPECT_FALSE(file.is_open());  // NOLINT(bugprone-use-after-move)
+  ASSERT_TRUE(write_all(moved.native_handle(), "kept"));
+  kept = moved.release();
+  EXPECT_FALSE(moved.is_open());
+  EXPECT_TRUE(moved.path().empty());
+  EXPECT_EQ(read_all(kept), "kept");
+
+  auto closed = rcpputils::fs::create_temp_file("bag_", parent.path());
+  const path closed_path = closed.path();
+  closed.close();
+  EXPECT_FALSE(closed.is_open());
+  EXPECT_FALSE(rcpputils::fs::exists(closed_path));
+  EXPECT_EQ(count_entries(parent.path()), 1u);
+}
+
+TEST(TestTempFile, anonymous_temp_file) {
+  const auto parent = rcpputils::fs::create_temp_directory();
+  {
+    const auto scratch = rcpputils::fs::create_anonymous_temp_file(parent.path());
+    ASSERT_TRUE(scratch.is_open());
+    EXPECT_TRUE(scratch.is_anonymous());
+    EXPECT_TRUE(scratch.path().empty());
+    EXPECT_TRUE(write_all(scratch.native_handle(), "scratch"));
+#ifndef _WIN32
+    // Nothing is visible in the parent, even while the file is open.
+    EXPECT_EQ(count_entries(parent.path()), 0u);
+#endif
+  }
+  EXPECT_EQ(count_entries(parent.path()), 0u);
+}
+
+TEST(TestTempFile, errors) {
+  const auto parent = rcpputils::fs::create_temp_directory();
+  const path missing = parent.path() / "missing";
+
+  std::error_code ec;
+  EXPECT_TRUE(rcpputils::fs::create_temp_directory("prefix", missing, ec).path().empty());
+  EXPECT_EQ(ec, std::errc::no_such_file_or_directory);
+  EXPECT_FALSE(rcpputils::fs::create_temp_file("prefix", missing, ec).is_open());
+  EXPECT_EQ(ec, std::errc::no_such_file_or_directory);
+  EXPECT_FALSE(rcpputils::fs::create_anonymous_temp_file(missing, ec).is_open());
+  EXPECT_TRUE(ec);
+
+  EXPECT_TRUE(rcpputils::fs::create_temp_directory("sub/dir", parent.path(), ec).path().empty());
+  EXPECT_EQ(ec, std::errc::invalid_argument);
+  EXPECT_FALSE(rcpputils::fs::create_temp_file("sub\\file", parent.path(), ec).is_open());
+  EXPECT_EQ(ec, std::errc::invalid_argument);
+
+  EXPECT_THROW(rcpputils::fs::create_temp_directory("prefix", missing), std::system_error);
+  EXPECT_THROW(rcpputils::fs::create_temp_file("prefix", missing), std::system_error);
+  EXPECT_THROW(rcpputils::fs::create_anonymous_temp_file(missing), std::system_error);
+
+  const auto file = rcpputils::fs::create_temp_file("prefix", parent.path(), ec);
+  EXPECT_FALSE(ec);
+  EXPECT_TRUE(file.is_open());
+}
+
+TEST(TestTempFile, concurrent_creation) {
+  const auto parent = rcpputils::fs::create_temp_directory();
+  constexpr int kThreads = 4;
+  constexpr int kFilesPerThread = 50;
+  std::vector<std::vector<rcpputils::fs::temp_file>> files(kThreads);
+  std::vector<std::thread> threads;
+  for (auto & thread_files : files) {
+    threads.emplace_back(
+      [&parent, &thread_files]() {
+        for (int i = 0; i < kFilesPerThread; ++i) {
+          thread_files.push_back(rcpputils::fs::create_temp_file("", parent.path()));
+        }
+      });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(count_entries(parent.path()), static_cast<std::size_t>(kThreads * kFilesPerThread));
+  files.clear();
+  EXPECT_EQ(count_entries(parent.path()), 0u);
+}